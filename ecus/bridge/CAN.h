@@ -5,35 +5,96 @@
 
 #include <Canny.h>
 #include <Canny/MCP2518.h>
+#include <Core.h>
+#include <Platform.h>
+#include <SPI.h>
 #include "Debug.h"
 
 Canny::MCP2518<Canny::CAN20Frame> CAN(MCP2518_CS_PIN);
 
+#if defined(VEHICLE_IRQ_ENABLE)
+// Frames drained from the controller by its interrupt handler.
+R51::IRQConnection<Canny::CAN20Frame, VEHICLE_IRQ_BUFFER> CAN_IRQ(&CAN);
+
+void onCANInterrupt() {
+    CAN_IRQ.onInterrupt();
+}
+#endif
+
 namespace R51 {
 
+// R51 climate, settings, tire, and IPDM state frames.
+static const IDRule kVehicleReadIDs[] = {
+    stdID(0x54A, 0x7FE),
+    stdID(0x72E, 0x7FE),
+    stdID(0x385),
+    stdID(0x625),
+};
+
+// R51 climate and settings control frames.
+static const IDRule kVehicleWriteIDs[] = {
+    stdID(0x540, 0x7FE),
+    stdID(0x71E, 0x7FE),
+};
+
+// R51 climate control frames. Each carries the full control state so only the
+// latest frame needs to be sent when the bus is congested.
+static const IDRule kVehicleCoalesceIDs[] = {
+    stdID(0x540, 0x7FE),
+};
+
+// Paces climate control frames to a burst of 4 and then 20/s and settings
+// frames to a burst of 2 and then 50/s. Encoder spins can otherwise flood the
+// bus with control frames.
+inline void paceVehicleWrites(CANPacer* pacer) {
+    pacer->limit(stdID(0x540, 0x7FE), 50, 4);
+    pacer->limit(stdID(0x71E, 0x7FE), 20, 2);
+}
+
 // CAN connection which filters and buffers frames; and logs errors to serial.
 class CANConnection : public Canny::BufferedConnection<Canny::CAN20Frame> {
     public:
         CANConnection() :
             Canny::BufferedConnection<Canny::CAN20Frame>(
-                    &CAN, VEHICLE_READ_BUFFER, VEHICLE_WRITE_BUFFER) {}
+#if defined(VEHICLE_IRQ_ENABLE)
+                    &CAN_IRQ,
+#else
+                    &CAN,
+#endif
+                    VEHICLE_READ_BUFFER, VEHICLE_WRITE_BUFFER),
+            read_ids_(kVehicleReadIDs), write_ids_(kVehicleWriteIDs) {}
 
         bool begin() {
             // Initialize controller.
-            return CAN.begin(VEHICLE_CAN_MODE);
+            if (!CAN.begin(VEHICLE_CAN_MODE)) {
+                return false;
+            }
+            // Program the controller's filters so that unused frames are not
+            // read over SPI. IDs the registers can't hold exactly are caught
+            // by readFilter.
+            MCP2518Filters<Canny::MCP2518<Canny::CAN20Frame>> filters(&CAN);
+            if (!programFilters(kVehicleReadIDs, &filters)) {
+                DEBUG_MSG("can: hardware filters are not exact");
+            }
+#if defined(VEHICLE_IRQ_ENABLE)
+            // Drain the controller when it raises its interrupt line. Frames
+            // received before the handler is attached are drained here.
+            pinMode(VEHICLE_IRQ_PIN, INPUT_PULLUP);
+            SPI.usingInterrupt(digitalPinToInterrupt(VEHICLE_IRQ_PIN));
+            attachInterrupt(digitalPinToInterrupt(VEHICLE_IRQ_PIN), onCANInterrupt, FALLING);
+            CAN_IRQ.onInterrupt();
+#endif
+            return true;
         }
 
         // Read R51 climate, settings, tire, and IPDM state frames.
         bool readFilter(const Canny::CAN20Frame& frame) const override {
-            return (frame.id() & 0xFFFFFFFE) == 0x54A ||
-                   (frame.id() & 0xFFFFFFFE) == 0x72E ||
-                    frame.id() == 0x385 || frame.id() == 0x625;
+            return read_ids_.match(frame);
         }
 
         // Write R51 climate and settings control frames.
         bool writeFilter(const Canny::CAN20Frame& frame) const override {
-            return (frame.id() & 0xFFFFFFFE) == 0x540 ||
-                   (frame.id() & 0xFFFFFFFE) == 0x71E;
+            return write_ids_.match(frame);
         }
 
         // Log read errors to debug serial.
@@ -46,6 +107,10 @@ class CANConnection : public Canny::BufferedConnection<Canny::CAN20Frame> {
             DEBUG_MSG_VAL("can: write error: ", err);
             DEBUG_MSG_OBJ("can: dropped frame: ", frame);
         }
+
+    private:
+        IDFilter read_ids_;
+        IDFilter write_ids_;
 };
 
 }  // namespace R51
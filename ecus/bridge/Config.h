@@ -11,6 +11,19 @@
 #define SERIAL_BAUDRATE 115200
 #define SERIAL_WAIT false
 
+// Per-node bus stats are collected when the libraries are built with
+// -DBUS_STATS_ENABLE. They are shown by the "stats nodes" console command.
+// Uncomment to also send them as CONTROLLER events, one node per interval.
+//#define BUS_STATS_EVENT_MS 1000
+
+// Uncomment to record each core's bus into a RAM ring of this many bytes. A
+// trace freezes on a pipe overrun or "trace freeze" and is written to the
+// serial device in binary by "trace dump ID", where ID is 0 for the I/O core
+// and 1 for the processing core. Recording continues for TRACE_POST_TRIGGER
+// messages after an overrun.
+//#define TRACE_SIZE 4096
+#define TRACE_POST_TRIGGER 16
+
 // Resolution of analogRead return value.
 #define ARDUINO_ANALOG_RESOLUTION 4096
 
@@ -24,11 +37,32 @@
 #define IO_CORE_BUFFER_SIZE 32
 #define PROC_CORE_BUFFER_SIZE 16
 
+// Maximum number of messages and time in microseconds spent draining the pipe
+// on each core per loop.
+#define PIPE_DRAIN_COUNT 8
+#define PIPE_DRAIN_US 250
+
+// Assemble the processing bus at compile time. Nodes are called without
+// virtual dispatch. Comment out to use the runtime indexed bus.
+#define STATIC_BUS_ENABLE
+
 // Vehicle CAN bus mode and speed. This is CAN 2.0 at 500K for the R51.
 #define VEHICLE_CAN_MODE Canny::CAN20_500K
 #define VEHICLE_READ_BUFFER 16
+#define VEHICLE_READ_BURST 8
+#define VEHICLE_READ_BURST_US 200
 #define VEHICLE_WRITE_BUFFER 2
 
+// Minimum time in milliseconds between frames written to the vehicle CAN bus.
+// Climate and settings frames are further limited per ID in CAN.h.
+#define VEHICLE_WRITE_SPACING_MS 1
+
+// Drain the vehicle CAN controller into a ring of VEHICLE_IRQ_BUFFER frames
+// from its interrupt line. Comment out to poll the controller.
+#define VEHICLE_IRQ_ENABLE
+#define VEHICLE_IRQ_PIN MCP2518_IRQ_PIN
+#define VEHICLE_IRQ_BUFFER 16
+
 // Uncomment to enable J1939 on boards that support it.
 #define J1939_ENABLE
 #define J1939_ADDRESS 0x18
@@ -36,8 +70,16 @@
 #define J1939_PROMISCUOUS true
 #define J1939_CAN_MODE Canny::CAN20_250K
 #define J1939_READ_BUFFER 32
+#define J1939_READ_BURST 16
+#define J1939_READ_BURST_US 250
 #define J1939_WRITE_BUFFER 2
 
+// Drain the J1939 CAN controller into a ring of J1939_IRQ_BUFFER frames
+// from its interrupt line. Comment out to poll the controller.
+#define J1939_IRQ_ENABLE
+#define J1939_IRQ_PIN MCP2515_IRQ_PIN
+#define J1939_IRQ_BUFFER 32
+
 // Uncomment the following line to enable rear defrost control.
 #define DEFROST_HEATER_ENABLE
 #define DEFROST_HEATER_PIN 24
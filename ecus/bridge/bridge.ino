@@ -23,8 +23,6 @@ extern "C" {
 };
 
 using namespace ::R51;
-using ::Caster::Bus;
-using ::Caster::Node;
 
 // core synchronization
 SyncWait sync;
@@ -35,9 +33,16 @@ SyncWait sync;
 R51::ConsoleNode console(&SERIAL_DEVICE);
 #endif
 
+// Periodic bus stats events.
+#if defined(BUS_STATS_EVENT_MS)
+BusStatsNode bus_stats(BUS_STATS_EVENT_MS);
+#endif
+
 // vehicle CAN connection
 CANConnection can_conn;
 CANGateway can_gw(&can_conn);
+IDFilter can_coalesce(kVehicleCoalesceIDs);
+CANPacer can_pacer(VEHICLE_WRITE_SPACING_MS);
 
 // control system J1939 connection
 #if defined(J1939_ENABLE)
@@ -82,39 +87,149 @@ SteeringKeypad steering_keypad(STEERING_KEYPAD_ID, STEERING_PIN_A, STEERING_PIN_
 // Create internal bus.
 FilteredPipe pipe;
 
-Node<Message>* io_nodes[] = {
-    pipe.left(),
-    &can_gw,
+// Deadlines of the processing nodes' tickers.
+TimerWheel proc_timers;
+
+// Bus traces. Each core records its own bus.
+#if defined(TRACE_SIZE)
+PipeOverrunTrigger io_trace_trigger(&pipe);
+PipeOverrunTrigger proc_trace_trigger(&pipe);
+TraceNode io_trace(0x00, TRACE_SIZE, &SERIAL_DEVICE, TRACE_POST_TRIGGER);
+TraceNode proc_trace(0x01, TRACE_SIZE, &SERIAL_DEVICE, TRACE_POST_TRIGGER);
+#endif
+
+BusNode io_nodes[] = {
+    {pipe.left(), "pipe"},
+    {&can_gw, "can_gw"},
 #if defined(J1939_ENABLE)
-    &j1939_gw,
+    {&j1939_gw, "j1939_gw"},
 #endif
 #if defined(STEERING_KEYPAD_ENABLE)
-    &steering_keypad,
+    {&steering_keypad, "steering_keypad"},
+#endif
+#if defined(TRACE_SIZE)
+    {&io_trace, "io_trace"},
 #endif
 };
-Bus<Message> io_bus(io_nodes, sizeof(io_nodes)/sizeof(io_nodes[0]));
+IndexedBus io_bus(io_nodes, sizeof(io_nodes)/sizeof(io_nodes[0]));
 
-Node<Message>* proc_nodes[] = {
+#if defined(STATIC_BUS_ENABLE)
+StaticBus<
+    TimerWheel,
+    PipeNode,
+    Climate,
+    Settings,
+    IPDM,
+    Illum,
+    TirePressure
+#if defined(DEBUG_ENABLE)
+    , ConsoleNode
+#endif
+#if defined(J1939_ENABLE)
+    , J1939Adapter
+#endif
+#if defined(BLUETOOTH_ENABLE)
+    , BLENode
+    , RealDashGateway
+#endif
+#if defined(DEFROST_HEATER_ENABLE)
+    , Defrost
+#endif
+#if defined(BUS_STATS_EVENT_MS)
+    , BusStatsNode
+#endif
+#if defined(TRACE_SIZE)
+    , TraceNode
+#endif
+> proc_bus(
+    &proc_timers,
+    (PipeNode*)pipe.right(),
     &climate,
     &settings,
     &ipdm,
     &illum,
-    &tire_pressure,
+    &tire_pressure
+#if defined(DEBUG_ENABLE)
+    , &console
+#endif
+#if defined(J1939_ENABLE)
+    , &j1939_adapter
+#endif
+#if defined(BLUETOOTH_ENABLE)
+    , &ble_monitor
+    , &realdash
+#endif
+#if defined(DEFROST_HEATER_ENABLE)
+    , &defrost
+#endif
+#if defined(BUS_STATS_EVENT_MS)
+    , &bus_stats
+#endif
+#if defined(TRACE_SIZE)
+    , &proc_trace
+#endif
+);
+
+// Names of the processing nodes in bus order for the stats command.
+const char* proc_names[] = {
+    "proc_timers",
+    "pipe",
+    "climate",
+    "settings",
+    "ipdm",
+    "illum",
+    "tire_pressure",
 #if defined(DEBUG_ENABLE)
-    &console,
+    "console",
 #endif
 #if defined(J1939_ENABLE)
-    &j1939_adapter,
+    "j1939_adapter",
 #endif
 #if defined(BLUETOOTH_ENABLE)
-    &ble_monitor,
-    &realdash,
+    "ble_monitor",
+    "realdash",
 #endif
 #if defined(DEFROST_HEATER_ENABLE)
-    &defrost,
+    "defrost",
+#endif
+#if defined(BUS_STATS_EVENT_MS)
+    "bus_stats",
+#endif
+#if defined(TRACE_SIZE)
+    "proc_trace",
 #endif
 };
-Bus<Message> proc_bus(proc_nodes, sizeof(proc_nodes)/sizeof(proc_nodes[0]));
+#else
+BusNode proc_nodes[] = {
+    {&proc_timers, "proc_timers"},
+    {pipe.right(), "pipe"},
+    {&climate, "climate"},
+    {&settings, "settings"},
+    {&ipdm, "ipdm"},
+    {&illum, "illum"},
+    {&tire_pressure, "tire_pressure"},
+#if defined(DEBUG_ENABLE)
+    {&console, "console"},
+#endif
+#if defined(J1939_ENABLE)
+    {&j1939_adapter, "j1939_adapter"},
+#endif
+#if defined(BLUETOOTH_ENABLE)
+    {&ble_monitor, "ble_monitor"},
+    {&realdash, "realdash"},
+#endif
+#if defined(DEFROST_HEATER_ENABLE)
+    {&defrost, "defrost"},
+#endif
+#if defined(BUS_STATS_EVENT_MS)
+    {&bus_stats, "bus_stats"},
+#endif
+#if defined(TRACE_SIZE)
+    {&proc_trace, "proc_trace"},
+#endif
+};
+IndexedBus proc_bus(proc_nodes, sizeof(proc_nodes)/sizeof(proc_nodes[0]));
+#endif
 
 void setup_serial() {
 #if defined(DEBUG_ENABLE) || defined(CONSOLE_ENABLE)
@@ -153,6 +268,10 @@ void setup_can() {
         DEBUG_MSG("setup: CAN failed");
         delay(500);
     }
+    can_gw.burst(VEHICLE_READ_BURST, VEHICLE_READ_BURST_US);
+    can_gw.coalesce(&can_coalesce);
+    paceVehicleWrites(&can_pacer);
+    can_gw.pace(&can_pacer);
 }
 
 void setup_j1939() {
@@ -162,6 +281,7 @@ void setup_j1939() {
         DEBUG_MSG("setup: J1939 failed");
         delay(500);
     }
+    j1939_gw.burst(J1939_READ_BURST, J1939_READ_BURST_US);
 #endif
 }
 
@@ -190,8 +310,43 @@ void setup_steering() {
     steering_keypad.begin();
 }
 
+void setup_stats() {
+#if defined(CONSOLE_ENABLE)
+    console.addBusStats("io", io_bus.stats());
+    console.addBusStats("proc", proc_bus.stats());
+    console.addQueueStats("pipe", &pipe);
+#endif
+#if defined(BUS_STATS_EVENT_MS)
+    bus_stats.add(0x00, io_bus.stats());
+    bus_stats.add(0x01, proc_bus.stats());
+#endif
+}
+
+void setup_proc_timers() {
+    climate.schedule(&proc_timers);
+    ipdm.schedule(&proc_timers);
+    tire_pressure.schedule(&proc_timers);
+#if defined(BLUETOOTH_ENABLE)
+    realdash.schedule(&proc_timers);
+#endif
+#if defined(DEFROST_HEATER_ENABLE)
+    defrost.schedule(&proc_timers);
+#endif
+#if defined(BUS_STATS_EVENT_MS)
+    bus_stats.schedule(&proc_timers);
+#endif
+}
+
+void setup_trace() {
+#if defined(TRACE_SIZE)
+    io_trace.triggerOn(&io_trace_trigger);
+    proc_trace.triggerOn(&proc_trace_trigger);
+#endif
+}
+
 void setup() {
     setup_serial();
+    setup_trace();
     setup_watchdog();
     setup_spi();
     setup_can();
@@ -206,7 +361,12 @@ void setup() {
 
 void setup1() {
     setup_serial();
+    setup_stats();
+    setup_proc_timers();
     proc_bus.init();
+#if defined(STATIC_BUS_ENABLE)
+    proc_bus.stats()->names(proc_names, sizeof(proc_names)/sizeof(proc_names[0]));
+#endif
     sync.wait();
 }
 
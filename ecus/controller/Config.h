@@ -10,6 +10,19 @@
 #define SERIAL_BAUDRATE 115200
 #define SERIAL_WAIT false
 
+// Per-node bus stats are collected when the libraries are built with
+// -DBUS_STATS_ENABLE. They are shown by the "stats nodes" console command.
+// Uncomment to also send them as CONTROLLER events, one node per interval.
+//#define BUS_STATS_EVENT_MS 1000
+
+// Uncomment to record each core's bus into a RAM ring of this many bytes. A
+// trace freezes on a pipe overrun or "trace freeze" and is written to the
+// serial device in binary by "trace dump ID", where ID is 0 for the I/O core
+// and 1 for the processing core. Recording continues for TRACE_POST_TRIGGER
+// messages after an overrun.
+//#define TRACE_SIZE 4096
+#define TRACE_POST_TRIGGER 16
+
 // I2C hardware configuration.
 #define I2C_DEVICE Wire1
 #define I2C_SDA_PIN 6
@@ -23,6 +36,11 @@
 #define IO_CORE_BUFFER_SIZE 32
 #define PROC_CORE_BUFFER_SIZE 16
 
+// Maximum number of messages and time in microseconds spent draining the pipe
+// on each core per loop.
+#define PIPE_DRAIN_COUNT 8
+#define PIPE_DRAIN_US 250
+
 #define WATCHDOG_TIMEOUT 500
 
 // J1939 gateway configuration.
@@ -31,8 +49,16 @@
 #define J1939_PROMISCUOUS true
 #define J1939_CAN_MODE Canny::CAN20_250K
 #define J1939_READ_BUFFER 128
+#define J1939_READ_BURST 16
+#define J1939_READ_BURST_US 250
 #define J1939_WRITE_BUFFER 4
 
+// Uncomment to drain the J1939 CAN controller into a ring of J1939_IRQ_BUFFER
+// frames from its interrupt line. Check the board's IRQ wiring first.
+//#define J1939_IRQ_ENABLE
+#define J1939_IRQ_PIN MCP2515_IRQ_PIN
+#define J1939_IRQ_BUFFER 32
+
 // Rotary encoder configuration.
 #define ROTARY_ENCODER_ID 0x01
 #define ROTARY_ENCODER_IRQ_PIN 8
@@ -6,10 +6,21 @@
 #include <Canny.h>
 #include <Canny/MCP2515.h>
 #include <Core.h>
+#include <Platform.h>
+#include <SPI.h>
 #include "Debug.h"
 
 Canny::MCP2515<Canny::J1939Message> J1939(MCP2515_CS_PIN);
 
+#if defined(J1939_IRQ_ENABLE)
+// Frames drained from the controller by its interrupt handler.
+R51::IRQConnection<Canny::J1939Message, J1939_IRQ_BUFFER> J1939_IRQ(&J1939);
+
+void onJ1939Interrupt() {
+    J1939_IRQ.onInterrupt();
+}
+#endif
+
 namespace R51 {
 
 // J1939 connection which that logs errors to serial.
@@ -19,10 +30,26 @@ class J1939Connection : public Canny::BufferedConnection<Canny::J1939Message> {
     public:
         J1939Connection() :
             Canny::BufferedConnection<Canny::J1939Message>(
-                    &J1939, J1939_READ_BUFFER, J1939_WRITE_BUFFER) {}
+#if defined(J1939_IRQ_ENABLE)
+                    &J1939_IRQ,
+#else
+                    &J1939,
+#endif
+                    J1939_READ_BUFFER, J1939_WRITE_BUFFER) {}
 
         bool begin() {
-            return J1939.begin(J1939_CAN_MODE);
+            if (!J1939.begin(J1939_CAN_MODE)) {
+                return false;
+            }
+#if defined(J1939_IRQ_ENABLE)
+            // Drain the controller when it raises its interrupt line. Frames
+            // received before the handler is attached are drained here.
+            pinMode(J1939_IRQ_PIN, INPUT_PULLUP);
+            SPI.usingInterrupt(digitalPinToInterrupt(J1939_IRQ_PIN));
+            attachInterrupt(digitalPinToInterrupt(J1939_IRQ_PIN), onJ1939Interrupt, FALLING);
+            J1939_IRQ.onInterrupt();
+#endif
+            return true;
         }
 
         // Log read errors to debug serial.
@@ -10,16 +10,19 @@ namespace R51 {
 
 class FilteredPipe : public Pipe {
     public:
-        FilteredPipe() : Pipe(IO_CORE_BUFFER_SIZE, PROC_CORE_BUFFER_SIZE) {}
+        FilteredPipe() : Pipe(IO_CORE_BUFFER_SIZE, PROC_CORE_BUFFER_SIZE,
+                PIPE_DRAIN_COUNT, PIPE_DRAIN_US) {}
 
         // Filtering for the I/O core. Forwards all frames to the processing core.
         bool filterLeft(const Message&) override { return true; }
 
-        // Filtering for the processing core. Only forwards CAN bus frames and
-        // system events to the I/O core.
+        // Filtering for the processing core. Forwards CAN frames, J1939
+        // messages, and trace commands to the I/O core.
         bool filterRight(const Message& msg) override {
             return msg.type() == Message::CAN_FRAME ||
-                msg.type() == Message::J1939_MESSAGE;
+                msg.type() == Message::J1939_MESSAGE ||
+                msg.type() == Message::J1939_TRANSFER ||
+                TraceCommand::match(msg);
         }
 
         void onBufferOverrun(const Message& msg) override {
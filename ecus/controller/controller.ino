@@ -20,8 +20,6 @@ extern "C" {
 
 using namespace ::R51;
 using ::Canny::J1939Message;
-using ::Caster::Bus;
-using ::Caster::Node;
 
 // Init core synchronization.
 SyncWait sync;
@@ -32,6 +30,11 @@ SyncWait sync;
 R51::ConsoleNode console(&SERIAL_DEVICE);
 #endif
 
+// Periodic bus stats events.
+#if defined(BUS_STATS_EVENT_MS)
+BusStatsNode bus_stats(BUS_STATS_EVENT_MS);
+#endif
+
 // Create J1939 connection.
 J1939Connection j1939_conn;
 J1939Gateway j1939_gw(&j1939_conn, J1939_ADDRESS, J1939_NAME, J1939_PROMISCUOUS);
@@ -65,28 +68,49 @@ SteeringControls steering_controls(STEERING_KEYPAD_ID);
 // Create internal bus.
 FilteredPipe pipe;
 
-Node<Message>* io_nodes[] = {
-    pipe.left(),
-    &j1939_gw,
-    &rotary_encoder_group,
+// Deadlines of the processing nodes' tickers.
+TimerWheel proc_timers;
+
+// Bus traces. Each core records its own bus.
+#if defined(TRACE_SIZE)
+PipeOverrunTrigger io_trace_trigger(&pipe);
+PipeOverrunTrigger proc_trace_trigger(&pipe);
+TraceNode io_trace(0x00, TRACE_SIZE, &SERIAL_DEVICE, TRACE_POST_TRIGGER);
+TraceNode proc_trace(0x01, TRACE_SIZE, &SERIAL_DEVICE, TRACE_POST_TRIGGER);
+#endif
+
+BusNode io_nodes[] = {
+    {pipe.left(), "pipe"},
+    {&j1939_gw, "j1939_gw"},
+    {&rotary_encoder_group, "rotary_encoder_group"},
+#if defined(TRACE_SIZE)
+    {&io_trace, "io_trace"},
+#endif
 };
-Bus<Message> io_bus(io_nodes, sizeof(io_nodes)/sizeof(io_nodes[0]));
+IndexedBus io_bus(io_nodes, sizeof(io_nodes)/sizeof(io_nodes[0]));
 
-Node<Message>* proc_nodes[] = {
-    pipe.right(),
+BusNode proc_nodes[] = {
+    {&proc_timers, "proc_timers"},
+    {pipe.right(), "pipe"},
 #if defined(DEBUG_ENABLE)
-    &console,
+    {&console, "console"},
+#endif
+    {&j1939_adapter, "j1939_adapter"},
+    {&fusion, "fusion"},
+    {&blink_keypad, "blink_keypad"},
+    {&blink_keybox, "blink_keybox"},
+    {&hmi, "hmi"},
+    {&nav_controls, "nav_controls"},
+    {&power_controls, "power_controls"},
+    {&steering_controls, "steering_controls"},
+#if defined(BUS_STATS_EVENT_MS)
+    {&bus_stats, "bus_stats"},
+#endif
+#if defined(TRACE_SIZE)
+    {&proc_trace, "proc_trace"},
 #endif
-    &j1939_adapter,
-    &fusion,
-    &blink_keypad,
-    &blink_keybox,
-    &hmi,
-    &nav_controls,
-    &power_controls,
-    &steering_controls,
 };
-Bus<Message> proc_bus(proc_nodes, sizeof(proc_nodes)/sizeof(proc_nodes[0]));
+IndexedBus proc_bus(proc_nodes, sizeof(proc_nodes)/sizeof(proc_nodes[0]));
 
 void setup_serial() {
 #if defined(DEBUG_ENABLE) || defined(CONSOLE_ENABLE)
@@ -127,6 +151,7 @@ void setup_j1939() {
         DEBUG_MSG("setup: J1939 failed");
         delay(500);
     }
+    j1939_gw.burst(J1939_READ_BURST, J1939_READ_BURST_US);
 }
 
 void setup_hmi() {
@@ -140,8 +165,36 @@ void setup_rotary_encoders() {
     rotary_encoder1.begin(ROTARY_ENCODER_ADDR1);
 }
 
+void setup_stats() {
+#if defined(CONSOLE_ENABLE)
+    console.addBusStats("io", io_bus.stats());
+    console.addBusStats("proc", proc_bus.stats());
+    console.addQueueStats("pipe", &pipe);
+#endif
+#if defined(BUS_STATS_EVENT_MS)
+    bus_stats.add(0x00, io_bus.stats());
+    bus_stats.add(0x01, proc_bus.stats());
+#endif
+}
+
+void setup_trace() {
+#if defined(TRACE_SIZE)
+    io_trace.triggerOn(&io_trace_trigger);
+    proc_trace.triggerOn(&proc_trace_trigger);
+#endif
+}
+
+void setup_proc_timers() {
+    fusion.schedule(&proc_timers);
+    blink_keybox.schedule(&proc_timers);
+#if defined(BUS_STATS_EVENT_MS)
+    bus_stats.schedule(&proc_timers);
+#endif
+}
+
 void setup() {
     setup_serial();
+    setup_trace();
     setup_spi();
     setup_watchdog();
     setup_i2c();
@@ -155,6 +208,8 @@ void setup() {
 void setup1() {
     setup_serial();
     setup_hmi();
+    setup_stats();
+    setup_proc_timers();
     sync.wait();
     proc_bus.init();
 }
@@ -5,38 +5,90 @@
 
 #include <Canny.h>
 #include <Canny/MCP2515.h>
+#include <Core.h>
+#include <Platform.h>
+#include <SPI.h>
 #include "Debug.h"
 
 Canny::MCP2515<Canny::CAN20Frame> CAN(MCP2515_CS_PIN);
 
+#if defined(VEHICLE_IRQ_ENABLE)
+// Frames drained from the controller by its interrupt handler.
+R51::IRQConnection<Canny::CAN20Frame, VEHICLE_IRQ_BUFFER> CAN_IRQ(&CAN);
+
+void onCANInterrupt() {
+    CAN_IRQ.onInterrupt();
+}
+#endif
+
 namespace R51 {
 
+// R51 climate, settings, tire, and IPDM state frames.
+static const IDRule kVehicleReadIDs[] = {
+    stdID(0x54A, 0x7FE),
+    stdID(0x72E, 0x7FE),
+    stdID(0x385),
+    stdID(0x625),
+};
+
+// R51 climate control frames. Each carries the full control state so only the
+// latest frame needs to be sent when the bus is congested.
+static const IDRule kVehicleCoalesceIDs[] = {
+    stdID(0x540, 0x7FE),
+};
+
+// Paces climate control frames to a burst of 4 and then 20/s and settings
+// frames to a burst of 2 and then 50/s. Encoder spins can otherwise flood the
+// bus with control frames.
+inline void paceVehicleWrites(CANPacer* pacer) {
+    pacer->limit(stdID(0x540, 0x7FE), 50, 4);
+    pacer->limit(stdID(0x71E, 0x7FE), 20, 2);
+}
+
 // CAN connection which filters and buffers frames; and logs errors to serial.
 class CANConnection : public Canny::BufferedConnection<Canny::CAN20Frame> {
     public:
         CANConnection() :
             Canny::BufferedConnection<Canny::CAN20Frame>(
-                    &CAN, VEHICLE_READ_BUFFER, VEHICLE_WRITE_BUFFER) {}
+#if defined(VEHICLE_IRQ_ENABLE)
+                    &CAN_IRQ,
+#else
+                    &CAN,
+#endif
+                    VEHICLE_READ_BUFFER, VEHICLE_WRITE_BUFFER),
+            read_ids_(kVehicleReadIDs) {}
 
         bool begin() {
             // Initialize controller.
             if (!CAN.begin(VEHICLE_CAN_MODE)) {
                 return false;
             }
-            // Enable hardware filtering if not in promiscuous mode.
+            // Enable hardware filtering if not in promiscuous mode. IDs the
+            // controller's registers can't hold exactly are caught by
+            // readFilter.
             if (!VEHICLE_PROMISCUOUS) {
-                // Read climate and settings frames.
-                CAN.setMask(0, 0, 0xFFFFFFFE);
-                CAN.setFilter(0, 0, 0x54A);
-                CAN.setFilter(1, 0, 0x72E);
-                // Read BCM tire and IPDM power frames.
-                CAN.setMask(1, 0, 0xFFFFFFFF);
-                CAN.setFilter(2, 0, 0x385);
-                CAN.setFilter(3, 0, 0x625);
+                MCP2515Filters<Canny::MCP2515<Canny::CAN20Frame>> filters(&CAN);
+                if (!programFilters(kVehicleReadIDs, &filters)) {
+                    DEBUG_MSG("can: hardware filters are not exact");
+                }
             }
+#if defined(VEHICLE_IRQ_ENABLE)
+            // Drain the controller when it raises its interrupt line. Frames
+            // received before the handler is attached are drained here.
+            pinMode(VEHICLE_IRQ_PIN, INPUT_PULLUP);
+            SPI.usingInterrupt(digitalPinToInterrupt(VEHICLE_IRQ_PIN));
+            attachInterrupt(digitalPinToInterrupt(VEHICLE_IRQ_PIN), onCANInterrupt, FALLING);
+            CAN_IRQ.onInterrupt();
+#endif
             return true;
         }
 
+        // Read R51 climate, settings, tire, and IPDM state frames unless in
+        // promiscuous mode.
+        bool readFilter(const Canny::CAN20Frame& frame) const override {
+            return VEHICLE_PROMISCUOUS || read_ids_.match(frame);
+        }
+
         // Log read errors to debug serial.
         void onReadError(Canny::Error err) const override {
             DEBUG_MSG_VAL("can: read error: ", err);
@@ -47,6 +99,9 @@ class CANConnection : public Canny::BufferedConnection<Canny::CAN20Frame> {
             DEBUG_MSG_VAL("can: write error: ", err);
             DEBUG_MSG_OBJ("can: dropped frame: ", frame);
         }
+
+    private:
+        IDFilter read_ids_;
 };
 
 }  // namespace R51
@@ -12,6 +12,19 @@
 #define SERIAL_BAUDRATE 115200
 #define SERIAL_WAIT false
 
+// Per-node bus stats are collected when the libraries are built with
+// -DBUS_STATS_ENABLE. They are shown by the "stats nodes" console command.
+// Uncomment to also send them as CONTROLLER events, one node per interval.
+//#define BUS_STATS_EVENT_MS 1000
+
+// Uncomment to record each core's bus into a RAM ring of this many bytes. A
+// trace freezes on a pipe overrun or "trace freeze" and is written to the
+// serial device in binary by "trace dump ID", where ID is 0 for the I/O core
+// and 1 for the processing core. Recording continues for TRACE_POST_TRIGGER
+// messages after an overrun.
+//#define TRACE_SIZE 4096
+#define TRACE_POST_TRIGGER 16
+
 // Arduino board constants.
 #define ARDUINO_ANALOG_RESOLUTION 4096
 
@@ -30,20 +43,45 @@
 #define IO_CORE_BUFFER_SIZE 256
 #define PROC_CORE_BUFFER_SIZE 16
 
+// Maximum number of messages and time in microseconds spent draining the pipe
+// on each core per loop.
+#define PIPE_DRAIN_COUNT 8
+#define PIPE_DRAIN_US 250
+
 // Vehicle CAN bus mode and speed. This is CAN 2.0 at 500K for the R51.
 #define VEHICLE_CAN_MODE Canny::CAN20_500K
 #define VEHICLE_PROMISCUOUS false
 #define VEHICLE_READ_BUFFER 16
+#define VEHICLE_READ_BURST 8
+#define VEHICLE_READ_BURST_US 200
 #define VEHICLE_WRITE_BUFFER 2
 
+// Minimum time in milliseconds between frames written to the vehicle CAN bus.
+// Climate and settings frames are further limited per ID in CAN.h.
+#define VEHICLE_WRITE_SPACING_MS 1
+
+// Drain the vehicle CAN controller into a ring of VEHICLE_IRQ_BUFFER frames
+// from its interrupt line. Comment out to poll the controller.
+#define VEHICLE_IRQ_ENABLE
+#define VEHICLE_IRQ_PIN MCP2515_IRQ_PIN
+#define VEHICLE_IRQ_BUFFER 16
+
 // J1939 gateway configuration.
 #define J1939_ADDRESS 0x20
 #define J1939_NAME 0x00001BB000FFFAC0
 #define J1939_PROMISCUOUS false
 #define J1939_CAN_MODE Canny::CAN20_250K
 #define J1939_READ_BUFFER 128
+#define J1939_READ_BURST 16
+#define J1939_READ_BURST_US 250
 #define J1939_WRITE_BUFFER 4
 
+// Drain the J1939 CAN controller into a ring of J1939_IRQ_BUFFER frames
+// from its interrupt line. Comment out to poll the controller.
+#define J1939_IRQ_ENABLE
+#define J1939_IRQ_PIN MCP2518_IRQ_PIN
+#define J1939_IRQ_BUFFER 32
+
 // Defrost heater configuration.
 #define DEFROST_HEATER_PIN 24
 #define DEFROST_HEATER_MS 300
@@ -10,17 +10,20 @@ namespace R51 {
 
 class FilteredPipe : public Pipe {
     public:
-        FilteredPipe() : Pipe(IO_CORE_BUFFER_SIZE, PROC_CORE_BUFFER_SIZE) {}
+        FilteredPipe() : Pipe(IO_CORE_BUFFER_SIZE, PROC_CORE_BUFFER_SIZE,
+                PIPE_DRAIN_COUNT, PIPE_DRAIN_US) {}
 
         // Filtering for the I/O core. Forwards all frames to the processing core.
         bool filterLeft(const Message&) override { return true; }
 
         // Filtering for the processing core. Forwards CAN frames, J1939
-        // messages, and events for BLE serial.
+        // messages, events for BLE serial, and trace commands.
         bool filterRight(const Message& msg) override {
             return msg.type() == Message::CAN_FRAME ||
                 msg.type() == Message::J1939_MESSAGE ||
-                isBluetoothEvent(msg);
+                msg.type() == Message::J1939_TRANSFER ||
+                isBluetoothEvent(msg) ||
+                TraceCommand::match(msg);
         }
 
         void onBufferOverrun(const Message& msg) override {
@@ -25,8 +25,6 @@ extern "C" {
 };
 
 using namespace ::R51;
-using ::Caster::Bus;
-using ::Caster::Node;
 
 // Init core synchronization.
 SyncWait sync;
@@ -37,6 +35,11 @@ SyncWait sync;
 ConsoleNode console(&SERIAL_DEVICE, CONSOLE_INITIAL_MUTE);
 #endif
 
+// Periodic bus stats events.
+#if defined(BUS_STATS_EVENT_MS)
+BusStatsNode bus_stats(BUS_STATS_EVENT_MS);
+#endif
+
 PlatformConfigStore config;
 
 /**
@@ -47,6 +50,8 @@ PlatformConfigStore config;
 // Connect to the vehicle via CAN.
 CANConnection can_conn;
 CANGateway can_gw(&can_conn);
+IDFilter can_coalesce(kVehicleCoalesceIDs);
+CANPacer can_pacer(VEHICLE_WRITE_SPACING_MS);
 
 // Vehicle hardware integration modules. These integrate with the vehicle via GPIO.
 Defrost defrost(DEFROST_HEATER_PIN, DEFROST_HEATER_MS);
@@ -127,37 +132,60 @@ SteeringControls steering_controls(STEERING_KEYPAD_ID);
  */
 FilteredPipe pipe;
 
-Node<Message>* io_nodes[] = {
-    pipe.left(),
-    &can_gw,
-    &j1939_gw,
-    &steering_keypad,
-    &rotary_encoder_group,
-    &ble_monitor,
-    &realdash_gw,
+// Deadlines of each core's node tickers.
+TimerWheel io_timers;
+TimerWheel proc_timers;
+
+// Bus traces. Each core records its own bus.
+#if defined(TRACE_SIZE)
+PipeOverrunTrigger io_trace_trigger(&pipe);
+PipeOverrunTrigger proc_trace_trigger(&pipe);
+TraceNode io_trace(0x00, TRACE_SIZE, &SERIAL_DEVICE, TRACE_POST_TRIGGER);
+TraceNode proc_trace(0x01, TRACE_SIZE, &SERIAL_DEVICE, TRACE_POST_TRIGGER);
+#endif
+
+BusNode io_nodes[] = {
+    {&io_timers, "io_timers"},
+    {pipe.left(), "pipe"},
+    {&can_gw, "can_gw"},
+    {&j1939_gw, "j1939_gw"},
+    {&steering_keypad, "steering_keypad"},
+    {&rotary_encoder_group, "rotary_encoder_group"},
+    {&ble_monitor, "ble_monitor"},
+    {&realdash_gw, "realdash_gw"},
+#if defined(TRACE_SIZE)
+    {&io_trace, "io_trace"},
+#endif
 };
-Bus<Message> io_bus(io_nodes, sizeof(io_nodes)/sizeof(io_nodes[0]));
+IndexedBus io_bus(io_nodes, sizeof(io_nodes)/sizeof(io_nodes[0]));
 
-Node<Message>* proc_nodes[] = {
-    pipe.right(),
+BusNode proc_nodes[] = {
+    {&proc_timers, "proc_timers"},
+    {pipe.right(), "pipe"},
 #if defined(CONSOLE_ENABLE)
-    &console,
+    {&console, "console"},
+#endif
+    {&defrost, "defrost"},
+    {&climate, "climate"},
+    {&settings, "settings"},
+    {&ipdm, "ipdm"},
+    {&tire_pressure, "tire_pressure"},
+    {&illum, "illum"},
+    {&fusion, "fusion"},
+    {&blink_keypad, "blink_keypad"},
+    {&blink_keybox, "blink_keybox"},
+    {&hmi, "hmi"},
+    {&nav_controls, "nav_controls"},
+    {&power_controls, "power_controls"},
+    {&steering_controls, "steering_controls"},
+#if defined(BUS_STATS_EVENT_MS)
+    {&bus_stats, "bus_stats"},
+#endif
+#if defined(TRACE_SIZE)
+    {&proc_trace, "proc_trace"},
 #endif
-    &defrost,
-    &climate,
-    &settings,
-    &ipdm,
-    &tire_pressure,
-    &illum,
-    &fusion,
-    &blink_keypad,
-    &blink_keybox,
-    &hmi,
-    &nav_controls,
-    &power_controls,
-    &steering_controls,
 };
-Bus<Message> proc_bus(proc_nodes, sizeof(proc_nodes)/sizeof(proc_nodes[0]));
+IndexedBus proc_bus(proc_nodes, sizeof(proc_nodes)/sizeof(proc_nodes[0]));
 
 /**
  * Arduino Setup and Loop Functions
@@ -208,6 +236,10 @@ void setup_can() {
         DEBUG_MSG("setup: CAN failed");
         delay(500);
     }
+    can_gw.burst(VEHICLE_READ_BURST, VEHICLE_READ_BURST_US);
+    can_gw.coalesce(&can_coalesce);
+    paceVehicleWrites(&can_pacer);
+    can_gw.pace(&can_pacer);
 }
 
 void setup_j1939() {
@@ -216,6 +248,7 @@ void setup_j1939() {
         DEBUG_MSG("setup: J1939 failed");
         delay(500);
     }
+    j1939_gw.burst(J1939_READ_BURST, J1939_READ_BURST_US);
 }
 
 void setup_bluetooth() {
@@ -255,8 +288,46 @@ void setup_rotary_encoders() {
 }
 
 // I/O core setup.
+void setup_stats() {
+#if defined(CONSOLE_ENABLE)
+    console.addBusStats("io", io_bus.stats());
+    console.addBusStats("proc", proc_bus.stats());
+    console.addQueueStats("pipe", &pipe);
+#endif
+#if defined(BUS_STATS_EVENT_MS)
+    bus_stats.add(0x00, io_bus.stats());
+    bus_stats.add(0x01, proc_bus.stats());
+#endif
+}
+
+void setup_trace() {
+#if defined(TRACE_SIZE)
+    io_trace.triggerOn(&io_trace_trigger);
+    proc_trace.triggerOn(&proc_trace_trigger);
+#endif
+}
+
+void setup_io_timers() {
+#if defined(BLUETOOTH_ENABLE)
+    realdash_gw.schedule(&io_timers);
+#endif
+}
+
+void setup_proc_timers() {
+    defrost.schedule(&proc_timers);
+    climate.schedule(&proc_timers);
+    ipdm.schedule(&proc_timers);
+    tire_pressure.schedule(&proc_timers);
+    fusion.schedule(&proc_timers);
+    blink_keybox.schedule(&proc_timers);
+#if defined(BUS_STATS_EVENT_MS)
+    bus_stats.schedule(&proc_timers);
+#endif
+}
+
 void setup() {
     setup_serial();
+    setup_trace();
     setup_watchdog();
     setup_spi();
     setup_i2c();
@@ -266,6 +337,7 @@ void setup() {
     setup_rotary_encoders();
     setup_defrost();
     setup_steering();
+    setup_io_timers();
     sync.wait();
     DEBUG_MSG("setup: ECU running");
     io_bus.init();
@@ -275,6 +347,8 @@ void setup() {
 void setup1() {
     setup_serial();
     setup_hmi();
+    setup_stats();
+    setup_proc_timers();
     sync.wait();
     proc_bus.init();
 }
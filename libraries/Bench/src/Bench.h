@@ -0,0 +1,12 @@
+#ifndef _R51_BENCH_H_
+#define _R51_BENCH_H_
+
+#include "Bench/Capture.h"
+#include "Bench/Clock.h"
+#include "Bench/Connection.h"
+#include "Bench/Latency.h"
+#include "Bench/Node.h"
+#include "Bench/Replay.h"
+#include "Bench/Report.h"
+
+#endif  // _R51_BENCH_H_
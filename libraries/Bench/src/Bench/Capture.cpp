@@ -0,0 +1,319 @@
+#include "Capture.h"
+
+#if defined(EPOXY_DUINO)
+
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace R51 {
+namespace {
+
+using ::Canny::CAN20Frame;
+
+// Size of a TraceNode dump header and of its entry timestamps.
+static const size_t kDumpHeaderSize = 16;
+static const size_t kTimestampSize = 4;
+
+// Longest text line that is parsed.
+static const size_t kMaxLine = 256;
+
+// Standard frame IDs are written with 3 hex digits and extended IDs with 8.
+static const size_t kMaxStdIdLen = 3;
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+const char* skipSpace(const char* s) {
+    while (*s == ' ' || *s == '\t') {
+        ++s;
+    }
+    return s;
+}
+
+const char* skipToken(const char* s) {
+    while (*s != 0 && !isspace(*s)) {
+        ++s;
+    }
+    return s;
+}
+
+// Parse a "(seconds.micros)" timestamp. Return nullptr on failure.
+const char* parseTimestamp(const char* s, uint64_t* time_us) {
+    char* end;
+    unsigned long long sec = strtoull(s + 1, &end, 10);
+    if (*end != '.') {
+        return nullptr;
+    }
+    const char* frac = end + 1;
+    uint64_t usec = 0;
+    size_t digits = 0;
+    for (; isdigit(*frac); ++frac, ++digits) {
+        if (digits < 6) {
+            usec = usec * 10 + (*frac - '0');
+        }
+    }
+    for (; digits < 6; ++digits) {
+        usec *= 10;
+    }
+    if (*frac != ')') {
+        return nullptr;
+    }
+    *time_us = sec * 1000000 + usec;
+    return frac + 1;
+}
+
+// Parse a hex frame ID. Sets ext if the ID is written in extended form.
+const char* parseId(const char* s, uint32_t* id, bool* ext) {
+    const char* start = s;
+    uint32_t value = 0;
+    for (; hexValue(*s) >= 0; ++s) {
+        value = (value << 4) | hexValue(*s);
+    }
+    size_t len = s - start;
+    if (len == 0 || len > 8) {
+        return nullptr;
+    }
+    *id = value;
+    *ext = len > kMaxStdIdLen;
+    return s;
+}
+
+// Parse the compact "ID#DATA" form. Return false for malformed, remote, and
+// CAN FD frames.
+bool parseCompact(const char* s, CAN20Frame* frame) {
+    uint32_t id;
+    bool ext;
+    s = parseId(s, &id, &ext);
+    if (s == nullptr || *s != '#' || s[1] == '#' || s[1] == 'R') {
+        return false;
+    }
+    ++s;
+    uint8_t data[8];
+    uint8_t size = 0;
+    while (hexValue(s[0]) >= 0 && hexValue(s[1]) >= 0 && size < 8) {
+        data[size++] = (hexValue(s[0]) << 4) | hexValue(s[1]);
+        s += 2;
+        if (*s == '.') {
+            ++s;
+        }
+    }
+    if (*s != 0 && !isspace(*s)) {
+        return false;
+    }
+    frame->id(id, ext);
+    frame->data(data, size);
+    return true;
+}
+
+// Parse the spaced "ID [n] XX XX ..." form.
+bool parseSpaced(const char* s, CAN20Frame* frame) {
+    uint32_t id;
+    bool ext;
+    s = parseId(s, &id, &ext);
+    if (s == nullptr) {
+        return false;
+    }
+    s = skipSpace(s);
+    if (*s != '[') {
+        return false;
+    }
+    char* end;
+    unsigned long size = strtoul(s + 1, &end, 10);
+    if (*end != ']' || size > 8) {
+        return false;
+    }
+    s = end + 1;
+    uint8_t data[8];
+    for (size_t i = 0; i < size; ++i) {
+        s = skipSpace(s);
+        if (hexValue(s[0]) < 0 || hexValue(s[1]) < 0) {
+            return false;
+        }
+        data[i] = (hexValue(s[0]) << 4) | hexValue(s[1]);
+        s += 2;
+    }
+    frame->id(id, ext);
+    frame->data(data, size);
+    return true;
+}
+
+}  // namespace
+
+CaptureReader::CaptureReader() :
+    file_(nullptr), binary_(false), started_(false), stamped_(false), start_us_(0),
+    last_us_(0), last_stamp_(0), remaining_(0), errors_(0) {}
+
+CaptureReader::~CaptureReader() {
+    close();
+}
+
+bool CaptureReader::open(const char* path) {
+    close();
+    file_ = fopen(path, "rb");
+    if (file_ == nullptr) {
+        return false;
+    }
+
+    char magic[4];
+    binary_ = fread(magic, 1, sizeof(magic), file_) == sizeof(magic) &&
+        memcmp(magic, "R51T", sizeof(magic)) == 0;
+    rewind(file_);
+    started_ = false;
+    stamped_ = false;
+    start_us_ = 0;
+    last_us_ = 0;
+    last_stamp_ = 0;
+    remaining_ = 0;
+    errors_ = 0;
+    return true;
+}
+
+void CaptureReader::close() {
+    if (file_ != nullptr) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool CaptureReader::next(CAN20Frame* frame, uint64_t* time_us) {
+    if (file_ == nullptr) {
+        return false;
+    }
+    return binary_ ? nextBinary(frame, time_us) : nextText(frame, time_us);
+}
+
+bool CaptureReader::nextText(CAN20Frame* frame, uint64_t* time_us) {
+    char line[kMaxLine];
+    while (fgets(line, sizeof(line), file_) != nullptr) {
+        const char* s = skipSpace(line);
+        if (*s == 0 || *s == '\n' || *s == '#') {
+            continue;
+        }
+
+        // Lines without a timestamp are replayed at the time of the previous
+        // frame.
+        uint64_t stamp = last_us_;
+        if (*s == '(') {
+            s = parseTimestamp(s, &stamp);
+            if (s == nullptr) {
+                ++errors_;
+                continue;
+            }
+            s = skipSpace(s);
+        }
+
+        // Skip the interface name.
+        s = skipSpace(skipToken(s));
+        const char* id_end = s;
+        while (hexValue(*id_end) >= 0) {
+            ++id_end;
+        }
+        bool ok = *id_end == '#' ? parseCompact(s, frame) : parseSpaced(s, frame);
+        if (!ok) {
+            // Remote and FD frames are valid but are not replayed.
+            if (strstr(s, "remote") == nullptr && strstr(s, "##") == nullptr &&
+                    strstr(s, "#R") == nullptr) {
+                ++errors_;
+            }
+            continue;
+        }
+        last_us_ = stamp;
+        *time_us = relative(stamp);
+        return true;
+    }
+    return false;
+}
+
+bool CaptureReader::nextBinary(CAN20Frame* frame, uint64_t* time_us) {
+    uint8_t entry[kTimestampSize + kMaxMessageRecordSize];
+    while (remaining_ > 0 || readDumpHeader()) {
+        if (remaining_ == 0) {
+            continue;
+        }
+        --remaining_;
+        if (fread(entry, 1, kTimestampSize + 1, file_) != kTimestampSize + 1) {
+            ++errors_;
+            return false;
+        }
+        size_t size = messageRecordSize(entry[kTimestampSize]) - 1;
+        if (size > kMaxMessageRecordSize - 1 ||
+                fread(entry + kTimestampSize + 1, 1, size, file_) != size) {
+            ++errors_;
+            return false;
+        }
+
+        // Timestamps are 32-bit micros() values and may wrap within a trace.
+        // Each dump continues from the last frame of the previous dump so
+        // that time does not run backwards.
+        uint32_t stamp;
+        memcpy(&stamp, entry, sizeof(stamp));
+        if (stamped_) {
+            last_us_ += (uint32_t)(stamp - last_stamp_);
+        } else if (!started_) {
+            last_us_ = stamp;
+        }
+        last_stamp_ = stamp;
+        stamped_ = true;
+
+        MessageValue msg;
+        if (!decodeMessageRecord(entry + kTimestampSize, &msg)) {
+            ++errors_;
+            continue;
+        }
+        if (msg.type() == Message::CAN_FRAME) {
+            *frame = *msg.can_frame();
+        } else if (msg.type() == Message::J1939_MESSAGE) {
+            const Canny::J1939Message* j1939 = msg.j1939_message();
+            frame->id(j1939->id(), true);
+            frame->data(j1939->data(), j1939->size());
+        } else {
+            continue;
+        }
+        *time_us = relative(last_us_);
+        return true;
+    }
+    return false;
+}
+
+bool CaptureReader::readDumpHeader() {
+    uint8_t header[kDumpHeaderSize];
+    size_t n = fread(header, 1, sizeof(header), file_);
+    if (n == 0) {
+        return false;
+    }
+    if (n != sizeof(header) || memcmp(header, "R51T", 4) != 0 ||
+            header[4] != TraceNode::kDumpVersion) {
+        ++errors_;
+        return false;
+    }
+    uint16_t count;
+    memcpy(&count, header + 6, sizeof(count));
+    remaining_ = count;
+    stamped_ = false;
+    return true;
+}
+
+uint64_t CaptureReader::relative(uint64_t time_us) {
+    if (!started_) {
+        started_ = true;
+        start_us_ = time_us;
+    }
+    return time_us - start_us_;
+}
+
+}  // namespace R51
+
+#endif  // EPOXY_DUINO
@@ -0,0 +1,66 @@
+#ifndef _R51_BENCH_CAPTURE_H_
+#define _R51_BENCH_CAPTURE_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+
+#if defined(EPOXY_DUINO)
+#include <stdio.h>
+
+namespace R51 {
+
+// Reads CAN frames from a capture file. Host builds only. Supported formats
+// are detected from the file contents:
+//
+// * candump log files (candump -l): "(1436509052.249713) can0 54A#3C3E7F80"
+// * candump console output, with or without a timestamp:
+//   "(1436509052.249713)  can0  54A   [4]  3C 3E 7F 80"
+// * binary bus trace dumps written by TraceNode. Only the CAN frames and
+//   J1939 messages in the trace are read.
+//
+// Remote, error, and CAN FD frames are skipped. Extended frames hold J1939
+// traffic and standard frames hold vehicle traffic.
+class CaptureReader {
+    public:
+        CaptureReader();
+        ~CaptureReader();
+
+        CaptureReader(const CaptureReader&) = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+
+        // Open a capture file. Return false if the file cannot be read.
+        bool open(const char* path);
+
+        // Close the capture file.
+        void close();
+
+        // Read the next frame and its time in microseconds since the first
+        // frame of the capture. Return false at the end of the capture.
+        bool next(Canny::CAN20Frame* frame, uint64_t* time_us);
+
+        // Return the number of lines or trace entries which could not be
+        // parsed.
+        uint32_t errors() const { return errors_; }
+
+    private:
+        FILE* file_;
+        bool binary_;
+        bool started_;
+        bool stamped_;          // The current trace dump has a timestamp.
+        uint64_t start_us_;
+        uint64_t last_us_;
+        uint32_t last_stamp_;   // Last raw binary trace timestamp.
+        uint32_t remaining_;    // Entries left in the current trace dump.
+        uint32_t errors_;
+
+        bool nextText(Canny::CAN20Frame* frame, uint64_t* time_us);
+        bool nextBinary(Canny::CAN20Frame* frame, uint64_t* time_us);
+        bool readDumpHeader();
+        uint64_t relative(uint64_t time_us);
+};
+
+}  // namespace R51
+
+#endif  // EPOXY_DUINO
+
+#endif  // _R51_BENCH_CAPTURE_H_
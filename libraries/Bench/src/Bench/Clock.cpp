@@ -0,0 +1,21 @@
+#include "Clock.h"
+
+#include <Arduino.h>
+
+#if defined(EPOXY_DUINO)
+#include <time.h>
+#endif
+
+namespace R51 {
+
+uint64_t benchNanos() {
+#if defined(EPOXY_DUINO)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    return (uint64_t)micros() * 1000;
+#endif
+}
+
+}  // namespace R51
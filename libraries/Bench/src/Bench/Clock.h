@@ -0,0 +1,14 @@
+#ifndef _R51_BENCH_CLOCK_H_
+#define _R51_BENCH_CLOCK_H_
+
+#include <Arduino.h>
+
+namespace R51 {
+
+// Return a monotonic timestamp in nanoseconds. Host builds read the system
+// monotonic clock. Hardware builds are limited to micros() resolution.
+uint64_t benchNanos();
+
+}  // namespace R51
+
+#endif  // _R51_BENCH_CLOCK_H_
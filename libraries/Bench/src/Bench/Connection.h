@@ -0,0 +1,100 @@
+#ifndef _R51_BENCH_CONNECTION_H_
+#define _R51_BENCH_CONNECTION_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+#include "Latency.h"
+
+namespace R51 {
+
+// Connection which replays a fixed set of frames and discards written
+// frames. Reads and writes are reported to an optional latency probe.
+template <typename T>
+class BenchConnection : public Canny::Connection<T> {
+    public:
+        BenchConnection(LatencyProbe* probe = nullptr) :
+            probe_(probe), frames_(nullptr), size_(0), pos_(0), remaining_(0),
+            reads_(0), writes_(0) {}
+
+        // Replay count frames from the given array. The array is read in
+        // order and wraps around until count frames have been read. The array
+        // must outlive the replay.
+        void replay(const T* frames, size_t size, size_t count) {
+            frames_ = frames;
+            size_ = size;
+            pos_ = 0;
+            remaining_ = size > 0 ? count : 0;
+        }
+
+        // Return true if all frames have been replayed.
+        bool done() const { return remaining_ == 0; }
+
+        // Return the number of frames read from the connection.
+        uint32_t reads() const { return reads_; }
+
+        // Return the number of frames written to the connection.
+        uint32_t writes() const { return writes_; }
+
+        Canny::Error read(T* frame) override {
+            if (remaining_ == 0) {
+                return Canny::ERR_FIFO;
+            }
+            *frame = frames_[pos_];
+            if (++pos_ >= size_) {
+                pos_ = 0;
+            }
+            --remaining_;
+            ++reads_;
+            if (probe_ != nullptr) {
+                probe_->input();
+            }
+            return Canny::ERR_OK;
+        }
+
+        Canny::Error write(const T&) override {
+            ++writes_;
+            if (probe_ != nullptr) {
+                probe_->output();
+            }
+            return Canny::ERR_OK;
+        }
+
+    private:
+        LatencyProbe* probe_;
+        const T* frames_;
+        size_t size_;
+        size_t pos_;
+        size_t remaining_;
+        uint32_t reads_;
+        uint32_t writes_;
+};
+
+// Stream which discards written bytes. Used in place of serial devices like
+// the HMI screen. The first write after an input is reported to the probe.
+class BenchStream : public Stream {
+    public:
+        BenchStream(LatencyProbe* probe = nullptr) : probe_(probe), writes_(0) {}
+
+        // Return the number of bytes written to the stream.
+        uint32_t writes() const { return writes_; }
+
+        size_t write(uint8_t) override {
+            ++writes_;
+            if (probe_ != nullptr) {
+                probe_->output();
+            }
+            return 1;
+        }
+
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+
+    private:
+        LatencyProbe* probe_;
+        uint32_t writes_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_BENCH_CONNECTION_H_
@@ -0,0 +1,79 @@
+#include "Latency.h"
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include "Clock.h"
+
+namespace R51 {
+namespace {
+
+int compareSamples(const void* a, const void* b) {
+    uint32_t lhs = *(const uint32_t*)a;
+    uint32_t rhs = *(const uint32_t*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+}  // namespace
+
+LatencyProbe::LatencyProbe(size_t capacity) :
+        samples_(new uint32_t[capacity]), capacity_(capacity), size_(0),
+        dropped_(0), start_(0), pending_(false), sorted_(true) {}
+
+LatencyProbe::~LatencyProbe() {
+    delete[] samples_;
+}
+
+void LatencyProbe::input() {
+    start_ = benchNanos();
+    pending_ = true;
+}
+
+void LatencyProbe::output() {
+    if (!pending_) {
+        return;
+    }
+    pending_ = false;
+    if (size_ >= capacity_) {
+        ++dropped_;
+        return;
+    }
+    uint64_t elapsed = benchNanos() - start_;
+    samples_[size_++] = elapsed > 0xFFFFFFFF ? 0xFFFFFFFF : elapsed;
+    sorted_ = false;
+}
+
+void LatencyProbe::reset() {
+    size_ = 0;
+    dropped_ = 0;
+    pending_ = false;
+    sorted_ = true;
+}
+
+uint32_t LatencyProbe::percentile(uint8_t p) {
+    if (size_ == 0) {
+        return 0;
+    }
+    if (p > 100) {
+        p = 100;
+    }
+    sort();
+    size_t i = (size_ * p + 99) / 100;
+    return samples_[i == 0 ? 0 : i - 1];
+}
+
+uint32_t LatencyProbe::max() {
+    if (size_ == 0) {
+        return 0;
+    }
+    sort();
+    return samples_[size_ - 1];
+}
+
+void LatencyProbe::sort() {
+    if (!sorted_) {
+        qsort(samples_, size_, sizeof(uint32_t), compareSamples);
+        sorted_ = true;
+    }
+}
+
+}  // namespace R51
@@ -0,0 +1,56 @@
+#ifndef _R51_BENCH_LATENCY_H_
+#define _R51_BENCH_LATENCY_H_
+
+#include <Arduino.h>
+
+namespace R51 {
+
+// Records the time between a frame being read into a node set and the first
+// frame written out as a result. Connections call input() on read and
+// output() on write. Outputs with no pending input are not recorded.
+class LatencyProbe {
+    public:
+        // Construct a probe which records at most capacity samples.
+        LatencyProbe(size_t capacity);
+        ~LatencyProbe();
+
+        // Mark a frame as read.
+        void input();
+
+        // Mark a frame as written. Records a sample if an input is pending.
+        void output();
+
+        // Drop the pending input. Called once the input's dispatch completes
+        // so that unrelated outputs are not attributed to it.
+        void clear() { pending_ = false; }
+
+        // Drop all samples.
+        void reset();
+
+        // Return the number of recorded samples.
+        size_t size() const { return size_; }
+
+        // Return the number of samples dropped due to capacity.
+        size_t dropped() const { return dropped_; }
+
+        // Return the p-th percentile latency in nanoseconds.
+        uint32_t percentile(uint8_t p);
+
+        // Return the maximum latency in nanoseconds.
+        uint32_t max();
+
+    private:
+        void sort();
+
+        uint32_t* samples_;
+        size_t capacity_;
+        size_t size_;
+        size_t dropped_;
+        uint64_t start_;
+        bool pending_;
+        bool sorted_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_BENCH_LATENCY_H_
@@ -0,0 +1,72 @@
+#include "Node.h"
+
+#include <Arduino.h>
+#include <Caster.h>
+#include <Core.h>
+#include "Clock.h"
+
+namespace R51 {
+
+using ::Caster::Yield;
+
+uint64_t TimedNode::nested_ns_ = 0;
+
+TimedNode::TimedNode(const char* name, BusNode node) :
+        name_(name), node_(node) {
+    reset();
+}
+
+void TimedNode::subscribe(Subscription* sub) {
+    if (node_.subscriber != nullptr) {
+        node_.subscriber->subscribe(sub);
+    } else {
+        sub->all();
+    }
+}
+
+void TimedNode::init(const Yield<Message>& yield) {
+    node_.node->init(yield);
+}
+
+void TimedNode::handle(const Message& msg, const Yield<Message>& yield) {
+    uint64_t outer = nested_ns_;
+    nested_ns_ = 0;
+    uint64_t t = benchNanos();
+    node_.node->handle(msg, CountYield(yield, &yielded_));
+    uint64_t total = benchNanos() - t;
+    uint64_t self = total - nested_ns_;
+    nested_ns_ = outer + total;
+
+    ++handled_;
+    handle_ns_ += self;
+    if (self > worst_ns_) {
+        worst_ns_ = self;
+    }
+}
+
+void TimedNode::emit(const Yield<Message>& yield) {
+    uint64_t outer = nested_ns_;
+    nested_ns_ = 0;
+    uint64_t t = benchNanos();
+    node_.node->emit(CountYield(yield, &yielded_));
+    uint64_t total = benchNanos() - t;
+    uint64_t self = total - nested_ns_;
+    nested_ns_ = outer + total;
+
+    ++emitted_;
+    emit_ns_ += self;
+    if (self > worst_ns_) {
+        worst_ns_ = self;
+    }
+}
+
+void TimedNode::reset() {
+    handled_ = 0;
+    emitted_ = 0;
+    yielded_ = 0;
+    handle_ns_ = 0;
+    emit_ns_ = 0;
+    worst_ns_ = 0;
+}
+
+}  // namespace R51
@@ -0,0 +1,85 @@
+#ifndef _R51_BENCH_NODE_H_
+#define _R51_BENCH_NODE_H_
+
+#include <Arduino.h>
+#include <Caster.h>
+#include <Core.h>
+
+namespace R51 {
+
+// Wraps a node to count and time its calls. Time spent in other nodes called
+// through this node's yield is excluded so that the totals of all timed nodes
+// on a bus add up to the time spent in the bus.
+class TimedNode : public Caster::Node<Message>, public Subscriber {
+    public:
+        // Wrap a node. The name is used when reporting results.
+        TimedNode(const char* name, BusNode node);
+
+        // Forward the wrapped node's subscription or subscribe to all
+        // messages if it is not a subscriber.
+        void subscribe(Subscription* sub) override;
+
+        // Initialize the wrapped node. This is not timed.
+        void init(const Caster::Yield<Message>& yield) override;
+
+        // Call and time the wrapped node's handle().
+        void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
+
+        // Call and time the wrapped node's emit().
+        void emit(const Caster::Yield<Message>& yield) override;
+
+        // Reset all counters.
+        void reset();
+
+        const char* name() const { return name_; }
+
+        // Number of handle() calls.
+        uint32_t handled() const { return handled_; }
+
+        // Number of emit() calls.
+        uint32_t emitted() const { return emitted_; }
+
+        // Number of messages yielded by the node.
+        uint32_t yielded() const { return yielded_; }
+
+        // Total time in nanoseconds spent in handle().
+        uint64_t handle_ns() const { return handle_ns_; }
+
+        // Total time in nanoseconds spent in emit().
+        uint64_t emit_ns() const { return emit_ns_; }
+
+        // Longest single handle() or emit() call in nanoseconds.
+        uint64_t worst_ns() const { return worst_ns_; }
+
+    private:
+        class CountYield : public Caster::Yield<Message> {
+            public:
+                CountYield(const Caster::Yield<Message>& yield, uint32_t* count) :
+                    yield_(yield), count_(count) {}
+
+                void operator()(const Message& msg) const override {
+                    ++*count_;
+                    yield_(msg);
+                }
+
+            private:
+                const Caster::Yield<Message>& yield_;
+                uint32_t* count_;
+        };
+
+        const char* name_;
+        BusNode node_;
+        uint32_t handled_;
+        uint32_t emitted_;
+        uint32_t yielded_;
+        uint64_t handle_ns_;
+        uint64_t emit_ns_;
+        uint64_t worst_ns_;
+
+        // Time spent in nested timed calls during the current call.
+        static uint64_t nested_ns_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_BENCH_NODE_H_
@@ -0,0 +1,61 @@
+#ifndef _R51_BENCH_REPLAY_H_
+#define _R51_BENCH_REPLAY_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+// Connection fed one frame at a time by a replay driver. Frames are read in
+// the order they are pushed. Written frames are counted and discarded.
+template <typename T, size_t N = 16>
+class ReplayConnection : public Canny::Connection<T> {
+    public:
+        ReplayConnection() : head_(0), size_(0), reads_(0), writes_(0) {}
+
+        // Queue a frame to be read. Return false if the queue is full.
+        bool push(const T& frame) {
+            if (size_ >= N) {
+                return false;
+            }
+            frames_[(head_ + size_) % N] = frame;
+            ++size_;
+            return true;
+        }
+
+        // Return true if all pushed frames have been read.
+        bool empty() const { return size_ == 0; }
+
+        // Return the number of frames read from the connection.
+        uint32_t reads() const { return reads_; }
+
+        // Return the number of frames written to the connection.
+        uint32_t writes() const { return writes_; }
+
+        Canny::Error read(T* frame) override {
+            if (size_ == 0) {
+                return Canny::ERR_FIFO;
+            }
+            *frame = frames_[head_];
+            head_ = (head_ + 1) % N;
+            --size_;
+            ++reads_;
+            return Canny::ERR_OK;
+        }
+
+        Canny::Error write(const T&) override {
+            ++writes_;
+            return Canny::ERR_OK;
+        }
+
+    private:
+        T frames_[N];
+        size_t head_;
+        size_t size_;
+        uint32_t reads_;
+        uint32_t writes_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_BENCH_REPLAY_H_
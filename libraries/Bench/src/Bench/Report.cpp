@@ -0,0 +1,95 @@
+#include "Report.h"
+
+#include <Arduino.h>
+#include "Latency.h"
+#include "Node.h"
+
+namespace R51 {
+namespace {
+
+void printKey(Print* out, const char* key) {
+    out->print(' ');
+    out->print(key);
+    out->print('=');
+}
+
+void printHeader(Print* out, const char* bench, const char* metric) {
+    out->print("bench=");
+    out->print(bench);
+    printKey(out, "metric");
+    out->print(metric);
+}
+
+void printValue(Print* out, const char* key, const char* value) {
+    printKey(out, key);
+    out->print(value);
+}
+
+void printValue(Print* out, const char* key, unsigned long value) {
+    printKey(out, key);
+    out->print(value);
+}
+
+void printValue(Print* out, const char* key, double value) {
+    printKey(out, key);
+    out->print(value);
+}
+
+}  // namespace
+
+void reportThroughput(Print* out, const char* bench, const char* pass,
+        uint32_t frames, uint64_t elapsed_ns) {
+    printHeader(out, bench, "throughput");
+    printValue(out, "pass", pass);
+    printValue(out, "frames", (unsigned long)frames);
+    printValue(out, "elapsed_us", (unsigned long)(elapsed_ns / 1000));
+    if (elapsed_ns > 0) {
+        printValue(out, "frames_per_sec", (double)frames * 1e9 / elapsed_ns);
+    }
+    if (frames > 0) {
+        printValue(out, "ns_per_frame", (double)elapsed_ns / frames);
+    }
+    out->println();
+}
+
+void reportNode(Print* out, const char* bench, const TimedNode& node) {
+    printHeader(out, bench, "node");
+    printValue(out, "node", node.name());
+    printValue(out, "handled", (unsigned long)node.handled());
+    printValue(out, "emitted", (unsigned long)node.emitted());
+    printValue(out, "yielded", (unsigned long)node.yielded());
+    printValue(out, "handle_us", (unsigned long)(node.handle_ns() / 1000));
+    printValue(out, "emit_us", (unsigned long)(node.emit_ns() / 1000));
+    printValue(out, "handle_ns_avg", node.handled() == 0 ? 0.0 :
+            (double)node.handle_ns() / node.handled());
+    printValue(out, "emit_ns_avg", node.emitted() == 0 ? 0.0 :
+            (double)node.emit_ns() / node.emitted());
+    printValue(out, "worst_ns", (unsigned long)node.worst_ns());
+    out->println();
+}
+
+void reportLatency(Print* out, const char* bench, LatencyProbe* probe) {
+    printHeader(out, bench, "latency");
+    printValue(out, "samples", (unsigned long)probe->size());
+    printValue(out, "dropped", (unsigned long)probe->dropped());
+    printValue(out, "p50_ns", (unsigned long)probe->percentile(50));
+    printValue(out, "p99_ns", (unsigned long)probe->percentile(99));
+    printValue(out, "max_ns", (unsigned long)probe->max());
+    out->println();
+}
+
+void reportReplay(Print* out, const char* bench, uint32_t frames,
+        uint32_t events, uint32_t errors, uint64_t capture_us, uint64_t elapsed_ns) {
+    printHeader(out, bench, "replay");
+    printValue(out, "frames", (unsigned long)frames);
+    printValue(out, "events", (unsigned long)events);
+    printValue(out, "errors", (unsigned long)errors);
+    printValue(out, "capture_ms", (unsigned long)(capture_us / 1000));
+    printValue(out, "elapsed_ms", (unsigned long)(elapsed_ns / 1000000));
+    if (elapsed_ns > 0) {
+        printValue(out, "speedup", (double)capture_us * 1000 / elapsed_ns);
+    }
+    out->println();
+}
+
+}  // namespace R51
@@ -0,0 +1,29 @@
+#ifndef _R51_BENCH_REPORT_H_
+#define _R51_BENCH_REPORT_H_
+
+#include <Arduino.h>
+#include "Latency.h"
+#include "Node.h"
+
+namespace R51 {
+
+// Print the throughput of a benchmark pass. Frames are the number of frames
+// read into the node set.
+void reportThroughput(Print* out, const char* bench, const char* pass,
+        uint32_t frames, uint64_t elapsed_ns);
+
+// Print the counters of a timed node.
+void reportNode(Print* out, const char* bench, const TimedNode& node);
+
+// Print the frame-in to frame-out latency percentiles of a probe.
+void reportLatency(Print* out, const char* bench, LatencyProbe* probe);
+
+// Print the results of a capture replay. Frames are the number of frames read
+// from the capture and events the number of events emitted in response.
+// Errors are the capture lines or entries which could not be parsed.
+void reportReplay(Print* out, const char* bench, uint32_t frames,
+        uint32_t events, uint32_t errors, uint64_t capture_us, uint64_t elapsed_ns);
+
+}  // namespace R51
+
+#endif  // _R51_BENCH_REPORT_H_
@@ -20,7 +20,7 @@ BlinkKeybox::BlinkKeybox(uint8_t address, uint8_t pdm_id, Faker::Clock* clock) :
         hb_tick_(kHeartbeatInterval, false, clock),
         hb_msg_(0xEE00, Canny::NullAddress, address, 0x06),
         pin_cmd_(0xEF00, Canny::NullAddress, address, 0x06),
-        pwm_cmd_(0xEF00, Canny::NullAddress, address, 0x06),
+        pwm_cmd_(0xEF00, Canny::NullAddress, address, 0x06), keybox_name_(0),
         pin_state_(0), pin_fault_(0), pin11_pwm_(0), pin12_pwm_(0),
         power_(pdm_id) {
     hb_msg_.resize(4);
@@ -36,6 +36,14 @@ BlinkKeybox::BlinkKeybox(uint8_t address, uint8_t pdm_id, Faker::Clock* clock) :
     pwm_cmd_.data()[4] = 0x00;
 }
 
+void BlinkKeybox::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+    sub->event((uint8_t)SubSystem::POWER, (uint8_t)PowerEvent::POWER_CMD);
+    sub->j1939Claim();
+    sub->j1939Address();
+    sub->j1939Message(0xEF00);
+}
+
 void BlinkKeybox::handle(const Message& msg, const Yield<Message>& yield) {
     switch (msg.type()) {
         case Message::EVENT:
@@ -50,6 +58,9 @@ void BlinkKeybox::handle(const Message& msg, const Yield<Message>& yield) {
         case Message::J1939_CLAIM:
             handleJ1939Claim(*msg.j1939_claim());
             break;
+        case Message::J1939_ADDRESS:
+            handleJ1939Address(*msg.j1939_address());
+            break;
         case Message::J1939_MESSAGE:
             handleJ1939Message(*msg.j1939_message(), yield);
             break;
@@ -146,6 +157,21 @@ void BlinkKeybox::handleJ1939Claim(const J1939Claim& claim) {
     hb_tick_.resume();
 }
 
+void BlinkKeybox::handleJ1939Address(const J1939Address& node) {
+    if (keybox_name_ == 0) {
+        // learn the keybox's NAME so it can be found if it moves
+        if (node.address() == pin_cmd_.dest_address()) {
+            keybox_name_ = node.name();
+        }
+    } else if (node.name() == keybox_name_ && node.address() != Canny::NullAddress &&
+            node.address() != pin_cmd_.dest_address()) {
+        // the keybox restarted with a new address
+        pin_cmd_.dest_address(node.address());
+        pwm_cmd_.dest_address(node.address());
+        hb_msg_.dest_address(node.address());
+    }
+}
+
 void BlinkKeybox::handleJ1939Message(const Canny::J1939Message& msg, const Yield<Message>& yield) {
     if (pin_cmd_.source_address() == Canny::NullAddress ||
             msg.source_address() != pin_cmd_.dest_address() ||
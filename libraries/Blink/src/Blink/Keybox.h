@@ -10,11 +10,15 @@
 
 namespace R51 {
 
-class BlinkKeybox : public Caster::Node<Message> {
+class BlinkKeybox : public Caster::Node<Message>, public Subscriber {
     public:
         BlinkKeybox(uint8_t address, uint8_t pdm_id,
                 Faker::Clock* clock = Faker::Clock::real());
 
+        // Subscribe to power requests and commands, address claims, node
+        // addresses, and keybox responses.
+        void subscribe(Subscription* sub) override;
+
         // Handle J1939 state changes from the Keybox and power events from the
         // internal bus.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
@@ -22,11 +26,15 @@ class BlinkKeybox : public Caster::Node<Message> {
         // Emit timed changes to the Keybox.
         void emit(const Caster::Yield<Message>& yield) override;
 
+        // Track the heartbeat ticker on a wheel.
+        void schedule(TimerWheel* wheel) { wheel->add(&hb_tick_); }
+
     private:
         void handlePowerCommand(const PowerCommand* cmd,
                 const Caster::Yield<Message>& yield);
         void handlePowerStateRequest(const Caster::Yield<Message>& yield);
         void handleJ1939Claim(const J1939Claim& claim);
+        void handleJ1939Address(const J1939Address& node);
         void handleJ1939Message(const Canny::J1939Message& msg,
                 const Caster::Yield<Message>& yield);
 
@@ -34,10 +42,11 @@ class BlinkKeybox : public Caster::Node<Message> {
         void setPWM(uint8_t pin, uint8_t duty_cycle, const Caster::Yield<Message>& yield);
         void reset(uint8_t pin, const Caster::Yield<Message>& yield);
 
-        Ticker hb_tick_;
+        Timer hb_tick_;
         Canny::J1939Message hb_msg_;
         Canny::J1939Message pin_cmd_;
         Canny::J1939Message pwm_cmd_;
+        uint64_t keybox_name_;
         uint16_t pin_state_;
         uint16_t pin_fault_;
         uint8_t pin11_pwm_;
@@ -46,12 +46,20 @@ uint8_t toBlinkBrightness(uint8_t brightness) {
 
 BlinkKeypad::BlinkKeypad(uint8_t address, uint8_t keypad, uint8_t key_count) :
         keypress_(KeyState(keypad)), command_(0xEF00, Canny::NullAddress, address, 0x06),
-        key_count_(key_count) {
+        keypad_name_(0), key_count_(key_count) {
     command_.resize(8);
     command_.data()[0] = 0x04;
     command_.data()[1] = 0x1B;
 }
 
+void BlinkKeypad::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::KEYPAD, (uint8_t)KeypadEvent::INDICATOR_CMD,
+            (uint8_t)KeypadEvent::BACKLIGHT_CMD);
+    sub->j1939Claim();
+    sub->j1939Address();
+    sub->j1939Message(0xEF00);
+}
+
 void BlinkKeypad::handle(const Message& msg, const Caster::Yield<Message>& yield) {
     switch (msg.type()) {
         case Message::EVENT:
@@ -74,6 +82,9 @@ void BlinkKeypad::handle(const Message& msg, const Caster::Yield<Message>& yield
         case Message::J1939_CLAIM:
             handleJ1939Claim(*msg.j1939_claim(), yield);
             break;
+        case Message::J1939_ADDRESS:
+            handleJ1939Address(*msg.j1939_address(), yield);
+            break;
         case Message::J1939_MESSAGE:
             handleJ1939Message(*msg.j1939_message(), yield);
             break;
@@ -84,6 +95,26 @@ void BlinkKeypad::handle(const Message& msg, const Caster::Yield<Message>& yield
 
 void BlinkKeypad::handleJ1939Claim(const J1939Claim& claim, const Yield<Message>& yield) {
     command_.source_address(claim.address());
+    resetKeypad(yield);
+}
+
+void BlinkKeypad::handleJ1939Address(const J1939Address& node, const Yield<Message>& yield) {
+    if (keypad_name_ == 0) {
+        // learn the keypad's NAME so it can be found if it moves
+        if (node.address() == command_.dest_address()) {
+            keypad_name_ = node.name();
+        }
+    } else if (node.name() == keypad_name_ && node.address() != Canny::NullAddress &&
+            node.address() != command_.dest_address()) {
+        // the keypad restarted with a new address
+        command_.dest_address(node.address());
+        if (command_.source_address() != Canny::NullAddress) {
+            resetKeypad(yield);
+        }
+    }
+}
+
+void BlinkKeypad::resetKeypad(const Yield<Message>& yield) {
     setBacklightBrightness(yield, 0x00);
     setKeyBrightness(yield, 0xFF);
     for (uint8_t i = 0; i < key_count_; ++i) {
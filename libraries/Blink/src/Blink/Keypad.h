@@ -11,14 +11,19 @@ namespace R51 {
 // A bus node that manages a Blink Marine PKP keypad over J1939. PKP keys are 1
 // indexed. This node emits events that are 0 indexed so adjust expectations
 // accordingly.
-class BlinkKeypad : public Caster::Node<Message> {
+class BlinkKeypad : public Caster::Node<Message>, public Subscriber {
     public:
         // Construct a node that interacts the PKP keypad at the given address.
+        // The keypad is followed if it later claims a different address.
         // The keypad value identifies the keypad on the system and must be
         // unique to this specific keypad. The key count is the number of
         // buttons on the PKP.
         BlinkKeypad(uint8_t address, uint8_t keypad, uint8_t key_count);
 
+        // Subscribe to keypad commands, address claims, node addresses, and
+        // keypad responses.
+        void subscribe(Subscription* sub) override;
+
         // Handle J1939 keypad message and a LED command events. Keypad events
         // are yield'd in response to J1939 keypad messages.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
@@ -26,6 +31,8 @@ class BlinkKeypad : public Caster::Node<Message> {
     private:
         void handleJ1939Claim(const J1939Claim& claim,
                 const Caster::Yield<Message>& yield);
+        void handleJ1939Address(const J1939Address& node,
+                const Caster::Yield<Message>& yield);
         void handleJ1939Message(const Canny::J1939Message& msg,
                 const Caster::Yield<Message>& yield);
         void handleIndicatorCommand(const IndicatorCommand* cmd,
@@ -41,9 +48,11 @@ class BlinkKeypad : public Caster::Node<Message> {
         void setKeyBrightness(const Caster::Yield<Message>& yield, uint8_t brightness);
         void setBacklightColor(const Caster::Yield<Message>& yield, LEDColor color);
         void setBacklightBrightness(const Caster::Yield<Message>& yield, uint8_t brightness);
+        void resetKeypad(const Caster::Yield<Message>& yield);
 
         KeyState keypress_;
         Canny::J1939Message command_;
+        uint64_t keypad_name_;
 
         uint8_t key_count_;
 };
@@ -269,6 +269,43 @@ test(KeyboxTest, TogglePWM) {
 
 }
 
+test(KeyboxTest, FollowAddress) {
+    FakeYield yield;
+    uint8_t ecm_address = 0x0A;
+    uint8_t pdm_address = 0x21;
+    uint8_t pdm_id = 0x01;
+    uint64_t pdm_name = 0x0000000000300002;
+    BlinkKeybox keybox(pdm_address, pdm_id);
+
+    J1939Claim claim(ecm_address, 0);
+    keybox.handle(MessageView(&claim), yield);
+
+    // the keybox is displaced and claims a new address
+    J1939Address nodes[] = {
+        J1939Address(pdm_address, pdm_name),
+        J1939Address(Canny::NullAddress, pdm_name),
+        J1939Address(pdm_address, 0x0000000000400003),
+        J1939Address(0x22, pdm_name),
+    };
+    for (size_t i = 0; i < sizeof(nodes) / sizeof(nodes[0]); ++i) {
+        keybox.handle(MessageView(&nodes[i]), yield);
+    }
+    assertSize(yield, 0);
+
+    // commands follow the keybox
+    PowerCommand cmd;
+    cmd.pdm(pdm_id);
+    cmd.pin(3);
+    cmd.cmd(PowerCmd::ON);
+    keybox.handle(MessageView(&cmd), yield);
+
+    J1939Message expect_msg(0xEF00, ecm_address, 0x22, 6);
+    expect_msg.data({0x04, 0x1B, 0x01, 0x04, 0x01, 0xFF, 0xFF, 0xFF});
+
+    assertSize(yield, 2);
+    assertIsJ1939Message(yield.messages()[0], expect_msg);
+}
+
 }
 
 // Test boilerplate.
@@ -0,0 +1,26 @@
+#include <Arduino.h>
+#include <Core.h>
+#include "Node.h"
+
+namespace R51 {
+namespace {
+
+// Schemas for the events defined by Bluetooth.
+
+constexpr EventField kStateFields[] = {
+    boolField("connected", 0, 8),
+};
+
+constexpr EventSchema kBluetoothSchemas[] = {
+    eventSchema("bluetooth_state", SubSystem::BLUETOOTH,
+            (uint8_t)BluetoothEvent::STATE, kStateFields),
+    eventSchema("bluetooth_disconnect", SubSystem::BLUETOOTH,
+            (uint8_t)BluetoothEvent::DISCONNECT_CMD),
+    eventSchema("bluetooth_forget", SubSystem::BLUETOOTH,
+            (uint8_t)BluetoothEvent::FORGET_CMD),
+};
+
+EventSchemaTable bluetooth_schemas(kBluetoothSchemas);
+
+}  // namespace
+}  // namespace R51
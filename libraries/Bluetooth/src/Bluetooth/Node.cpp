@@ -2,6 +2,11 @@
 
 namespace R51 {
 
+void BLENode::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+    sub->event((uint8_t)SubSystem::BLUETOOTH);
+}
+
 void BLENode::handle(const Message& msg, const Caster::Yield<Message>& yield) {
     if (msg.type() != Message::EVENT) {
         return;
@@ -15,13 +15,16 @@ enum class BluetoothEvent : uint8_t {
 };
 
 // Node for managing BLE connectivity.
-class BLENode : public Caster::Node<Message> {
+class BLENode : public Caster::Node<Message>, public Subscriber {
     public:
         BLENode(BLE* ble) :
             ble_(ble),
             event_((uint8_t)SubSystem::BLUETOOTH, (uint8_t)BluetoothEvent::STATE, {0x00}),
             emit_(false) {}
 
+        // Subscribe to bluetooth requests and commands.
+        void subscribe(Subscription* sub) override;
+
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
         void emit(const Caster::Yield<Message>& yield) override;
@@ -6,6 +6,22 @@
 #include "Console.h"
 
 namespace R51::internal {
+namespace {
+
+// Parse a frame ID for the filter commands. IDs may be prefixed with + or -
+// to force an extended or standard ID, the same as for can send.
+bool parseFilterID(const char* arg, IDRule* rule) {
+    size_t offset = (arg[0] == '+' || arg[0] == '-') ? 1 : 0;
+    uint32_t id = strtoul(arg + offset, nullptr, 16);
+    if (id == 0) {
+        return false;
+    }
+    bool ext = arg[0] == '+' || (arg[0] != '-' && id > 0x7FF);
+    *rule = ext ? extID(id) : stdID(id);
+    return true;
+}
+
+}  // namespace
 
 void CANSendRunCommand::run(Console* console, char* arg, const Caster::Yield<Message>& yield) {
     size_t len = strlen(arg);
@@ -66,27 +82,27 @@ void CANSendRunCommand::run(Console* console, char* arg, const Caster::Yield<Mes
 
 void CANFilterAllowRunCommand::run(Console* console, char* arg, const Caster::Yield<Message>&) {
     if (strcmp(arg, "all") == 0) {
-        console->can_filter()->mode(Canny::FilterMode::ALLOW);
-    } else {
-        uint32_t id = strtoul(arg, nullptr, 16);
-        if (id == 0) {
-            console->stream()->println("invalid frame id");
-        } else {
-            console->can_filter()->allow(id);
-        }
+        console->can_filter()->reset(true);
+        return;
+    }
+    IDRule rule;
+    if (!parseFilterID(arg, &rule)) {
+        console->stream()->println("invalid frame id");
+    } else if (!console->can_filter()->allow(rule)) {
+        console->stream()->println("too many extended frame filters");
     }
 }
 
 void CANFilterDropRunCommand::run(Console* console, char* arg, const Caster::Yield<Message>&) {
     if (strcmp(arg, "all") == 0) {
-        console->can_filter()->mode(Canny::FilterMode::DROP);
-    } else {
-        uint32_t id = strtoul(arg, nullptr, 16);
-        if (id == 0) {
-            console->stream()->println("invalid frame id");
-        } else {
-            console->can_filter()->drop(id);
-        }
+        console->can_filter()->reset(false);
+        return;
+    }
+    IDRule rule;
+    if (!parseFilterID(arg, &rule)) {
+        console->stream()->println("invalid frame id");
+    } else if (!console->can_filter()->drop(rule)) {
+        console->stream()->println("too many extended frame filters");
     }
 }
 
@@ -3,28 +3,69 @@
 
 #include <Arduino.h>
 #include <Canny.h>
+#include <Core.h>
 
 namespace R51 {
 
 class Console {
     public:
-        Console(Stream* stream, bool mute) : stream_(stream), event_mute_(mute), j1939_mute_(mute) {
-            if (mute) {
-                can_filter_.mode(Canny::FilterMode::DROP);
-            }
-        }
+        // Maximum number of buses whose stats may be added.
+        static const size_t kMaxBuses = 4;
+
+        // Maximum number of queue sources whose stats may be added.
+        static const size_t kMaxQueues = 2;
+
+        Console(Stream* stream, bool mute) : stream_(stream), can_filter_(!mute),
+                event_mute_(mute), j1939_mute_(mute), bus_count_(0),
+                queue_count_(0) {}
         Stream* stream() { return stream_; }
-        Canny::FrameIDFilter* can_filter() { return &can_filter_; }
+        IDFilter* can_filter() { return &can_filter_; }
         bool event_mute() { return event_mute_; }
         void event_mute(bool mute) { event_mute_ = mute; }
         bool j1939_mute() { return j1939_mute_; }
         void j1939_mute(bool mute) { j1939_mute_ = mute; }
 
+        // Add a bus's stats to the stats command. Returns false if too many
+        // buses have been added.
+        bool addBusStats(const char* name, BusStats* stats) {
+            if (bus_count_ >= kMaxBuses) {
+                return false;
+            }
+            bus_names_[bus_count_] = name;
+            bus_stats_[bus_count_] = stats;
+            ++bus_count_;
+            return true;
+        }
+        size_t bus_count() { return bus_count_; }
+        const char* bus_name(size_t i) { return bus_names_[i]; }
+        BusStats* bus_stats(size_t i) { return bus_stats_[i]; }
+
+        // Add a set of queues to the stats command. Returns false if too many
+        // have been added.
+        bool addQueueStats(const char* name, QueueStatsSource* queues) {
+            if (queue_count_ >= kMaxQueues) {
+                return false;
+            }
+            queue_names_[queue_count_] = name;
+            queue_stats_[queue_count_] = queues;
+            ++queue_count_;
+            return true;
+        }
+        size_t queue_count() { return queue_count_; }
+        const char* queue_name(size_t i) { return queue_names_[i]; }
+        QueueStatsSource* queue_stats(size_t i) { return queue_stats_[i]; }
+
     private:
         Stream* stream_;
-        Canny::FrameIDFilter can_filter_;
+        IDFilter can_filter_;
         bool event_mute_;
         bool j1939_mute_;
+        const char* bus_names_[kMaxBuses];
+        BusStats* bus_stats_[kMaxBuses];
+        size_t bus_count_;
+        const char* queue_names_[kMaxQueues];
+        QueueStatsSource* queue_stats_[kMaxQueues];
+        size_t queue_count_;
 };
 
 }  // namespace R51::internal
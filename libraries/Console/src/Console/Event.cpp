@@ -9,11 +9,25 @@ namespace R51::internal {
 
 void EventSendRunCommand::run(Console* console, char* arg, const Caster::Yield<Message>& yield) {
     size_t len = strlen(arg);
-    if (len < 5 || arg[2] != ':' || (
-            arg[5] != '#' && arg[5] != 0)) {
-        console->stream()->println("console: invalid event format");
+    if (len >= 3 && arg[2] == ':') {
+        if (!parseHex(arg)) {
+            console->stream()->println("console: invalid event format");
+            return;
+        }
+    } else if (!parseSchema(console, arg)) {
         return;
     }
+    console->stream()->print("console: send event ");
+    event_.printTo(*console->stream());
+    console->stream()->println();
+    yield(MessageView(&event_));
+}
+
+bool EventSendRunCommand::parseHex(char* arg) {
+    size_t len = strlen(arg);
+    if (len < 5 || (arg[5] != '#' && arg[5] != 0)) {
+        return false;
+    }
 
     arg[2] = 0;
     event_.subsystem = strtoul((char*)arg, nullptr, 16);
@@ -22,11 +36,7 @@ void EventSendRunCommand::run(Console* console, char* arg, const Caster::Yield<M
 
     if (len <= 5) {
         memset(event_.data, 0xFF, 6);
-        console->stream()->print("console: send event ");
-        event_.printTo(*console->stream());
-        console->stream()->println();
-        yield(MessageView(&event_));
-        return;
+        return true;
     }
 
     byte tmp;
@@ -56,10 +66,34 @@ void EventSendRunCommand::run(Console* console, char* arg, const Caster::Yield<M
     for (int i = data_len; i < 6; ++i) {
         event_.data[i] = 0xFF;
     }
-    console->stream()->print("console: send event ");
-    event_.printTo(*console->stream());
-    console->stream()->println();
-    yield(MessageView(&event_));
+    return true;
+}
+
+bool EventSendRunCommand::parseSchema(Console* console, char* arg) {
+    char* name = strtok(arg, " ");
+    const EventSchema* schema = name == nullptr ? nullptr : EventSchemaTable::find(name);
+    if (schema == nullptr) {
+        console->stream()->println("console: unknown event");
+        return false;
+    }
+    schema->init(&event_);
+
+    char* pair;
+    while ((pair = strtok(nullptr, " ")) != nullptr) {
+        char* value = strchr(pair, '=');
+        if (value != nullptr) {
+            *value++ = 0;
+        }
+        const EventField* field = schema->field(pair);
+        uint32_t parsed;
+        if (field == nullptr || !field->parse(value, &parsed)) {
+            console->stream()->print("console: invalid event field ");
+            console->stream()->println(pair);
+            return false;
+        }
+        field->set(event_.data, parsed);
+    }
+    return true;
 }
 
 void EventMuteCommand::run(Console* console, char*, const Caster::Yield<Message>&) {
@@ -32,11 +32,16 @@ class EventSendRunCommand : public Command {
             return TooManyArgumentsCommand::get();
         }
 
-        // Run the command. Parses and yields the event.
+        // Run the command. Parses and yields the event. The event is given
+        // in hex as SS:II#DD:DD:... or by schema name followed by
+        // field=value pairs.
         void run(Console* console, char* arg, const Caster::Yield<Message>& yield) override;
 
     private:
         Event event_;
+
+        bool parseHex(char* arg);
+        bool parseSchema(Console* console, char* arg);
 };
 
 class EventReadCommand : public NotEnoughArgumentsCommand {
@@ -45,6 +50,8 @@ class EventReadCommand : public NotEnoughArgumentsCommand {
             return &run_;
         }
 
+        bool line() override { return true; }
+
     private:
         EventSendRunCommand run_;
 };
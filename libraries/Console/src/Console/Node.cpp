@@ -4,161 +4,9 @@
 #include <Caster.h>
 #include <Core.h>
 #include <Foundation.h>
-#include <Vehicle.h>
 #include "Console.h"
 
-#define isEvent(e, s, i) (e->subsystem == (uint8_t)s && e->id == (uint8_t)i)
-
 namespace R51 {
-namespace {
-
-void prettyPrintEvent(Stream* stream, const Event* event) {
-    if (isEvent(event, SubSystem::POWER, PowerEvent::POWER_STATE)) {
-        const auto* s = (PowerState*)event;
-        stream->print(" (pdm ");
-        stream->print(s->pdm());
-        stream->print(" output ");
-        stream->print(s->pin());
-        stream->print(" ");
-        switch (s->mode()) {
-            case PowerMode::OFF:
-                stream->print("off");
-                break;
-            case PowerMode::ON:
-                stream->print("on");
-                break;
-            case PowerMode::PWM:
-                stream->print("pwm ");
-                stream->print(s->duty_cycle());
-                break;
-            case PowerMode::FAULT:
-                stream->print("fault");
-                break;
-        }
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::POWER, PowerEvent::INPUT_STATE)) {
-        const auto* s = (InputState*)event;
-        stream->print(" (pdm ");
-        stream->print(s->pdm());
-        stream->print(" input ");
-        stream->print(s->pin());
-        stream->print(" ");
-        stream->print(s->state() ? "on" : "off");
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::KEYPAD, KeypadEvent::KEY_STATE)) {
-        const auto* s = (KeyState*)event;
-        stream->print(" (keypad ");
-        stream->print(s->keypad());
-        if (s->pressed()) {
-            stream->print(" press ");
-        } else {
-            stream->print(" release ");
-        }
-        stream->print(s->key());
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::KEYPAD, KeypadEvent::ENCODER_STATE)) {
-        const auto* s = (EncoderState*)event;
-        stream->print(" (keypad ");
-        stream->print(s->keypad());
-        stream->print(" encoder ");
-        stream->print(s->encoder());
-        stream->print(" delta ");
-        stream->print(s->delta());
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::CLIMATE, ClimateEvent::SYSTEM_STATE)) {
-        const auto* s = (ClimateSystemState*)event;
-        stream->print(" (climate ");
-        switch (s->mode()) {
-            case CLIMATE_SYSTEM_OFF:
-                stream->print("off");
-                break;
-            case CLIMATE_SYSTEM_AUTO:
-                stream->print("auto");
-                break;
-            case CLIMATE_SYSTEM_MANUAL:
-                stream->print("manual");
-                break;
-            case CLIMATE_SYSTEM_DEFOG:
-                stream->print("defog");
-                break;
-            default:
-                break;
-        }
-        stream->print(", ac ");
-        stream->print(s->ac() ? "on" : "off");
-        stream->print(", dual ");
-        stream->print(s->dual() ? "on" : "off");
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::CLIMATE, ClimateEvent::AIRFLOW_STATE)) {
-        const auto* s = (ClimateAirflowState*)event;
-        stream->print(" (climate fan ");
-        stream->print(s->fan_speed());
-        if (s->face()) {
-            stream->print(" face");
-        }
-        if (s->feet()) {
-            stream->print(" feet");
-        }
-        if (s->windshield()) { 
-            stream->print(" windshield");
-        }
-        if (s->recirculate()) {
-            stream->print(" recirculate");
-        }
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::CLIMATE, ClimateEvent::TEMP_STATE)) {
-        const auto* s = (ClimateTempState*)event;
-        char unit = 'F';
-        if (s->units() == UNITS_METRIC) {
-            unit = 'C';
-        }
-        stream->print(" (climate driver temp ");
-        stream->print(s->driver_temp());
-        stream->print(unit);
-        stream->print(", passenger temp ");
-        stream->print(s->passenger_temp());
-        stream->print(unit);
-        stream->print(", outside temp ");
-        stream->print(s->outside_temp());
-        stream->print(unit);
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::BCM, BCMEvent::ILLUM_STATE)) {
-        const auto* s = (IllumState*)event;
-        stream->print(" (dash illumination ");
-        stream->print(s->illum()  ? "on" : "off");
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::BCM, BCMEvent::TIRE_PRESSURE_STATE)) {
-        stream->print(" (tire pressure ");
-        stream->print(event->data[0]);
-        stream->print(" ");
-        stream->print(event->data[1]);
-        stream->print(" ");
-        stream->print(event->data[2]);
-        stream->print(" ");
-        stream->print(event->data[3]);
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::IPDM, IPDMEvent::POWER_STATE)) {
-        stream->print(" (ipdm high beams ");
-        stream->print(getBit(event->data, 0, 0) ? "on" : "off");
-        stream->print(", low beams ");
-        stream->print(getBit(event->data, 0, 1) ? "on" : "off");
-        stream->print(", running lights ");
-        stream->print(getBit(event->data, 0, 2) ? "on" : "off");
-        stream->print(", fog lights ");
-        stream->print(getBit(event->data, 0, 3) ? "on" : "off");
-        stream->print(", defrost ");
-        stream->print(getBit(event->data, 0, 6) ? "on" : "off");
-        stream->print(", a/c comp ");
-        stream->print(getBit(event->data, 0, 7) ? "on" : "off");
-        stream->print(")");
-    } else if (isEvent(event, SubSystem::BLUETOOTH, BluetoothEvent::STATE)) {
-        stream->print(" (bluetooth ");
-        stream->print(event->data[0] == 0x00 ? "disconnect" : "connect");
-        stream->print(")");
-    }
-}
-
-}  // namespace
 
 void ConsoleNode::emit(const Caster::Yield<Message>& yield) {
     Reader::Error err;
@@ -191,8 +39,7 @@ void ConsoleNode::handle(const Message& msg, const Caster::Yield<R51::Message>&)
         case Message::EVENT:
             if (!console_.event_mute()) {
                 console_.stream()->print("console: event recv ");
-                msg.event()->printTo(*console_.stream());
-                prettyPrintEvent(console_.stream(), msg.event());
+                EventSchemaTable::print(*console_.stream(), *msg.event());
                 console_.stream()->println();
             }
             break;
@@ -221,6 +68,20 @@ void ConsoleNode::handle(const Message& msg, const Caster::Yield<R51::Message>&)
                 console_.stream()->println();
             }
             break;
+        case Message::J1939_TRANSFER:
+            if (!console_.j1939_mute()) {
+                console_.stream()->print("console: j1939 transfer ");
+                msg.j1939_transfer()->printTo(*console_.stream());
+                console_.stream()->println();
+            }
+            break;
+        case Message::J1939_ADDRESS:
+            if (!console_.j1939_mute()) {
+                console_.stream()->print("console: j1939 address ");
+                msg.j1939_address()->printTo(*console_.stream());
+                console_.stream()->println();
+            }
+            break;
         case Message::EMPTY:
             break;
     }
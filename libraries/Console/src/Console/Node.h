@@ -38,6 +38,18 @@ class ConsoleNode : public Caster::Node<R51::Message> {
 
         Console* console() { return &console_; }
 
+        // Add a bus's per-node stats to the "stats" command. Returns false if
+        // too many buses have been added.
+        bool addBusStats(const char* name, BusStats* stats) {
+            return console_.addBusStats(name, stats);
+        }
+
+        // Add a set of queues, e.g. a Pipe, to the "stats" command. Returns
+        // false if too many have been added.
+        bool addQueueStats(const char* name, QueueStatsSource* queues) {
+            return console_.addQueueStats(name, queues);
+        }
+
     private:
         char buffer_[256];
         Console console_;
@@ -13,6 +13,8 @@
 #include "IPDM.h"
 #include "J1939.h"
 #include "Scratch.h"
+#include "Stats.h"
+#include "Trace.h"
 
 namespace R51::internal {
 
@@ -36,6 +38,10 @@ class RootCommand : public Command {
                 return &ipdm_;
             } else if (strcmp(arg, "bluetooth") == 0 || strcmp(arg, "ble") == 0) {
                 return &bluetooth_;
+            } else if (strcmp(arg, "stats") == 0) {
+                return &stats_;
+            } else if (strcmp(arg, "trace") == 0 || strcmp(arg, "t") == 0) {
+                return &trace_;
             }
             return NotFoundCommand::get();
         }
@@ -54,6 +60,8 @@ class RootCommand : public Command {
         BCMCommand bcm_;
         IPDMCommand ipdm_;
         BluetoothCommand bluetooth_;
+        StatsCommand stats_;
+        TraceCommand trace_;
 };
 
 }  // namespace R51::internal
@@ -6,7 +6,8 @@ namespace R51::internal {
 
 void ScratchSetCommand::run(Console* console, char* arg, const Caster::Yield<Message>&) {
     size_t len = strlen(arg);
-    if (len + 1 > kScratchCapacity) {
+    scratch_->clear();
+    if (!scratch_->reserve(len + 1)) {
         console->stream()->println("console: scratch buffer overflow");
         return;
     }
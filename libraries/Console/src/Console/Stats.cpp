@@ -0,0 +1,95 @@
+#include "Stats.h"
+
+#include <Arduino.h>
+#include <Caster.h>
+#include <Core.h>
+#include "Console.h"
+
+namespace R51::internal {
+
+void StatsNodesCommand::run(Console* console, char*, const Caster::Yield<Message>&) {
+    Stream* stream = console->stream();
+    bool enabled = false;
+    for (size_t i = 0; i < console->bus_count(); ++i) {
+        const BusStats* stats = console->bus_stats(i);
+        for (size_t j = 0; j < stats->size(); ++j) {
+            enabled = true;
+            NodeStats node = stats->snapshot(j);
+            stream->print("console: stats ");
+            stream->print(console->bus_name(i));
+            stream->print(" node ");
+            if (stats->name(j) != nullptr) {
+                stream->print(stats->name(j));
+            } else {
+                stream->print(j);
+            }
+            stream->print(" handled ");
+            stream->print(node.handled);
+            stream->print(" emitted ");
+            stream->print(node.emitted);
+            stream->print(" yielded ");
+            stream->print(node.yielded);
+            stream->print(" handle_us ");
+            stream->print(node.handle_us);
+            stream->print(" emit_us ");
+            stream->print(node.emit_us);
+            stream->print(" worst_us ");
+            stream->println(node.worst_us);
+        }
+    }
+    if (!enabled) {
+        stream->println("console: bus stats disabled");
+    }
+}
+
+void StatsQueuesCommand::run(Console* console, char*, const Caster::Yield<Message>&) {
+    Stream* stream = console->stream();
+    for (size_t i = 0; i < console->queue_count(); ++i) {
+        QueueStatsSource* queues = console->queue_stats(i);
+        for (size_t j = 0; j < queues->queueCount(); ++j) {
+            QueueStats stats = queues->queueStats(j);
+            stream->print("console: stats ");
+            stream->print(console->queue_name(i));
+            stream->print(" ");
+            stream->print(queues->queueName(j));
+            stream->print(" depth ");
+            stream->print(stats.depth);
+            stream->print(" peak_depth ");
+            stream->print(stats.peak_depth);
+            stream->print(" peak_bytes ");
+            stream->print(stats.peak_bytes);
+            stream->print(" overruns ");
+            stream->print(stats.overruns);
+            stream->print(" peak_drain ");
+            stream->println(stats.peak_drain);
+        }
+    }
+    if (console->queue_count() == 0) {
+        stream->println("console: no queue stats");
+    }
+}
+
+void StatsScratchCommand::run(Console* console, char*, const Caster::Yield<Message>&) {
+    Stream* stream = console->stream();
+    const ScratchArena* arena = ScratchArena::shared();
+    stream->print("console: stats scratch used ");
+    stream->print(arena->used());
+    stream->print(" peak ");
+    stream->print(arena->peak());
+    stream->print(" capacity ");
+    stream->print(arena->capacity());
+    stream->print(" failures ");
+    stream->println(arena->failures());
+}
+
+void StatsResetCommand::run(Console* console, char*, const Caster::Yield<Message>&) {
+    for (size_t i = 0; i < console->bus_count(); ++i) {
+        console->bus_stats(i)->reset();
+    }
+    for (size_t i = 0; i < console->queue_count(); ++i) {
+        console->queue_stats(i)->resetQueueStats();
+    }
+    ScratchArena::shared()->resetPeak();
+}
+
+}  // namespace R51::internal
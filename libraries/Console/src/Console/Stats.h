@@ -0,0 +1,79 @@
+#ifndef _R51_CONSOLE_STATS_H_
+#define _R51_CONSOLE_STATS_H_
+
+#include <Arduino.h>
+#include <Caster.h>
+#include <Core.h>
+#include "Command.h"
+#include "Console.h"
+#include "Error.h"
+
+namespace R51::internal {
+
+// Prints the per-node stats of each bus added to the console. Nodes are
+// printed by name if the bus names them.
+class StatsNodesCommand : public Command {
+    public:
+        Command* next(char*) override {
+            return TooManyArgumentsCommand::get();
+        }
+
+        void run(Console* console, char*, const Caster::Yield<Message>&) override;
+};
+
+// Prints the stats of each queue added to the console.
+class StatsQueuesCommand : public Command {
+    public:
+        Command* next(char*) override {
+            return TooManyArgumentsCommand::get();
+        }
+
+        void run(Console* console, char*, const Caster::Yield<Message>&) override;
+};
+
+// Prints the usage of the shared scratch arena.
+class StatsScratchCommand : public Command {
+    public:
+        Command* next(char*) override {
+            return TooManyArgumentsCommand::get();
+        }
+
+        void run(Console* console, char*, const Caster::Yield<Message>&) override;
+};
+
+// Resets the per-node stats of each bus added to the console, the queue
+// stats, and the peak usage of the shared scratch arena.
+class StatsResetCommand : public Command {
+    public:
+        Command* next(char*) override {
+            return TooManyArgumentsCommand::get();
+        }
+
+        void run(Console* console, char*, const Caster::Yield<Message>&) override;
+};
+
+class StatsCommand : public NotEnoughArgumentsCommand {
+    public:
+        Command* next(char* arg) override {
+            if (strcmp(arg, "nodes") == 0 || strcmp(arg, "n") == 0) {
+                return &nodes_;
+            } else if (strcmp(arg, "queues") == 0 || strcmp(arg, "q") == 0) {
+                return &queues_;
+            } else if (strcmp(arg, "scratch") == 0 || strcmp(arg, "s") == 0) {
+                return &scratch_;
+            } else if (strcmp(arg, "reset") == 0) {
+                return &reset_;
+            }
+            return NotFoundCommand::get();
+        }
+
+    private:
+        StatsNodesCommand nodes_;
+        StatsQueuesCommand queues_;
+        StatsScratchCommand scratch_;
+        StatsResetCommand reset_;
+};
+
+}  // namespace R51::internal
+
+#endif  // _R51_CONSOLE_STATS_H_
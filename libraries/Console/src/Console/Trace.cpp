@@ -0,0 +1,21 @@
+#include "Trace.h"
+
+#include <Arduino.h>
+#include <Caster.h>
+#include <Core.h>
+#include "Console.h"
+
+namespace R51::internal {
+
+void TraceSendCommand::run(Console* console, char* arg, const Caster::Yield<Message>& yield) {
+    char* end;
+    unsigned long id = strtoul(arg, &end, 0);
+    if (*arg == 0 || *end != 0 || id > 0xFF) {
+        console->stream()->println("console: invalid trace id");
+        return;
+    }
+    cmd_.trace(id);
+    yield(MessageView(&cmd_));
+}
+
+}  // namespace R51::internal
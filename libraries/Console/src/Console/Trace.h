@@ -0,0 +1,83 @@
+#ifndef _R51_CONSOLE_TRACE_H_
+#define _R51_CONSOLE_TRACE_H_
+
+#include <Arduino.h>
+#include <Caster.h>
+#include <Core.h>
+#include "Command.h"
+#include "Console.h"
+#include "Error.h"
+
+namespace R51::internal {
+
+// Sends a trace command to the trace whose ID is given as the argument.
+class TraceSendCommand : public Command {
+    public:
+        TraceSendCommand(TraceAction action) : cmd_(action) {}
+
+        Command* next(char*) override {
+            return TooManyArgumentsCommand::get();
+        }
+
+        void run(Console* console, char* arg, const Caster::Yield<Message>& yield) override;
+
+    private:
+        R51::TraceCommand cmd_;
+};
+
+// Sends a trace command to all traces or to the one given as the argument.
+class TraceActionCommand : public Command {
+    public:
+        TraceActionCommand(TraceAction action) : cmd_(action), id_(action) {}
+
+        Command* next(char*) override {
+            return &id_;
+        }
+
+        void run(Console*, char*, const Caster::Yield<Message>& yield) override {
+            yield(MessageView(&cmd_));
+        }
+
+    private:
+        R51::TraceCommand cmd_;
+        TraceSendCommand id_;
+};
+
+// Dumps a single trace. Traces on different cores share the serial port so
+// they are dumped one at a time.
+class TraceDumpCommand : public NotEnoughArgumentsCommand {
+    public:
+        TraceDumpCommand() : id_(TraceAction::DUMP) {}
+
+        Command* next(char*) override {
+            return &id_;
+        }
+
+    private:
+        TraceSendCommand id_;
+};
+
+class TraceCommand : public NotEnoughArgumentsCommand {
+    public:
+        TraceCommand() : freeze_(TraceAction::FREEZE), resume_(TraceAction::RESUME) {}
+
+        Command* next(char* arg) override {
+            if (strcmp(arg, "freeze") == 0 || strcmp(arg, "f") == 0) {
+                return &freeze_;
+            } else if (strcmp(arg, "resume") == 0 || strcmp(arg, "r") == 0) {
+                return &resume_;
+            } else if (strcmp(arg, "dump") == 0 || strcmp(arg, "d") == 0) {
+                return &dump_;
+            }
+            return NotFoundCommand::get();
+        }
+
+    private:
+        TraceActionCommand freeze_;
+        TraceActionCommand resume_;
+        TraceDumpCommand dump_;
+};
+
+}  // namespace R51::internal
+
+#endif  // _R51_CONSOLE_TRACE_H_
@@ -149,6 +149,32 @@ test(ConsoleCANTest, ReadValidButBadlyFormed) {
     assertPrintablesEqual(*yield.messages()[0].can_frame(), expect);
 }
 
+test(ConsoleCANTest, Filter) {
+    FakeReadStream stream;
+    FakeYield yield;
+    ConsoleNode console(&stream, false);
+    IDFilter* filter = console.console()->can_filter();
+    assertTrue(filter->match(0x123, false));
+
+    strcpy((char*)buffer, "can filter drop all\n");
+    stream.set(buffer, strlen((char*)buffer));
+    console.emit(yield);
+    assertFalse(filter->match(0x123, false));
+    assertFalse(filter->match(0x324, false));
+
+    strcpy((char*)buffer, "can filter allow 324\n");
+    stream.set(buffer, strlen((char*)buffer));
+    console.emit(yield);
+    assertTrue(filter->match(0x324, false));
+    assertFalse(filter->match(0x324, true));
+
+    strcpy((char*)buffer, "can filter allow +45324\n");
+    stream.set(buffer, strlen((char*)buffer));
+    console.emit(yield);
+    assertTrue(filter->match(0x45324, true));
+    assertSize(yield, 0);
+}
+
 }  // namespace R51
 
 // Test boilerplate.
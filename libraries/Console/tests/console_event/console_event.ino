@@ -147,6 +147,34 @@ test(ConsoleEventTest, ReadValidButBadlyFormedEvent) {
     assertPrintablesEqual(*yield.messages()[0].event(), expect);
 }
 
+test(ConsoleEventTest, ReadNamedEvent) {
+    Event expect(SubSystem::POWER, (uint8_t)PowerEvent::POWER_CMD,
+            (uint8_t[]){0x01, 0x02, (uint8_t)PowerCmd::TOGGLE, 0x00});
+    strcpy((char*)buffer, "event send power_cmd pdm=1 pin=2 cmd=toggle\n");
+
+    FakeReadStream stream;
+    stream.set(buffer, strlen((char*)buffer));
+    FakeYield yield;
+    ConsoleNode console(&stream, false);
+
+    console.emit(yield);
+    assertSize(yield, 1);
+    assertEqual(yield.messages()[0].type(), Message::EVENT);
+    assertPrintablesEqual(*yield.messages()[0].event(), expect);
+}
+
+test(ConsoleEventTest, ReadNamedEventInvalidField) {
+    strcpy((char*)buffer, "event send power_cmd pdm=1 cmd=explode\n");
+
+    FakeReadStream stream;
+    stream.set(buffer, strlen((char*)buffer));
+    FakeYield yield;
+    ConsoleNode console(&stream, false);
+
+    console.emit(yield);
+    assertSize(yield, 0);
+}
+
 test(ConsoleEventTest, ReadInvalidEvent) {
     strcpy((char*)buffer, "0304#\n");
 
@@ -0,0 +1,177 @@
+#include <Arduino.h>
+#include <Bench.h>
+#include <Blink.h>
+#include <Canny.h>
+#include <Caster.h>
+#include <Controls.h>
+#include <Core.h>
+
+// Pushes synthetic J1939 traffic through the controller's node set. The
+// stereo streams Fusion state messages and the keypad reports key presses.
+// Results leave through the J1939 gateway and the HMI's serial stream. The
+// I/O and processing buses are merged into a single bus since the inter-core
+// pipe is not available on the host. The rotary encoders require I2C hardware
+// and are not included.
+
+namespace R51 {
+
+using ::Canny::J1939Message;
+
+static const size_t kFrames = 200000;
+static const uint8_t kJ1939Address = 0x19;
+static const uint64_t kJ1939Name = 0x00000BB000FFFAC0;
+static const uint8_t kEncoderKeypadId = 0x01;
+static const uint8_t kKeypadId = 0x02;
+static const uint8_t kKeypadAddress = 0x24;
+static const uint8_t kKeypadKeys = 8;
+static const uint8_t kKeyboxId = 0x01;
+static const uint8_t kKeyboxAddress = 0x23;
+static const uint8_t kSteeringKeypadId = 0x00;
+
+J1939Message message(uint32_t id, const uint8_t (&data)[8]) {
+    J1939Message msg;
+    msg.id(id);
+    msg.data(data);
+    return msg;
+}
+
+// Stereo discovery. Sent once to bring the Fusion node online.
+const J1939Message boot[] = {
+    message(0x19F0140A, {0xA0, 0x86, 0x35, 0x08, 0x8E, 0x12, 0x4D, 0x53}),
+    message(0x19F0140A, {0xA1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF}),
+};
+
+// Fusion state messages and keypad presses. Fast packet counters change
+// between messages and volume alternates so that every state message results
+// in a state change.
+const J1939Message traffic[] = {
+    message(0x1DFF040A, {0x20, 0x0E, 0xA3, 0x99, 0x1D, 0x80, 0x0A, 0x0A}),
+    message(0x1DFF040A, {0x21, 0x0A, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}),
+    message(0x1DFF040A, {0x40, 0x0A, 0xA3, 0x99, 0x20, 0x80, 0x01, 0x00}),
+    message(0x1DFF040A, {0x41, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF}),
+    message(0x18EF1924, {0x04, 0x1B, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF}),
+    message(0x1DFF040A, {0x60, 0x0E, 0xA3, 0x99, 0x1D, 0x80, 0x0B, 0x0B}),
+    message(0x1DFF040A, {0x61, 0x0B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}),
+    message(0x1DFF040A, {0x80, 0x0A, 0xA3, 0x99, 0x20, 0x80, 0x01, 0x00}),
+    message(0x1DFF040A, {0x81, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF}),
+    message(0x18EF1924, {0x04, 0x1B, 0x01, 0x01, 0x00, 0xFF, 0xFF, 0xFF}),
+};
+
+// The controller nodes with their hardware connections replaced by bench
+// connections.
+class Controller {
+    public:
+        Controller(LatencyProbe* probe = nullptr) :
+            j1939_conn(probe), hmi_stream(probe),
+            j1939_gw(&j1939_conn, kJ1939Address, kJ1939Name, true),
+            hmi(&hmi_stream, kEncoderKeypadId, kKeyboxId),
+            blink_keypad(kKeypadAddress, kKeypadId, kKeypadKeys),
+            blink_keybox(kKeyboxAddress, kKeyboxId),
+            nav_controls(kEncoderKeypadId),
+            power_controls(kKeypadId, kKeyboxId),
+            steering_controls(kSteeringKeypadId) {}
+
+        BenchConnection<J1939Message> j1939_conn;
+        BenchStream hmi_stream;
+        J1939Gateway j1939_gw;
+        J1939Adapter j1939_adapter;
+        HMI hmi;
+        Fusion fusion;
+        BlinkKeypad blink_keypad;
+        BlinkKeybox blink_keybox;
+        NavControls nav_controls;
+        PowerControls power_controls;
+        SteeringControls steering_controls;
+};
+
+// Replay frames into the controller until all of them have been read.
+template <typename Bus>
+void replay(Controller* controller, Bus* bus, const J1939Message* frames,
+        size_t size, size_t count, LatencyProbe* probe) {
+    controller->j1939_conn.replay(frames, size, count);
+    while (!controller->j1939_conn.done()) {
+        bus->loop();
+        if (probe != nullptr) {
+            probe->clear();
+        }
+    }
+}
+
+// Boot the controller and replay the traffic. Returns the elapsed time of the
+// traffic replay in nanoseconds.
+template <typename Bus>
+uint64_t drive(Controller* controller, Bus* bus, LatencyProbe* probe = nullptr) {
+    replay(controller, bus, boot, sizeof(boot)/sizeof(boot[0]),
+            sizeof(boot)/sizeof(boot[0]), nullptr);
+    if (probe != nullptr) {
+        probe->reset();
+    }
+    uint64_t start = benchNanos();
+    replay(controller, bus, traffic, sizeof(traffic)/sizeof(traffic[0]),
+            kFrames, probe);
+    return benchNanos() - start;
+}
+
+void benchIndexedBus() {
+    Controller controller;
+    BusNode nodes[] = {
+        &controller.j1939_gw,
+        &controller.j1939_adapter,
+        &controller.fusion,
+        &controller.blink_keypad,
+        &controller.blink_keybox,
+        &controller.hmi,
+        &controller.nav_controls,
+        &controller.power_controls,
+        &controller.steering_controls,
+    };
+    IndexedBus bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+    uint64_t elapsed = drive(&controller, &bus);
+    reportThroughput(&Serial, "controller", "indexed", kFrames, elapsed);
+}
+
+void benchProfile() {
+    LatencyProbe probe(kFrames);
+    Controller controller(&probe);
+    TimedNode timed[] = {
+        TimedNode("j1939_gw", &controller.j1939_gw),
+        TimedNode("j1939_adapter", &controller.j1939_adapter),
+        TimedNode("fusion", &controller.fusion),
+        TimedNode("blink_keypad", &controller.blink_keypad),
+        TimedNode("blink_keybox", &controller.blink_keybox),
+        TimedNode("hmi", &controller.hmi),
+        TimedNode("nav_controls", &controller.nav_controls),
+        TimedNode("power_controls", &controller.power_controls),
+        TimedNode("steering_controls", &controller.steering_controls),
+    };
+    BusNode nodes[] = {
+        &timed[0], &timed[1], &timed[2], &timed[3], &timed[4],
+        &timed[5], &timed[6], &timed[7], &timed[8],
+    };
+    static const size_t size = sizeof(nodes)/sizeof(nodes[0]);
+    IndexedBus bus(nodes, size);
+    bus.init();
+    uint64_t elapsed = drive(&controller, &bus, &probe);
+
+    reportThroughput(&Serial, "controller", "profile", kFrames, elapsed);
+    for (size_t i = 0; i < size; ++i) {
+        reportNode(&Serial, "controller", timed[i]);
+    }
+    reportLatency(&Serial, "controller", &probe);
+}
+
+}  // namespace R51
+
+void setup() {
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+
+    R51::benchIndexedBus();
+    R51::benchProfile();
+#if defined(EPOXY_DUINO)
+    exit(0);
+#endif
+}
+
+void loop() {}
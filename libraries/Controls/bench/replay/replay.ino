@@ -0,0 +1,181 @@
+#include <Arduino.h>
+#include <Bench.h>
+#include <Canny.h>
+#include <Caster.h>
+#include <Controls.h>
+#include <Core.h>
+#include <Faker.h>
+#include <Vehicle.h>
+
+// Replays a recorded capture through the vehicle and J1939 nodes. Standard
+// frames are read by the vehicle CAN gateway and extended frames by the J1939
+// gateway. All nodes share a fake clock which follows the capture timestamps,
+// so the replay runs as fast as the nodes allow and its event stream is the
+// same on every run.
+//
+// Usage: replay.out [-q] <capture>
+//
+// Each event is printed as "<ms> <event>". The -q flag suppresses the events
+// for profiling. Timing results are printed at the end.
+
+namespace R51 {
+
+using ::Canny::CAN20Frame;
+using ::Canny::J1939Message;
+
+static const uint8_t kJ1939Address = 0x20;
+static const uint64_t kJ1939Name = 0x00001BB000FFFAC0;
+
+// Clock step used to run node tickers between frames.
+static const uint32_t kStepMs = 10;
+
+// Prints every event on the bus with the current capture time.
+class EventLog : public Caster::Node<Message>, public Subscriber {
+    public:
+        EventLog(Faker::Clock* clock, Print* out) :
+            clock_(clock), out_(out), events_(0) {}
+
+        void subscribe(Subscription* sub) override { sub->all(); }
+
+        void handle(const Message& msg, const Caster::Yield<Message>&) override {
+            if (msg.type() != Message::EVENT) {
+                return;
+            }
+            ++events_;
+            if (out_ != nullptr) {
+                out_->print(clock_->millis());
+                out_->print(' ');
+                msg.event()->printTo(*out_);
+                out_->println();
+            }
+        }
+
+        uint32_t events() const { return events_; }
+
+    private:
+        Faker::Clock* clock_;
+        Print* out_;
+        uint32_t events_;
+};
+
+// The replayed nodes with their hardware connections replaced by replay
+// connections.
+class Replay {
+    public:
+        Replay(Print* out) :
+            can_gw(&can_conn),
+            j1939_gw(&j1939_conn, kJ1939Address, kJ1939Name, true),
+            climate(0, &clock), settings(&clock), ipdm(0, &clock),
+            tire_pressure(nullptr, 0, &clock), engine_temp(0, &clock),
+            fusion(&clock), log(&clock, out) {}
+
+        Faker::FakeClock clock;
+        ReplayConnection<CAN20Frame> can_conn;
+        ReplayConnection<J1939Message> j1939_conn;
+        CANGateway can_gw;
+        J1939Gateway j1939_gw;
+        J1939Adapter j1939_adapter;
+        Climate climate;
+        Settings settings;
+        IPDM ipdm;
+        TirePressure tire_pressure;
+        EngineTempState engine_temp;
+        Fusion fusion;
+        EventLog log;
+};
+
+// Read a frame from the connection it was captured on.
+void push(Replay* replay, const CAN20Frame& frame) {
+    if (frame.ext()) {
+        J1939Message msg;
+        msg.id(frame.id());
+        msg.resize(frame.size());
+        memcpy(msg.data(), frame.data(), frame.size());
+        replay->j1939_conn.push(msg);
+    } else {
+        replay->can_conn.push(frame);
+    }
+}
+
+// Advance the clock to the given capture time. The bus is looped at every
+// step so that ticking nodes emit as they would have in the vehicle.
+template <typename Bus>
+void advance(Replay* replay, Bus* bus, uint32_t ms) {
+    while (replay->clock.millis() + kStepMs < ms) {
+        replay->clock.delay(kStepMs);
+        bus->loop();
+    }
+    replay->clock.set(ms);
+}
+
+int run(const char* path, bool quiet) {
+    CaptureReader reader;
+    if (!reader.open(path)) {
+        Serial.print("replay: unable to open ");
+        Serial.println(path);
+        return 1;
+    }
+
+    Replay replay(quiet ? nullptr : &Serial);
+    TimedNode timed[] = {
+        TimedNode("can_gw", &replay.can_gw),
+        TimedNode("j1939_gw", &replay.j1939_gw),
+        TimedNode("j1939_adapter", &replay.j1939_adapter),
+        TimedNode("climate", &replay.climate),
+        TimedNode("settings", &replay.settings),
+        TimedNode("ipdm", &replay.ipdm),
+        TimedNode("tire_pressure", &replay.tire_pressure),
+        TimedNode("engine_temp", &replay.engine_temp),
+        TimedNode("fusion", &replay.fusion),
+    };
+    BusNode nodes[] = {
+        &timed[0], &timed[1], &timed[2], &timed[3], &timed[4],
+        &timed[5], &timed[6], &timed[7], &timed[8], &replay.log,
+    };
+    static const size_t size = sizeof(nodes)/sizeof(nodes[0]);
+    IndexedBus bus(nodes, size);
+    bus.init();
+
+    CAN20Frame frame;
+    uint64_t time_us = 0;
+    uint32_t frames = 0;
+    uint64_t start = benchNanos();
+    while (reader.next(&frame, &time_us)) {
+        advance(&replay, &bus, time_us / 1000);
+        push(&replay, frame);
+        while (!replay.can_conn.empty() || !replay.j1939_conn.empty()) {
+            bus.loop();
+        }
+        ++frames;
+    }
+    // Let pending emits and retries run out.
+    advance(&replay, &bus, time_us / 1000 + 1000);
+    uint64_t elapsed = benchNanos() - start;
+
+    reportReplay(&Serial, "replay", frames, replay.log.events(), reader.errors(),
+            time_us, elapsed);
+    reportThroughput(&Serial, "replay", "capture", frames, elapsed);
+    for (size_t i = 0; i < size - 1; ++i) {
+        reportNode(&Serial, "replay", timed[i]);
+    }
+    return 0;
+}
+
+}  // namespace R51
+
+void setup() {
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+
+#if defined(EPOXY_DUINO)
+    bool quiet = epoxy_argc > 1 && strcmp(epoxy_argv[1], "-q") == 0;
+    int path = quiet ? 2 : 1;
+    if (path >= epoxy_argc) {
+        Serial.println("usage: replay.out [-q] <capture>");
+        exit(2);
+    }
+    exit(R51::run(epoxy_argv[path], quiet));
+#endif
+}
+
+void loop() {}
@@ -12,7 +12,7 @@
 
 namespace R51 {
 
-class Controls : public Caster::Node<Message> {
+class Controls : public Caster::Node<Message>, public Subscriber {
     public:
         Controls() = default;
         virtual ~Controls() = default;
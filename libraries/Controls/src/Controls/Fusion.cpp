@@ -27,6 +27,8 @@ static const uint32_t kBootInitTimeout = 500;
 static const uint32_t kBootRequestTimeout = 5000;
 static const uint32_t kHeartbeatTimeout = 5000;
 static const uint32_t kDiscoveryTick = 5000;
+static const uint32_t kDiscoveryMaxTick = 60000;
+static const uint32_t kFastPacketTimeout = 750;
 static const int8_t kFadeMultiplier = 3;
 
 enum BootState : uint8_t {
@@ -39,7 +41,7 @@ enum BootState : uint8_t {
 
 // Mapping of Fusion state identifiers.
 enum FusionState : uint8_t {
-    // 4th byte of A3:99:XX:80 state frames.
+    // 3rd byte of A3:99:XX:80 state payloads.
     // 1DFF040A#C0:19:A3:99:11:80:07:00
     SOURCE = 0x02,
     TRACK_PLAYBACK = 0x04,
@@ -58,13 +60,6 @@ enum FusionState : uint8_t {
     VOLUME = 0x1D,
     HEARTBEAT = 0x20,
     POWER = 0x39,
-
-    // Response to J1939 request messages.
-    PGN_01F014 = 0xF4,
-    PGN_01F016 = 0xF6,
-
-    // Invalid state detected.
-    INVALID = 0xFF,
 };
 
 enum TrackCmd : uint8_t {
@@ -82,26 +77,6 @@ enum RadioCmd : uint8_t {
     RADIO_CMD_TUNE = 0x05,
 };
 
-uint8_t counter(const J1939Message& msg) {
-    return msg.data()[0];
-}
-
-uint8_t counter_id(uint8_t counter) {
-    return (counter & 0xE0) >> 4;
-}
-
-uint8_t counter_id(const J1939Message& msg) {
-    return counter_id(counter(msg));
-}
-
-uint8_t counter_seq(uint8_t counter) {
-    return counter & 0x1F;
-}
-
-uint8_t counter_seq(const J1939Message& msg) {
-    return counter_seq(counter(msg));
-}
-
 template <size_t N> 
 bool match(const uint8_t* data, const uint8_t (&match)[N]) {
     for (uint8_t i = 0; i < N; i++) {
@@ -116,12 +91,11 @@ bool match(const uint8_t* data, const uint8_t (&match)[N]) {
 
 Fusion::Fusion(Clock* clock) :
         clock_(clock), address_(Canny::NullAddress), hu_address_(Canny::NullAddress),
-        boot_state_(UNKNOWN),
-        disco_timer_(kDiscoveryTick, false, clock),
+        boot_state_(UNKNOWN), tx_hold_(TxNetwork::J1939, clock),
+        disco_timer_(kDiscoveryTick, true, clock),
         boot_timer_(kBootInitTimeout, true, clock),
-        state_(0xFF), state_ignore_next_(false), state_pgn_(0), state_counter_(0xFF),
-        cmd_counter_(0x00), cmd_(0x1EF00, Canny::NullAddress),
-        secondary_source_((AudioSource)0xFF) {
+        packets_(kFastPacketTimeout, clock),
+        cmd_counter_(0x00), cmd_(0x1EF00, Canny::NullAddress) {
     cmd_.resize(8);
     track_title_.scratch = &track_title_scratch_;
     track_artist_.scratch = &track_artist_scratch_;
@@ -129,6 +103,17 @@ Fusion::Fusion(Clock* clock) :
     settings_item_.scratch = &settings_item_scratch_;
 }
 
+void Fusion::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::TX_STATE);
+    sub->event((uint8_t)SubSystem::AUDIO);
+    sub->j1939Claim();
+    sub->j1939Address();
+    sub->j1939Message(0x1F014);
+    sub->j1939Message(0x1F016);
+    sub->j1939Message(0x1FF04);
+}
+
 void Fusion::handle(const Message& msg, const Yield<Message>& yield) {
     switch (msg.type()) {
         case Message::EVENT:
@@ -175,10 +160,16 @@ void Fusion::handle(const Message& msg, const Yield<Message>& yield) {
             if (msg.event()->subsystem == (uint8_t)SubSystem::AUDIO) {
                 handleCommand(*msg.event(), yield);
             }
+            if (TxState::match(msg)) {
+                tx_hold_.update(*(TxState*)msg.event());
+            }
             break;
         case Message::J1939_CLAIM:
             handleJ1939Claim(*msg.j1939_claim(), yield);
             break;
+        case Message::J1939_ADDRESS:
+            handleJ1939Address(*msg.j1939_address(), yield);
+            break;
         case Message::J1939_MESSAGE:
             handleJ1939Message(*msg.j1939_message(), yield);
             break;
@@ -425,348 +416,311 @@ void Fusion::handleJ1939Claim(const J1939Claim& claim, const Yield<Message>& yie
     address_ = claim.address();
     cmd_.source_address(address_);
     if (address_ != Canny::NullAddress && hu_address_ == Canny::NullAddress) {
-        sendStereoDiscovery(yield);
+        // ask every stereo already on the network to identify itself
+        sendPGN01F014Request(yield);
+        disco_timer_.resume(kDiscoveryTick);
     }
 }
 
+void Fusion::handleJ1939Address(const J1939Address& node, const Yield<Message>& yield) {
+    if (address_ == Canny::NullAddress || hu_address_ != Canny::NullAddress ||
+            node.address() == Canny::NullAddress) {
+        return;
+    }
+    // ask nodes which join the network if they are a stereo
+    sendPGN01F014Request(yield, node.address());
+}
+
 void Fusion::handleJ1939Message(const J1939Message& msg, const Yield<Message>& yield) {
     if (address_ == Canny::NullAddress) {
         return;
     }
 
-    // Detect state.
-    if (msg.pgn() == 0x1F014) {
-        state_ = FusionState::PGN_01F014;
-        state_pgn_ = msg.pgn();
-        state_counter_ = counter(msg);
-    } else if (msg.pgn() == 0x1F016) {
-        state_ = FusionState::PGN_01F016;
-        state_pgn_ = msg.pgn();
-        state_counter_ = counter(msg);
-    } else if (msg.pgn() == 0x1FF04 && msg.source_address() == hu_address_) {
-        if (counter_seq(msg) == 0) {
-            if ((msg.pgn() != state_pgn_ || counter_id(msg) != counter_id(state_counter_)) &&
-                    match(msg.data() + 2, {0xA3, 0x99, 0xFF, 0x80})) {
-                // first state message
-                state_ = (FusionState)msg.data()[4];
-            } else {
-                state_ = FusionState::INVALID;
+    switch (msg.pgn()) {
+        case 0x1F014:
+            if (FastPacketAssembler::index(msg) == 0) {
+                // first frame of the product info triggers boot init
+                bootInit(msg.source_address(), yield);
             }
-        } else if (counter_seq(msg) != counter_seq(state_counter_) + 1) {
-            // message out of sequence
-            state_ = FusionState::INVALID;
-        } else if (state_ignore_next_) {
-            // ignore requested
-            state_ignore_next_ = false;
-            state_ = FusionState::INVALID;
-        }
-        // else use current state 
-        state_pgn_ = msg.pgn();
-        state_counter_ = counter(msg);
-    } else {
+            break;
+        case 0x1F016:
+            break;
+        case 0x1FF04:
+            if (msg.source_address() != hu_address_) {
+                return;
+            }
+            break;
+        default:
+            return;
+    }
+    if (!packets_.add(msg)) {
         return;
     }
 
-    // Handle state message.
-    uint8_t seq = counter_seq(msg);
-    switch (state_) {
-        // System state messages.
-        case PGN_01F014:
-            handlePGN01F014(seq, msg, yield);
+    const FastPacket& packet = packets_.packet();
+    switch (packet.pgn) {
+        case 0x1F014:
+            handlePGN01F014(yield);
             break;
-        case PGN_01F016:
-            handlePGN01F016(seq, msg, yield);
+        case 0x1F016:
+            handlePGN01F016(yield);
             break;
+        case 0x1FF04:
+            handleState(packet.data->bytes, packet.data->size, yield);
+            break;
+    }
+}
+
+void Fusion::handleState(const uint8_t* data, size_t size, const Yield<Message>& yield) {
+    // 1DFF040A#C0:19:A3:99:11:80:07:00
+    //                      |
+    //                      +----------- state
+    if (size < 6 || !match(data, {0xA3, 0x99, 0xFF, 0x80})) {
+        return;
+    }
+
+    switch ((FusionState)data[2]) {
+        // System state messages.
         case POWER:
-            handlePower(seq, msg, yield);
+            handlePower(data, size, yield);
             break;
         case HEARTBEAT:
-            handleHeartbeat(seq, msg, yield);
+            handleHeartbeat(data, size, yield);
             break;
 
         // Volume and equalizer messages.
         case VOLUME:
-            handleVolume(seq, msg, yield);
+            handleVolume(data, size, yield);
             break;
         case MUTE:
-            handleMute(seq, msg, yield);
+            handleMute(data, size, yield);
             break;
         case BALANCE:
-            handleBalance(seq, msg, yield);
+            handleBalance(data, size, yield);
             break;
         case TONE:
-            handleTone(seq, msg, yield);
+            handleTone(data, size, yield);
             break;
 
         // Source messages.
         case SOURCE:
-            handleSource(seq, msg, yield);
+            handleSource(data, size, yield);
             break;
         case TRACK_PLAYBACK:
-            handleTrackPlayback(seq, msg, yield);
+            handleTrackPlayback(data, size, yield);
             break;
         case TRACK_TITLE:
-            handleTrackString(seq, msg, &track_title_, yield);
+            handleTrackString(data, size, &track_title_, yield);
             break;
         case TRACK_ARTIST:
-            handleTrackString(seq, msg, &track_artist_, yield);
+            handleTrackString(data, size, &track_artist_, yield);
             break;
         case TRACK_ALBUM:
-            handleTrackString(seq, msg, &track_album_, yield);
+            handleTrackString(data, size, &track_album_, yield);
             break;
         case TRACK_ELAPSED:
-            handleTrackTimeElapsed(seq, msg, yield);
+            handleTrackTimeElapsed(data, size, yield);
             break;
         case RADIO_FREQUENCY:
-            handleRadioFrequency(seq, msg, yield);
+            handleRadioFrequency(data, size, yield);
             break;
         case INPUT_GAIN:
-            handleInputGain(seq, msg, yield);
+            handleInputGain(data, size, yield);
             break;
 
         // Settings menu messages.
         case MENU_LOAD:
-            handleMenuLoad(seq, msg, yield);
+            handleMenuLoad(data, size, yield);
             break;
         case MENU_ITEM_COUNT:
-            handleMenuItemCount(seq, msg, yield);
+            handleMenuItemCount(data, size, yield);
             break;
         case MENU_ITEM_LIST:
-            handleMenuItemList(seq, msg, yield);
+            handleMenuItemList(data, size, yield);
             break;
     }
 }
 
-void Fusion::handlePGN01F014(uint8_t seq, const Canny::J1939Message& msg,
-        const Yield<Message>& yield) {
-    // 19F0140A#A0:86:35:08:8E:12:4D:53
-    if (seq == 0) {
-        // first message triggers boot init
-        bootInit(msg.source_address(), yield);
-    }
-    if (msg.data()[7] == 0xFF && boot_state_ == DISCOVERED) {
-        // last message triggers boot announce
+void Fusion::handlePGN01F014(const Yield<Message>& yield) {
+    // complete product info triggers boot announce
+    if (boot_state_ == DISCOVERED) {
         bootAnnounce(yield);
     }
 }
 
-void Fusion::handlePGN01F016(uint8_t, const Canny::J1939Message& msg,
-        const Yield<Message>& yield) {
-    if (msg.data()[7] == 0xFF && boot_state_ == ANNOUNCED) {
-        // last message triggers boot request
+void Fusion::handlePGN01F016(const Yield<Message>& yield) {
+    // complete configuration info triggers boot request
+    if (boot_state_ == ANNOUNCED) {
         bootRequest(yield);
     }
 }
 
-void Fusion::handlePower(uint8_t seq, const Canny::J1939Message& msg,
-        const Yield<Message>& yield) {
-    if (seq != 0) {
-        return;
-    }
-    updatePower(msg.data()[6] != 0x00, yield);
+void Fusion::handlePower(const uint8_t* data, size_t, const Yield<Message>& yield) {
+    updatePower(data[4] != 0x00, yield);
 }
 
-void Fusion::handleHeartbeat(uint8_t seq, const Canny::J1939Message& msg,
-        const Yield<Message>& yield) {
-    if (seq != 0) {
-        return;
-    }
-    updatePower(msg.data()[6] != 0x02, yield);
+void Fusion::handleHeartbeat(const uint8_t* data, size_t, const Yield<Message>& yield) {
+    updatePower(data[4] != 0x02, yield);
 }
 
-void Fusion::handleVolume(uint8_t seq, const J1939Message& msg,
-        const Yield<Message>& yield) {
-    // The second message contains the volume for zone 3. We don't use zone 3
-    // because we're mimicing a car stereo with front/rear. So we only parse
-    // the first message.
-    if (seq == 0) {
-        uint8_t zone1 = msg.data()[6];
-        uint8_t zone2 = msg.data()[7];
-        bool changed = false;
-        if (zone1 > zone2) {
-            changed |= volume_.volume(zone1);
-        } else {
-            changed |= volume_.volume(zone2);
-        }
-        if (zone1 != zone2 && volume_.fade() == 0) {
-            // calculate the fade value if we don't have one stored
-            changed |= volume_.fade((zone1 - zone2) / kFadeMultiplier);
-        }
-        if (changed) {
-            yield(MessageView(&volume_));
-        }
+void Fusion::handleVolume(const uint8_t* data, size_t, const Yield<Message>& yield) {
+    // The payload also contains the volume for zone 3. We don't use zone 3
+    // because we're mimicing a car stereo with front/rear.
+    uint8_t zone1 = data[4];
+    uint8_t zone2 = data[5];
+    bool changed = false;
+    if (zone1 > zone2) {
+        changed |= volume_.volume(zone1);
+    } else {
+        changed |= volume_.volume(zone2);
+    }
+    if (zone1 != zone2 && volume_.fade() == 0) {
+        // calculate the fade value if we don't have one stored
+        changed |= volume_.fade((zone1 - zone2) / kFadeMultiplier);
+    }
+    if (changed) {
+        yield(MessageView(&volume_));
     }
 }
 
-void Fusion::handleMute(uint8_t seq, const J1939Message& msg,
-        const Yield<Message>& yield) {
-    if (seq == 0 && volume_.mute(msg.data()[6] == 0x01) && system_.state() == AudioSystem::ON)  {
+void Fusion::handleMute(const uint8_t* data, size_t, const Yield<Message>& yield) {
+    if (volume_.mute(data[4] == 0x01) && system_.state() == AudioSystem::ON)  {
         yield(MessageView(&volume_));
     }
 }
 
-void Fusion::handleBalance(uint8_t seq, const J1939Message& msg,
-        const Yield<Message>& yield) {
+void Fusion::handleBalance(const uint8_t* data, size_t, const Yield<Message>& yield) {
     // We balance all zones together so we only need to read
     // balance from zone 1.
-    if (seq == 0 && msg.data()[6] == 0x00 &&
-            volume_.balance(msg.data()[7]) &&
+    if (data[4] == 0x00 && volume_.balance(data[5]) &&
             system_.state() == AudioSystem::ON) {
         yield(MessageView(&volume_));
     }
 }
 
-void Fusion::handleTone(uint8_t seq, const J1939Message& msg,
-        const Yield<Message>& yield) {
+void Fusion::handleTone(const uint8_t* data, size_t size, const Yield<Message>& yield) {
     // We set all zones to the same EQ so we only care about reading the first
     // zone.
-    bool changed = false;
-    switch (seq) {
-        case 0:
-            if (msg.data()[6] != 0x00) {
-                state_ignore_next_ = true;
-                return;
-            }
-            changed |= tone_.bass(msg.data()[7]);
-            break;
-        case 1:
-            changed |= tone_.mid(msg.data()[1]);
-            changed |= tone_.treble(msg.data()[2]);
-            break;
-        default:
-            break;
+    if (size < 8 || data[4] != 0x00) {
+        return;
     }
+    bool changed = false;
+    changed |= tone_.bass(data[5]);
+    changed |= tone_.mid(data[6]);
+    changed |= tone_.treble(data[7]);
     if (changed && system_.state() == AudioSystem::ON) {
         yield(MessageView(&tone_));
     }
 }
 
-void Fusion::handleSource(uint8_t seq, const J1939Message& msg,
-        const Yield<Message>& yield) {
-    switch (seq) {
-        case 0:
-            secondary_source_ = (AudioSource)msg.data()[6];
-            if (msg.data()[6] == msg.data()[7]) {
-                source_.source((AudioSource)msg.data()[7]);
-            }
-            break;
-        case 1:
-            if (source_.source() == secondary_source_) {
-                if (source_.source() == AudioSource::BLUETOOTH) {
-                    switch (msg.data()[2]) {
-                        case 0xA5:
-                            source_.bt_connected(true);
-                            break;
-                        case 0x85:
-                            source_.bt_connected(false);
-                            break;
-                        default:
-                            break;
-                    }
-                }
-                if (system_.state() == AudioSystem::POWER_ON) {
-                    system_.state(AudioSystem::ON);
-                    bootComplete(yield);
-                } else if (system_.state() == AudioSystem::ON) {
-                    yield(MessageView(&source_));
-                }
-            }
-            break;
-        default:
-            break;
+void Fusion::handleSource(const uint8_t* data, size_t size, const Yield<Message>& yield) {
+    if (size < 8) {
+        return;
+    }
+    if (data[4] == data[5]) {
+        source_.source((AudioSource)data[5]);
+    }
+    if (source_.source() != (AudioSource)data[4]) {
+        return;
+    }
+    if (source_.source() == AudioSource::BLUETOOTH) {
+        switch (data[7]) {
+            case 0xA5:
+                source_.bt_connected(true);
+                break;
+            case 0x85:
+                source_.bt_connected(false);
+                break;
+            default:
+                break;
+        }
+    }
+    if (system_.state() == AudioSystem::POWER_ON) {
+        system_.state(AudioSystem::ON);
+        bootComplete(yield);
+    } else if (system_.state() == AudioSystem::ON) {
+        yield(MessageView(&source_));
     }
 }
 
-void Fusion::handleTrackPlayback(uint8_t seq, const J1939Message& msg,
+void Fusion::handleTrackPlayback(const uint8_t* data, size_t size,
         const Yield<Message>& yield) {
-    uint32_t time;
-    switch (seq) {
-        case 0:
-            if (msg.data()[7] > 0x02) {
-                msg.data()[7] = 0x00;
-            }
-            track_playback_.playback((AudioPlayback)msg.data()[7]);
-            break;
-        case 2:
-            memcpy(buffer_, msg.data() + 3, 3);
-            buffer_[3] = 0x00;
-            time = btohl(buffer_, ByteOrder::LITTLE);
-            track_playback_.time_total(time / 1000);
-            if (system_.state() == AudioSystem::ON) {
-                yield(MessageView(&track_playback_));
-            }
-            break;
-        default:
-            break;
+    if (size < 18) {
+        return;
+    }
+    uint8_t playback = data[5];
+    if (playback > 0x02) {
+        playback = 0x00;
+    }
+    track_playback_.playback((AudioPlayback)playback);
+    memcpy(buffer_, data + 15, 3);
+    buffer_[3] = 0x00;
+    uint32_t time = btohl(buffer_, ByteOrder::LITTLE);
+    track_playback_.time_total(time / 1000);
+    if (system_.state() == AudioSystem::ON) {
+        yield(MessageView(&track_playback_));
     }
 }
 
-void Fusion::handleTrackString(uint8_t seq, const J1939Message& msg,
-        Event* event, const Yield<Message>& yield) {
-    if (handleString(event->scratch, seq, msg, 4)) {
+void Fusion::handleTrackString(const uint8_t* data, size_t size, Event* event,
+        const Yield<Message>& yield) {
+    if (handleString(event->scratch, data, size, 10)) {
         yield(MessageView(event));
     }
 }
 
-void Fusion::handleTrackTimeElapsed(uint8_t seq, const J1939Message& msg,
+void Fusion::handleTrackTimeElapsed(const uint8_t* data, size_t size,
         const Yield<Message>& yield) {
-    if (seq == 1) {
-        memcpy(buffer_, msg.data() + 1, 3);
-        buffer_[3] = 0x00;
-        uint32_t time = btohl(buffer_, ByteOrder::LITTLE);
-        track_playback_.time_elapsed(time / 4);
-        if (system_.state() == AudioSystem::ON) {
-            yield(MessageView(&track_playback_));
-        }
+    if (size < 9) {
+        return;
+    }
+    memcpy(buffer_, data + 6, 3);
+    buffer_[3] = 0x00;
+    uint32_t time = btohl(buffer_, ByteOrder::LITTLE);
+    track_playback_.time_elapsed(time / 4);
+    if (system_.state() == AudioSystem::ON) {
+        yield(MessageView(&track_playback_));
     }
 }
 
-void Fusion::handleRadioFrequency(uint8_t seq, const J1939Message& msg,
+void Fusion::handleRadioFrequency(const uint8_t* data, size_t size,
         const Yield<Message>& yield) {
-    if (seq == 1) {
-        uint32_t frequency = btohl(msg.data() + 1, ByteOrder::LITTLE);
-        radio_.frequency(frequency);
-        if (system_.state() == AudioSystem::ON) {
-            yield(MessageView(&radio_));
-        }
+    if (size < 10) {
+        return;
+    }
+    uint32_t frequency = btohl(data + 6, ByteOrder::LITTLE);
+    radio_.frequency(frequency);
+    if (system_.state() == AudioSystem::ON) {
+        yield(MessageView(&radio_));
     }
 }
 
-void Fusion::handleInputGain(uint8_t seq, const J1939Message& msg,
-        const Yield<Message>& yield) {
-    if (seq == 0) {
-        input_.gain((int8_t)msg.data()[7]);
-        if (system_.state() == AudioSystem::ON) {
-            yield(MessageView(&input_));
-        }
+void Fusion::handleInputGain(const uint8_t* data, size_t, const Yield<Message>& yield) {
+    input_.gain((int8_t)data[5]);
+    if (system_.state() == AudioSystem::ON) {
+        yield(MessageView(&input_));
     }
 }
 
-void Fusion::handleMenuLoad(uint8_t seq, const Canny::J1939Message& msg,
-        const Yield<Message>& yield) {
-    switch (seq) {
-        case 0:
-            settings_menu_.item(msg.data()[7]);
-            break;
-        case 1:
-            settings_menu_.page(msg.data()[4]);
-            switch (msg.data()[4]) {
-                case 0x01:
-                case 0x02:
-                    // load menu page
-                    sendMenuReqItemCount(yield);
-                    break;
-                case 0x03:
-                    // refresh menu item
-                    break;
-                case 0x04:
-                    {
-                        Event event(SubSystem::AUDIO, (uint8_t)AudioEvent::SETTINGS_EXIT_STATE);
-                        yield(MessageView(&event));
-                    }
-                    break;
-                default:
-                    break;
+void Fusion::handleMenuLoad(const uint8_t* data, size_t size, const Yield<Message>& yield) {
+    if (size < 10) {
+        return;
+    }
+    settings_menu_.item(data[5]);
+    settings_menu_.page(data[9]);
+    switch (data[9]) {
+        case 0x01:
+        case 0x02:
+            // load menu page
+            sendMenuReqItemCount(yield);
+            break;
+        case 0x03:
+            // refresh menu item
+            break;
+        case 0x04:
+            {
+                Event event(SubSystem::AUDIO, (uint8_t)AudioEvent::SETTINGS_EXIT_STATE);
+                yield(MessageView(&event));
             }
             break;
         default:
@@ -774,54 +728,48 @@ void Fusion::handleMenuLoad(uint8_t seq, const Canny::J1939Message& msg,
     }
 }
 
-void Fusion::handleMenuItemCount(uint8_t seq, const Canny::J1939Message& msg,
-        const Yield<Message>& yield) {
+void Fusion::handleMenuItemCount(const uint8_t* data, size_t, const Yield<Message>& yield) {
     // 1DFF040A#20:0A:A3:99:10:80:07:03
     //                                |
     //                                +- count
     // 1DFF040A#21:00:00:00:03:FF:FF:FF
-    if (seq == 0) {
-        uint8_t count = msg.data()[7];
-        if (count > 5) {
-            count = 5;
-        }
-        settings_menu_.count(count);
-        yield(MessageView(&settings_menu_));
-        sendMenuReqItemList(yield, count);
+    uint8_t count = data[5];
+    if (count > 5) {
+        count = 5;
     }
+    settings_menu_.count(count);
+    yield(MessageView(&settings_menu_));
+    sendMenuReqItemList(yield, count);
 }
 
-void Fusion::handleMenuItemList(uint8_t seq, const Canny::J1939Message& msg,
+void Fusion::handleMenuItemList(const uint8_t* data, size_t size,
         const Yield<Message>& yield) {
     // 1DFF040A#60:19:A3:99:11:80:07:00
     // 1DFF040A#61:00:00:00:89:03:0C:44
     // 1DFF040A#62:69:73:63:6F:76:65:72
     // 1DFF040A#63:61:62:6C:65:00:FF:FF
-    switch (seq) {
-        case 0:
-            settings_item_.reload(settings_menu_.page() == 0x03);
-            settings_item_.item(msg.data()[7]);
-            break;
-        case 1:
-            switch (msg.data()[4]) {
-                case 0x49:
-                    settings_item_.type(AudioSettingsType::SUBMENU);
-                    break;
-                case 0x011:
-                    settings_item_.type(AudioSettingsType::SELECT);
-                    break;
-                case 0x81:
-                case 0x89:
-                    settings_item_.type(AudioSettingsType::CHECKBOX_OFF);
-                    break;
-                case 0x83:
-                case 0x8B:
-                    settings_item_.type(AudioSettingsType::CHECKBOX_ON);
-                    break;
-            }
+    if (size < 10) {
+        return;
+    }
+    settings_item_.reload(settings_menu_.page() == 0x03);
+    settings_item_.item(data[5]);
+    switch (data[9]) {
+        case 0x49:
+            settings_item_.type(AudioSettingsType::SUBMENU);
+            break;
+        case 0x011:
+            settings_item_.type(AudioSettingsType::SELECT);
+            break;
+        case 0x81:
+        case 0x89:
+            settings_item_.type(AudioSettingsType::CHECKBOX_OFF);
+            break;
+        case 0x83:
+        case 0x8B:
+            settings_item_.type(AudioSettingsType::CHECKBOX_ON);
             break;
     }
-    if (handleString(&settings_item_scratch_, seq, msg, 6)) {
+    if (handleString(&settings_item_scratch_, data, size, 12)) {
         yield(MessageView(&settings_item_));
     }
 }
@@ -925,31 +873,25 @@ void Fusion::handlePlaybackPrevCmd(const Caster::Yield<Message>& yield) {
     }
 }
 
-bool Fusion::handleString(Scratch* scratch, uint8_t seq, const J1939Message& msg, uint8_t offset) {
-    if (seq == 0) {
-        scratch->clear();
+bool Fusion::handleString(Scratch* scratch, const uint8_t* data, size_t size, size_t offset) {
+    scratch->clear();
+    if (offset > size) {
         return false;
     }
 
-    uint8_t i = 0;
-    if (seq == 1) {
-        // skip prefix in first frame
-        i = offset;
+    // The string ends at a null byte or the end of the payload.
+    size_t len = 0;
+    while (offset + len < size && data[offset + len] != 0) {
+        ++len;
     }
-    for (; i < 7; i++) {
-        if (scratch->size >= 256) {
-            // buffer overflow
-            return false;
-        }
-
-        scratch->bytes[scratch->size] = msg.data()[i + 1];
-        if (scratch->bytes[scratch->size] == 0) {
-            // end of string
-            return true;
-        }
-        ++(scratch->size);
+    if (!scratch->reserve(len + 1)) {
+        // buffer overflow
+        return false;
     }
-    return false;
+    memcpy(scratch->bytes, data + offset, len);
+    scratch->bytes[len] = 0;
+    scratch->size = len;
+    return true;
 }
 
 void Fusion::emit(const Yield<Message>& yield) {
@@ -958,13 +900,22 @@ void Fusion::emit(const Yield<Message>& yield) {
         return;
     }
     if (hu_address_ == Canny::NullAddress) {
-        // periodically try to discover a stereo if we don't have one
+        // Retry discovery with backoff in case the request was lost or the
+        // stereo was not ready. A stereo which reboots with the same
+        // address does not trigger a J1939_ADDRESS message.
         if (disco_timer_.active()) {
-            sendStereoDiscovery(yield);
+            uint32_t interval = disco_timer_.interval() * 2;
+            disco_timer_.reset(interval < kDiscoveryMaxTick ? interval : kDiscoveryMaxTick);
+            sendPGN01F014Request(yield);
         }
         return;
     }
 
+    if (tx_hold_.held()) {
+        // hold the boot sequence until the network drains
+        return;
+    }
+
     if (boot_timer_.active()) {
         if (boot_state_ == DISCOVERED) {
             bootAnnounce(yield);
@@ -989,14 +940,9 @@ void Fusion::send0CRequest(const Yield<Message>& yield) {
     sendCmdPayload(yield, {0x00, 0x00});
 }
 
-void Fusion::sendStereoDiscovery(const Caster::Yield<Message>& yield) {
-    disco_timer_.reset();
-    sendPGN01F014Request(yield);
-}
-
-void Fusion::sendPGN01F014Request(const Yield<Message>& yield) {
+void Fusion::sendPGN01F014Request(const Yield<Message>& yield, uint8_t dest) {
     // 18EAFF21#14:F0:01
-    J1939Message msg(0xEAFF, address_, 0xFF, 0x06);
+    J1939Message msg(0xEA00, address_, dest, 0x06);
     msg.data({0x14, 0xF0, 0x01});
     yield(MessageView(&msg));
 }
@@ -1183,7 +1129,7 @@ void Fusion::updatePower(bool power, const Yield<Message>& yield) {
     if (system_.state() == AudioSystem::UNAVAILABLE) {
         // Rely on discovery to transition from unavailable as doing so
         // here would put us into an invalid state.
-        sendStereoDiscovery(yield);
+        sendPGN01F014Request(yield, hu_address_);
     } else if (system_.state() != state) {
         bootPower(power, yield);
     }
@@ -13,18 +13,30 @@
 namespace R51 {
 
 // Node for interacting with Garming Fusion head units over J1939/NMEA2000.
-class Fusion : public Caster::Node<Message> {
+class Fusion : public Caster::Node<Message>, public Subscriber {
     public:
         // Construct a fusion node.
         Fusion(Faker::Clock* clock = Faker::Clock::real());
 
+        // Subscribe to audio requests and commands, J1939 transmit state,
+        // address claims, node addresses, and Fusion stereo PGNs.
+        void subscribe(Subscription* sub) override;
+
         // Handle J1939 state messages from the head unit and control Events
         // from other devices.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
-        // Emit state events from the head units.
+        // Emit state events from the head units. Stereo discovery is retried
+        // with backoff until a stereo answers. The boot sequence is held
+        // while the J1939 network is congested.
         void emit(const Caster::Yield<Message>& yield) override;
 
+        // Track the discovery and boot timers on a wheel.
+        void schedule(TimerWheel* wheel) {
+            wheel->add(&disco_timer_);
+            wheel->add(&boot_timer_);
+        }
+
     private:
         // Handle commands from the internal bus.
         void handleCommand(const Event& event, const Caster::Yield<Message>& yield);
@@ -32,49 +44,53 @@ class Fusion : public Caster::Node<Message> {
         // Handle J1939 messages.
         void handleJ1939Claim(const J1939Claim& claim,
                 const Caster::Yield<Message>& yield);
+        void handleJ1939Address(const J1939Address& node,
+                const Caster::Yield<Message>& yield);
         void handleJ1939Message(const Canny::J1939Message& msg,
                 const Caster::Yield<Message>& yield);
 
-        // Handle Fusion J1939 state messages. 
-        void handlePGN01F014(uint8_t seq, const Canny::J1939Message& msg,
+        // Handle complete Fusion J1939 payloads.
+        void handlePGN01F014(const Caster::Yield<Message>& yield);
+        void handlePGN01F016(const Caster::Yield<Message>& yield);
+        void handleState(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handlePGN01F016(uint8_t seq, const Canny::J1939Message& msg,
-                const Caster::Yield<Message>& yield);
-        void handlePower(uint8_t seq, const Canny::J1939Message& msg,
+
+        // Handle Fusion state payloads. The data begins with the A3:99 state
+        // header.
+        void handlePower(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handleHeartbeat(uint8_t seq, const Canny::J1939Message& msg,
+        void handleHeartbeat(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
 
-        void handleVolume(uint8_t seq, const Canny::J1939Message& msg,
+        void handleVolume(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handleMute(uint8_t seq, const Canny::J1939Message& msg,
+        void handleMute(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handleBalance(uint8_t seq, const Canny::J1939Message& msg,
+        void handleBalance(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handleTone(uint8_t seq, const Canny::J1939Message& msg,
+        void handleTone(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
 
-        void handleSource(uint8_t seq, const Canny::J1939Message& msg,
+        void handleSource(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handleTrackPlayback(uint8_t seq, const Canny::J1939Message& msg,
+        void handleTrackPlayback(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handleTrackString(uint8_t seq,
-                const Canny::J1939Message& msg, Event* event,
+        void handleTrackString(const uint8_t* data, size_t size, Event* event,
                 const Caster::Yield<Message>& yield);
-        void handleTrackTimeElapsed(uint8_t seq, const Canny::J1939Message& msg,
+        void handleTrackTimeElapsed(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
 
-        void handleRadioFrequency(uint8_t seq, const Canny::J1939Message& msg,
+        void handleRadioFrequency(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
 
-        void handleInputGain(uint8_t seq, const Canny::J1939Message& msg,
+        void handleInputGain(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
 
-        void handleMenuLoad(uint8_t seq, const Canny::J1939Message& msg,
+        void handleMenuLoad(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handleMenuItemCount(uint8_t seq, const Canny::J1939Message& msg,
+        void handleMenuItemCount(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
-        void handleMenuItemList(uint8_t seq, const Canny::J1939Message& msg,
+        void handleMenuItemList(const uint8_t* data, size_t size,
                 const Caster::Yield<Message>& yield);
 
         void handleSourceNextCmd(const Caster::Yield<Message>& yield);
@@ -84,14 +100,16 @@ class Fusion : public Caster::Node<Message> {
         void handlePlaybackNextCmd(const Caster::Yield<Message>& yield);
         void handlePlaybackPrevCmd(const Caster::Yield<Message>& yield);
 
-        bool handleString(Scratch* scratch, uint8_t seq,
-                const Canny::J1939Message& msg, uint8_t offset);
+        // Copy the null terminated string at offset in a payload into a
+        // scratch.
+        bool handleString(Scratch* scratch, const uint8_t* data, size_t size,
+                size_t offset);
 
         void sendStereoRequest(const Caster::Yield<Message>& yield);
-        void sendStereoDiscovery(const Caster::Yield<Message>& yield);
         void send0CRequest(const Caster::Yield<Message>& yield);
 
-        void sendPGN01F014Request(const Caster::Yield<Message>& yield);
+        void sendPGN01F014Request(const Caster::Yield<Message>& yield,
+                uint8_t dest = 0xFF);
         void sendPGN01F016Request(const Caster::Yield<Message>& yield);
 
         void sendCmd(const Caster::Yield<Message>& yield,
@@ -131,8 +149,9 @@ class Fusion : public Caster::Node<Message> {
         uint8_t address_;
         uint8_t hu_address_;
         uint8_t boot_state_;
-        Ticker disco_timer_;
-        Ticker boot_timer_;
+        TxHold tx_hold_;
+        Timer disco_timer_;
+        Timer boot_timer_;
 
         Scratch track_title_scratch_;
         Scratch track_artist_scratch_;
@@ -153,15 +172,10 @@ class Fusion : public Caster::Node<Message> {
         AudioSettingsItemState settings_item_;
         AudioSettingsExitState settings_exit_;
 
-        uint8_t state_;
-        bool state_ignore_next_;
-        uint32_t state_pgn_;
-        uint8_t state_counter_;
+        FastPacketAssembler packets_;
         uint8_t cmd_counter_;
         Canny::J1939Message cmd_;
 
-        AudioSource secondary_source_;
-
         uint8_t buffer_[4];
 };
 
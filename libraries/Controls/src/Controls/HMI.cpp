@@ -83,6 +83,18 @@ void HMI::init(const Caster::Yield<Message>& yield) {
     page(ScreenPage::SPLASH);
 }
 
+void HMI::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+    sub->event((uint8_t)SubSystem::SCREEN);
+    sub->event((uint8_t)SubSystem::ECM);
+    sub->event((uint8_t)SubSystem::IPDM);
+    sub->event((uint8_t)SubSystem::BCM);
+    sub->event((uint8_t)SubSystem::POWER);
+    sub->event((uint8_t)SubSystem::CLIMATE);
+    sub->event((uint8_t)SubSystem::SETTINGS);
+    sub->event((uint8_t)SubSystem::AUDIO);
+}
+
 void HMI::handle(const Message& msg, const Yield<Message>& yield) {
     if (msg.type() != Message::EVENT) {
         return;
@@ -1403,7 +1415,7 @@ bool HMI::read(bool block) {
             continue;
         }
 
-        if ((size_t)n >= kScratchCapacity) {
+        if (n >= 0 && !scratch_.reserve(n + 1)) {
             n = -1;
         } else if (n >= 0) {
             scratch_.bytes[n++] = (uint8_t)b;
@@ -22,6 +22,9 @@ class HMI : public Controls {
         // Initialize display state. 
         void init(const Caster::Yield<Message>&) override;
 
+        // Subscribe to the events displayed on or controlled by the screen.
+        void subscribe(Subscription* sub) override;
+
         // Updates the HMI display with received broadcast events.
         void handle(const Message& msg, const Caster::Yield<Message>&) override;
 
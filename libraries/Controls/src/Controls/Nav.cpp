@@ -25,6 +25,13 @@ NavControls::NavControls(uint8_t encoder_keypad_id, Faker::Clock* clock) :
     power_btn_(kPowerLongPressTimeout, clock),
     page_(NavPage::NONE) {}
 
+void NavControls::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::SCREEN, (uint8_t)ScreenEvent::POWER_STATE);
+    sub->event((uint8_t)SubSystem::SCREEN, (uint8_t)ScreenEvent::PAGE_STATE);
+    sub->event((uint8_t)SubSystem::KEYPAD);
+    sub->event((uint8_t)SubSystem::BCM, (uint8_t)BCMEvent::ILLUM_STATE);
+}
+
 void NavControls::handle(const Message& msg, const Yield<Message>& yield) {
     if (msg.type() != Message::EVENT) {
         return;
@@ -23,6 +23,9 @@ class NavControls : public Controls {
         NavControls(uint8_t encoder_keypad_id,
                 Faker::Clock* clock = Faker::Clock::real());
 
+        // Subscribe to screen state, keypad, and illumination events.
+        void subscribe(Subscription* sub) override;
+
         // Handle rotary encoder keypad and illum events.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
@@ -27,6 +27,14 @@ PowerControls::PowerControls(uint8_t keypad_id, uint8_t pdm_id, Faker::Clock* cl
     nav_button_(kNavLongPressTimeout, clock),
     indicator_cmd_(keypad_id_)  {}
 
+void PowerControls::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::KEYPAD, (uint8_t)KeypadEvent::KEY_STATE);
+    sub->event((uint8_t)SubSystem::IPDM, (uint8_t)IPDMEvent::POWER_STATE);
+    sub->event((uint8_t)SubSystem::POWER, (uint8_t)PowerEvent::POWER_STATE);
+    sub->event((uint8_t)SubSystem::SCREEN, (uint8_t)ScreenEvent::POWER_STATE);
+    sub->event((uint8_t)SubSystem::BCM, (uint8_t)BCMEvent::ILLUM_STATE);
+}
+
 void PowerControls::handle(const Message& msg, const Yield<Message>& yield) {
     if (msg.type() != Message::EVENT) {
         return;
@@ -44,6 +44,9 @@ class PowerControls : public Controls {
         PowerControls(uint8_t keypad_id, uint8_t pdm_id,
                 Faker::Clock* clock = Faker::Clock::real());
 
+        // Subscribe to keypad, power state, and illumination events.
+        void subscribe(Subscription* sub) override;
+
         // Handle keypad, PDM, and illum events.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
@@ -23,6 +23,10 @@ SteeringControls::SteeringControls(uint8_t steering_keypad_id, Faker::Clock* clo
     volume_up_(kKeyRepeatInterval, clock),
     volume_down_(kKeyRepeatInterval, clock) {}
 
+void SteeringControls::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::KEYPAD);
+}
+
 void SteeringControls::handle(const Message& msg, const Yield<Message>& yield) {
     if (msg.type() != Message::EVENT ||
             msg.event()->subsystem != (uint8_t)SubSystem::KEYPAD) {
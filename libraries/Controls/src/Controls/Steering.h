@@ -15,6 +15,9 @@ class SteeringControls : public Controls {
         SteeringControls(uint8_t steering_keypad_id,
                 Faker::Clock* clock = Faker::Clock::real());
 
+        // Subscribe to keypad events.
+        void subscribe(Subscription* sub) override;
+
         // Handle steering keypad events.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
@@ -82,6 +82,101 @@ testF(FusionTest, StateDetectionDoesntCrash) {
     assertSize(yield, 0);
 }
 
+testF(FusionTest, DiscoverOnAddress) {
+    Fusion f(&clock);
+    J1939Claim claim(addr, 0);
+    f.handle(MessageView(&claim), yield);
+    yield.clear();
+
+    // A node joining the network is asked for its product info.
+    J1939Address node(hu_addr, 0x00A0340000E00001);
+    f.handle(MessageView(&node), yield);
+    J1939Message request(0xEA00, addr, hu_addr, 0x06);
+    request.data({0x14, 0xF0, 0x01});
+    assertSize(yield, 1);
+    assertIsJ1939Message(yield.messages()[0], request);
+    yield.clear();
+
+    // Nodes are ignored once the stereo is found.
+    J1939Message msg(0x1F014, hu_addr, 0xFF, 0x06);
+    msg.data({0xA0, 0x86, 0x35, 0x08, 0x8E, 0x12, 0x4D, 0x53});
+    f.handle(MessageView(&msg), yield);
+    yield.clear();
+    J1939Address other(0x30, 0x0000000000300002);
+    f.handle(MessageView(&other), yield);
+    assertSize(yield, 0);
+}
+
+testF(FusionTest, DiscoverRetry) {
+    Fusion f(&clock);
+    J1939Claim claim(addr, 0);
+    f.handle(MessageView(&claim), yield);
+    J1939Message request(0xEA00, addr, 0xFF, 0x06);
+    request.data({0x14, 0xF0, 0x01});
+    assertSize(yield, 1);
+    assertIsJ1939Message(yield.messages()[0], request);
+    yield.clear();
+
+    // The broadcast request is repeated with backoff until a stereo answers.
+    clock.delay(4999);
+    f.emit(yield);
+    assertSize(yield, 0);
+    clock.delay(1);
+    f.emit(yield);
+    assertSize(yield, 1);
+    assertIsJ1939Message(yield.messages()[0], request);
+    yield.clear();
+
+    clock.delay(9999);
+    f.emit(yield);
+    assertSize(yield, 0);
+    clock.delay(1);
+    f.emit(yield);
+    assertSize(yield, 1);
+    yield.clear();
+
+    J1939Message msg(0x1F014, hu_addr, 0xFF, 0x06);
+    msg.data({0xA0, 0x86, 0x35, 0x08, 0x8E, 0x12, 0x4D, 0x53});
+    f.handle(MessageView(&msg), yield);
+    yield.clear();
+
+    // Discovery stops once the stereo is found.
+    clock.delay(60000);
+    f.emit(yield);
+    for (size_t i = 0; i < yield.size(); ++i) {
+        assertFalse(yield.messages()[i].type() == Message::J1939_MESSAGE &&
+                yield.messages()[i].j1939_message()->pgn() == 0xEA00 &&
+                yield.messages()[i].j1939_message()->data()[0] == 0x14);
+    }
+}
+
+testF(FusionTest, TrackTitleOutOfOrder) {
+    Fusion f(&clock);
+    start(&f);
+
+    // 1DFF040A#40:10:A3:99:05:80:00:00
+    // 1DFF040A#42:6C:6F:00:FF:FF:FF:FF
+    // 1DFF040A#41:00:00:00:00:48:65:6C
+    J1939Message msg0, msg1, msg2;
+    msg0.id(0x1DFF040A);
+    msg0.data({0x40, 0x10, 0xA3, 0x99, 0x05, 0x80, 0x00, 0x00});
+    msg1.id(0x1DFF040A);
+    msg1.data({0x41, 0x00, 0x00, 0x00, 0x00, 0x48, 0x65, 0x6C});
+    msg2.id(0x1DFF040A);
+    msg2.data({0x42, 0x6C, 0x6F, 0x00, 0xFF, 0xFF, 0xFF, 0xFF});
+
+    f.handle(MessageView(&msg0), yield);
+    f.handle(MessageView(&msg2), yield);
+    assertSize(yield, 0);
+    f.handle(MessageView(&msg1), yield);
+    assertSize(yield, 1);
+
+    const Event* event = yield.messages()[0].event();
+    assertEqual(event->id, (uint8_t)AudioEvent::TRACK_TITLE_STATE);
+    assertEqual(event->scratch->size, 5u);
+    assertEqual(strcmp((const char*)event->scratch->bytes, "Hello"), 0);
+}
+
 }  // namespace R51
 
 // Test boilerplate.
@@ -0,0 +1,210 @@
+#include <Arduino.h>
+#include <Bench.h>
+#include <Canny.h>
+#include <Caster.h>
+#include <Core.h>
+
+// Compares the per-message dispatch cost of Caster::Bus, IndexedBus, and
+// StaticBus with a node set shaped like the controller's processing bus: ten
+// event nodes which each care about one subsystem, one CAN node, and one
+// J1939 node.
+
+namespace R51 {
+
+using ::Canny::CAN20Frame;
+using ::Canny::J1939Message;
+
+static const size_t kTrafficSize = 256;
+static const size_t kRounds = 2000;
+
+// Handles events for a single subsystem. Filters in handle() like the real
+// nodes do so that it behaves correctly on an unfiltered bus.
+class EventNode : public Caster::Node<Message>, public Subscriber {
+    public:
+        EventNode(uint8_t subsystem) : subsystem_(subsystem), count_(0) {}
+
+        void subscribe(Subscription* sub) override {
+            sub->event(subsystem_);
+        }
+
+        void handle(const Message& msg, const Caster::Yield<Message>&) override {
+            if (msg.type() != Message::EVENT || msg.event()->subsystem != subsystem_) {
+                return;
+            }
+            count_ += msg.event()->id;
+        }
+
+        uint32_t count() const { return count_; }
+
+    private:
+        uint8_t subsystem_;
+        uint32_t count_;
+};
+
+// Handles vehicle climate frames.
+class FrameNode : public Caster::Node<Message>, public Subscriber {
+    public:
+        FrameNode() : count_(0) {}
+
+        void subscribe(Subscription* sub) override {
+            sub->canFrame(0x54A, 0x54B);
+        }
+
+        void handle(const Message& msg, const Caster::Yield<Message>&) override {
+            if (msg.type() != Message::CAN_FRAME ||
+                    (msg.can_frame()->id() != 0x54A && msg.can_frame()->id() != 0x54B)) {
+                return;
+            }
+            count_ += msg.can_frame()->data()[0];
+        }
+
+        uint32_t count() const { return count_; }
+
+    private:
+        uint32_t count_;
+};
+
+// Handles Fusion state messages.
+class J1939Node : public Caster::Node<Message>, public Subscriber {
+    public:
+        J1939Node() : count_(0) {}
+
+        void subscribe(Subscription* sub) override {
+            sub->j1939Message(0x1FF04);
+        }
+
+        void handle(const Message& msg, const Caster::Yield<Message>&) override {
+            if (msg.type() != Message::J1939_MESSAGE || msg.j1939_message()->pgn() != 0x1FF04) {
+                return;
+            }
+            count_ += msg.j1939_message()->data()[0];
+        }
+
+        uint32_t count() const { return count_; }
+
+    private:
+        uint32_t count_;
+};
+
+EventNode ecm((uint8_t)SubSystem::ECM);
+EventNode ipdm((uint8_t)SubSystem::IPDM);
+EventNode bcm((uint8_t)SubSystem::BCM);
+EventNode climate((uint8_t)SubSystem::CLIMATE);
+EventNode settings((uint8_t)SubSystem::SETTINGS);
+EventNode bluetooth((uint8_t)SubSystem::BLUETOOTH);
+EventNode audio((uint8_t)SubSystem::AUDIO);
+EventNode screen((uint8_t)SubSystem::SCREEN);
+EventNode power((uint8_t)SubSystem::POWER);
+EventNode keypad((uint8_t)SubSystem::KEYPAD);
+FrameNode frames;
+J1939Node j1939;
+
+uint32_t checksum() {
+    return ecm.count() + ipdm.count() + bcm.count() + climate.count() +
+        settings.count() + bluetooth.count() + audio.count() + screen.count() +
+        power.count() + keypad.count() + frames.count() + j1939.count();
+}
+
+// Synthetic traffic: mostly J1939 and CAN frames with a sprinkling of events,
+// similar to what the controller sees while the stereo is streaming state.
+MessageValue* traffic;
+
+void buildTraffic() {
+    static const uint8_t subsystems[] = {
+        (uint8_t)SubSystem::ECM, (uint8_t)SubSystem::IPDM,
+        (uint8_t)SubSystem::BCM, (uint8_t)SubSystem::CLIMATE,
+        (uint8_t)SubSystem::SETTINGS, (uint8_t)SubSystem::AUDIO,
+        (uint8_t)SubSystem::SCREEN, (uint8_t)SubSystem::KEYPAD,
+    };
+    static const uint32_t frame_ids[] = {0x54A, 0x54B, 0x625, 0x385, 0x72E, 0x551};
+    static const uint32_t pgns[] = {0x1FF04, 0x1F014, 0x1F016, 0xEF00, 0xFF00};
+
+    traffic = new MessageValue[kTrafficSize];
+    for (size_t i = 0; i < kTrafficSize; ++i) {
+        switch (i % 4) {
+            case 0: {
+                Event event(subsystems[(i / 4) % sizeof(subsystems)], 0x01 + i % 3);
+                traffic[i] = MessageView(&event);
+                break;
+            }
+            case 1: {
+                CAN20Frame frame(frame_ids[(i / 4) % 6], 0, 8);
+                frame.data()[0] = i;
+                traffic[i] = MessageView(&frame);
+                break;
+            }
+            default: {
+                J1939Message msg(pgns[(i / 2) % 5], 0x0A, 0x00);
+                msg.data()[0] = i;
+                traffic[i] = MessageView(&msg);
+                break;
+            }
+        }
+    }
+}
+
+template <typename Bus>
+void run(const char* name, Bus* bus) {
+    uint32_t start_checksum = checksum();
+    uint64_t start = benchNanos();
+    for (size_t r = 0; r < kRounds; ++r) {
+        for (size_t i = 0; i < kTrafficSize; ++i) {
+            bus->emit(traffic[i]);
+        }
+    }
+    uint64_t elapsed = benchNanos() - start;
+    reportThroughput(&Serial, "bus", name, kRounds * kTrafficSize, elapsed);
+
+    // Print the checksum to keep the handlers from being optimized away and
+    // to verify that every bus delivered the same messages.
+    Serial.print("bench=bus metric=checksum pass=");
+    Serial.print(name);
+    Serial.print(" checksum=");
+    Serial.println(checksum() - start_checksum);
+}
+
+void benchCasterBus() {
+    Caster::Node<Message>* nodes[] = {
+        &ecm, &ipdm, &bcm, &climate, &settings, &bluetooth,
+        &audio, &screen, &power, &keypad, &frames, &j1939,
+    };
+    Caster::Bus<Message> bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+    run("caster", &bus);
+}
+
+void benchIndexedBus() {
+    BusNode nodes[] = {
+        &ecm, &ipdm, &bcm, &climate, &settings, &bluetooth,
+        &audio, &screen, &power, &keypad, &frames, &j1939,
+    };
+    IndexedBus bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+    run("indexed", &bus);
+}
+
+void benchStaticBus() {
+    StaticBus<EventNode, EventNode, EventNode, EventNode, EventNode, EventNode,
+        EventNode, EventNode, EventNode, EventNode, FrameNode, J1939Node> bus(
+            &ecm, &ipdm, &bcm, &climate, &settings, &bluetooth,
+            &audio, &screen, &power, &keypad, &frames, &j1939);
+    bus.init();
+    run("static", &bus);
+}
+
+}  // namespace R51
+
+void setup() {
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+
+    R51::buildTraffic();
+    R51::benchCasterBus();
+    R51::benchIndexedBus();
+    R51::benchStaticBus();
+#if defined(EPOXY_DUINO)
+    exit(0);
+#endif
+}
+
+void loop() {}
@@ -1,15 +1,36 @@
 #ifndef _R51_CORE_H_
 #define _R51_CORE_H_
 
+#include "Core/Bus.h"
+#include "Core/BusStats.h"
 #include "Core/CAN.h"
+#include "Core/CANPacer.h"
+#include "Core/CANTxQueue.h"
 #include "Core/Event.h"
+#include "Core/EventSchema.h"
+#include "Core/FastPacket.h"
+#include "Core/HardwareFilter.h"
+#include "Core/IDFilter.h"
+#include "Core/IsoTP.h"
 #include "Core/J1939Adapter.h"
+#include "Core/J1939AddressMap.h"
 #include "Core/J1939Claim.h"
 #include "Core/J1939Gateway.h"
+#include "Core/J1939Transfer.h"
+#include "Core/J1939Transport.h"
+#include "Core/J1939TxQueue.h"
 #include "Core/Keypad.h"
 #include "Core/Message.h"
+#include "Core/MessageRecord.h"
 #include "Core/Power.h"
+#include "Core/QueueStats.h"
+#include "Core/ReadBurst.h"
 #include "Core/RealDash.h"
 #include "Core/Scratch.h"
+#include "Core/StaticBus.h"
+#include "Core/Subscription.h"
+#include "Core/Timer.h"
+#include "Core/Trace.h"
+#include "Core/TxState.h"
 
 #endif  // _R51_CORE_H_
@@ -0,0 +1,69 @@
+#include "Bus.h"
+
+#include <Arduino.h>
+#include <Caster.h>
+#include "BusStats.h"
+#include "Message.h"
+#include "Subscription.h"
+
+namespace R51 {
+
+IndexedBus::IndexedBus(BusNode* nodes, size_t size) : nodes_(nodes), size_(size) {
+    if (size_ > SubscriptionIndex::kMaxNodes) {
+        size_ = SubscriptionIndex::kMaxNodes;
+    }
+}
+
+void IndexedBus::init() {
+    Subscription* subs = new Subscription[size_];
+    const Subscription** refs = new const Subscription*[size_];
+    for (size_t i = 0; i < size_; ++i) {
+        if (nodes_[i].subscriber != nullptr) {
+            nodes_[i].subscriber->subscribe(&subs[i]);
+            refs[i] = &subs[i];
+        } else {
+            refs[i] = nullptr;
+        }
+    }
+    index_.build(refs, size_);
+    delete[] refs;
+    delete[] subs;
+    stats_.init(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        stats_.name(i, nodes_[i].name);
+    }
+
+    for (size_t i = 0; i < size_; ++i) {
+        nodes_[i].node->init(NodeYield(this, i));
+    }
+}
+
+void IndexedBus::loop() {
+    stats_.poll();
+    for (size_t i = 0; i < size_; ++i) {
+        BusStats::Mark mark = stats_.begin();
+        nodes_[i].node->emit(NodeYield(this, i));
+        stats_.emitted(i, mark);
+    }
+}
+
+void IndexedBus::emit(const Message& msg) {
+    dispatch(msg, size_);
+}
+
+void IndexedBus::dispatch(const Message& msg, size_t source) {
+    uint32_t nodes = index_.match(msg);
+    if (source < size_) {
+        nodes &= ~((uint32_t)1 << source);
+        stats_.yielded(source);
+    }
+    while (nodes != 0) {
+        size_t i = __builtin_ctz(nodes);
+        nodes &= nodes - 1;
+        BusStats::Mark mark = stats_.begin();
+        nodes_[i].node->handle(msg, NodeYield(this, i));
+        stats_.handled(i, mark);
+    }
+}
+
+}  // namespace R51
@@ -0,0 +1,81 @@
+#ifndef _R51_CORE_BUS_H_
+#define _R51_CORE_BUS_H_
+
+#include <Arduino.h>
+#include <Caster.h>
+#include "BusStats.h"
+#include "Message.h"
+#include "Subscription.h"
+
+namespace R51 {
+
+namespace internal {
+
+inline Subscriber* asSubscriber(Subscriber* node) { return node; }
+inline Subscriber* asSubscriber(void*) { return nullptr; }
+
+}  // namespace internal
+
+// A node entry on an IndexedBus. Captures the node's subscriber interface if
+// it implements one. Nodes which are not subscribers receive all messages.
+// The optional name is reported in the bus's stats.
+struct BusNode {
+    Caster::Node<Message>* node;
+    Subscriber* subscriber;
+    const char* name;
+
+    template <typename N>
+    BusNode(N* node, const char* name = nullptr) :
+        node(node), subscriber(internal::asSubscriber(node)), name(name) {}
+};
+
+// Message bus which routes messages only to the nodes subscribed to them.
+// Subscriptions are collected from each node when init() is called and used
+// to build a dispatch index. As with Caster::Bus, a message is never
+// delivered to the node which yielded it.
+//
+// A bus can hold at most SubscriptionIndex::kMaxNodes nodes. Additional nodes
+// are ignored.
+class IndexedBus {
+    public:
+        // Construct a bus over the given array of nodes.
+        IndexedBus(BusNode* nodes, size_t size);
+
+        // Build the dispatch index and initialize the nodes.
+        void init();
+
+        // Call emit() on every node.
+        void loop();
+
+        // Send a message to all subscribed nodes.
+        void emit(const Message& msg);
+
+        // Return the per-node stats. Nodes are in the order passed to the
+        // constructor and are named after their entries.
+        BusStats* stats() { return &stats_; }
+
+    private:
+        class NodeYield : public Caster::Yield<Message> {
+            public:
+                NodeYield(IndexedBus* bus, size_t source) : bus_(bus), source_(source) {}
+
+                void operator()(const Message& msg) const override {
+                    bus_->dispatch(msg, source_);
+                }
+
+            private:
+                IndexedBus* bus_;
+                size_t source_;
+        };
+
+        BusNode* nodes_;
+        size_t size_;
+        SubscriptionIndex index_;
+        BusStats stats_;
+
+        void dispatch(const Message& msg, size_t source);
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_BUS_H_
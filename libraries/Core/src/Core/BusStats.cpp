@@ -0,0 +1,184 @@
+#include "BusStats.h"
+
+#include <Arduino.h>
+#include <Caster.h>
+#include "Message.h"
+
+namespace R51 {
+
+#if defined(BUS_STATS_ENABLE)
+
+namespace {
+
+// Counters are written by the bus's core and read by others. Each access is a
+// single aligned word so it is never torn.
+uint32_t load(const uint32_t* value) {
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+void store(uint32_t* value, uint32_t update) {
+    __atomic_store_n(value, update, __ATOMIC_RELAXED);
+}
+
+}  // namespace
+
+BusStats::~BusStats() {
+    delete[] nodes_;
+    delete[] names_;
+}
+
+void BusStats::init(size_t size) {
+    delete[] nodes_;
+    delete[] names_;
+    nodes_ = new NodeStats[size];
+    names_ = new const char*[size];
+    size_ = size;
+    memset(nodes_, 0, sizeof(NodeStats) * size_);
+    memset(names_, 0, sizeof(const char*) * size_);
+}
+
+void BusStats::poll() {
+    uint32_t requests = __atomic_load_n(&reset_requests_, __ATOMIC_ACQUIRE);
+    if (requests == resets_) {
+        return;
+    }
+    resets_ = requests;
+    for (size_t i = 0; i < size_; ++i) {
+        NodeStats* stats = &nodes_[i];
+        store(&stats->handled, 0);
+        store(&stats->emitted, 0);
+        store(&stats->yielded, 0);
+        store(&stats->handle_us, 0);
+        store(&stats->emit_us, 0);
+        store(&stats->worst_us, 0);
+    }
+}
+
+BusStats::Mark BusStats::begin() {
+    Mark mark;
+    mark.outer = nested_us_;
+    nested_us_ = 0;
+    mark.start = micros();
+    return mark;
+}
+
+uint32_t BusStats::end(const Mark& mark) {
+    uint32_t total = micros() - mark.start;
+    uint32_t self = total - nested_us_;
+    nested_us_ = mark.outer + total;
+    return self;
+}
+
+void BusStats::record(uint32_t* total, uint32_t* worst, uint32_t elapsed) {
+    store(total, *total + elapsed);
+    if (elapsed > *worst) {
+        store(worst, elapsed);
+    }
+}
+
+void BusStats::handled(size_t node, const Mark& mark) {
+    uint32_t elapsed = end(mark);
+    if (node >= size_) {
+        return;
+    }
+    NodeStats* stats = &nodes_[node];
+    store(&stats->handled, stats->handled + 1);
+    record(&stats->handle_us, &stats->worst_us, elapsed);
+}
+
+void BusStats::emitted(size_t node, const Mark& mark) {
+    uint32_t elapsed = end(mark);
+    if (node >= size_) {
+        return;
+    }
+    NodeStats* stats = &nodes_[node];
+    store(&stats->emitted, stats->emitted + 1);
+    record(&stats->emit_us, &stats->worst_us, elapsed);
+}
+
+void BusStats::yielded(size_t node) {
+    if (node < size_) {
+        store(&nodes_[node].yielded, nodes_[node].yielded + 1);
+    }
+}
+
+void BusStats::reset() {
+    uint32_t requests = __atomic_load_n(&reset_requests_, __ATOMIC_RELAXED);
+    __atomic_store_n(&reset_requests_, requests + 1, __ATOMIC_RELEASE);
+}
+
+NodeStats BusStats::snapshot(size_t node) const {
+    NodeStats copy;
+    if (node >= size_) {
+        memset(&copy, 0, sizeof(copy));
+        return copy;
+    }
+    const NodeStats* stats = &nodes_[node];
+    copy.handled = load(&stats->handled);
+    copy.emitted = load(&stats->emitted);
+    copy.yielded = load(&stats->yielded);
+    copy.handle_us = load(&stats->handle_us);
+    copy.emit_us = load(&stats->emit_us);
+    copy.worst_us = load(&stats->worst_us);
+    return copy;
+}
+
+void BusStats::name(size_t node, const char* name) {
+    if (node < size_) {
+        names_[node] = name;
+    }
+}
+
+void BusStats::names(const char* const* names, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        name(i, names[i]);
+    }
+}
+
+const char* BusStats::name(size_t node) const {
+    return node < size_ ? names_[node] : nullptr;
+}
+
+#endif  // defined(BUS_STATS_ENABLE)
+
+bool BusStatsNode::add(uint8_t id, BusStats* stats) {
+    if (size_ >= kMaxBuses) {
+        return false;
+    }
+    ids_[size_] = id;
+    stats_[size_] = stats;
+    ++size_;
+    return true;
+}
+
+void BusStatsNode::emit(const Caster::Yield<Message>& yield) {
+    if (!ticker_.active()) {
+        return;
+    }
+    ticker_.reset();
+
+    // Skip buses without counters.
+    for (size_t i = 0; i < size_ && node_ >= stats_[bus_]->size(); ++i) {
+        node_ = 0;
+        bus_ = (bus_ + 1) % size_;
+    }
+    if (size_ == 0 || node_ >= stats_[bus_]->size()) {
+        return;
+    }
+
+    BusStats* stats = stats_[bus_];
+    NodeStats node = stats->snapshot(node_);
+    event_.bus(ids_[bus_]);
+    event_.node(node_);
+    event_.worst_us(node.worst_us > 0xFFFF ? 0xFFFF : node.worst_us);
+    event_.handled(node.handled > 0xFFFF ? 0xFFFF : node.handled);
+    yield(MessageView(&event_));
+
+    if (++node_ >= stats->size()) {
+        stats->reset();
+        node_ = 0;
+        bus_ = (bus_ + 1) % size_;
+    }
+}
+
+}  // namespace R51
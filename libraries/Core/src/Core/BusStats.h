@@ -0,0 +1,179 @@
+#ifndef _R51_CORE_BUS_STATS_H_
+#define _R51_CORE_BUS_STATS_H_
+
+#include <Arduino.h>
+#include <ByteOrder.h>
+#include <Caster.h>
+#include <Faker.h>
+#include <Foundation.h>
+#include "Event.h"
+#include "Message.h"
+#include "Subscription.h"
+#include "Timer.h"
+
+namespace R51 {
+
+// Per-node counters collected by a bus. Times are in microseconds and exclude
+// time spent in other nodes called through the node's yield.
+struct NodeStats {
+    uint32_t handled;   // Number of handle() calls.
+    uint32_t emitted;   // Number of emit() calls.
+    uint32_t yielded;   // Number of messages yielded.
+    uint32_t handle_us; // Total time spent in handle().
+    uint32_t emit_us;   // Total time spent in emit().
+    uint32_t worst_us;  // Longest single handle() or emit() call.
+};
+
+// Collects per-node stats for IndexedBus and StaticBus. Stats are only
+// collected when the libraries are built with BUS_STATS_ENABLE defined, e.g.
+// with -DBUS_STATS_ENABLE in the build flags. Otherwise every method is an
+// empty inline, the bus carries no counters, and size() is zero.
+//
+// The flag must be set for the whole build since it changes the layout of
+// this class.
+//
+// Counters are only written by the core which runs the bus. Other cores read
+// them with snapshot() and clear them with reset(), which asks the bus to
+// clear them at the start of its next loop.
+class BusStats {
+    public:
+        // Start of a timed node call.
+        struct Mark {
+#if defined(BUS_STATS_ENABLE)
+            uint32_t start;
+            uint32_t outer;
+#endif
+        };
+
+#if defined(BUS_STATS_ENABLE)
+        BusStats() : nodes_(nullptr), names_(nullptr), size_(0), nested_us_(0),
+            reset_requests_(0), resets_(0) {}
+        ~BusStats();
+
+        // Allocate counters for size nodes.
+        void init(size_t size);
+
+        // Apply a pending reset. Called by the bus at the start of each loop.
+        void poll();
+
+        // Mark the start of a node call.
+        Mark begin();
+
+        // Record a handle() call to a node started at mark.
+        void handled(size_t node, const Mark& mark);
+
+        // Record an emit() call to a node started at mark.
+        void emitted(size_t node, const Mark& mark);
+
+        // Record a message yielded by a node.
+        void yielded(size_t node);
+
+        // Ask the bus to reset all counters to zero. May be called from
+        // another core but all requests must come from the same core.
+        void reset();
+
+        // Return the number of nodes with counters.
+        size_t size() const { return size_; }
+
+        // Return a copy of a node's counters. May be called from another
+        // core. Each counter is read whole but they may be read a few calls
+        // apart.
+        NodeStats snapshot(size_t node) const;
+
+        // Set the name reported for a node. The name is not copied.
+        void name(size_t node, const char* name);
+
+        // Set the names of the first count nodes.
+        void names(const char* const* names, size_t count);
+
+        // Return the name of a node or null if it has none.
+        const char* name(size_t node) const;
+#else
+        void init(size_t) {}
+        void poll() {}
+        Mark begin() { return Mark(); }
+        void handled(size_t, const Mark&) {}
+        void emitted(size_t, const Mark&) {}
+        void yielded(size_t) {}
+        void reset() {}
+        size_t size() const { return 0; }
+        NodeStats snapshot(size_t) const { return NodeStats(); }
+        void name(size_t, const char*) {}
+        void names(const char* const*, size_t) {}
+        const char* name(size_t) const { return nullptr; }
+#endif
+
+    private:
+#if defined(BUS_STATS_ENABLE)
+        uint32_t end(const Mark& mark);
+        void record(uint32_t* total, uint32_t* worst, uint32_t elapsed);
+
+        NodeStats* nodes_;
+        const char** names_;
+        size_t size_;
+        uint32_t nested_us_;
+        uint32_t reset_requests_;   // Written by the core calling reset().
+        uint32_t resets_;           // Written by the bus's core.
+#endif
+};
+
+// Event sent periodically by BusStatsNode for each node on a bus.
+class NodeStatsState : public Event {
+    public:
+        NodeStatsState() : Event(SubSystem::CONTROLLER,
+                (uint8_t)ControllerEvent::NODE_STATS_STATE,
+                {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}) {}
+
+        // ID of the bus as given to BusStatsNode::add().
+        EVENT_PROPERTY(uint8_t, bus, data[0], data[0] = value);
+        // Position of the node on the bus.
+        EVENT_PROPERTY(uint8_t, node, data[1], data[1] = value);
+        // Longest call to the node in microseconds. Saturates at 0xFFFF.
+        EVENT_PROPERTY(uint16_t, worst_us,
+                ByteOrder::nbtohs(data + 2),
+                ByteOrder::hstonb(data + 2, value));
+        // Messages handled by the node. Saturates at 0xFFFF.
+        EVENT_PROPERTY(uint16_t, handled,
+                ByteOrder::nbtohs(data + 4),
+                ByteOrder::hstonb(data + 4, value));
+};
+
+// Yields a NODE_STATS_STATE event for one node of the attached buses each
+// interval so that a report never floods the pipe. Nodes are reported in turn
+// and a bus's counters are reset once all of its nodes have been reported.
+// Yields nothing unless built with BUS_STATS_ENABLE.
+class BusStatsNode : public Caster::Node<Message>, public Subscriber {
+    public:
+        // Maximum number of buses which may be attached.
+        static const size_t kMaxBuses = 4;
+
+        BusStatsNode(uint32_t interval_ms,
+                Faker::Clock* clock = Faker::Clock::real()) :
+            size_(0), bus_(0), node_(0), ticker_(interval_ms, false, clock) {}
+
+        // Attach a bus's stats under the given ID. Returns false if too many
+        // buses are attached.
+        bool add(uint8_t id, BusStats* stats);
+
+        // Does not handle messages.
+        void subscribe(Subscription*) override {}
+
+        // Yield the next node's stats event when the interval has elapsed.
+        void emit(const Caster::Yield<Message>& yield) override;
+
+        // Track the interval ticker on a wheel.
+        void schedule(TimerWheel* wheel) { wheel->add(&ticker_); }
+
+    private:
+        uint8_t ids_[kMaxBuses];
+        BusStats* stats_[kMaxBuses];
+        size_t size_;
+        size_t bus_;    // Bus of the next node to report.
+        size_t node_;   // Next node to report.
+        Timer ticker_;
+        NodeStatsState event_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_BUS_STATS_H_
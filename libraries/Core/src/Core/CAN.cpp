@@ -2,26 +2,104 @@
 
 namespace R51 {
 
+using ::Canny::CAN20Frame;
 using ::Canny::ERR_FIFO;
 using ::Canny::ERR_OK;
 using ::Canny::Error;
 
-void CANGateway::handle(const Message& msg, const Caster::Yield<Message>&) {
+void CANGateway::subscribe(Subscription* sub) {
+    sub->all(Message::CAN_FRAME);
+}
+
+void CANGateway::handle(const Message& msg, const Caster::Yield<Message>& yield) {
     if (msg.type() != Message::CAN_FRAME) {
         return;
     }
-    Error err = can_->write(*msg.can_frame());
-    if (err != ERR_OK && err != ERR_FIFO) {
-        onWriteError(err, *msg.can_frame());
+    const CAN20Frame& frame = *msg.can_frame();
+    bool coalesce = coalesce_ != nullptr && coalesce_->match(frame);
+    if (!tx_.push(frame, clock_->millis() + write_timeout_, coalesce)) {
+        onWriteError(ERR_FIFO, frame);
     }
+    flush();
+    updateTxState(yield);
 }
 
 void CANGateway::emit(const Caster::Yield<Message>& yield) {
-    Error err = can_->read(&frame_);
-    if (err == ERR_OK) {
+    burst_.begin();
+    while (burst_.more()) {
+        Error err = can_->read(&frame_);
+        if (err != ERR_OK) {
+            if (err != ERR_FIFO) {
+                onReadError(err);
+            }
+            break;
+        }
+        burst_.read();
         yield(MessageView(&frame_));
-    } else if (err != ERR_FIFO) {
-        onReadError(err);
+    }
+    burst_.end();
+
+    if (!tx_.empty()) {
+        flush();
+        updateTxState(yield);
+    }
+}
+
+void CANGateway::flush() {
+    CAN20Frame expired;
+    while (tx_.expire(clock_->millis(), &expired)) {
+        onWriteError(ERR_FIFO, expired);
+    }
+
+    // Frames stay queued while the connection's write buffer is full or the
+    // pacer holds them. Frames which fail for other reasons are dropped.
+    size_t i = 0;
+    while (i < tx_.size()) {
+        const CAN20Frame* frame = tx_.at(i);
+        if (pacer_ != nullptr && !pacer_->ready(*frame)) {
+            ++i;
+            continue;
+        }
+        Error err = can_->write(*frame);
+        if (err == ERR_FIFO) {
+            break;
+        }
+        if (err != ERR_OK) {
+            onWriteError(err, *frame);
+        } else if (pacer_ != nullptr) {
+            pacer_->sent(*frame);
+        }
+        tx_.erase(i, err == ERR_OK);
+    }
+}
+
+size_t CANGateway::backlog() {
+    if (pacer_ == nullptr) {
+        return tx_.size();
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < tx_.size(); ++i) {
+        if (pacer_->ready(*tx_.at(i))) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void CANGateway::updateTxState(const Caster::Yield<Message>& yield) {
+    // Congestion is reported once frames back up behind the controller and
+    // cleared once none are left waiting on it. Frames the pacer is holding
+    // back are not congestion. The report is repeated while congested in case
+    // it was dropped on the way to the nodes holding their frames.
+    size_t depth = backlog();
+    bool congested = depth >= kCongestedDepth ||
+        (tx_state_.congested() && depth > 0);
+    uint32_t now = clock_->millis();
+    if (tx_state_.congested(congested) ||
+            (congested && now - tx_state_sent_ >= TxState::kRefresh)) {
+        tx_state_.depth(depth);
+        tx_state_sent_ = now;
+        yield(MessageView(&tx_state_));
     }
 }
 
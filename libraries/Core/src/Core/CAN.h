@@ -3,34 +3,108 @@
 
 #include <Canny.h>
 #include <Caster.h>
+#include <Faker.h>
 
+#include "CANPacer.h"
+#include "CANTxQueue.h"
+#include "IDFilter.h"
 #include "Message.h"
+#include "ReadBurst.h"
+#include "Subscription.h"
+#include "TxState.h"
 
 namespace R51 {
 
 // Bus node for reading and writing frames to a CAN 2.0 controller.
-class CANGateway : public Caster::Node<Message> {
+//
+// Frames which can't be written because the connection's write buffer is full
+// or the pacer is holding them wait in a retry queue and are written in order
+// once the buffer frees up. A frame which is still queued after the write
+// timeout is dropped. Frames whose IDs match the coalesce filter replace a
+// queued frame with the same ID rather than queueing behind it. An optional
+// pacer holds frames back to keep their rate within budget; frames held by the
+// pacer don't block frames with other IDs. A CONTROLLER:TX_STATE event is
+// broadcast when the queue becomes congested, periodically while it stays
+// congested, and again when it drains so that producers can hold back periodic
+// frames. Only frames waiting on the controller count toward congestion;
+// frames the pacer is holding back do not.
+class CANGateway : public Caster::Node<Message>, public Subscriber {
     public:
+        // Number of frames waiting on the controller at which the gateway
+        // reports congestion.
+        static const size_t kCongestedDepth = 4;
+
+        // Default time a frame may wait in the retry queue.
+        static const uint32_t kWriteTimeout = 200;
+
         // Construct a new note that transmits frames over the given
         // connection.
-        CANGateway(Canny::Connection<Canny::CAN20Frame>* can) : can_(can) {}
+        CANGateway(Canny::Connection<Canny::CAN20Frame>* can,
+                Faker::Clock* clock = Faker::Clock::real()) :
+            can_(can), clock_(clock), coalesce_(nullptr), pacer_(nullptr),
+            write_timeout_(kWriteTimeout), tx_state_(TxNetwork::CAN),
+            tx_state_sent_(0) {}
         virtual ~CANGateway() = default;
 
-        // Write a frame to the CAN bus.
-        void handle(const Message& msg, const Caster::Yield<Message>&) override;
+        // Subscribe to all CAN frames.
+        void subscribe(Subscription* sub) override;
+
+        // Write a frame to the CAN bus or queue it if the bus is busy.
+        void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
-        // Read a single CAN frame and broadcast it to the event bus.
+        // Read CAN frames and broadcast them to the event bus. Reads one
+        // frame per call unless a larger burst is configured. Also retries
+        // queued frames.
         void emit(const Caster::Yield<Message>& yield) override;
 
+        // Set the time in milliseconds a frame may wait to be written.
+        void writeTimeout(uint32_t timeout_ms) { write_timeout_ = timeout_ms; }
+
+        // Coalesce queued frames whose IDs are accepted by the filter. Set to
+        // nullptr to queue every frame.
+        void coalesce(const IDFilter* ids) { coalesce_ = ids; }
+
+        // Pace writes with the given pacer. Set to nullptr to write frames as
+        // fast as the connection accepts them.
+        void pace(CANPacer* pacer) { pacer_ = pacer; }
+
+        // Return true if frames are backing up in the retry queue.
+        bool congested() const { return tx_state_.congested(); }
+
+        // Return the retry queue counters.
+        const CANTxStats& txStats() const { return tx_.stats(); }
+
+        // Read up to count frames per emit, stopping early once budget_us
+        // microseconds have been spent if non-zero.
+        void burst(uint16_t count, uint32_t budget_us = 0) {
+            burst_.limit(count, budget_us);
+        }
+
+        // Return the counts of frames read per emit.
+        const BurstStats& burstStats() const { return burst_.stats(); }
+
         // Called when a frame can't be read from the bus.
         virtual void onReadError(Canny::Error) {}
 
-        // Called when a frame can't be written to the bus.
+        // Called when a frame can't be written to the bus. The error is
+        // ERR_FIFO if the frame was dropped from the retry queue.
         virtual void onWriteError(Canny::Error, const Canny::CAN20Frame&) {}
 
     private:
+        void flush();
+        size_t backlog();
+        void updateTxState(const Caster::Yield<Message>& yield);
+
         Canny::Connection<Canny::CAN20Frame>* can_;
+        Faker::Clock* clock_;
+        const IDFilter* coalesce_;
+        CANPacer* pacer_;
+        uint32_t write_timeout_;
         Canny::CAN20Frame frame_;
+        ReadBurst burst_;
+        CANTxQueue tx_;
+        TxState tx_state_;
+        uint32_t tx_state_sent_;
 };
 
 }  // namespace R51
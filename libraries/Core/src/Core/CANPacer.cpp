@@ -0,0 +1,82 @@
+#include "CANPacer.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+using ::Canny::CAN20Frame;
+
+bool CANPacer::limit(const IDRule& rule, uint32_t interval_ms, uint8_t burst) {
+    if (size_ >= kMaxLimits || burst == 0) {
+        return false;
+    }
+    Limit* limit = &limits_[size_++];
+    limit->rule = rule;
+    limit->interval_ms = interval_ms;
+    limit->refill_ms = clock_->millis();
+    limit->burst = burst;
+    limit->tokens = burst;
+    return true;
+}
+
+bool CANPacer::ready(const CAN20Frame& frame) {
+    uint32_t now = clock_->millis();
+    if (!idle_ && now - last_ms_ < spacing_ms_) {
+        return false;
+    }
+    Limit* limit = find(frame);
+    if (limit == nullptr) {
+        return true;
+    }
+    refill(limit, now);
+    return limit->tokens > 0;
+}
+
+void CANPacer::sent(const CAN20Frame& frame) {
+    uint32_t now = clock_->millis();
+    last_ms_ = now;
+    idle_ = false;
+    Limit* limit = find(frame);
+    if (limit == nullptr) {
+        return;
+    }
+    refill(limit, now);
+    if (limit->tokens > 0) {
+        --limit->tokens;
+    }
+}
+
+CANPacer::Limit* CANPacer::find(const CAN20Frame& frame) {
+    for (size_t i = 0; i < size_; ++i) {
+        if (limits_[i].rule.match(frame.id(), frame.ext())) {
+            return &limits_[i];
+        }
+    }
+    return nullptr;
+}
+
+void CANPacer::refill(Limit* limit, uint32_t now) {
+    if (limit->tokens >= limit->burst) {
+        // A full bucket starts refilling from its next frame.
+        limit->refill_ms = now;
+        return;
+    }
+    if (limit->interval_ms == 0) {
+        limit->tokens = limit->burst;
+        return;
+    }
+    uint32_t count = (now - limit->refill_ms) / limit->interval_ms;
+    if (count == 0) {
+        return;
+    }
+    if (count >= (uint32_t)(limit->burst - limit->tokens)) {
+        limit->tokens = limit->burst;
+        limit->refill_ms = now;
+    } else {
+        limit->tokens += count;
+        limit->refill_ms += count * limit->interval_ms;
+    }
+}
+
+}  // namespace R51
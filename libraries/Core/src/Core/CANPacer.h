@@ -0,0 +1,65 @@
+#ifndef _R51_CORE_CAN_PACER_H_
+#define _R51_CORE_CAN_PACER_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+#include <Faker.h>
+#include "IDFilter.h"
+
+namespace R51 {
+
+// Limits the rate at which frames are written to a CAN bus so that our
+// traffic does not crowd out the vehicle's own frames.
+//
+// Each limit is a token bucket for the IDs matched by an IDRule. A bucket
+// holds up to burst frames and gains one every interval_ms, so the IDs may
+// burst briefly but are held to one frame per interval over time. The first
+// limit which matches a frame decides it. Frames which match no limit are not
+// rate limited. All frames are additionally kept spacing_ms apart.
+class CANPacer {
+    public:
+        // Maximum number of rate limits.
+        static const size_t kMaxLimits = 8;
+
+        // Construct a pacer which keeps frames spacing_ms apart.
+        CANPacer(uint32_t spacing_ms = 0, Faker::Clock* clock = Faker::Clock::real()) :
+            clock_(clock), spacing_ms_(spacing_ms), last_ms_(0), idle_(true),
+            size_(0) {}
+
+        // Limit frames matched by the rule to burst frames at once and one
+        // frame every interval_ms after that. Returns false if there is no
+        // room for the limit.
+        bool limit(const IDRule& rule, uint32_t interval_ms, uint8_t burst = 1);
+
+        // Set the minimum time between any two frames.
+        void spacing(uint32_t spacing_ms) { spacing_ms_ = spacing_ms; }
+
+        // Return true if the frame may be written now.
+        bool ready(const Canny::CAN20Frame& frame);
+
+        // Record that the frame was written.
+        void sent(const Canny::CAN20Frame& frame);
+
+    private:
+        struct Limit {
+            IDRule rule;
+            uint32_t interval_ms;
+            uint32_t refill_ms;
+            uint8_t burst;
+            uint8_t tokens;
+        };
+
+        Faker::Clock* clock_;
+        uint32_t spacing_ms_;
+        uint32_t last_ms_;
+        bool idle_;
+        Limit limits_[kMaxLimits];
+        size_t size_;
+
+        Limit* find(const Canny::CAN20Frame& frame);
+        void refill(Limit* limit, uint32_t now);
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_CAN_PACER_H_
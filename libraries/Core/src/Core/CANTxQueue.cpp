@@ -0,0 +1,69 @@
+#include "CANTxQueue.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+using ::Canny::CAN20Frame;
+
+bool CANTxQueue::push(const CAN20Frame& frame, uint32_t deadline, bool coalesce) {
+    if (coalesce) {
+        for (size_t i = 0; i < size_; ++i) {
+            if (queue_[i].frame.id() == frame.id() &&
+                    queue_[i].frame.ext() == frame.ext()) {
+                queue_[i].frame = frame;
+                queue_[i].deadline = deadline;
+                ++stats_.coalesced;
+                return true;
+            }
+        }
+    }
+    if (size_ >= kCapacity) {
+        ++stats_.shed;
+        return false;
+    }
+    queue_[size_].frame = frame;
+    queue_[size_].deadline = deadline;
+    ++size_;
+    ++stats_.queued;
+    if (size_ > stats_.peak) {
+        stats_.peak = size_;
+    }
+    return true;
+}
+
+void CANTxQueue::erase(size_t i, bool sent) {
+    if (i >= size_) {
+        return;
+    }
+    remove(i);
+    if (sent) {
+        ++stats_.sent;
+    }
+}
+
+bool CANTxQueue::expire(uint32_t now, CAN20Frame* expired) {
+    // Coalesced frames take a later deadline so deadlines are not in queue
+    // order.
+    for (size_t i = 0; i < size_; ++i) {
+        if ((int32_t)(now - queue_[i].deadline) > 0) {
+            if (expired != nullptr) {
+                *expired = queue_[i].frame;
+            }
+            remove(i);
+            ++stats_.expired;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CANTxQueue::remove(size_t i) {
+    for (++i; i < size_; ++i) {
+        queue_[i - 1] = queue_[i];
+    }
+    --size_;
+}
+
+}  // namespace R51
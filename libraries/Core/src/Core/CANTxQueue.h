@@ -0,0 +1,91 @@
+#ifndef _R51_CORE_CAN_TX_QUEUE_H_
+#define _R51_CORE_CAN_TX_QUEUE_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+// Frame counts kept by a CANTxQueue.
+struct CANTxStats {
+    // Frames accepted into the queue.
+    uint32_t queued;
+    // Frames removed from the queue after being written.
+    uint32_t sent;
+    // Frames which replaced a queued frame with the same ID.
+    uint32_t coalesced;
+    // Frames dropped because their deadline passed before they were written.
+    uint32_t expired;
+    // Frames rejected because the queue was full.
+    uint32_t shed;
+    // Most frames held at once.
+    uint16_t peak;
+};
+
+// A bounded queue of CAN frames waiting to be retried. Frames are written in
+// the order they were queued and each must be written before its deadline.
+//
+// A frame pushed with coalesce set replaces the data of a queued frame with
+// the same ID instead of taking a new slot. The frame keeps its place in the
+// queue so that a frequently updated ID is not starved. This is meant for
+// frames which carry a full state snapshot, where only the latest matters.
+class CANTxQueue {
+    public:
+        // Number of frames held by the queue.
+        static const size_t kCapacity = 16;
+
+        CANTxQueue() : size_(0), stats_({0, 0, 0, 0, 0, 0}) {}
+
+        // Add a frame which must be written before deadline, in
+        // milliseconds. Returns false if the queue is full and the frame was
+        // shed.
+        bool push(const Canny::CAN20Frame& frame, uint32_t deadline, bool coalesce = false);
+
+        // Return the oldest frame or nullptr if the queue is empty.
+        const Canny::CAN20Frame* peek() const {
+            return size_ == 0 ? nullptr : &queue_[0].frame;
+        }
+
+        // Return the frame at position i, oldest first, or nullptr if i is
+        // past the end of the queue.
+        const Canny::CAN20Frame* at(size_t i) const {
+            return i >= size_ ? nullptr : &queue_[i].frame;
+        }
+
+        // Remove the oldest frame. The frame is counted as sent if sent is
+        // true.
+        void pop(bool sent = true) { erase(0, sent); }
+
+        // Remove the frame at position i. The frame is counted as sent if
+        // sent is true.
+        void erase(size_t i, bool sent = true);
+
+        // Remove a frame whose deadline is earlier than now and copy it to
+        // expired if not null. Returns false if no frame has expired.
+        bool expire(uint32_t now, Canny::CAN20Frame* expired = nullptr);
+
+        // Return the number of frames in the queue.
+        size_t size() const { return size_; }
+
+        // Return true if the queue is empty.
+        bool empty() const { return size_ == 0; }
+
+        // Return the queue counters.
+        const CANTxStats& stats() const { return stats_; }
+
+    private:
+        struct Entry {
+            Canny::CAN20Frame frame;
+            uint32_t deadline;
+        };
+
+        Entry queue_[kCapacity];
+        size_t size_;
+        CANTxStats stats_;
+
+        void remove(size_t i);
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_CAN_TX_QUEUE_H_
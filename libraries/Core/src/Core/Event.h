@@ -41,9 +41,17 @@ enum class SubSystem : uint8_t {
 };
 
 enum class ControllerEvent : uint8_t {
+    NODE_STATS_STATE = 0x01, // Per-node bus stats. Payload is the bus ID,
+                             // node position, worst call time, and handled
+                             // count. See NodeStatsState.
+    TX_STATE = 0x02,    // Gateway transmit queue state. Payload is the
+                        // network, congested flag, and queue depth. See
+                        // TxState.
     REQUEST_CMD = 0x10, // Request state from the controller. Payload is the
                         // subsystem and state ID to retrieve or 0xFFFF for
                         // all states the controller owns.
+    TRACE_CMD = 0x11,   // Freeze, resume, or dump bus traces. Payload is the
+                        // action and trace ID. See TraceCommand.
 };
 
 struct Event {
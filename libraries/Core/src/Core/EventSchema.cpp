@@ -0,0 +1,351 @@
+#include "EventSchema.h"
+
+#include <Arduino.h>
+#include "BusStats.h"
+#include "Event.h"
+#include "Keypad.h"
+#include "Power.h"
+#include "Trace.h"
+#include "TxState.h"
+
+namespace R51 {
+namespace {
+
+// Head of the list of linked schema tables. Constant initialized so tables
+// may register from any static constructor.
+EventSchemaTable* tables = nullptr;
+
+uint32_t mask(uint8_t width) {
+    return width >= 32 ? 0xFFFFFFFF : ((uint32_t)1 << width) - 1;
+}
+
+// Sign extend a raw field value.
+int32_t signExtend(uint32_t value, uint8_t width) {
+    if (width < 32 && (value & ((uint32_t)1 << (width - 1))) != 0) {
+        value |= ~mask(width);
+    }
+    return (int32_t)value;
+}
+
+}  // namespace
+
+uint32_t EventField::get(const uint8_t* data) const {
+    const uint8_t* b = data + offset / 8;
+    if (width <= 8) {
+        return (*b >> (offset % 8)) & mask(width);
+    }
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < width / 8; ++i) {
+        value = (value << 8) | b[i];
+    }
+    return value;
+}
+
+void EventField::set(uint8_t* data, uint32_t value) const {
+    uint8_t* b = data + offset / 8;
+    if (width <= 8) {
+        uint8_t m = mask(width) << (offset % 8);
+        *b = (*b & ~m) | ((value << (offset % 8)) & m);
+        return;
+    }
+    for (uint8_t i = width / 8; i > 0; --i) {
+        b[i - 1] = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+bool EventField::valid(uint32_t value) const {
+    if (value > mask(width)) {
+        return false;
+    }
+    if (type == FieldType::ENUM) {
+        return value < label_count;
+    }
+    return true;
+}
+
+size_t EventField::printTo(Print& p, const uint8_t* data) const {
+    uint32_t value = get(data);
+    size_t n = p.print(name);
+    n += p.print("=");
+    switch (type) {
+        case FieldType::UINT:
+            n += p.print(value);
+            break;
+        case FieldType::INT:
+            n += p.print(signExtend(value, width));
+            break;
+        case FieldType::BOOL:
+            n += p.print(value != 0 ? "on" : "off");
+            break;
+        case FieldType::ENUM:
+            if (value < label_count) {
+                n += p.print(labels[value]);
+            } else {
+                n += p.print(value);
+            }
+            break;
+    }
+    if (unit != nullptr) {
+        n += p.print(unit);
+    }
+    return n;
+}
+
+bool EventField::parse(const char* str, uint32_t* value) const {
+    if (str == nullptr || *str == 0) {
+        return false;
+    }
+    if (type == FieldType::BOOL) {
+        if (strcmp(str, "on") == 0) {
+            *value = 1;
+            return true;
+        } else if (strcmp(str, "off") == 0) {
+            *value = 0;
+            return true;
+        }
+    } else if (type == FieldType::ENUM) {
+        for (uint8_t i = 0; i < label_count; ++i) {
+            if (strcmp(str, labels[i]) == 0) {
+                *value = i;
+                return true;
+            }
+        }
+    }
+
+    char* end;
+    if (type == FieldType::INT) {
+        long v = strtol(str, &end, 0);
+        if (*end != 0) {
+            return false;
+        }
+        long max = width >= 32 ? 0x7FFFFFFF : ((long)1 << (width - 1)) - 1;
+        if (v > max || v < -max - 1) {
+            return false;
+        }
+        *value = (uint32_t)v & mask(width);
+        return true;
+    }
+    if (*str == '-') {
+        return false;
+    }
+    unsigned long v = strtoul(str, &end, 0);
+    if (*end != 0 || v > mask(width) || !valid(v)) {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+const EventField* EventSchema::field(const char* name) const {
+    for (uint8_t i = 0; i < field_count; ++i) {
+        if (strcmp(fields[i].name, name) == 0) {
+            return &fields[i];
+        }
+    }
+    return nullptr;
+}
+
+bool EventSchema::valid(const Event& event) const {
+    for (uint8_t i = 0; i < field_count; ++i) {
+        if (!fields[i].valid(fields[i].get(event.data))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t EventSchema::printTo(Print& p, const Event& event) const {
+    size_t n = p.print(name);
+    for (uint8_t i = 0; i < field_count; ++i) {
+        n += p.print(" ");
+        n += fields[i].printTo(p, event.data);
+    }
+    return n;
+}
+
+void EventSchema::init(Event* event) const {
+    event->subsystem = subsystem;
+    event->id = id;
+    event->scratch = nullptr;
+    memset(event->data, 0xFF, 6);
+    for (uint8_t i = 0; i < field_count; ++i) {
+        fields[i].set(event->data, 0);
+    }
+}
+
+EventSchemaTable::EventSchemaTable(const EventSchema* schemas, size_t size) :
+        schemas_(schemas), size_(size), next_(tables) {
+    tables = this;
+}
+
+const EventSchema* EventSchemaTable::find(uint8_t subsystem, uint8_t id) {
+    for (const EventSchemaTable* t = tables; t != nullptr; t = t->next_) {
+        for (size_t i = 0; i < t->size_; ++i) {
+            if (t->schemas_[i].subsystem == subsystem && t->schemas_[i].id == id) {
+                return &t->schemas_[i];
+            }
+        }
+    }
+    return nullptr;
+}
+
+const EventSchema* EventSchemaTable::find(const char* name) {
+    for (const EventSchemaTable* t = tables; t != nullptr; t = t->next_) {
+        for (size_t i = 0; i < t->size_; ++i) {
+            if (strcmp(t->schemas_[i].name, name) == 0) {
+                return &t->schemas_[i];
+            }
+        }
+    }
+    return nullptr;
+}
+
+size_t EventSchemaTable::count() {
+    size_t n = 0;
+    for (const EventSchemaTable* t = tables; t != nullptr; t = t->next_) {
+        n += t->size_;
+    }
+    return n;
+}
+
+const EventSchema* EventSchemaTable::at(size_t i) {
+    for (const EventSchemaTable* t = tables; t != nullptr; t = t->next_) {
+        if (i < t->size_) {
+            return &t->schemas_[i];
+        }
+        i -= t->size_;
+    }
+    return nullptr;
+}
+
+size_t EventSchemaTable::print(Print& p, const Event& event) {
+    size_t n = event.printTo(p);
+    const EventSchema* schema = find(event);
+    if (schema != nullptr) {
+        n += p.print(" (");
+        n += schema->printTo(p, event);
+        n += p.print(")");
+    }
+    return n;
+}
+
+namespace {
+
+// Schemas for the events defined by Core.
+
+constexpr const char* kPowerModes[] = {"off", "on", "pwm", "fault"};
+constexpr const char* kPowerCmds[] = {"off", "on", "toggle", "pwm", "reset"};
+constexpr const char* kTraceActions[] = {"freeze", "resume", "dump"};
+constexpr const char* kTxNetworks[] = {"can", "j1939"};
+constexpr const char* kLEDModes[] = {"off", "on", "blink", "alt_blink"};
+constexpr const char* kLEDColors[] = {
+    "white", "red", "green", "blue", "cyan", "yellow", "magenta", "amber",
+};
+
+constexpr EventField kNodeStatsFields[] = {
+    uintField("bus", 0),
+    uintField("node", 8),
+    uintField("worst", 16, 16, "us"),
+    uintField("handled", 32, 16),
+};
+
+constexpr EventField kTxStateFields[] = {
+    enumField("network", 0, 8, kTxNetworks),
+    boolField("congested", 8, 8),
+    uintField("depth", 16),
+};
+
+constexpr EventField kRequestFields[] = {
+    uintField("subsystem", 0),
+    uintField("id", 8),
+};
+
+constexpr EventField kTraceFields[] = {
+    enumField("action", 0, 8, kTraceActions),
+    uintField("trace", 8),
+};
+
+constexpr EventField kPowerStateFields[] = {
+    uintField("pdm", 0),
+    uintField("pin", 8),
+    enumField("mode", 16, 8, kPowerModes),
+    uintField("duty", 24),
+};
+
+constexpr EventField kInputStateFields[] = {
+    uintField("pdm", 0),
+    uintField("pin", 8),
+    boolField("state", 16, 8),
+};
+
+constexpr EventField kPowerCmdFields[] = {
+    uintField("pdm", 0),
+    uintField("pin", 8),
+    enumField("cmd", 16, 8, kPowerCmds),
+    uintField("duty", 24),
+};
+
+constexpr EventField kKeyStateFields[] = {
+    uintField("keypad", 0),
+    uintField("key", 8),
+    boolField("pressed", 16, 8),
+};
+
+constexpr EventField kEncoderStateFields[] = {
+    uintField("keypad", 0),
+    uintField("encoder", 8),
+    intField("delta", 16),
+};
+
+constexpr EventField kIndicatorCmdFields[] = {
+    uintField("keypad", 0),
+    uintField("led", 8),
+    enumField("mode", 16, 8, kLEDModes),
+    enumField("color", 24, 8, kLEDColors),
+    enumField("alt_color", 32, 8, kLEDColors),
+};
+
+constexpr EventField kBrightnessCmdFields[] = {
+    uintField("keypad", 0),
+    uintField("brightness", 8),
+};
+
+constexpr EventField kBacklightCmdFields[] = {
+    uintField("keypad", 0),
+    uintField("brightness", 8),
+    enumField("color", 16, 8, kLEDColors),
+};
+
+constexpr EventSchema kCoreSchemas[] = {
+    eventSchema("node_stats", SubSystem::CONTROLLER,
+            (uint8_t)ControllerEvent::NODE_STATS_STATE, kNodeStatsFields),
+    eventSchema("tx_state", SubSystem::CONTROLLER,
+            (uint8_t)ControllerEvent::TX_STATE, kTxStateFields),
+    eventSchema("request", SubSystem::CONTROLLER,
+            (uint8_t)ControllerEvent::REQUEST_CMD, kRequestFields),
+    eventSchema("trace", SubSystem::CONTROLLER,
+            (uint8_t)ControllerEvent::TRACE_CMD, kTraceFields),
+    eventSchema("power_state", SubSystem::POWER,
+            (uint8_t)PowerEvent::POWER_STATE, kPowerStateFields),
+    eventSchema("input_state", SubSystem::POWER,
+            (uint8_t)PowerEvent::INPUT_STATE, kInputStateFields),
+    eventSchema("power_cmd", SubSystem::POWER,
+            (uint8_t)PowerEvent::POWER_CMD, kPowerCmdFields),
+    eventSchema("key_state", SubSystem::KEYPAD,
+            (uint8_t)KeypadEvent::KEY_STATE, kKeyStateFields),
+    eventSchema("encoder_state", SubSystem::KEYPAD,
+            (uint8_t)KeypadEvent::ENCODER_STATE, kEncoderStateFields),
+    eventSchema("indicator_cmd", SubSystem::KEYPAD,
+            (uint8_t)KeypadEvent::INDICATOR_CMD, kIndicatorCmdFields),
+    eventSchema("brightness_cmd", SubSystem::KEYPAD,
+            (uint8_t)KeypadEvent::BRIGHTNESS_CMD, kBrightnessCmdFields),
+    eventSchema("backlight_cmd", SubSystem::KEYPAD,
+            (uint8_t)KeypadEvent::BACKLIGHT_CMD, kBacklightCmdFields),
+};
+
+EventSchemaTable core_schemas(kCoreSchemas);
+
+}  // namespace
+
+}  // namespace R51
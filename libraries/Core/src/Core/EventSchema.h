@@ -0,0 +1,147 @@
+#ifndef _R51_CORE_EVENT_SCHEMA_H_
+#define _R51_CORE_EVENT_SCHEMA_H_
+
+#include <Arduino.h>
+#include "Event.h"
+
+namespace R51 {
+
+// How an event field's value is interpreted.
+enum class FieldType : uint8_t {
+    UINT    = 0,    // Unsigned integer.
+    INT     = 1,    // Two's complement signed integer.
+    BOOL    = 2,    // Printed as on or off.
+    ENUM    = 3,    // Printed as one of the field's labels.
+};
+
+// Describes a single field in an event's data. Fields of eight bits or fewer
+// are packed into a single byte; offset is the bit position within the data
+// with bit 0 being the least significant bit of data[0]. Wider fields must be
+// byte aligned and 16 or 32 bits wide and are stored big endian.
+struct EventField {
+    const char* name;
+    const char* unit;           // Printed after the value. May be nullptr.
+    const char* const* labels;  // Names of ENUM values, in order.
+    uint8_t offset;
+    uint8_t width;
+    FieldType type;
+    uint8_t label_count;
+
+    // Return the field's raw value from the event data.
+    uint32_t get(const uint8_t* data) const;
+
+    // Write the raw value to the event data. Other fields are preserved.
+    void set(uint8_t* data, uint32_t value) const;
+
+    // Return true if value is legal for the field.
+    bool valid(uint32_t value) const;
+
+    // Print the field's value as name=value.
+    size_t printTo(Print& p, const uint8_t* data) const;
+
+    // Parse a value for the field. Accepts decimal or 0x prefixed hex
+    // numbers, on/off for BOOL fields, and labels for ENUM fields. Return
+    // false if the value is malformed or not legal for the field.
+    bool parse(const char* str, uint32_t* value) const;
+};
+
+// Create an unsigned integer field.
+constexpr EventField uintField(const char* name, uint8_t offset,
+        uint8_t width = 8, const char* unit = nullptr) {
+    return {name, unit, nullptr, offset, width, FieldType::UINT, 0};
+}
+
+// Create a signed integer field.
+constexpr EventField intField(const char* name, uint8_t offset,
+        uint8_t width = 8, const char* unit = nullptr) {
+    return {name, unit, nullptr, offset, width, FieldType::INT, 0};
+}
+
+// Create a single bit boolean field. A width of 8 treats any non-zero byte
+// as on.
+constexpr EventField boolField(const char* name, uint8_t offset, uint8_t width = 1) {
+    return {name, nullptr, nullptr, offset, width, FieldType::BOOL, 0};
+}
+
+// Create an enumerated field. Values are printed and parsed as labels.
+template <size_t N>
+constexpr EventField enumField(const char* name, uint8_t offset, uint8_t width,
+        const char* const (&labels)[N]) {
+    return {name, nullptr, labels, offset, width, FieldType::ENUM, N};
+}
+
+// Compile time description of an event's layout. Schemas are used to print
+// events in a human readable form and to build events from their names and
+// field values.
+struct EventSchema {
+    const char* name;
+    const EventField* fields;
+    uint8_t field_count;
+    uint8_t subsystem;
+    uint8_t id;
+
+    // Return the named field or nullptr if the event has no such field.
+    const EventField* field(const char* name) const;
+
+    // Return true if all fields of the event hold legal values.
+    bool valid(const Event& event) const;
+
+    // Print the event's name and fields as "name field=value ...".
+    size_t printTo(Print& p, const Event& event) const;
+
+    // Reset the event to this schema's subsystem and id with all fields set
+    // to zero. Data not covered by a field is set to 0xFF.
+    void init(Event* event) const;
+};
+
+// Create a schema for an event with fields.
+template <size_t N>
+constexpr EventSchema eventSchema(const char* name, SubSystem subsystem, uint8_t id,
+        const EventField (&fields)[N]) {
+    return {name, fields, N, (uint8_t)subsystem, id};
+}
+
+// Create a schema for an event with no fields.
+constexpr EventSchema eventSchema(const char* name, SubSystem subsystem, uint8_t id) {
+    return {name, nullptr, 0, (uint8_t)subsystem, id};
+}
+
+// A library's table of event schemas. Each library that defines events
+// creates one static table in its sources. Tables link themselves into a
+// global list on construction so lookups see every linked library.
+class EventSchemaTable {
+    public:
+        template <size_t N>
+        EventSchemaTable(const EventSchema (&schemas)[N]) : EventSchemaTable(schemas, N) {}
+        EventSchemaTable(const EventSchema* schemas, size_t size);
+
+        // Return the schema for an event or nullptr if none is defined.
+        static const EventSchema* find(uint8_t subsystem, uint8_t id);
+        static const EventSchema* find(const Event& event) {
+            return find(event.subsystem, event.id);
+        }
+
+        // Return the schema with the given name or nullptr if none is
+        // defined.
+        static const EventSchema* find(const char* name);
+
+        // Return the number of schemas in all linked tables.
+        static size_t count();
+
+        // Return the schema at index i of all linked tables or nullptr if i
+        // is out of range.
+        static const EventSchema* at(size_t i);
+
+        // Print the event followed by its name and field values in
+        // parentheses if it has a schema.
+        static size_t print(Print& p, const Event& event);
+
+    private:
+        const EventSchema* schemas_;
+        size_t size_;
+        EventSchemaTable* next_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_EVENT_SCHEMA_H_
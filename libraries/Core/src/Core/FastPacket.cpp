@@ -0,0 +1,171 @@
+#include "FastPacket.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+#include <Faker.h>
+#include "Scratch.h"
+
+namespace R51 {
+namespace {
+
+using ::Canny::J1939Message;
+
+// Payload bytes held by frame 0 and by each later frame.
+static const size_t kFirstSize = 6;
+static const size_t kFrameSize = 7;
+
+uint8_t frameCount(uint8_t size) {
+    if (size <= kFirstSize) {
+        return 1;
+    }
+    return 1 + (size - kFirstSize + kFrameSize - 1) / kFrameSize;
+}
+
+}  // namespace
+
+FastPacketAssembler::FastPacketAssembler(uint32_t timeout_ms, Faker::Clock* clock) :
+        clock_(clock), timeout_(timeout_ms), delivered_(nullptr),
+        packet_({0, Canny::NullAddress, 0, nullptr}), stats_({0, 0}) {
+    for (size_t i = 0; i < kSlots; ++i) {
+        slots_[i].active = false;
+    }
+}
+
+bool FastPacketAssembler::add(const J1939Message& msg) {
+    if (delivered_ != nullptr) {
+        delivered_->data.clear();
+        delivered_ = nullptr;
+        packet_.data = nullptr;
+    }
+    if (msg.size() < 2) {
+        return false;
+    }
+    expire();
+
+    uint8_t seq = sequence(msg);
+    uint8_t idx = index(msg);
+    Slot* slot = find(msg.source_address(), msg.pgn(), seq);
+    if (slot != nullptr && idx == 0 && slot->frames != 0) {
+        // the sequence ID was reused before the last payload completed
+        drop(slot);
+        slot = nullptr;
+    }
+    if (slot == nullptr) {
+        slot = open(msg.source_address(), msg.pgn(), seq);
+    }
+    if ((slot->received & (1UL << idx)) != 0) {
+        // duplicate frame
+        return false;
+    }
+
+    size_t offset;
+    size_t count;
+    const uint8_t* src;
+    if (idx == 0) {
+        uint8_t size = msg.data()[1];
+        if (size == 0 || size > kMaxSize) {
+            drop(slot);
+            return false;
+        }
+        slot->size = size;
+        slot->frames = frameCount(size);
+        if (slot->frames < 32 && (slot->received >> slot->frames) != 0) {
+            // frames past the end of the payload arrived first
+            drop(slot);
+            return false;
+        }
+        offset = 0;
+        count = kFirstSize;
+        src = msg.data() + 2;
+    } else {
+        offset = kFirstSize + (idx - 1) * kFrameSize;
+        if (offset >= kMaxSize || (slot->frames != 0 && idx >= slot->frames)) {
+            return false;
+        }
+        count = kFrameSize;
+        src = msg.data() + 1;
+    }
+    if (src + count > msg.data() + msg.size()) {
+        count = msg.data() + msg.size() - src;
+    }
+    size_t limit = slot->frames != 0 ? slot->size : kMaxSize;
+    if (offset + count > limit) {
+        count = limit - offset;
+    }
+    if (!slot->data.reserve(idx == 0 ? slot->size : offset + count)) {
+        drop(slot);
+        return false;
+    }
+    memcpy(slot->data.bytes + offset, src, count);
+    slot->received |= 1UL << idx;
+    slot->updated = clock_->millis();
+
+    if (slot->frames == 0 || slot->received != (0xFFFFFFFFUL >> (32 - slot->frames))) {
+        return false;
+    }
+    slot->data.size = slot->size;
+    slot->active = false;
+    delivered_ = slot;
+    packet_.pgn = slot->pgn;
+    packet_.source_address = slot->source;
+    packet_.sequence = slot->sequence;
+    packet_.data = &slot->data;
+    ++stats_.completed;
+    return true;
+}
+
+FastPacketAssembler::Slot* FastPacketAssembler::find(uint8_t source, uint32_t pgn,
+        uint8_t sequence) {
+    for (size_t i = 0; i < kSlots; ++i) {
+        Slot* slot = &slots_[i];
+        if (slot->active && slot->source == source && slot->pgn == pgn &&
+                slot->sequence == sequence) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+FastPacketAssembler::Slot* FastPacketAssembler::open(uint8_t source, uint32_t pgn,
+        uint8_t sequence) {
+    // Take a free slot or else the one which has waited longest.
+    Slot* slot = nullptr;
+    for (size_t i = 0; i < kSlots; ++i) {
+        if (!slots_[i].active) {
+            slot = &slots_[i];
+            break;
+        }
+        if (slot == nullptr || (int32_t)(slots_[i].updated - slot->updated) < 0) {
+            slot = &slots_[i];
+        }
+    }
+    if (slot->active) {
+        drop(slot);
+    }
+    slot->pgn = pgn;
+    slot->received = 0;
+    slot->updated = clock_->millis();
+    slot->source = source;
+    slot->sequence = sequence;
+    slot->size = 0;
+    slot->frames = 0;
+    slot->active = true;
+    return slot;
+}
+
+void FastPacketAssembler::drop(Slot* slot) {
+    slot->active = false;
+    slot->data.clear();
+    ++stats_.dropped;
+}
+
+void FastPacketAssembler::expire() {
+    uint32_t now = clock_->millis();
+    for (size_t i = 0; i < kSlots; ++i) {
+        if (slots_[i].active && now - slots_[i].updated >= timeout_) {
+            drop(&slots_[i]);
+        }
+    }
+}
+
+}  // namespace R51
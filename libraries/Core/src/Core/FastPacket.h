@@ -0,0 +1,104 @@
+#ifndef _R51_CORE_FAST_PACKET_H_
+#define _R51_CORE_FAST_PACKET_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+#include <Faker.h>
+#include "Scratch.h"
+
+namespace R51 {
+
+// A payload reassembled from NMEA 2000 fast packet frames.
+struct FastPacket {
+    uint32_t pgn;
+    uint8_t source_address;
+    // The 3-bit sequence ID shared by the payload's frames.
+    uint8_t sequence;
+    // The payload bytes.
+    const Scratch* data;
+};
+
+// Counters kept by a FastPacketAssembler.
+struct FastPacketStats {
+    // Payloads delivered.
+    uint32_t completed;
+    // Partial payloads discarded because a frame was lost.
+    uint32_t dropped;
+};
+
+// Reassembles NMEA 2000 fast packets. A fast packet spreads a payload of up
+// to 223 bytes over as many as 32 frames of the same PGN. The first byte of
+// each frame holds a 3-bit sequence ID shared by the payload's frames and a
+// 5-bit frame index. Frame 0 holds the payload size followed by six bytes of
+// payload. The other frames each hold seven.
+//
+// Payloads are keyed by source address, PGN, and sequence ID so several may
+// be in flight at once. Frames are placed by their index so they may arrive
+// in any order; a payload is delivered once every frame has arrived. A
+// partial payload is dropped when a new frame 0 arrives for its key, when it
+// times out, or when its slot is taken by a newer payload.
+//
+// Payloads are held in scratch leases which are returned to the arena as
+// soon as the payload is delivered and the next frame is added.
+class FastPacketAssembler {
+    public:
+        // Number of payloads which may be reassembled at once.
+        static const size_t kSlots = 4;
+
+        // Largest fast packet payload.
+        static const size_t kMaxSize = 223;
+
+        // Construct an assembler. Partial payloads time out after timeout_ms
+        // milliseconds without a new frame.
+        FastPacketAssembler(uint32_t timeout_ms = 750,
+                Faker::Clock* clock = Faker::Clock::real());
+
+        // Add a frame. Returns true if the frame completed a payload. The
+        // payload is then available from packet() until the next call.
+        bool add(const Canny::J1939Message& msg);
+
+        // Return the last completed payload.
+        const FastPacket& packet() const { return packet_; }
+
+        // Return the assembler's counters.
+        const FastPacketStats& stats() const { return stats_; }
+
+        // Return the sequence ID of a fast packet frame.
+        static uint8_t sequence(const Canny::J1939Message& msg) {
+            return msg.data()[0] >> 5;
+        }
+
+        // Return the index of a fast packet frame within its payload.
+        static uint8_t index(const Canny::J1939Message& msg) {
+            return msg.data()[0] & 0x1F;
+        }
+
+    private:
+        struct Slot {
+            Scratch data;
+            uint32_t pgn;
+            uint32_t received;  // Bitmap of received frame indexes.
+            uint32_t updated;
+            uint8_t source;
+            uint8_t sequence;
+            uint8_t size;
+            uint8_t frames;     // Zero until frame 0 arrives.
+            bool active;
+        };
+
+        Faker::Clock* clock_;
+        uint32_t timeout_;
+        Slot slots_[kSlots];
+        Slot* delivered_;
+        FastPacket packet_;
+        FastPacketStats stats_;
+
+        Slot* find(uint8_t source, uint32_t pgn, uint8_t sequence);
+        Slot* open(uint8_t source, uint32_t pgn, uint8_t sequence);
+        void drop(Slot* slot);
+        void expire();
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_FAST_PACKET_H_
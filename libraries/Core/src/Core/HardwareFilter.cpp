@@ -0,0 +1,319 @@
+#include "HardwareFilter.h"
+
+#include <Arduino.h>
+#include "IDFilter.h"
+
+namespace R51 {
+namespace {
+
+// Most ID/mask pairs considered at once.
+static const size_t kMaxTerms = 32;
+
+// Most masks programmed.
+static const size_t kMaxMasks = 32;
+
+// Matches the IDs equal to id in the bits set in mask.
+struct Term {
+    uint32_t id;
+    uint32_t mask;
+    bool ext;
+};
+
+// A mask and the terms which share it.
+struct Group {
+    uint8_t capacity;
+    uint8_t size;
+    uint8_t terms[kMaxTerms];
+    uint32_t mask;
+    bool ext;
+};
+
+uint32_t idBits(bool ext) {
+    return ext ? 0x1FFFFFFF : 0x7FF;
+}
+
+uint8_t popcount(uint32_t value) {
+    uint8_t count = 0;
+    for (; value != 0; value &= value - 1) {
+        ++count;
+    }
+    return count;
+}
+
+// Return the number of IDs matched by a mask.
+uint32_t span(uint32_t mask, bool ext) {
+    return 1UL << ((ext ? 29 : 11) - popcount(mask & idBits(ext)));
+}
+
+Term merge(const Term& a, const Term& b) {
+    uint32_t mask = a.mask & b.mask & ~(a.id ^ b.id);
+    return {a.id & mask, mask, a.ext};
+}
+
+// Add the aligned blocks which cover a range. Falls back to the block which
+// shares the range's common prefix if there is no room. There must be room
+// for at least one term. Returns false if the fallback was used.
+bool addRange(Term* terms, size_t* count, const IDRule& rule) {
+    uint32_t bits = idBits(rule.ext);
+    uint32_t first = rule.id & bits;
+    uint32_t last = rule.arg & bits;
+    if (first > last) {
+        return true;
+    }
+
+    size_t start = *count;
+    uint32_t id = first;
+    while (true) {
+        uint32_t size = 1;
+        while (size <= bits / 2 && (id & (size * 2 - 1)) == 0 &&
+                id + size * 2 - 1 <= last) {
+            size *= 2;
+        }
+        if (*count >= kMaxTerms) {
+            break;
+        }
+        terms[(*count)++] = {id, bits & ~(size - 1), rule.ext};
+        if (id + size - 1 >= last) {
+            return true;
+        }
+        id += size;
+    }
+
+    uint32_t diff = first ^ last;
+    diff |= diff >> 1;
+    diff |= diff >> 2;
+    diff |= diff >> 4;
+    diff |= diff >> 8;
+    diff |= diff >> 16;
+    *count = start;
+    terms[(*count)++] = {first & ~diff, bits & ~diff, rule.ext};
+    return false;
+}
+
+// Merge the pair of terms which widens the accepted IDs the least. Returns
+// false if no terms can be merged.
+bool mergeCheapest(Term* terms, size_t* count, bool* exact) {
+    size_t best_a = 0;
+    size_t best_b = 0;
+    int64_t best_cost = 0;
+    bool found = false;
+    for (size_t a = 0; a < *count; ++a) {
+        for (size_t b = a + 1; b < *count; ++b) {
+            if (terms[a].ext != terms[b].ext) {
+                continue;
+            }
+            Term m = merge(terms[a], terms[b]);
+            int64_t cost = (int64_t)span(m.mask, m.ext) -
+                span(terms[a].mask, terms[a].ext) -
+                span(terms[b].mask, terms[b].ext);
+            if (!found || cost < best_cost) {
+                best_a = a;
+                best_b = b;
+                best_cost = cost;
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    const Term& a = terms[best_a];
+    const Term& b = terms[best_b];
+    Term m = merge(a, b);
+    uint32_t span_m = span(m.mask, m.ext);
+    uint32_t span_a = span(a.mask, a.ext);
+    uint32_t span_b = span(b.mask, b.ext);
+    // A merge is lossless if it covers exactly the two terms or one term
+    // contains the other.
+    if (span_m != span_a + span_b && span_m != span_a && span_m != span_b) {
+        *exact = false;
+    }
+    terms[best_a] = m;
+    terms[best_b] = terms[--(*count)];
+    return true;
+}
+
+// Return the number of distinct filters in a group with the given mask.
+uint8_t distinct(const Term* terms, const uint8_t* indexes, uint8_t size,
+        uint32_t mask, uint32_t* values = nullptr) {
+    uint32_t seen[kMaxTerms];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < size; ++i) {
+        uint32_t value = terms[indexes[i]].id & mask;
+        bool dup = false;
+        for (uint8_t j = 0; j < count; ++j) {
+            if (seen[j] == value) {
+                dup = true;
+                break;
+            }
+        }
+        if (!dup) {
+            seen[count++] = value;
+        }
+    }
+    if (values != nullptr) {
+        memcpy(values, seen, count * sizeof(uint32_t));
+    }
+    return count;
+}
+
+// Return the number of IDs accepted by a group.
+int64_t groupCost(const Term* terms, const uint8_t* indexes, uint8_t size,
+        uint32_t mask, bool ext) {
+    if (size == 0) {
+        return 0;
+    }
+    return (int64_t)distinct(terms, indexes, size, mask) * span(mask, ext);
+}
+
+// Assign terms to groups, narrowest first, choosing the group whose accepted
+// IDs grow the least. Returns false if a term does not fit.
+bool place(const Term* terms, size_t count, Group* groups, size_t group_count) {
+    uint8_t order[kMaxTerms];
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    for (size_t i = 1; i < count; ++i) {
+        for (size_t j = i; j > 0 && popcount(terms[order[j]].mask) >
+                popcount(terms[order[j - 1]].mask); --j) {
+            uint8_t tmp = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const Term& term = terms[order[i]];
+        int best = -1;
+        int64_t best_cost = 0;
+        for (size_t g = 0; g < group_count; ++g) {
+            Group* group = &groups[g];
+            if (group->size > 0 && group->ext != term.ext) {
+                continue;
+            }
+            uint32_t mask = group->size > 0 ? group->mask & term.mask : term.mask;
+            group->terms[group->size] = order[i];
+            uint8_t filters = distinct(terms, group->terms, group->size + 1, mask);
+            if (filters > group->capacity) {
+                continue;
+            }
+            int64_t cost = groupCost(terms, group->terms, group->size + 1, mask, term.ext) -
+                groupCost(terms, group->terms, group->size, group->mask, group->ext);
+            if (best < 0 || cost < best_cost || (cost == best_cost &&
+                    group->capacity - group->size > groups[best].capacity - groups[best].size)) {
+                best = g;
+                best_cost = cost;
+            }
+        }
+        if (best < 0) {
+            return false;
+        }
+        Group* group = &groups[best];
+        group->mask = group->size > 0 ? group->mask & term.mask : term.mask;
+        group->ext = term.ext;
+        group->terms[group->size++] = order[i];
+    }
+    return true;
+}
+
+// Program the controller to accept all frames.
+void openAll(FilterRegisters* regs, size_t group_count) {
+    bool ext = false;
+    for (size_t g = 0; g < group_count; ++g) {
+        regs->setMask(g, false, 0);
+        for (uint8_t f = 0; f < regs->filterCount(g); ++f) {
+            regs->setFilter(g, f, ext, 0);
+            ext = !ext;
+        }
+    }
+}
+
+}  // namespace
+
+bool programFilters(const IDRule* rules, size_t count, FilterRegisters* regs) {
+    size_t group_count = regs->maskCount();
+    if (group_count > kMaxMasks) {
+        group_count = kMaxMasks;
+    }
+    size_t capacity = 0;
+    Group groups[kMaxMasks];
+    for (size_t g = 0; g < group_count; ++g) {
+        groups[g].capacity = regs->filterCount(g);
+        if (groups[g].capacity > kMaxTerms) {
+            groups[g].capacity = kMaxTerms;
+        }
+        capacity += groups[g].capacity;
+    }
+
+    Term terms[kMaxTerms];
+    size_t term_count = 0;
+    bool exact = true;
+    for (size_t i = 0; i < count; ++i) {
+        const IDRule& rule = rules[i];
+        if (term_count >= kMaxTerms && !mergeCheapest(terms, &term_count, &exact)) {
+            openAll(regs, group_count);
+            return false;
+        }
+        if (rule.type == IDRuleType::RANGE) {
+            if (!addRange(terms, &term_count, rule)) {
+                exact = false;
+            }
+            continue;
+        }
+        uint32_t bits = idBits(rule.ext);
+        terms[term_count++] = {rule.id & rule.arg & bits, rule.arg & bits, rule.ext};
+    }
+    if (term_count == 0) {
+        openAll(regs, group_count);
+        return false;
+    }
+
+    while (term_count > capacity) {
+        if (!mergeCheapest(terms, &term_count, &exact)) {
+            openAll(regs, group_count);
+            return false;
+        }
+    }
+    while (true) {
+        for (size_t g = 0; g < group_count; ++g) {
+            groups[g].size = 0;
+            groups[g].mask = 0;
+            groups[g].ext = false;
+        }
+        if (place(terms, term_count, groups, group_count)) {
+            break;
+        }
+        if (!mergeCheapest(terms, &term_count, &exact)) {
+            openAll(regs, group_count);
+            return false;
+        }
+    }
+
+    for (size_t g = 0; g < group_count; ++g) {
+        Group* group = &groups[g];
+        if (group->size == 0) {
+            // Unused groups match a single ID which is already accepted.
+            regs->setMask(g, terms[0].ext, idBits(terms[0].ext));
+            for (uint8_t f = 0; f < group->capacity; ++f) {
+                regs->setFilter(g, f, terms[0].ext, terms[0].id);
+            }
+            continue;
+        }
+        for (uint8_t i = 0; i < group->size; ++i) {
+            if (terms[group->terms[i]].mask != group->mask) {
+                exact = false;
+            }
+        }
+        uint32_t values[kMaxTerms];
+        uint8_t filters = distinct(terms, group->terms, group->size, group->mask, values);
+        regs->setMask(g, group->ext, group->mask);
+        for (uint8_t f = 0; f < group->capacity; ++f) {
+            // Spare filters repeat the first so they do not match other IDs.
+            regs->setFilter(g, f, group->ext, values[f < filters ? f : 0]);
+        }
+    }
+    return exact;
+}
+
+}  // namespace R51
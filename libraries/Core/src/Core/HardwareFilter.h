@@ -0,0 +1,95 @@
+#ifndef _R51_CORE_HARDWARE_FILTER_H_
+#define _R51_CORE_HARDWARE_FILTER_H_
+
+#include <Arduino.h>
+#include "IDFilter.h"
+
+namespace R51 {
+
+// The acceptance mask and filter registers of a CAN controller. Filters are
+// grouped by the mask they share. A frame is accepted if it matches any
+// filter in any group.
+class FilterRegisters {
+    public:
+        virtual ~FilterRegisters() = default;
+
+        // Return the number of masks.
+        virtual uint8_t maskCount() const = 0;
+
+        // Return the number of filters which share the given mask.
+        virtual uint8_t filterCount(uint8_t mask) const = 0;
+
+        // Set a mask. Bits set in the mask are compared against the filters
+        // which share it.
+        virtual void setMask(uint8_t mask, bool ext, uint32_t value) = 0;
+
+        // Set a filter within a mask's group. The filter only matches
+        // extended IDs if ext is true and only standard IDs otherwise.
+        virtual void setFilter(uint8_t mask, uint8_t filter, bool ext, uint32_t value) = 0;
+};
+
+// Program a controller's registers to accept the IDs matched by the rules.
+// Rules which do not fit are widened and merged so that the controller
+// accepts a superset of the IDs; the caller filters the rest in software.
+// Returns true if the controller accepts exactly the rule IDs. If the rules
+// cannot be fit at all the controller is opened to accept all frames and
+// false is returned.
+bool programFilters(const IDRule* rules, size_t count, FilterRegisters* regs);
+
+template <size_t N>
+bool programFilters(const IDRule (&rules)[N], FilterRegisters* regs) {
+    return programFilters(rules, N, regs);
+}
+
+// Filter registers of an MCP2515 driven through Canny. Mask 0 is shared by
+// filters 0 and 1 on RX buffer 0. Mask 1 is shared by filters 2 through 5 on
+// RX buffer 1.
+template <typename Controller>
+class MCP2515Filters : public FilterRegisters {
+    public:
+        MCP2515Filters(Controller* controller) : controller_(controller) {}
+
+        uint8_t maskCount() const override { return 2; }
+
+        uint8_t filterCount(uint8_t mask) const override {
+            return mask == 0 ? 2 : 4;
+        }
+
+        void setMask(uint8_t mask, bool ext, uint32_t value) override {
+            controller_->setMask(mask, ext, value);
+        }
+
+        void setFilter(uint8_t mask, uint8_t filter, bool ext, uint32_t value) override {
+            controller_->setFilter(mask == 0 ? filter : 2 + filter, ext, value);
+        }
+
+    private:
+        Controller* controller_;
+};
+
+// Filter registers of an MCP2518 driven through Canny. Each of the N filter
+// objects has its own mask; mask n is paired with filter n.
+template <typename Controller, uint8_t N = 8>
+class MCP2518Filters : public FilterRegisters {
+    public:
+        MCP2518Filters(Controller* controller) : controller_(controller) {}
+
+        uint8_t maskCount() const override { return N; }
+
+        uint8_t filterCount(uint8_t) const override { return 1; }
+
+        void setMask(uint8_t mask, bool ext, uint32_t value) override {
+            controller_->setMask(mask, ext, value);
+        }
+
+        void setFilter(uint8_t mask, uint8_t, bool ext, uint32_t value) override {
+            controller_->setFilter(mask, ext, value);
+        }
+
+    private:
+        Controller* controller_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_HARDWARE_FILTER_H_
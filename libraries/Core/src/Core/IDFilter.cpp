@@ -0,0 +1,87 @@
+#include "IDFilter.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+bool IDRule::match(uint32_t id, bool ext) const {
+    if (ext != this->ext) {
+        return false;
+    }
+    switch (type) {
+        case IDRuleType::MASK:
+            return (id & arg) == (this->id & arg);
+        case IDRuleType::RANGE:
+            return id >= this->id && id <= arg;
+    }
+    return false;
+}
+
+IDFilter::IDFilter(bool accept) {
+    reset(accept);
+}
+
+void IDFilter::reset(bool accept) {
+    memset(std_, accept ? 0xFF : 0x00, sizeof(std_));
+    ext_count_ = 0;
+    accept_ = accept;
+}
+
+bool IDFilter::allow(const IDRule& rule) {
+    return apply(rule, true);
+}
+
+bool IDFilter::drop(const IDRule& rule) {
+    return apply(rule, false);
+}
+
+bool IDFilter::match(uint32_t id, bool ext) const {
+    if (!ext) {
+        id &= 0x7FF;
+        return (std_[id >> 3] & (1 << (id & 0x07))) != 0;
+    }
+    for (size_t i = ext_count_; i > 0; --i) {
+        if (ext_[i - 1].match(id, true)) {
+            return ext_allow_[i - 1];
+        }
+    }
+    return accept_;
+}
+
+bool IDFilter::apply(const IDRule& rule, bool allow) {
+    if (!rule.ext) {
+        for (uint32_t id = 0; id < 2048; ++id) {
+            if (rule.match(id, false)) {
+                if (allow) {
+                    std_[id >> 3] |= (1 << (id & 0x07));
+                } else {
+                    std_[id >> 3] &= ~(1 << (id & 0x07));
+                }
+            }
+        }
+        return true;
+    }
+
+    // Replace an identical rule so that toggling an ID does not use up room.
+    for (size_t i = 0; i < ext_count_; ++i) {
+        if (ext_[i].type == rule.type && ext_[i].id == rule.id &&
+                ext_[i].arg == rule.arg) {
+            for (; i + 1 < ext_count_; ++i) {
+                ext_[i] = ext_[i + 1];
+                ext_allow_[i] = ext_allow_[i + 1];
+            }
+            --ext_count_;
+            break;
+        }
+    }
+    if (ext_count_ >= kMaxExtRules) {
+        return false;
+    }
+    ext_[ext_count_] = rule;
+    ext_allow_[ext_count_] = allow;
+    ++ext_count_;
+    return true;
+}
+
+}  // namespace R51
@@ -0,0 +1,110 @@
+#ifndef _R51_CORE_ID_FILTER_H_
+#define _R51_CORE_ID_FILTER_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+// How an IDRule matches frame IDs.
+enum class IDRuleType : uint8_t {
+    MASK    = 0,    // Match IDs equal to id in the bits set in mask.
+    RANGE   = 1,    // Match IDs from id through last, inclusive.
+};
+
+// Matches a set of standard or extended CAN frame IDs. Rules are built with
+// the functions below so that fixed filters may be declared at compile time.
+struct IDRule {
+    uint32_t id;
+    uint32_t arg;   // The mask or last ID, depending on type.
+    IDRuleType type;
+    bool ext;
+
+    // Return true if the rule matches the ID.
+    bool match(uint32_t id, bool ext) const;
+};
+
+// Match a standard ID or, with a mask, the standard IDs equal to id in the
+// masked bits.
+constexpr IDRule stdID(uint32_t id, uint32_t mask = 0x7FF) {
+    return {id & 0x7FF, mask & 0x7FF, IDRuleType::MASK, false};
+}
+
+// Match a range of standard IDs.
+constexpr IDRule stdRange(uint32_t first, uint32_t last) {
+    return {first & 0x7FF, last & 0x7FF, IDRuleType::RANGE, false};
+}
+
+// Match an extended ID or, with a mask, the extended IDs equal to id in the
+// masked bits.
+constexpr IDRule extID(uint32_t id, uint32_t mask = 0x1FFFFFFF) {
+    return {id & 0x1FFFFFFF, mask & 0x1FFFFFFF, IDRuleType::MASK, true};
+}
+
+// Match a range of extended IDs.
+constexpr IDRule extRange(uint32_t first, uint32_t last) {
+    return {first & 0x1FFFFFFF, last & 0x1FFFFFFF, IDRuleType::RANGE, true};
+}
+
+// Accepts or rejects CAN frames by ID. Standard IDs are looked up in a 2048
+// bit map so the cost of a match does not depend on the number of rules.
+// Extended IDs are matched against a short list of rules; the most recently
+// added rule which matches an ID decides it. IDs which match no rule are
+// accepted or rejected according to the filter's default.
+class IDFilter {
+    public:
+        // Maximum number of extended ID rules.
+        static const size_t kMaxExtRules = 8;
+
+        // Construct a filter which accepts all frames if accept is true or
+        // rejects all frames otherwise.
+        IDFilter(bool accept = false);
+
+        // Construct a filter which accepts only the frames matched by the
+        // given rules.
+        template <size_t N>
+        IDFilter(const IDRule (&rules)[N]) : IDFilter(false) {
+            for (size_t i = 0; i < N; ++i) {
+                allow(rules[i]);
+            }
+        }
+
+        // Remove all rules and accept all frames if accept is true or reject
+        // all frames otherwise.
+        void reset(bool accept);
+
+        // Accept the IDs matched by the rule. Returns false if the rule is
+        // for extended IDs and there is no room left for it.
+        bool allow(const IDRule& rule);
+
+        // Reject the IDs matched by the rule. Returns false if the rule is
+        // for extended IDs and there is no room left for it.
+        bool drop(const IDRule& rule);
+
+        // Return true if a frame with the given ID is accepted.
+        bool match(uint32_t id, bool ext) const;
+
+        // Return true if the frame is accepted.
+        bool match(const Canny::CAN20Frame& frame) const {
+            return match(frame.id(), frame.ext());
+        }
+
+        // Return true if IDs which match no rule are accepted.
+        bool accept() const { return accept_; }
+
+        // Return the number of extended ID rules.
+        size_t ext_count() const { return ext_count_; }
+
+    private:
+        uint8_t std_[2048 / 8];
+        IDRule ext_[kMaxExtRules];
+        bool ext_allow_[kMaxExtRules];
+        size_t ext_count_;
+        bool accept_;
+
+        bool apply(const IDRule& rule, bool allow);
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_ID_FILTER_H_
@@ -0,0 +1,309 @@
+#include "IsoTP.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+#include <Faker.h>
+
+namespace R51 {
+namespace {
+
+using ::Canny::CAN20Frame;
+
+// Protocol control information frame types.
+static const uint8_t kSingleFrame = 0x00;
+static const uint8_t kFirstFrame = 0x10;
+static const uint8_t kConsecutiveFrame = 0x20;
+static const uint8_t kFlowControl = 0x30;
+
+// Flow status values.
+static const uint8_t kContinue = 0x00;
+static const uint8_t kWait = 0x01;
+static const uint8_t kOverflow = 0x02;
+static const uint8_t kNoControl = 0xFF;
+
+// Unused bytes are padded.
+static const uint8_t kPadding = 0xFF;
+
+static const size_t kSingleSize = 7;
+static const size_t kFirstSize = 6;
+static const size_t kConsecutiveSize = 7;
+
+// Return the STmin in milliseconds. Sub-millisecond values are rounded up
+// and reserved values are treated as the maximum as required by the spec.
+uint32_t decodeStMin(uint8_t st_min) {
+    if (st_min <= 0x7F) {
+        return st_min;
+    }
+    if (st_min >= 0xF1 && st_min <= 0xF9) {
+        return 1;
+    }
+    return 0x7F;
+}
+
+bool expired(uint32_t now, uint32_t deadline) {
+    return (int32_t)(now - deadline) > 0;
+}
+
+}  // namespace
+
+IsoTP::IsoTP(uint32_t tx_id, uint32_t rx_id, uint8_t block_size, uint8_t st_min,
+        Faker::Clock* clock) :
+        tx_id_(tx_id), rx_id_(rx_id), block_size_(block_size), st_min_(st_min),
+        clock_(clock), rx_deadline_(0), rx_size_(0), rx_offset_(0), rx_seq_(0),
+        rx_block_(0), rx_active_(false), tx_deadline_(0), tx_ready_(0),
+        tx_st_min_(0), tx_offset_(0), tx_seq_(0), tx_block_(0),
+        tx_state_(TxState::IDLE), control_(kNoControl),
+        pending_control_(kNoControl), pending_(Pending::NONE),
+        stats_({0, 0, 0, 0}) {}
+
+bool IsoTP::receive(const CAN20Frame& frame) {
+    if (frame.id() != rx_id_ || frame.size() < 1) {
+        return false;
+    }
+    switch (frame.data()[0] & 0xF0) {
+        case kSingleFrame:
+            return receiveSingle(frame);
+        case kFirstFrame:
+            receiveFirst(frame);
+            return false;
+        case kConsecutiveFrame:
+            return receiveConsecutive(frame);
+        case kFlowControl:
+            receiveFlowControl(frame);
+            return false;
+        default:
+            return false;
+    }
+}
+
+bool IsoTP::receiveSingle(const CAN20Frame& frame) {
+    size_t size = frame.data()[0] & 0x0F;
+    if (size == 0 || size > kSingleSize || size >= frame.size()) {
+        return false;
+    }
+    // A new payload replaces one being reassembled.
+    if (rx_active_) {
+        abortReceive();
+    }
+    if (!rx_data_.reserve(size)) {
+        ++stats_.aborted;
+        return false;
+    }
+    memcpy(rx_data_.bytes, frame.data() + 1, size);
+    rx_data_.size = size;
+    ++stats_.received;
+    return true;
+}
+
+void IsoTP::receiveFirst(const CAN20Frame& frame) {
+    if (frame.size() < 8) {
+        return;
+    }
+    size_t size = ((frame.data()[0] & 0x0F) << 8) | frame.data()[1];
+    if (size <= kSingleSize) {
+        return;
+    }
+    if (rx_active_) {
+        abortReceive();
+    }
+    if (size > kScratchCapacity || !rx_data_.reserve(size)) {
+        control_ = kOverflow;
+        ++stats_.aborted;
+        return;
+    }
+    memcpy(rx_data_.bytes, frame.data() + 2, kFirstSize);
+    rx_data_.size = 0;
+    rx_size_ = size;
+    rx_offset_ = kFirstSize;
+    rx_seq_ = 1;
+    rx_block_ = block_size_;
+    rx_active_ = true;
+    rx_deadline_ = clock_->millis() + kTimeout;
+    control_ = kContinue;
+}
+
+bool IsoTP::receiveConsecutive(const CAN20Frame& frame) {
+    if (!rx_active_ || frame.size() < 2) {
+        return false;
+    }
+    if ((frame.data()[0] & 0x0F) != rx_seq_) {
+        abortReceive();
+        return false;
+    }
+
+    size_t count = rx_size_ - rx_offset_;
+    if (count > kConsecutiveSize) {
+        count = kConsecutiveSize;
+    }
+    if (count >= frame.size()) {
+        abortReceive();
+        return false;
+    }
+    memcpy(rx_data_.bytes + rx_offset_, frame.data() + 1, count);
+    rx_offset_ += count;
+    rx_seq_ = (rx_seq_ + 1) & 0x0F;
+
+    if (rx_offset_ >= rx_size_) {
+        rx_active_ = false;
+        rx_data_.size = rx_size_;
+        ++stats_.received;
+        return true;
+    }
+    if (block_size_ != 0 && --rx_block_ == 0) {
+        rx_block_ = block_size_;
+        control_ = kContinue;
+    }
+    rx_deadline_ = clock_->millis() + kTimeout;
+    return false;
+}
+
+void IsoTP::receiveFlowControl(const CAN20Frame& frame) {
+    if (tx_state_ != TxState::WAIT_FC || frame.size() < 3) {
+        return;
+    }
+    uint32_t now = clock_->millis();
+    switch (frame.data()[0] & 0x0F) {
+        case kContinue:
+            tx_block_ = frame.data()[1];
+            tx_st_min_ = decodeStMin(frame.data()[2]);
+            tx_ready_ = now;
+            tx_state_ = TxState::SEND;
+            break;
+        case kWait:
+            tx_deadline_ = now + kTimeout;
+            break;
+        default:
+            tx_state_ = TxState::IDLE;
+            tx_data_.clear();
+            ++stats_.aborted;
+            break;
+    }
+}
+
+bool IsoTP::send(const uint8_t* data, size_t size) {
+    if (tx_state_ != TxState::IDLE || size == 0 || size > kScratchCapacity ||
+            !tx_data_.reserve(size)) {
+        return false;
+    }
+    memcpy(tx_data_.bytes, data, size);
+    tx_data_.size = size;
+    tx_offset_ = 0;
+    tx_seq_ = 0;
+    tx_ready_ = clock_->millis();
+    tx_state_ = TxState::SEND;
+    return true;
+}
+
+bool IsoTP::next(CAN20Frame* frame) {
+    if (pending_ == Pending::NONE) {
+        expire();
+        if (control_ != kNoControl) {
+            pending_ = Pending::CONTROL;
+            pending_control_ = control_;
+        } else if (tx_state_ == TxState::SEND &&
+                (int32_t)(clock_->millis() - tx_ready_) >= 0) {
+            pending_ = Pending::DATA;
+        }
+    }
+    switch (pending_) {
+        case Pending::CONTROL:
+            fillControl(frame);
+            return true;
+        case Pending::DATA:
+            fillData(frame);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void IsoTP::pop() {
+    // The transfer may have been aborted or replaced since next() returned
+    // its frame. Only advance one which is still waiting on that frame.
+    uint32_t now = clock_->millis();
+    if (pending_ == Pending::CONTROL && control_ == pending_control_) {
+        control_ = kNoControl;
+        if (rx_active_) {
+            rx_deadline_ = now + kTimeout;
+        }
+    } else if (pending_ == Pending::DATA && tx_state_ == TxState::SEND) {
+        if (tx_offset_ == 0 && tx_data_.size <= kSingleSize) {
+            finishSend();
+        } else if (tx_offset_ == 0) {
+            tx_offset_ = kFirstSize;
+            tx_seq_ = 1;
+            tx_state_ = TxState::WAIT_FC;
+            tx_deadline_ = now + kTimeout;
+        } else {
+            tx_offset_ += kConsecutiveSize;
+            tx_seq_ = (tx_seq_ + 1) & 0x0F;
+            if (tx_offset_ >= tx_data_.size) {
+                finishSend();
+            } else if (tx_block_ != 0 && --tx_block_ == 0) {
+                tx_state_ = TxState::WAIT_FC;
+                tx_deadline_ = now + kTimeout;
+            } else {
+                tx_ready_ = now + tx_st_min_;
+            }
+        }
+    }
+    pending_ = Pending::NONE;
+}
+
+void IsoTP::abortReceive() {
+    rx_active_ = false;
+    ++stats_.aborted;
+}
+
+void IsoTP::finishSend() {
+    tx_state_ = TxState::IDLE;
+    tx_data_.clear();
+    ++stats_.sent;
+}
+
+void IsoTP::expire() {
+    uint32_t now = clock_->millis();
+    if (rx_active_ && control_ == kNoControl && expired(now, rx_deadline_)) {
+        rx_active_ = false;
+        ++stats_.timeouts;
+    }
+    if (tx_state_ == TxState::WAIT_FC && expired(now, tx_deadline_)) {
+        tx_state_ = TxState::IDLE;
+        tx_data_.clear();
+        ++stats_.timeouts;
+    }
+}
+
+void IsoTP::fillData(CAN20Frame* frame) const {
+    frame->id(tx_id_, 0);
+    frame->resize(8);
+    memset(frame->data(), kPadding, 8);
+
+    size_t size = tx_data_.size;
+    if (tx_offset_ == 0 && size <= kSingleSize) {
+        frame->data()[0] = kSingleFrame | size;
+        memcpy(frame->data() + 1, tx_data_.bytes, size);
+    } else if (tx_offset_ == 0) {
+        frame->data()[0] = kFirstFrame | ((size >> 8) & 0x0F);
+        frame->data()[1] = size & 0xFF;
+        memcpy(frame->data() + 2, tx_data_.bytes, kFirstSize);
+    } else {
+        size_t count = size - tx_offset_;
+        if (count > kConsecutiveSize) {
+            count = kConsecutiveSize;
+        }
+        frame->data()[0] = kConsecutiveFrame | tx_seq_;
+        memcpy(frame->data() + 1, tx_data_.bytes + tx_offset_, count);
+    }
+}
+
+void IsoTP::fillControl(CAN20Frame* frame) const {
+    frame->id(tx_id_, 0);
+    frame->resize(8);
+    memset(frame->data(), kPadding, 8);
+    frame->data()[0] = kFlowControl | pending_control_;
+    frame->data()[1] = block_size_;
+    frame->data()[2] = st_min_;
+}
+
+}  // namespace R51
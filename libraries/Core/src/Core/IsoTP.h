@@ -0,0 +1,142 @@
+#ifndef _R51_CORE_ISO_TP_H_
+#define _R51_CORE_ISO_TP_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+#include <Faker.h>
+#include "Scratch.h"
+
+namespace R51 {
+
+// Counters kept by an ISO-TP link.
+struct IsoTPStats {
+    // Payloads reassembled.
+    uint32_t received;
+    // Payloads fully sent.
+    uint32_t sent;
+    // Transfers abandoned on a sequence error or refused by either side.
+    uint32_t aborted;
+    // Transfers dropped because the other side stopped responding.
+    uint32_t timeouts;
+};
+
+// An ISO 15765-2 (ISO-TP) link between two standard CAN IDs. Payloads of up
+// to seven bytes are sent in a single frame. Larger payloads are sent as a
+// first frame followed by consecutive frames paced by the receiver's flow
+// control. Segmented payloads sent to us are reassembled and answered with
+// flow control carrying our block size and STmin.
+//
+// One payload may be sent and one received at a time. Payloads are held in
+// scratch leases and so are limited to kScratchCapacity bytes. Larger
+// transfers are refused with an overflow.
+//
+// The link does not write to the bus itself. Frames which are ready to send
+// are returned by next() and must be confirmed with pop() once written.
+class IsoTP {
+    public:
+        // Time to wait for flow control or for the next consecutive frame.
+        static const uint32_t kTimeout = 1000;
+
+        // Construct a link which sends on tx_id and receives on rx_id. Flow
+        // control sent to the other side asks for block_size frames between
+        // flow control frames, or all of them if zero, with st_min between
+        // each frame. STmin is encoded as in ISO 15765-2.
+        IsoTP(uint32_t tx_id, uint32_t rx_id, uint8_t block_size = 0,
+                uint8_t st_min = 0, Faker::Clock* clock = Faker::Clock::real());
+
+        // Return the ID of frames sent by the link.
+        uint32_t txId() const { return tx_id_; }
+
+        // Return the ID of frames received by the link.
+        uint32_t rxId() const { return rx_id_; }
+
+        // Set the block size sent in flow control.
+        void blockSize(uint8_t block_size) { block_size_ = block_size; }
+
+        // Set the STmin sent in flow control.
+        void stMin(uint8_t st_min) { st_min_ = st_min; }
+
+        // Handle a received frame. Returns true if the frame completed a
+        // payload. The payload is then available from payload() until the
+        // next call. Frames with other IDs are ignored.
+        bool receive(const Canny::CAN20Frame& frame);
+
+        // Return the last received payload.
+        const Scratch& payload() const { return rx_data_; }
+
+        // Start sending a payload. The payload is copied. Returns false if
+        // the payload is empty or too large or if a send is in progress.
+        bool send(const uint8_t* data, size_t size);
+
+        // Return true if a send is in progress.
+        bool sending() const { return tx_state_ != TxState::IDLE; }
+
+        // Fill frame with the next frame to write. Returns false if nothing
+        // is due. The same frame is returned until pop() is called. Expires
+        // transfers which have timed out.
+        bool next(Canny::CAN20Frame* frame);
+
+        // Mark the frame returned by next() as written. Does nothing for a
+        // transfer which was aborted since next() was called.
+        void pop();
+
+        // Return the link counters.
+        const IsoTPStats& stats() const { return stats_; }
+
+    private:
+        enum class TxState : uint8_t {
+            IDLE,
+            SEND,       // Sending frames.
+            WAIT_FC,    // Waiting for flow control.
+        };
+
+        enum class Pending : uint8_t {
+            NONE,
+            CONTROL,
+            DATA,
+        };
+
+        const uint32_t tx_id_;
+        const uint32_t rx_id_;
+        uint8_t block_size_;
+        uint8_t st_min_;
+        Faker::Clock* clock_;
+
+        Scratch rx_data_;
+        uint32_t rx_deadline_;
+        uint16_t rx_size_;
+        uint16_t rx_offset_;
+        uint8_t rx_seq_;
+        uint8_t rx_block_;
+        bool rx_active_;
+
+        Scratch tx_data_;
+        uint32_t tx_deadline_;
+        uint32_t tx_ready_;
+        uint32_t tx_st_min_;
+        uint16_t tx_offset_;
+        uint8_t tx_seq_;
+        uint8_t tx_block_;
+        TxState tx_state_;
+
+        // Flow status of the flow control frame to send next, if any.
+        uint8_t control_;
+        // Flow status of the pending flow control frame.
+        uint8_t pending_control_;
+        Pending pending_;
+        IsoTPStats stats_;
+
+        bool receiveSingle(const Canny::CAN20Frame& frame);
+        void receiveFirst(const Canny::CAN20Frame& frame);
+        bool receiveConsecutive(const Canny::CAN20Frame& frame);
+        void receiveFlowControl(const Canny::CAN20Frame& frame);
+        void abortReceive();
+        void finishSend();
+        void expire();
+        void fillData(Canny::CAN20Frame* frame) const;
+        void fillControl(Canny::CAN20Frame* frame) const;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_ISO_TP_H_
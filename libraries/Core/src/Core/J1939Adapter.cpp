@@ -13,6 +13,13 @@ using ::Caster::Yield;
 
 J1939Adapter::J1939Adapter() : j1939_(0xFF00, Canny::NullAddress) {}
 
+void J1939Adapter::subscribe(Subscription* sub) {
+    sub->j1939Claim();
+    sub->all(Message::EVENT);
+    sub->j1939Message(0xEF00);
+    sub->j1939Message(0xFF00);
+}
+
 void J1939Adapter::handle(const Message& msg, const Yield<Message>& yield) {
     switch (msg.type()) {
         case Message::J1939_CLAIM:
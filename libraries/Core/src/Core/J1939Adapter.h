@@ -6,6 +6,7 @@
 #include <Caster.h>
 #include "Event.h"
 #include "Message.h"
+#include "Subscription.h"
 
 namespace R51 {
 
@@ -13,11 +14,15 @@ namespace R51 {
 // at the controller are translated to events. The node does not operate until
 // a source address has been claimed. Incoming messages must be of PGN 0xFF00.
 // Outgoing messages have a PGN of 0xEF00.
-class J1939Adapter : public Caster::Node<Message> {
+class J1939Adapter : public Caster::Node<Message>, public Subscriber {
     public:
         J1939Adapter();
         virtual ~J1939Adapter() = default;
 
+        // Subscribe to address claims, all events, and J1939 messages which
+        // may contain events.
+        void subscribe(Subscription* sub) override;
+
         // Translate Events to and from J1939 messages.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
@@ -0,0 +1,134 @@
+#include "J1939AddressMap.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+using ::Canny::NullAddress;
+
+J1939AddressMap::J1939AddressMap() {
+    clear();
+}
+
+void J1939AddressMap::clear() {
+    for (size_t i = 0; i < kCapacity; ++i) {
+        nodes_[i].name = 0;
+        nodes_[i].address = NullAddress;
+    }
+    memset(index_, kNone, sizeof(index_));
+    size_ = 0;
+}
+
+bool J1939AddressMap::claim(uint8_t address, uint64_t name, uint64_t* displaced) {
+    if (address > NullAddress) {
+        return false;
+    }
+
+    size_t slot = find(name);
+    if (address == NullAddress) {
+        // the node could not claim an address
+        if (slot == kCapacity) {
+            return false;
+        }
+        remove(slot);
+        return true;
+    }
+    if (slot != kCapacity && nodes_[slot].address == address) {
+        return false;
+    }
+
+    bool changed = false;
+    uint8_t holder = index_[address];
+    if (holder != kNone) {
+        // the address moves to the new node
+        if (displaced != nullptr) {
+            *displaced = nodes_[holder].name;
+        }
+        remove(holder);
+        slot = find(name);
+        changed = true;
+    }
+
+    if (slot != kCapacity) {
+        // the node moved to a new address
+        index_[nodes_[slot].address] = kNone;
+        nodes_[slot].address = address;
+        index_[address] = slot;
+        return true;
+    }
+
+    if (size_ >= kCapacity) {
+        return changed;
+    }
+    slot = home(name);
+    while (nodes_[slot].address != NullAddress) {
+        slot = (slot + 1) & (kCapacity - 1);
+    }
+    nodes_[slot].name = name;
+    nodes_[slot].address = address;
+    index_[address] = slot;
+    ++size_;
+    return true;
+}
+
+uint8_t J1939AddressMap::address(uint64_t name) const {
+    size_t slot = find(name);
+    return slot == kCapacity ? NullAddress : nodes_[slot].address;
+}
+
+uint64_t J1939AddressMap::name(uint8_t address) const {
+    if (address >= NullAddress || index_[address] == kNone) {
+        return 0;
+    }
+    return nodes_[index_[address]].name;
+}
+
+size_t J1939AddressMap::home(uint64_t name) {
+    uint32_t hash = (uint32_t)name ^ (uint32_t)(name >> 32);
+    hash ^= hash >> 16;
+    hash ^= hash >> 8;
+    return hash & (kCapacity - 1);
+}
+
+size_t J1939AddressMap::find(uint64_t name) const {
+    size_t slot = home(name);
+    for (size_t i = 0; i < kCapacity; ++i) {
+        if (nodes_[slot].address == NullAddress) {
+            break;
+        }
+        if (nodes_[slot].name == name) {
+            return slot;
+        }
+        slot = (slot + 1) & (kCapacity - 1);
+    }
+    return kCapacity;
+}
+
+void J1939AddressMap::remove(size_t slot) {
+    index_[nodes_[slot].address] = kNone;
+    nodes_[slot].address = NullAddress;
+    --size_;
+
+    // Shift later nodes in the probe sequence back into the hole so that
+    // lookups need no tombstones.
+    size_t next = slot;
+    while (true) {
+        next = (next + 1) & (kCapacity - 1);
+        if (nodes_[next].address == NullAddress) {
+            break;
+        }
+        size_t want = home(nodes_[next].name);
+        bool between = slot <= next ? (slot < want && want <= next) :
+            (slot < want || want <= next);
+        if (between) {
+            continue;
+        }
+        nodes_[slot] = nodes_[next];
+        index_[nodes_[slot].address] = slot;
+        nodes_[next].address = NullAddress;
+        slot = next;
+    }
+}
+
+}  // namespace R51
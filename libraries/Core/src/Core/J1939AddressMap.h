@@ -0,0 +1,63 @@
+#ifndef _R51_CORE_J1939_ADDRESS_MAP_H_
+#define _R51_CORE_J1939_ADDRESS_MAP_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+// Maps the NAME of each node on a J1939 network to its claimed address. The
+// map is built from address claims and answers lookups by NAME or by address
+// in constant time.
+//
+// Nodes are held in a fixed open addressed table keyed by NAME. Claims from
+// new nodes are ignored once kCapacity nodes are known.
+class J1939AddressMap {
+    public:
+        // Maximum number of nodes held by the map. Must be a power of two.
+        static const size_t kCapacity = 32;
+
+        // Construct an empty map.
+        J1939AddressMap();
+
+        // Record an address claim. A node which claims an address held by
+        // another node displaces that node, whose NAME is written to
+        // displaced if not null. A claim for the null address removes the
+        // node from the map. Returns true if the map changed.
+        bool claim(uint8_t address, uint64_t name, uint64_t* displaced = nullptr);
+
+        // Return the address claimed by the node with the given NAME or
+        // Canny::NullAddress if the node is not known.
+        uint8_t address(uint64_t name) const;
+
+        // Return the NAME of the node which holds the given address or 0 if
+        // the address is not claimed.
+        uint64_t name(uint8_t address) const;
+
+        // Return the number of nodes in the map.
+        size_t size() const { return size_; }
+
+        // Remove all nodes from the map.
+        void clear();
+
+    private:
+        static const uint8_t kNone = 0xFF;
+        static const size_t kAddresses = Canny::NullAddress;
+
+        struct Node {
+            uint64_t name;
+            uint8_t address;
+        };
+
+        Node nodes_[kCapacity];
+        uint8_t index_[kAddresses];
+        size_t size_;
+
+        static size_t home(uint64_t name);
+        size_t find(uint64_t name) const;
+        void remove(size_t slot);
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_J1939_ADDRESS_MAP_H_
@@ -41,4 +41,16 @@ bool operator!=(const J1939Claim& left, const J1939Claim& right) {
     return left.address() != right.address() || left.name() != right.name();
 }
 
+size_t J1939Address::printTo(Print& p) const {
+    return p.print(address_, HEX) + p.print(":") + printHexUint64(p, name_);
+}
+
+bool operator==(const J1939Address& left, const J1939Address& right) {
+    return left.address() == right.address() && left.name() == right.name();
+}
+
+bool operator!=(const J1939Address& left, const J1939Address& right) {
+    return left.address() != right.address() || left.name() != right.name();
+}
+
 }  // namespace R51
@@ -27,6 +27,29 @@ class J1939Claim {
 bool operator==(const J1939Claim& left, const J1939Claim& right);
 bool operator!=(const J1939Claim& left, const J1939Claim& right);
 
+// The address of another node on the network. Emitted to the bus when a node
+// claims a new address or loses its address. The address is
+// Canny::NullAddress if the node no longer holds an address.
+class J1939Address {
+    public:
+        J1939Address() : address_(Canny::NullAddress), name_(0) {}
+        J1939Address(uint8_t address, uint64_t name) : address_(address), name_(name) {}
+
+        uint8_t address() const { return address_; }
+        void address(uint8_t address) { address_ = address; }
+
+        uint64_t name() const { return name_; }
+        void name(uint64_t name) { name_ = name; }
+
+        size_t printTo(Print& p) const;
+    private:
+        uint8_t address_;
+        uint64_t name_;
+};
+
+bool operator==(const J1939Address& left, const J1939Address& right);
+bool operator!=(const J1939Address& left, const J1939Address& right);
+
 }  // namespace R51
 
 #endif  // _R51_CORE_J1939_CLAIM_H_
@@ -16,7 +16,7 @@ using ::Canny::j1939_name_arbitrary_address;
 using ::Caster::Yield;
 
 bool isAddressClaim(const J1939Message& msg) {
-    return msg.pdu_format() == 0xEA;
+    return msg.pdu_format() == 0xEE;
 }
 
 bool isRequestAddressClaim(const J1939Message& msg, uint8_t address) {
@@ -29,16 +29,34 @@ bool isRequestAddressClaim(const J1939Message& msg, uint8_t address) {
 void J1939Gateway::init(const Caster::Yield<Message>& yield) {
     if (name_ != 0) {
         writeClaim();
+        writeClaimRequest();
     }
     emitEvent(yield);
 }
 
-void J1939Gateway::handle(const Message& msg, const Yield<Message>&) {
-    if (msg.type() == Message::J1939_MESSAGE &&
-        (promiscuous_ || (msg.j1939_message()->source_address() == address_ &&
-                          address_ != NullAddress))) {
-        write(*msg.j1939_message());
+void J1939Gateway::subscribe(Subscription* sub) {
+    sub->all(Message::J1939_MESSAGE);
+    sub->all(Message::J1939_TRANSFER);
+}
+
+void J1939Gateway::handle(const Message& msg, const Yield<Message>& yield) {
+    switch (msg.type()) {
+        case Message::J1939_MESSAGE:
+            if (promiscuous_ || (msg.j1939_message()->source_address() == address_ &&
+                                 address_ != NullAddress)) {
+                send(*msg.j1939_message());
+            }
+            break;
+        case Message::J1939_TRANSFER:
+            if (promiscuous_ || (msg.j1939_transfer()->source_address() == address_ &&
+                                 address_ != NullAddress)) {
+                writeTransfer(*msg.j1939_transfer());
+            }
+            break;
+        default:
+            return;
     }
+    updateTxState(yield);
 }
 
 void J1939Gateway::handleAddressClaim(const J1939Message& msg,
@@ -76,16 +94,47 @@ void J1939Gateway::handleAddressClaim(const J1939Message& msg,
     }
 }
 
-void J1939Gateway::emit(const Yield<Message>& yield) {
-    // read a message off the J1939 bus
-    Error err = can_->read(&msg_);
-    if (err == ERR_FIFO)  {
+void J1939Gateway::updateAddress(const J1939Message& msg,
+        const Yield<Message>& yield) {
+    uint64_t name = msg.name();
+    if (name_ != 0 && name == name_) {
+        // our own claim looped back
         return;
-    } else if (err != ERR_OK) {
-        onReadError(err);
+    }
+
+    uint64_t displaced = name;
+    if (!addresses_.claim(msg.source_address(), name, &displaced)) {
         return;
     }
+    if (displaced != name) {
+        J1939Address lost(NullAddress, displaced);
+        yield(MessageView(&lost));
+    }
+    J1939Address node(msg.source_address(), name);
+    yield(MessageView(&node));
+}
+
+void J1939Gateway::emit(const Yield<Message>& yield) {
+    burst_.begin();
+    while (burst_.more()) {
+        // read a message off the J1939 bus
+        Error err = can_->read(&msg_);
+        if (err != ERR_OK) {
+            if (err != ERR_FIFO) {
+                onReadError(err);
+            }
+            break;
+        }
+        burst_.read();
+        emitMessage(yield);
+    }
+    burst_.end();
+    flush();
+    writeTransport();
+    updateTxState(yield);
+}
 
+void J1939Gateway::emitMessage(const Yield<Message>& yield) {
     // handle address claim if configured
     if (name_ != 0) {
         if (isAddressClaim(msg_) && msg_.source_address() == address_) {
@@ -95,6 +144,17 @@ void J1939Gateway::emit(const Yield<Message>& yield) {
         }
     }
 
+    // track the addresses of other nodes
+    if (isAddressClaim(msg_) && msg_.size() == 8) {
+        updateAddress(msg_, yield);
+    }
+
+    // reassemble transport protocol sessions
+    if (J1939Transport::match(msg_)) {
+        transport_.receive(msg_, address_, promiscuous_, yield);
+        return;
+    }
+
     // broadcast it on the internal bus
     if (promiscuous_ || msg_.dest_address() == address_ || msg_.broadcast()) {
         yield(MessageView(&msg_));
@@ -106,17 +166,106 @@ void J1939Gateway::emitEvent(const Yield<Message>& yield) {
     yield(MessageView(&claim));
 }
 
-void J1939Gateway::write(const J1939Message& msg) {
+void J1939Gateway::send(const J1939Message& msg) {
+    J1939Message shed;
+    bool coalesce = coalesce_ != nullptr && coalesce_->match(msg.id(), true);
+    if (!tx_.push(msg, clock_->millis() + write_timeout_, coalesce, &shed)) {
+        onWriteError(ERR_FIFO, shed);
+    }
+    flush();
+}
+
+void J1939Gateway::flush() {
+    J1939Message expired;
+    while (tx_.expire(clock_->millis(), &expired)) {
+        onWriteError(ERR_FIFO, expired);
+    }
+
+    // Frames stay queued while the connection's write buffer is full. Frames
+    // which fail for other reasons are dropped.
+    while (!tx_.empty()) {
+        Error err = can_->write(*tx_.peek());
+        if (err == ERR_FIFO) {
+            break;
+        }
+        if (err != ERR_OK) {
+            onWriteError(err, *tx_.peek());
+        }
+        tx_.pop(err == ERR_OK);
+    }
+}
+
+void J1939Gateway::updateTxState(const Yield<Message>& yield) {
+    // Congestion is reported once the queue backs up and cleared once it has
+    // fully drained. The report is repeated while congested in case it was
+    // dropped on the way to the nodes holding their frames.
+    bool congested = tx_.size() >= kCongestedDepth ||
+        (tx_state_.congested() && !tx_.empty());
+    uint32_t now = clock_->millis();
+    if (tx_state_.congested(congested) ||
+            (congested && now - tx_state_sent_ >= TxState::kRefresh)) {
+        tx_state_.depth(tx_.size());
+        tx_state_sent_ = now;
+        yield(MessageView(&tx_state_));
+    }
+}
+
+Error J1939Gateway::write(const J1939Message& msg) {
     Error err = can_->write(msg);
     if (err != ERR_OK && err != ERR_FIFO) {
         onWriteError(err, msg);
     }
+    return err;
+}
+
+void J1939Gateway::writeTransfer(const J1939Transfer& transfer) {
+    if (transfer.size() <= 8) {
+        J1939Message msg(transfer.pgn(), transfer.source_address(),
+                transfer.dest_address(), transfer.priority());
+        msg.resize(transfer.size());
+        if (transfer.size() > 0) {
+            memcpy(msg.data(), transfer.bytes(), transfer.size());
+        }
+        send(msg);
+        return;
+    }
+    if (!transport_.send(transfer)) {
+        onTransferError(transfer);
+        return;
+    }
+    writeTransport();
+}
+
+void J1939Gateway::writeTransport() {
+    // Frames stay queued in the transport while the connection's write
+    // buffer is full or more urgent frames are waiting. Frames which fail for
+    // other reasons are dropped and left to the protocol's timeouts.
+    if (!tx_.empty()) {
+        return;
+    }
+    J1939Message msg;
+    while (transport_.next(&msg)) {
+        Error err = write(msg);
+        if (err == ERR_FIFO) {
+            break;
+        }
+        transport_.pop();
+        if (err != ERR_OK) {
+            break;
+        }
+    }
 }
 
 void J1939Gateway::writeClaim() {
     J1939Message msg(0xEE00, address_, 0xFF, 0x06);
     msg.name(name_);
-    write(msg);
+    send(msg);
+}
+
+void J1939Gateway::writeClaimRequest() {
+    J1939Message msg(0xEA00, address_, 0xFF, 0x06);
+    msg.data({0x00, 0xEE, 0x00});
+    send(msg);
 }
 
 }  // namespace R51
@@ -4,8 +4,17 @@
 #include <Arduino.h>
 #include <Canny.h>
 #include <Caster.h>
+#include <Faker.h>
+#include "IDFilter.h"
+#include "J1939AddressMap.h"
 #include "J1939Claim.h"
+#include "J1939Transfer.h"
+#include "J1939Transport.h"
+#include "J1939TxQueue.h"
 #include "Message.h"
+#include "ReadBurst.h"
+#include "Subscription.h"
+#include "TxState.h"
 
 namespace R51 {
 
@@ -15,8 +24,37 @@ namespace R51 {
 // These features may also be disabled when required. The gateway sends a
 // J1939_CLAIM message on the bus any time the gateway assigns itself an
 // address. This address will be Canny::NullAddress if the address claim fails.
-class J1939Gateway : public Caster::Node<Message> {
+//
+// Payloads longer than a single frame are carried by the J1939 transport
+// protocol. The gateway reassembles incoming BAM and RTS/CTS transfers and
+// broadcasts them as J1939_TRANSFER messages. J1939_TRANSFER messages handled
+// by the gateway are segmented and sent the same way. Transport frames
+// themselves are not broadcast to the internal bus.
+//
+// The gateway keeps a map of the NAME and address of every other node from the
+// address claims it reads. A gateway which claims an address requests address
+// claims from all nodes once on init to fill the map. A J1939_ADDRESS message
+// is broadcast to the internal bus each time a node claims a new address or
+// loses its address so that attached nodes can find their devices without
+// sending their own discovery requests.
+//
+// Frames written by the gateway wait in a bounded queue ordered by J1939
+// priority and then age. The queue is drained into the connection until its
+// write buffer is full, so urgent frames always go first. Transport protocol
+// frames are only written once the queue is empty. When the queue overflows
+// the least urgent frames are shed. Frames which wait longer than the write
+// timeout are dropped and frames whose IDs match the coalesce filter replace a
+// queued frame with the same ID. A CONTROLLER:TX_STATE event is broadcast when
+// the queue becomes congested, periodically while it stays congested, and again
+// when it drains.
+class J1939Gateway : public Caster::Node<Message>, public Subscriber {
     public:
+        // Queue depth at which the gateway reports congestion.
+        static const size_t kCongestedDepth = 4;
+
+        // Default time a frame may wait in the transmit queue.
+        static const uint32_t kWriteTimeout = 200;
+
         // Construct a gateway that communicates with the J1939 bus over the
         // given connection and claims the preferred address on init. The given
         // J1939 NAME is sentt with the address claim message. If NAME's
@@ -29,9 +67,12 @@ class J1939Gateway : public Caster::Node<Message> {
         // promiscuous to true. A gateway which fails to claim an address will
         // filter all outgoing messages when promiscuous mode is disabled.
         J1939Gateway(Canny::Connection<Canny::J1939Message>* can,
-                uint8_t preferred_address, uint64_t name, bool promiscuous) :
-            can_(can), preferred_address_(preferred_address), address_(preferred_address),
-            name_(name), promiscuous_(promiscuous) {}
+                uint8_t preferred_address, uint64_t name, bool promiscuous,
+                Faker::Clock* clock = Faker::Clock::real()) :
+            can_(can), clock_(clock), preferred_address_(preferred_address),
+            address_(preferred_address), name_(name), promiscuous_(promiscuous),
+            coalesce_(nullptr), write_timeout_(kWriteTimeout), transport_(clock),
+            tx_state_(TxNetwork::J1939), tx_state_sent_(0) {}
 
         // Construct a gateway that communicates with the J1939 bus over the
         // given connection. The gateway does not participate in the address
@@ -42,54 +83,116 @@ class J1939Gateway : public Caster::Node<Message> {
         // J1939 bus when there is no need to send messages. Generally you
         // would assign the null address in such cases.
         J1939Gateway(Canny::Connection<Canny::J1939Message>* can,
-                uint8_t address, bool promiscuous) :
-            can_(can), preferred_address_(address), address_(address), name_(0),
-            promiscuous_(promiscuous) {}
+                uint8_t address, bool promiscuous,
+                Faker::Clock* clock = Faker::Clock::real()) :
+            can_(can), clock_(clock), preferred_address_(address), address_(address),
+            name_(0), promiscuous_(promiscuous), coalesce_(nullptr),
+            write_timeout_(kWriteTimeout), transport_(clock),
+            tx_state_(TxNetwork::J1939), tx_state_sent_(0) {}
 
         virtual ~J1939Gateway() = default;
 
         // Initialize the module. Assigns the preferred address and sends out
-        // an initial address claim.
+        // an initial address claim followed by a request for address claims.
         void init(const Caster::Yield<Message>& yield) override;
 
-        // Handle outgoing J1939 messages. Discards messsasges whose source
-        // address is not address() when promiscuous mode is disabled.
+        // Subscribe to all J1939 messages and transfers.
+        void subscribe(Subscription* sub) override;
+
+        // Handle outgoing J1939 messages and transfers. Discards messsasges
+        // whose source address is not address() when promiscuous mode is
+        // disabled. Transfers which fit in a frame are sent as one message.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
-        // Read a message from the J1939 bus and broadcast it to the internal
-        // bus. Messages whose destination address is neither address() or the
+        // Read messages from the J1939 bus and broadcast them to the internal
+        // bus. Reads one message per call unless a larger burst is configured.
+        // Messages whose destination address is neither address() or the
         // broadcast address are discarded when promiscuous mode is disabled.
         // Address claim messages are forwarded to the internal bus so that
         // attached nodes can identify specific endpoints on the bus. Emits a
-        // J1939_CLAIM message any time the gateway claims a new address.
+        // J1939_CLAIM message any time the gateway claims a new address and a
+        // J1939_ADDRESS message when the address map changes. Also sends any
+        // transport protocol frames which are due.
         void emit(const Caster::Yield<Message>&) override;
 
+        // Read up to count messages per emit, stopping early once budget_us
+        // microseconds have been spent if non-zero.
+        void burst(uint16_t count, uint32_t budget_us = 0) {
+            burst_.limit(count, budget_us);
+        }
+
+        // Return the counts of messages read per emit.
+        const BurstStats& burstStats() const { return burst_.stats(); }
+
+        // Return the transport protocol counters.
+        const J1939TransportStats& transportStats() const { return transport_.stats(); }
+
+        // Set the time in milliseconds a frame may wait to be written.
+        void writeTimeout(uint32_t timeout_ms) { write_timeout_ = timeout_ms; }
+
+        // Coalesce queued frames whose IDs are accepted by the filter. Set to
+        // nullptr to queue every frame.
+        void coalesce(const IDFilter* ids) { coalesce_ = ids; }
+
+        // Return true if frames are backing up in the transmit queue.
+        bool congested() const { return tx_state_.congested(); }
+
+        // Return the transmit queue counters.
+        const J1939TxStats& txStats() const { return tx_.stats(); }
+
         // The current address of the gateway.
         uint8_t address() { return address_; }
 
         // The J1939 NAME of the gateway.
         uint64_t name() { return name_; }
 
+        // The addresses claimed by other nodes on the network.
+        const J1939AddressMap& addresses() const { return addresses_; }
+
         // Called when a J1939 message can't be read from the CAN bus.
         virtual void onReadError(Canny::Error) {}
 
-        // Called when a J1939 message can't be written to the CAN bus.
+        // Called when a J1939 message can't be written to the CAN bus. The
+        // error is ERR_FIFO if the message was shed from the transmit queue or
+        // was not written before the write timeout.
         virtual void onWriteError(Canny::Error, const Canny::J1939Message&) {}
+
+        // Called when a J1939 transfer can't be sent because the transport
+        // has no free session for it.
+        virtual void onTransferError(const J1939Transfer&) {}
     private:
         void handleAddressClaim(const Canny::J1939Message& msg,
                 const Caster::Yield<Message>& yield);
+        void updateAddress(const Canny::J1939Message& msg,
+                const Caster::Yield<Message>& yield);
 
-        void write(const Canny::J1939Message& msg);
+        void send(const Canny::J1939Message& msg);
+        void flush();
+        Canny::Error write(const Canny::J1939Message& msg);
         void writeClaim();
+        void writeClaimRequest();
+        void writeTransfer(const J1939Transfer& transfer);
+        void writeTransport();
         void emitEvent(const Caster::Yield<Message>& yield);
+        void emitMessage(const Caster::Yield<Message>& yield);
+        void updateTxState(const Caster::Yield<Message>& yield);
 
         Canny::Connection<Canny::J1939Message>* can_;
+        Faker::Clock* clock_;
         const uint8_t preferred_address_;
         uint8_t address_;
         uint64_t name_;
         bool promiscuous_;
+        const IDFilter* coalesce_;
+        uint32_t write_timeout_;
 
         Canny::J1939Message msg_;
+        ReadBurst burst_;
+        J1939Transport transport_;
+        J1939AddressMap addresses_;
+        J1939TxQueue tx_;
+        TxState tx_state_;
+        uint32_t tx_state_sent_;
 };
 
 }  // namespace R51
@@ -0,0 +1,69 @@
+#include "J1939Transfer.h"
+
+#include <Arduino.h>
+
+namespace R51 {
+namespace {
+
+void printHexByte(Print& p, uint8_t byte) {
+    if (byte <= 0x0F)  {
+        p.print('0');
+    }
+    p.print(byte, HEX);
+}
+
+}  // namespace
+
+J1939Transfer::J1939Transfer(uint32_t pgn, uint8_t source_address,
+        uint8_t dest_address, Scratch* data, uint8_t priority) :
+        pgn_(pgn), data_(data), priority_(priority),
+        source_address_(source_address), dest_address_(dest_address) {
+    normalize();
+}
+
+uint32_t J1939Transfer::id() const {
+    uint32_t pgn = pgn_;
+    if (((pgn_ >> 8) & 0xFF) < 0xF0) {
+        pgn |= dest_address_;
+    }
+    return ((uint32_t)(priority_ & 0x07) << 26) | (pgn << 8) | source_address_;
+}
+
+void J1939Transfer::id(uint32_t id) {
+    priority_ = (id >> 26) & 0x07;
+    pgn_ = (id >> 8) & 0x3FFFF;
+    source_address_ = id & 0xFF;
+    dest_address_ = pgn_ & 0xFF;
+    normalize();
+}
+
+void J1939Transfer::normalize() {
+    if (((pgn_ >> 8) & 0xFF) < 0xF0) {
+        pgn_ &= 0x3FF00;
+    } else {
+        dest_address_ = 0xFF;
+    }
+}
+
+size_t J1939Transfer::printTo(Print& p) const {
+    size_t n = p.print(id(), HEX) + p.print("#");
+    for (size_t i = 0; i < size(); ++i) {
+        if (i > 0) {
+            n += p.print(":");
+        }
+        printHexByte(p, bytes()[i]);
+        n += 2;
+    }
+    return n;
+}
+
+bool operator==(const J1939Transfer& left, const J1939Transfer& right) {
+    return left.id() == right.id() && left.size() == right.size() &&
+        (left.size() == 0 || memcmp(left.bytes(), right.bytes(), left.size()) == 0);
+}
+
+bool operator!=(const J1939Transfer& left, const J1939Transfer& right) {
+    return !(left == right);
+}
+
+}  // namespace R51
@@ -0,0 +1,67 @@
+#ifndef _R51_CORE_J1939_TRANSFER_H_
+#define _R51_CORE_J1939_TRANSFER_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+#include "Scratch.h"
+
+namespace R51 {
+
+// A J1939 message whose payload may be longer than a single frame. Transfers
+// are sent and received by the J1939 gateway using the J1939 transport
+// protocol. The payload is held in a scratch owned by the node which created
+// the transfer; see Scratch for how long its contents remain valid.
+class J1939Transfer {
+    public:
+        J1939Transfer() : J1939Transfer(0, Canny::NullAddress, 0xFF, nullptr) {}
+
+        // Construct a transfer of a PGN. The destination address is only
+        // kept for PDU1 PGNs. PDU2 PGNs are always broadcast.
+        J1939Transfer(uint32_t pgn, uint8_t source_address, uint8_t dest_address,
+                Scratch* data, uint8_t priority = 0x06);
+
+        // Return the 29-bit J1939 ID that a single frame of this transfer
+        // would have.
+        uint32_t id() const;
+
+        // Set the priority, PGN, and addresses from a 29-bit J1939 ID.
+        void id(uint32_t id);
+
+        uint32_t pgn() const { return pgn_; }
+        uint8_t priority() const { return priority_; }
+        uint8_t source_address() const { return source_address_; }
+        void source_address(uint8_t address) { source_address_ = address; }
+        uint8_t dest_address() const { return dest_address_; }
+
+        // Return true if the transfer is sent to all nodes.
+        bool broadcast() const { return dest_address_ == 0xFF; }
+
+        // Return the scratch holding the payload. May be nullptr for an empty
+        // transfer.
+        Scratch* data() const { return data_; }
+        void data(Scratch* data) { data_ = data; }
+
+        // Return the payload bytes. Returns nullptr for an empty transfer.
+        const uint8_t* bytes() const { return data_ != nullptr ? data_->bytes : nullptr; }
+
+        // Return the payload size.
+        size_t size() const { return data_ != nullptr ? data_->size : 0; }
+
+        size_t printTo(Print& p) const;
+    private:
+        uint32_t pgn_;
+        Scratch* data_;
+        uint8_t priority_;
+        uint8_t source_address_;
+        uint8_t dest_address_;
+
+        void normalize();
+};
+
+// Transfers are equal if their IDs and payload bytes are equal.
+bool operator==(const J1939Transfer& left, const J1939Transfer& right);
+bool operator!=(const J1939Transfer& left, const J1939Transfer& right);
+
+}  // namespace R51
+
+#endif  // _R51_CORE_J1939_TRANSFER_H_
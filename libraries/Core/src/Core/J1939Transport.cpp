@@ -0,0 +1,491 @@
+#include "J1939Transport.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+#include <Caster.h>
+#include "J1939Transfer.h"
+#include "Message.h"
+
+namespace R51 {
+namespace {
+
+using ::Canny::J1939Message;
+using ::Caster::Yield;
+
+// Connection management and data transfer PGNs.
+static const uint32_t kCMPGN = 0xEC00;
+static const uint32_t kDTPGN = 0xEB00;
+
+// Connection management control bytes.
+static const uint8_t kRTS = 16;
+static const uint8_t kCTS = 17;
+static const uint8_t kEndOfMsgAck = 19;
+static const uint8_t kBAM = 32;
+static const uint8_t kAbort = 255;
+
+// Abort reasons.
+static const uint8_t kAbortResources = 2;
+static const uint8_t kAbortTimeout = 3;
+static const uint8_t kAbortSequence = 7;
+
+// Timeouts in milliseconds from J1939-21.
+static const uint32_t kT1 = 750;    // Between received data packets.
+static const uint32_t kT2 = 1250;   // After sending a CTS.
+static const uint32_t kT3 = 1250;   // After sending the last packet of a window.
+static const uint32_t kT4 = 1050;   // After receiving a CTS hold.
+
+// Time between BAM packets. J1939-21 allows 50 to 200 ms.
+static const uint32_t kBAMInterval = 50;
+
+// Transport frames are sent at the lowest priority.
+static const uint8_t kPriority = 0x07;
+
+static const uint8_t kPacketSize = 7;
+
+uint8_t packetCount(size_t size) {
+    return (size + kPacketSize - 1) / kPacketSize;
+}
+
+uint32_t getPGN(const J1939Message& msg) {
+    return msg.data()[5] | ((uint32_t)msg.data()[6] << 8) |
+        ((uint32_t)msg.data()[7] << 16);
+}
+
+void putPGN(J1939Message* msg, uint32_t pgn) {
+    msg->data()[5] = pgn & 0xFF;
+    msg->data()[6] = (pgn >> 8) & 0xFF;
+    msg->data()[7] = (pgn >> 16) & 0xFF;
+}
+
+}  // namespace
+
+J1939Transport::J1939Transport(Faker::Clock* clock) :
+        clock_(clock), control_head_(0), control_size_(0), pending_(nullptr),
+        pending_control_(false), stats_({0, 0, 0, 0}) {
+    for (size_t i = 0; i < kRxSessions; ++i) {
+        rx_[i].active = false;
+        rx_[i].state = State::IDLE;
+    }
+    for (size_t i = 0; i < kTxSessions; ++i) {
+        tx_[i].active = false;
+        tx_[i].state = State::IDLE;
+    }
+}
+
+bool J1939Transport::match(const J1939Message& msg) {
+    return msg.pdu_format() == (kCMPGN >> 8) || msg.pdu_format() == (kDTPGN >> 8);
+}
+
+void J1939Transport::receive(const J1939Message& msg, uint8_t address, bool promiscuous,
+        const Yield<Message>& yield) {
+    if (msg.size() != 8) {
+        return;
+    }
+    if (msg.pdu_format() == (kCMPGN >> 8)) {
+        receiveControl(msg, address, promiscuous);
+    } else if (msg.pdu_format() == (kDTPGN >> 8)) {
+        receiveData(msg, yield);
+    }
+}
+
+void J1939Transport::receiveControl(const J1939Message& msg, uint8_t address,
+        bool promiscuous) {
+    bool ours = msg.dest_address() == address;
+    switch (msg.data()[0]) {
+        case kRTS:
+            if (ours || promiscuous) {
+                startReceive(msg, ours);
+            }
+            break;
+        case kBAM:
+            if (msg.broadcast()) {
+                startReceive(msg, false);
+            }
+            break;
+        case kCTS:
+            if (ours) {
+                handleCTS(msg);
+            }
+            break;
+        case kEndOfMsgAck:
+            if (ours) {
+                handleAck(msg);
+            }
+            break;
+        case kAbort:
+            handleAbort(msg);
+            break;
+        default:
+            break;
+    }
+}
+
+void J1939Transport::startReceive(const J1939Message& msg, bool respond) {
+    uint8_t source = msg.source_address();
+    uint8_t dest = msg.dest_address();
+    uint16_t size = msg.data()[1] | (msg.data()[2] << 8);
+    uint8_t packets = msg.data()[3];
+    uint32_t pgn = getPGN(msg);
+    if (size <= 8 || packets != packetCount(size)) {
+        return;
+    }
+
+    // A new announcement from the same node replaces its open session.
+    Session* session = findRx(source, dest);
+    if (session == nullptr) {
+        for (size_t i = 0; i < kRxSessions; ++i) {
+            if (!rx_[i].active) {
+                session = &rx_[i];
+                break;
+            }
+        }
+    }
+    if (session == nullptr || !session->data.reserve(size)) {
+        if (respond) {
+            queueAbort(pgn, dest, source, kAbortResources);
+        }
+        ++stats_.aborted;
+        return;
+    }
+
+    session->pgn = pgn;
+    session->size = size;
+    session->packets = packets;
+    session->next_seq = 1;
+    session->source = source;
+    session->dest = dest;
+    session->priority = 0x06;
+    session->active = true;
+    session->respond = respond;
+    if (respond) {
+        session->max_window = msg.data()[4] == 0 ? 0xFF : msg.data()[4];
+        session->window_end = packets < session->max_window ? packets : session->max_window;
+        queueCTS(session);
+        deadline(session, kT2);
+    } else {
+        session->max_window = 0xFF;
+        session->window_end = packets;
+        deadline(session, msg.broadcast() ? kT1 : kT2);
+    }
+}
+
+void J1939Transport::receiveData(const J1939Message& msg, const Yield<Message>& yield) {
+    Session* session = findRx(msg.source_address(), msg.dest_address());
+    if (session == nullptr) {
+        return;
+    }
+
+    uint8_t seq = msg.data()[0];
+    if (seq < session->next_seq) {
+        // duplicate packet
+        return;
+    }
+    if (seq > session->next_seq) {
+        if (session->respond) {
+            queueAbort(session->pgn, session->dest, session->source, kAbortSequence);
+        }
+        close(session);
+        ++stats_.aborted;
+        return;
+    }
+
+    size_t offset = (seq - 1) * kPacketSize;
+    size_t count = session->size - offset;
+    if (count > kPacketSize) {
+        count = kPacketSize;
+    }
+    memcpy(session->data.bytes + offset, msg.data() + 1, count);
+    ++session->next_seq;
+
+    if (seq == session->packets) {
+        if (session->respond) {
+            queueAck(session);
+        }
+        // The lease is kept so the yielded payload remains valid until the
+        // session is reused. Handlers which pass it on must copy it.
+        session->data.size = session->size;
+        session->active = false;
+        ++stats_.received;
+        transfer_ = J1939Transfer(session->pgn, session->source, session->dest,
+                &session->data, session->priority);
+        yield(MessageView(&transfer_));
+    } else if (session->respond && seq == session->window_end) {
+        uint16_t end = seq + session->max_window;
+        session->window_end = end < session->packets ? end : session->packets;
+        queueCTS(session);
+        deadline(session, kT2);
+    } else {
+        deadline(session, kT1);
+    }
+}
+
+void J1939Transport::handleCTS(const J1939Message& msg) {
+    Session* session = findTx(msg.dest_address(), msg.source_address());
+    if (session == nullptr || session->state == State::BAM ||
+            session->pgn != getPGN(msg)) {
+        return;
+    }
+
+    uint8_t count = msg.data()[1];
+    uint8_t next_seq = msg.data()[2];
+    if (count == 0) {
+        // the receiver asked us to hold
+        session->state = State::WAIT_CTS;
+        deadline(session, kT4);
+        return;
+    }
+    if (next_seq == 0 || next_seq > session->packets) {
+        queueAbort(session->pgn, session->source, session->dest, kAbortSequence);
+        close(session);
+        ++stats_.aborted;
+        return;
+    }
+    uint16_t end = next_seq + count - 1;
+    session->next_seq = next_seq;
+    session->window_end = end < session->packets ? end : session->packets;
+    session->state = State::SEND;
+}
+
+void J1939Transport::handleAck(const J1939Message& msg) {
+    Session* session = findTx(msg.dest_address(), msg.source_address());
+    if (session == nullptr || session->state == State::BAM ||
+            session->pgn != getPGN(msg)) {
+        return;
+    }
+    close(session);
+    ++stats_.sent;
+}
+
+void J1939Transport::handleAbort(const J1939Message& msg) {
+    uint8_t source = msg.source_address();
+    uint8_t dest = msg.dest_address();
+    uint32_t pgn = getPGN(msg);
+    Session* sessions[] = {
+        findTx(dest, source),   // the receiver aborted our transfer
+        findRx(source, dest),   // the sender aborted its transfer
+        findRx(dest, source),   // a receiver aborted a transfer we overheard
+    };
+    for (Session* session : sessions) {
+        if (session != nullptr && session->pgn == pgn) {
+            close(session);
+            ++stats_.aborted;
+        }
+    }
+}
+
+bool J1939Transport::send(const J1939Transfer& transfer) {
+    if (transfer.size() <= 8 || transfer.size() > kScratchCapacity) {
+        return false;
+    }
+    uint8_t source = transfer.source_address();
+    uint8_t dest = transfer.dest_address();
+    if (findTx(source, dest) != nullptr) {
+        return false;
+    }
+    Session* session = nullptr;
+    for (size_t i = 0; i < kTxSessions; ++i) {
+        if (!tx_[i].active) {
+            session = &tx_[i];
+            break;
+        }
+    }
+    if (session == nullptr || !session->data.reserve(transfer.size())) {
+        return false;
+    }
+
+    memcpy(session->data.bytes, transfer.bytes(), transfer.size());
+    session->data.size = transfer.size();
+    session->pgn = transfer.pgn();
+    session->size = transfer.size();
+    session->packets = packetCount(transfer.size());
+    session->next_seq = 1;
+    session->window_end = 0;
+    session->source = source;
+    session->dest = dest;
+    session->priority = transfer.priority();
+    session->state = transfer.broadcast() ? State::BAM : State::WAIT_CTS;
+    session->active = true;
+    if (!queueAnnounce(session)) {
+        close(session);
+        return false;
+    }
+    deadline(session, transfer.broadcast() ? kBAMInterval : kT3);
+    return true;
+}
+
+bool J1939Transport::next(J1939Message* msg) {
+    expire();
+    pending_ = nullptr;
+    pending_control_ = false;
+    if (control_size_ > 0) {
+        *msg = control_[control_head_];
+        pending_control_ = true;
+        return true;
+    }
+    for (size_t i = 0; i < kTxSessions; ++i) {
+        Session* session = &tx_[i];
+        if (!session->active) {
+            continue;
+        }
+        if (session->state == State::SEND ||
+                (session->state == State::BAM && expired(session))) {
+            fillData(session, msg);
+            pending_ = session;
+            return true;
+        }
+    }
+    return false;
+}
+
+void J1939Transport::pop() {
+    if (pending_control_) {
+        control_head_ = (control_head_ + 1) % kControlSize;
+        --control_size_;
+    } else if (pending_ != nullptr) {
+        Session* session = pending_;
+        ++session->next_seq;
+        if (session->state == State::BAM) {
+            if (session->next_seq > session->packets) {
+                close(session);
+                ++stats_.sent;
+            } else {
+                deadline(session, kBAMInterval);
+            }
+        } else if (session->next_seq > session->packets) {
+            session->state = State::WAIT_ACK;
+            deadline(session, kT3);
+        } else if (session->next_seq > session->window_end) {
+            session->state = State::WAIT_CTS;
+            deadline(session, kT3);
+        }
+    }
+    pending_ = nullptr;
+    pending_control_ = false;
+}
+
+void J1939Transport::expire() {
+    for (size_t i = 0; i < kRxSessions; ++i) {
+        Session* session = &rx_[i];
+        if (session->active && expired(session)) {
+            if (session->respond) {
+                queueAbort(session->pgn, session->dest, session->source, kAbortTimeout);
+            }
+            close(session);
+            ++stats_.timeouts;
+        }
+    }
+    for (size_t i = 0; i < kTxSessions; ++i) {
+        Session* session = &tx_[i];
+        if (session->active && (session->state == State::WAIT_CTS ||
+                session->state == State::WAIT_ACK) && expired(session)) {
+            queueAbort(session->pgn, session->source, session->dest, kAbortTimeout);
+            close(session);
+            ++stats_.timeouts;
+        }
+    }
+}
+
+J1939Transport::Session* J1939Transport::findRx(uint8_t source, uint8_t dest) {
+    for (size_t i = 0; i < kRxSessions; ++i) {
+        if (rx_[i].active && rx_[i].source == source && rx_[i].dest == dest) {
+            return &rx_[i];
+        }
+    }
+    return nullptr;
+}
+
+J1939Transport::Session* J1939Transport::findTx(uint8_t source, uint8_t dest) {
+    for (size_t i = 0; i < kTxSessions; ++i) {
+        if (tx_[i].active && tx_[i].source == source && tx_[i].dest == dest) {
+            return &tx_[i];
+        }
+    }
+    return nullptr;
+}
+
+void J1939Transport::close(Session* session) {
+    session->active = false;
+    session->state = State::IDLE;
+    session->data.clear();
+}
+
+void J1939Transport::deadline(Session* session, uint32_t timeout) {
+    session->deadline = clock_->millis() + timeout;
+}
+
+bool J1939Transport::expired(const Session* session) const {
+    return (int32_t)(clock_->millis() - session->deadline) >= 0;
+}
+
+void J1939Transport::queueCTS(const Session* session) {
+    J1939Message* msg = queueControl(session->dest, session->source);
+    if (msg == nullptr) {
+        return;
+    }
+    msg->data()[0] = kCTS;
+    msg->data()[1] = session->window_end - session->next_seq + 1;
+    msg->data()[2] = session->next_seq;
+    putPGN(msg, session->pgn);
+}
+
+void J1939Transport::queueAck(const Session* session) {
+    J1939Message* msg = queueControl(session->dest, session->source);
+    if (msg == nullptr) {
+        return;
+    }
+    msg->data()[0] = kEndOfMsgAck;
+    msg->data()[1] = session->size & 0xFF;
+    msg->data()[2] = session->size >> 8;
+    msg->data()[3] = session->packets;
+    putPGN(msg, session->pgn);
+}
+
+void J1939Transport::queueAbort(uint32_t pgn, uint8_t source, uint8_t dest, uint8_t reason) {
+    J1939Message* msg = queueControl(source, dest);
+    if (msg == nullptr) {
+        return;
+    }
+    msg->data()[0] = kAbort;
+    msg->data()[1] = reason;
+    putPGN(msg, pgn);
+}
+
+bool J1939Transport::queueAnnounce(const Session* session) {
+    J1939Message* msg = queueControl(session->source, session->dest);
+    if (msg == nullptr) {
+        return false;
+    }
+    msg->data()[0] = session->state == State::BAM ? kBAM : kRTS;
+    msg->data()[1] = session->size & 0xFF;
+    msg->data()[2] = session->size >> 8;
+    msg->data()[3] = session->packets;
+    putPGN(msg, session->pgn);
+    return true;
+}
+
+J1939Message* J1939Transport::queueControl(uint8_t source, uint8_t dest) {
+    if (control_size_ >= kControlSize) {
+        return nullptr;
+    }
+    J1939Message* msg = &control_[(control_head_ + control_size_) % kControlSize];
+    ++control_size_;
+    *msg = J1939Message(kCMPGN, source, dest, kPriority);
+    msg->resize(8);
+    memset(msg->data(), 0xFF, 8);
+    return msg;
+}
+
+void J1939Transport::fillData(const Session* session, J1939Message* msg) const {
+    *msg = J1939Message(kDTPGN, session->source, session->dest, kPriority);
+    msg->resize(8);
+    memset(msg->data(), 0xFF, 8);
+    msg->data()[0] = session->next_seq;
+    size_t offset = (session->next_seq - 1) * kPacketSize;
+    size_t count = session->size - offset;
+    if (count > kPacketSize) {
+        count = kPacketSize;
+    }
+    memcpy(msg->data() + 1, session->data.bytes + offset, count);
+}
+
+}  // namespace R51
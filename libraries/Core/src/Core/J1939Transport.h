@@ -0,0 +1,153 @@
+#ifndef _R51_CORE_J1939_TRANSPORT_H_
+#define _R51_CORE_J1939_TRANSPORT_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+#include <Caster.h>
+#include <Faker.h>
+#include "J1939Transfer.h"
+#include "Message.h"
+#include "Scratch.h"
+
+namespace R51 {
+
+// Counters kept by the transport protocol.
+struct J1939TransportStats {
+    // Transfers reassembled and yielded.
+    uint32_t received;
+    // Transfers fully sent.
+    uint32_t sent;
+    // Sessions aborted by either side or refused for lack of resources.
+    uint32_t aborted;
+    // Sessions dropped because the other side stopped responding.
+    uint32_t timeouts;
+};
+
+// The J1939 transport protocol (J1939-21 TP.CM and TP.DT). Reassembles
+// multi-packet PGNs received as BAM broadcasts or RTS/CTS sessions and
+// segments outgoing transfers the same way.
+//
+// Sessions are held in fixed tables. Each session is keyed by its source and
+// destination address so a node may have one broadcast and one addressed
+// session open with us at the same time. Payloads are held in scratch leases
+// and so are limited to kScratchCapacity bytes. Transfers which do not fit
+// are refused with an abort.
+//
+// Each session leases from its own arena of kScratchCapacity bytes. Every
+// session can then hold a full payload at once. The transport also never
+// touches the shared arena, which belongs to whichever core runs the other
+// nodes. A yielded transfer references the session's scratch. It is valid
+// until the transport is next called, so nodes on another core must be given
+// a copy, as Pipe does.
+//
+// The transport does not write to the bus itself. Frames which are ready to
+// send are returned by next() and must be confirmed with pop() once written.
+class J1939Transport {
+    public:
+        // Number of transfers which may be received at once.
+        static const size_t kRxSessions = 4;
+
+        // Number of transfers which may be sent at once.
+        static const size_t kTxSessions = 2;
+
+        // Construct a transport protocol handler. Timeouts are measured with
+        // the given clock.
+        J1939Transport(Faker::Clock* clock = Faker::Clock::real());
+
+        // Return true if the message is a TP.CM or TP.DT message.
+        static bool match(const Canny::J1939Message& msg);
+
+        // Handle a received TP.CM or TP.DT message. Transfers addressed to
+        // address or broadcast are reassembled and yielded as J1939_TRANSFER
+        // messages. Transfers between other nodes are also reassembled when
+        // promiscuous is true but are never responded to.
+        void receive(const Canny::J1939Message& msg, uint8_t address, bool promiscuous,
+                const Caster::Yield<Message>& yield);
+
+        // Start sending a transfer. The payload is copied. Transfers to the
+        // broadcast address are sent with BAM and others with RTS/CTS.
+        // Returns false if the transfer fits in a single frame, is too large,
+        // or if a session for the same addresses is already open or none are
+        // free.
+        bool send(const J1939Transfer& transfer);
+
+        // Fill msg with the next frame to write. Returns false if nothing is
+        // due. The same frame is returned until pop() is called. Expires
+        // sessions which have timed out.
+        bool next(Canny::J1939Message* msg);
+
+        // Mark the frame returned by next() as written.
+        void pop();
+
+        // Return the transport counters.
+        const J1939TransportStats& stats() const { return stats_; }
+
+    private:
+        static const size_t kControlSize = 8;
+
+        enum class State : uint8_t {
+            IDLE,
+            BAM,        // Sending BAM data.
+            WAIT_CTS,   // Waiting for a CTS.
+            SEND,       // Sending the packets requested by a CTS.
+            WAIT_ACK,   // Waiting for the end of message ack.
+        };
+
+        struct Session {
+            Session() : arena(kScratchCapacity), data(&arena) {}
+
+            ScratchArena arena;
+            Scratch data;
+            uint32_t pgn;
+            uint32_t deadline;
+            uint16_t size;
+            uint8_t packets;
+            uint8_t next_seq;
+            uint8_t window_end;
+            uint8_t max_window;
+            uint8_t source;
+            uint8_t dest;
+            uint8_t priority;
+            State state;
+            bool active;
+            // Received sessions only. True if we answer with CTS and ack.
+            bool respond;
+        };
+
+        Faker::Clock* clock_;
+        Session rx_[kRxSessions];
+        Session tx_[kTxSessions];
+        Canny::J1939Message control_[kControlSize];
+        size_t control_head_;
+        size_t control_size_;
+        Session* pending_;
+        bool pending_control_;
+        J1939Transfer transfer_;
+        J1939TransportStats stats_;
+
+        void receiveControl(const Canny::J1939Message& msg, uint8_t address,
+                bool promiscuous);
+        void receiveData(const Canny::J1939Message& msg, const Caster::Yield<Message>& yield);
+        void startReceive(const Canny::J1939Message& msg, bool respond);
+        void handleCTS(const Canny::J1939Message& msg);
+        void handleAck(const Canny::J1939Message& msg);
+        void handleAbort(const Canny::J1939Message& msg);
+        void expire();
+
+        Session* findRx(uint8_t source, uint8_t dest);
+        Session* findTx(uint8_t source, uint8_t dest);
+        void close(Session* session);
+        void deadline(Session* session, uint32_t timeout);
+        bool expired(const Session* session) const;
+
+        void queueCTS(const Session* session);
+        void queueAck(const Session* session);
+        void queueAbort(uint32_t pgn, uint8_t source, uint8_t dest, uint8_t reason);
+        bool queueAnnounce(const Session* session);
+        Canny::J1939Message* queueControl(uint8_t source, uint8_t dest);
+        void fillData(const Session* session, Canny::J1939Message* msg) const;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_J1939_TRANSPORT_H_
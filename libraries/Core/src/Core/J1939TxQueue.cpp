@@ -0,0 +1,89 @@
+#include "J1939TxQueue.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+using ::Canny::J1939Message;
+
+bool J1939TxQueue::push(const J1939Message& msg, uint32_t deadline,
+        bool coalesce, J1939Message* shed) {
+    if (coalesce) {
+        // The ID includes the priority so the frame keeps its order.
+        for (size_t i = 0; i < size_; ++i) {
+            if (queue_[i].msg.id() == msg.id()) {
+                queue_[i].msg = msg;
+                queue_[i].deadline = deadline;
+                ++stats_.coalesced;
+                return true;
+            }
+        }
+    }
+
+    bool accepted = true;
+    if (size_ >= kCapacity) {
+        // The last frame is the newest of the least urgent.
+        if (msg.priority() >= queue_[size_ - 1].msg.priority()) {
+            if (shed != nullptr) {
+                *shed = msg;
+            }
+            ++stats_.shed;
+            return false;
+        }
+        if (shed != nullptr) {
+            *shed = queue_[size_ - 1].msg;
+        }
+        --size_;
+        ++stats_.shed;
+        accepted = false;
+    }
+
+    // Insert after all frames of equal or more urgent priority.
+    size_t i = size_;
+    while (i > 0 && queue_[i - 1].msg.priority() > msg.priority()) {
+        queue_[i] = queue_[i - 1];
+        --i;
+    }
+    queue_[i].msg = msg;
+    queue_[i].deadline = deadline;
+    ++size_;
+    ++stats_.queued;
+    if (size_ > stats_.peak) {
+        stats_.peak = size_;
+    }
+    return accepted;
+}
+
+void J1939TxQueue::pop(bool sent) {
+    if (size_ == 0) {
+        return;
+    }
+    remove(0);
+    if (sent) {
+        ++stats_.sent;
+    }
+}
+
+bool J1939TxQueue::expire(uint32_t now, J1939Message* expired) {
+    for (size_t i = 0; i < size_; ++i) {
+        if ((int32_t)(now - queue_[i].deadline) > 0) {
+            if (expired != nullptr) {
+                *expired = queue_[i].msg;
+            }
+            remove(i);
+            ++stats_.expired;
+            return true;
+        }
+    }
+    return false;
+}
+
+void J1939TxQueue::remove(size_t i) {
+    for (++i; i < size_; ++i) {
+        queue_[i - 1] = queue_[i];
+    }
+    --size_;
+}
+
+}  // namespace R51
@@ -0,0 +1,85 @@
+#ifndef _R51_CORE_J1939_TX_QUEUE_H_
+#define _R51_CORE_J1939_TX_QUEUE_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+
+namespace R51 {
+
+// Frame counts kept by a J1939TxQueue.
+struct J1939TxStats {
+    // Frames accepted into the queue.
+    uint32_t queued;
+    // Frames removed from the queue after being written.
+    uint32_t sent;
+    // Frames which replaced a queued frame with the same ID.
+    uint32_t coalesced;
+    // Frames dropped because their deadline passed before they were written.
+    uint32_t expired;
+    // Frames dropped because the queue was full of more urgent frames.
+    uint32_t shed;
+    // Most frames held at once.
+    uint16_t peak;
+};
+
+// A bounded queue of J1939 frames waiting to be written. Frames are ordered
+// by their J1939 priority field, lowest value first, and then by age so that
+// frames of the same priority keep their order. Each frame must be written
+// before its deadline.
+//
+// When the queue is full a new frame displaces the newest of the least urgent
+// frames if it is more urgent than them. Otherwise the new frame is shed. A
+// frame pushed with coalesce set instead replaces the data of a queued frame
+// with the same ID and keeps that frame's place in the queue.
+class J1939TxQueue {
+    public:
+        // Number of frames held by the queue.
+        static const size_t kCapacity = 16;
+
+        J1939TxQueue() : size_(0), stats_({0, 0, 0, 0, 0, 0}) {}
+
+        // Add a frame which must be written before deadline, in
+        // milliseconds. Returns false if a frame was shed, in which case the
+        // shed frame is copied to shed if not null. The shed frame may be msg
+        // itself.
+        bool push(const Canny::J1939Message& msg, uint32_t deadline,
+                bool coalesce = false, Canny::J1939Message* shed = nullptr);
+
+        // Return the most urgent frame or nullptr if the queue is empty.
+        const Canny::J1939Message* peek() const {
+            return size_ == 0 ? nullptr : &queue_[0].msg;
+        }
+
+        // Remove the most urgent frame. The frame is counted as sent if sent
+        // is true.
+        void pop(bool sent = true);
+
+        // Remove a frame whose deadline is earlier than now and copy it to
+        // expired if not null. Returns false if no frame has expired.
+        bool expire(uint32_t now, Canny::J1939Message* expired = nullptr);
+
+        // Return the number of frames in the queue.
+        size_t size() const { return size_; }
+
+        // Return true if the queue is empty.
+        bool empty() const { return size_ == 0; }
+
+        // Return the queue counters.
+        const J1939TxStats& stats() const { return stats_; }
+
+    private:
+        struct Entry {
+            Canny::J1939Message msg;
+            uint32_t deadline;
+        };
+
+        Entry queue_[kCapacity];
+        size_t size_;
+        J1939TxStats stats_;
+
+        void remove(size_t i);
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_J1939_TX_QUEUE_H_
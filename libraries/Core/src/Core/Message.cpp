@@ -1,24 +1,10 @@
 #include "Message.h"
 
+#include <new>
+
 namespace R51 {
 namespace {
 
-const void* makeRef(const Message& msg) {
-    switch (msg.type()) {
-        case Message::EMPTY:
-            return nullptr;
-        case Message::EVENT:
-            return msg.event();
-        case Message::CAN_FRAME:
-            return msg.can_frame();
-        case Message::J1939_CLAIM:
-            return msg.j1939_claim();
-        case Message::J1939_MESSAGE:
-            return msg.j1939_message();
-    }
-    return nullptr;
-}
-
 template <typename T>
 bool checkRef(const T* left, const T* right) {
     if (left == right) {
@@ -43,6 +29,10 @@ bool operator==(const Message& left, const Message& right) {
                 return checkRef(left.j1939_claim(), right.j1939_claim());
             case Message::J1939_MESSAGE:
                 return checkRef(left.j1939_message(), right.j1939_message());
+            case Message::J1939_TRANSFER:
+                return checkRef(left.j1939_transfer(), right.j1939_transfer());
+            case Message::J1939_ADDRESS:
+                return checkRef(left.j1939_address(), right.j1939_address());
             case Message::EMPTY:
                 return true;
         }
@@ -76,6 +66,16 @@ size_t Message::printTo(Print& p) const {
                 return j1939_message()->printTo(p);
             }
             return 0;
+        case J1939_TRANSFER:
+            if (j1939_transfer() != nullptr) {
+                return j1939_transfer()->printTo(p);
+            }
+            return 0;
+        case J1939_ADDRESS:
+            if (j1939_address() != nullptr) {
+                return j1939_address()->printTo(p);
+            }
+            return 0;
         case EMPTY:
             return 0;
     }
@@ -91,117 +91,106 @@ MessageValue::MessageValue(const MessageValue& msg) : MessageValue() {
 }
 
 MessageValue::~MessageValue() {
-    switch (type_) {
+    destroy();
+}
+
+MessageValue& MessageValue::operator=(const Message& msg) {
+    copyFrom(msg);
+    return *this;
+}
+
+MessageValue& MessageValue::operator=(const MessageValue& msg) {
+    copyFrom(msg);
+    return *this;
+}
+
+void MessageValue::copyFrom(const Message& msg) {
+    const void* src = nullptr;
+    switch (msg.type()) {
         case EMPTY:
             break;
         case EVENT:
-            event_.~Event();
+            src = msg.event();
             break;
         case CAN_FRAME:
-            can_frame_.~CAN20Frame();
+            src = msg.can_frame();
             break;
         case J1939_CLAIM:
-            j1939_claim_.~J1939Claim();
+            src = msg.j1939_claim();
             break;
         case J1939_MESSAGE:
-            j1939_message_.~J1939Message();
+            src = msg.j1939_message();
+            break;
+        case J1939_TRANSFER:
+            src = msg.j1939_transfer();
+            break;
+        case J1939_ADDRESS:
+            src = msg.j1939_address();
             break;
     }
-}
-
-// Return the event referenced by the message. Return nullptr if type()
-// != EVENT.
-const Event* MessageValue::event() const {
-    return type_ == EVENT ? &event_ : nullptr;
-}
-
-// Return the CAN frame referenced by the message. Return nullptr if
-// type() != CAN_FRAME.
-const Canny::CAN20Frame* MessageValue::can_frame() const {
-    return type_ == CAN_FRAME ? &can_frame_ : nullptr;
-}
-
-// Return the J1939 address claim event referenced by the message.
-// Return nullptr if type() != J1939_CLAIM.
-const J1939Claim* MessageValue::j1939_claim() const {
-    return type_ == J1939_CLAIM ? &j1939_claim_ : nullptr;
-}
-
-// Return the J1939 message referenced by the message. Return nullptr
-// if type() != J1939_MESSAGE.
-const Canny::J1939Message* MessageValue::j1939_message() const {
-    return type_ == J1939_MESSAGE ? &j1939_message_ : nullptr;
-}
+    if (src != nullptr && src == ref_) {
+        // copying from ourselves
+        return;
+    }
 
-MessageValue& MessageValue::operator=(const Message& msg) {
-    copyFrom(msg);
-    return *this;
+    // The union members hold vtables so they must be constructed in place
+    // rather than assigned.
+    destroy();
+    if (src == nullptr) {
+        return;
+    }
+    switch (msg.type()) {
+        case EMPTY:
+            break;
+        case EVENT:
+            new (&event_) Event(*msg.event());
+            break;
+        case CAN_FRAME:
+            new (&can_frame_) Canny::CAN20Frame(*msg.can_frame());
+            break;
+        case J1939_CLAIM:
+            new (&j1939_claim_) J1939Claim(*msg.j1939_claim());
+            break;
+        case J1939_MESSAGE:
+            new (&j1939_message_) Canny::J1939Message(*msg.j1939_message());
+            break;
+        case J1939_TRANSFER:
+            new (&j1939_transfer_) J1939Transfer(*msg.j1939_transfer());
+            break;
+        case J1939_ADDRESS:
+            new (&j1939_address_) J1939Address(*msg.j1939_address());
+            break;
+    }
+    type_ = msg.type();
+    relocate();
 }
 
-void MessageValue::copyFrom(const Message& msg) {
-    type_ = msg.type();
+void MessageValue::destroy() {
     switch (type_) {
         case EMPTY:
             break;
         case EVENT:
-            if (msg.event() == nullptr) {
-                type_ = EMPTY;
-                empty_ = 0;
-            } else {
-                event_ = *msg.event();
-            }
+            event_.~Event();
             break;
         case CAN_FRAME:
-            if (msg.can_frame() == nullptr) {
-                type_ = EMPTY;
-                empty_ = 0;
-            } else {
-                can_frame_ = *msg.can_frame();
-            }
+            can_frame_.~CAN20Frame();
             break;
         case J1939_CLAIM:
-            if (msg.j1939_claim() == nullptr) {
-                type_ = EMPTY;
-                empty_ = 0;
-            } else {
-                j1939_claim_ = *msg.j1939_claim();
-            }
+            j1939_claim_.~J1939Claim();
             break;
         case J1939_MESSAGE:
-            if (msg.j1939_message() == nullptr) {
-                type_ = EMPTY;
-                empty_ = 0;
-            } else {
-                j1939_message_ = *msg.j1939_message();
-            }
+            j1939_message_.~J1939Message();
+            break;
+        case J1939_TRANSFER:
+            j1939_transfer_.~J1939Transfer();
+            break;
+        case J1939_ADDRESS:
+            j1939_address_.~J1939Address();
             break;
     }
-}
-
-MessageView::MessageView(const Message& msg) : type_(msg.type()), ref_(makeRef(msg)) {}
-
-// Return the event referenced by the message. Return nullptr if type()
-// != EVENT.
-const Event* MessageView::event() const {
-    return type_ == EVENT ? (Event*)ref_ : nullptr;
-}
-
-// Return the CAN frame referenced by the message. Return nullptr if
-// type() != CAN_FRAME.
-const Canny::CAN20Frame* MessageView::can_frame() const {
-    return type_ == CAN_FRAME ? (Canny::CAN20Frame*)ref_ : nullptr;
-}
-
-// Return the J1939 address claim event referenced by the message.
-// Return nullptr if type() != J1939_CLAIM.
-const J1939Claim* MessageView::j1939_claim() const {
-    return type_ == J1939_CLAIM ? (J1939Claim*)ref_ : nullptr;
-}
-
-// Return the J1939 message referenced by the message. Return nullptr
-// if type() != J1939_MESSAGE.
-const Canny::J1939Message* MessageView::j1939_message() const {
-    return type_ == J1939_MESSAGE ? (Canny::J1939Message*)ref_ : nullptr;
+    type_ = EMPTY;
+    ref_ = nullptr;
+    empty_ = 0;
 }
 
 }  // namespace R51
@@ -5,10 +5,13 @@
 #include <Canny.h>
 #include "Event.h"
 #include "J1939Claim.h"
+#include "J1939Transfer.h"
 
 namespace R51 {
 
-// Message type used on the internal bus.
+// Message type used on the internal bus. A message is a type tag and a
+// reference to its payload. Accessors are not virtual so that they may be
+// inlined into the nodes which call them.
 class Message : public Printable {
     public:
         // The message type.
@@ -18,33 +21,60 @@ class Message : public Printable {
             CAN_FRAME,
             J1939_CLAIM,
             J1939_MESSAGE,
+            J1939_TRANSFER,
+            J1939_ADDRESS,
         };
 
         // Return the type of the message.
-        virtual enum Type type() const { return EMPTY; };
+        enum Type type() const { return type_; };
 
         // Return the event referenced by the message. Return nullptr if type()
         // != EVENT.
-        virtual const Event* event() const { return nullptr; }
+        const Event* event() const {
+            return type_ == EVENT ? (const Event*)ref_ : nullptr;
+        }
 
         // Return the CAN frame referenced by the message. Return nullptr if
         // type() != CAN_FRAME.
-        virtual const Canny::CAN20Frame* can_frame() const { return nullptr; }
+        const Canny::CAN20Frame* can_frame() const {
+            return type_ == CAN_FRAME ? (const Canny::CAN20Frame*)ref_ : nullptr;
+        }
 
         // Return the J1939 address claim event referenced by the message.
         // Return nullptr if type() != J1939_CLAIM.
-        virtual const J1939Claim* j1939_claim() const { return nullptr; }
+        const J1939Claim* j1939_claim() const {
+            return type_ == J1939_CLAIM ? (const J1939Claim*)ref_ : nullptr;
+        }
 
         // Return the J1939 message referenced by the message. Return nullptr
         // if type() != J1939_MESSAGE.
-        virtual const Canny::J1939Message* j1939_message() const { return nullptr; }
+        const Canny::J1939Message* j1939_message() const {
+            return type_ == J1939_MESSAGE ? (const Canny::J1939Message*)ref_ : nullptr;
+        }
+
+        // Return the J1939 transfer referenced by the message. Return nullptr
+        // if type() != J1939_TRANSFER.
+        const J1939Transfer* j1939_transfer() const {
+            return type_ == J1939_TRANSFER ? (const J1939Transfer*)ref_ : nullptr;
+        }
+
+        // Return the J1939 node address referenced by the message. Return
+        // nullptr if type() != J1939_ADDRESS.
+        const J1939Address* j1939_address() const {
+            return type_ == J1939_ADDRESS ? (const J1939Address*)ref_ : nullptr;
+        }
 
         // Print the message. This prints the payload or nothing if empty.
         size_t printTo(Print& p) const;
 
     protected:
-        Message() {}
+        Message(Type type, const void* ref) : type_(type), ref_(ref) {}
         ~Message() = default;
+
+        Type type_;
+        const void* ref_;
+
+        friend class MessageView;
 };
 
 // The message value type. Holds a copy of the message payload. This should be
@@ -52,7 +82,7 @@ class Message : public Printable {
 class MessageValue : public Message {
     public:
         // Default constructor. Sets type to EMPTY.
-        MessageValue() : type_(EMPTY), empty_(0) {}
+        MessageValue() : Message(EMPTY, nullptr), empty_(0) {}
         ~MessageValue();
 
         // Copy another message into this one. If msg is a MessageView then its
@@ -62,52 +92,51 @@ class MessageValue : public Message {
 
         // Construct a message holding a copy of a system event.
         MessageValue(const Event& event) :
-            type_(EVENT), event_(event) {}
+            Message(EVENT, &event_), event_(event) {}
 
         // Construct a message holding a copy of a CAN frame.
         MessageValue(const Canny::CAN20Frame& can_frame) :
-            type_(CAN_FRAME), can_frame_(can_frame) {}
+            Message(CAN_FRAME, &can_frame_), can_frame_(can_frame) {}
 
         // Construct a message holding a copy of a J1939 address claim.
         MessageValue(const J1939Claim& j1939_claim) :
-            type_(J1939_CLAIM), j1939_claim_(j1939_claim) {}
+            Message(J1939_CLAIM, &j1939_claim_), j1939_claim_(j1939_claim) {}
 
         // Construct a message holding a copy of a J1939 message.
         MessageValue(const Canny::J1939Message& j1939_message) :
-            type_(J1939_MESSAGE), j1939_message_(j1939_message) {}
+            Message(J1939_MESSAGE, &j1939_message_), j1939_message_(j1939_message) {}
 
-        // Return the type of the mesasge.
-        enum Type type() const override { return type_; };
+        // Construct a message holding a copy of a J1939 transfer. The
+        // transfer's payload is not copied.
+        MessageValue(const J1939Transfer& j1939_transfer) :
+            Message(J1939_TRANSFER, &j1939_transfer_), j1939_transfer_(j1939_transfer) {}
 
-        // Return the event referenced by the message. Return nullptr if type()
-        // != EVENT.
-        const Event* event() const override;
-
-        // Return the CAN frame referenced by the message. Return nullptr if
-        // type() != CAN_FRAME.
-        const Canny::CAN20Frame* can_frame() const override;
+        // Construct a message holding a copy of a J1939 node address.
+        MessageValue(const J1939Address& j1939_address) :
+            Message(J1939_ADDRESS, &j1939_address_), j1939_address_(j1939_address) {}
 
-        // Return the J1939 address claim event referenced by the message.
-        // Return nullptr if type() != J1939_CLAIM.
-        const J1939Claim* j1939_claim() const override;
+        // Assignment operators.
+        MessageValue& operator=(const Message& msg);
+        MessageValue& operator=(const MessageValue& msg);
 
-        // Return the J1939 message referenced by the message. Return nullptr
-        // if type() != J1939_MESSAGE.
-        const Canny::J1939Message* j1939_message() const;
+        // Point the message back at its own payload. This must be called when
+        // the object's bytes have been copied without using its copy
+        // constructor, e.g. through a pico queue.
+        void relocate() { ref_ = type_ == EMPTY ? nullptr : &empty_; }
 
-        // Assignment operator.
-        MessageValue& operator=(const Message& msg);
     private:
-        Type type_;
         union {
             uint8_t empty_;
             Event event_;
             Canny::CAN20Frame can_frame_;
             J1939Claim j1939_claim_;
             Canny::J1939Message j1939_message_;
+            J1939Transfer j1939_transfer_;
+            J1939Address j1939_address_;
         };
 
         void copyFrom(const Message& msg);
+        void destroy();
 };
 
 // The message view type. Holds a reference to the message payload to avoid
@@ -115,50 +144,35 @@ class MessageValue : public Message {
 class MessageView : public Message {
     public:
         // Default constructor. Sets type to EMPTY.
-        MessageView() : type_(EMPTY), ref_(nullptr) {}
+        MessageView() : Message(EMPTY, nullptr) {}
 
         // Copy a reference to another message into this one. If msg is a
         // MessageValue then the new MessageView references that MessageValue.
-        MessageView(const Message& msg);
+        MessageView(const Message& msg) : Message(msg.type_, msg.ref_) {}
 
         // Construct a message that references a system event.
         MessageView(Event* event) :
-            type_(EVENT), ref_(event) {}
+            Message(event == nullptr ? EMPTY : EVENT, event) {}
 
         // Construct a message that references a CAN frame.
         MessageView(Canny::CAN20Frame* can_frame) :
-            type_(can_frame == nullptr ? EMPTY : CAN_FRAME), ref_(can_frame) {}
+            Message(can_frame == nullptr ? EMPTY : CAN_FRAME, can_frame) {}
 
         // Construct a message that references a J1939 address claim.
         MessageView(J1939Claim* j1939_claim) :
-            type_(j1939_claim == nullptr ? EMPTY : J1939_CLAIM), ref_(j1939_claim) {}
+            Message(j1939_claim == nullptr ? EMPTY : J1939_CLAIM, j1939_claim) {}
 
         // Construct a message that references a J1939 message.
         MessageView(Canny::J1939Message* j1939_message) :
-            type_(j1939_message == nullptr ? EMPTY : J1939_MESSAGE), ref_(j1939_message) {}
+            Message(j1939_message == nullptr ? EMPTY : J1939_MESSAGE, j1939_message) {}
 
-        // Return the type of the mesasge.
-        enum Type type() const override { return type_; };
+        // Construct a message that references a J1939 transfer.
+        MessageView(J1939Transfer* j1939_transfer) :
+            Message(j1939_transfer == nullptr ? EMPTY : J1939_TRANSFER, j1939_transfer) {}
 
-        // Return the event referenced by the message. Return nullptr if type()
-        // != EVENT.
-        const Event* event() const override;
-
-        // Return the CAN frame referenced by the message. Return nullptr if
-        // type() != CAN_FRAME.
-        const Canny::CAN20Frame* can_frame() const override;
-
-        // Return the J1939 address claim event referenced by the message.
-        // Return nullptr if type() != J1939_CLAIM.
-        const J1939Claim* j1939_claim() const override;
-
-        // Return the J1939 message referenced by the message. Return nullptr
-        // if type() != J1939_MESSAGE.
-        const Canny::J1939Message* j1939_message() const override;
-
-    private:
-        Type type_;
-        const void* ref_;
+        // Construct a message that references a J1939 node address.
+        MessageView(J1939Address* j1939_address) :
+            Message(j1939_address == nullptr ? EMPTY : J1939_ADDRESS, j1939_address) {}
 };
 
 // Return true if the two messages reference the same payload.
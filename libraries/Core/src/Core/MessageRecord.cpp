@@ -0,0 +1,231 @@
+#include "MessageRecord.h"
+
+#include <Arduino.h>
+#include <Canny.h>
+#include "Event.h"
+#include "J1939Claim.h"
+#include "J1939Transfer.h"
+#include "Message.h"
+
+namespace R51 {
+namespace {
+
+using ::Canny::CAN20Frame;
+using ::Canny::J1939Message;
+
+static const uint8_t kSizeMask = 0x1F;
+static const uint8_t kTypeShift = 5;
+
+// Set in a serialized CAN frame ID for extended frames.
+static const uint32_t kExtFlag = 0x80000000;
+
+// Largest frame or J1939 payload stored in a record.
+static const size_t kMaxDataSize = 8;
+
+// Size of an event record payload which is followed by scratch contents.
+static const size_t kScratchEventSize = 10;
+
+void putU32(uint8_t* dst, uint32_t value) {
+    memcpy(dst, &value, sizeof(value));
+}
+
+uint32_t getU32(const uint8_t* src) {
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+void putU16(uint8_t* dst, uint16_t value) {
+    memcpy(dst, &value, sizeof(value));
+}
+
+uint16_t getU16(const uint8_t* src) {
+    uint16_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
+size_t encodeMessageRecord(const Message& msg, uint8_t* record) {
+    uint8_t* payload = record + 1;
+    size_t size = 0;
+    switch (msg.type()) {
+        case Message::EVENT: {
+            const Event* event = msg.event();
+            payload[0] = event->subsystem;
+            payload[1] = event->id;
+            if (event->scratch != nullptr) {
+                memcpy(payload + 2, event->data, 6);
+                putU16(payload + 8, event->scratch->size);
+                size = kScratchEventSize;
+            } else {
+                size_t data_size = 6;
+                while (data_size > 0 && event->data[data_size - 1] == 0xFF) {
+                    --data_size;
+                }
+                memcpy(payload + 2, event->data, data_size);
+                size = 2 + data_size;
+            }
+            break;
+        }
+        case Message::CAN_FRAME: {
+            const CAN20Frame* frame = msg.can_frame();
+            uint32_t id = frame->id();
+            if (frame->ext()) {
+                id |= kExtFlag;
+            }
+            size_t data_size = frame->size() < kMaxDataSize ? frame->size() : kMaxDataSize;
+            putU32(payload, id);
+            memcpy(payload + 4, frame->data(), data_size);
+            size = 4 + data_size;
+            break;
+        }
+        case Message::J1939_CLAIM: {
+            const J1939Claim* claim = msg.j1939_claim();
+            uint64_t name = claim->name();
+            payload[0] = claim->address();
+            memcpy(payload + 1, &name, sizeof(name));
+            size = 1 + sizeof(name);
+            break;
+        }
+        case Message::J1939_MESSAGE: {
+            const J1939Message* j1939 = msg.j1939_message();
+            size_t data_size = j1939->size() < kMaxDataSize ? j1939->size() : kMaxDataSize;
+            putU32(payload, j1939->id());
+            memcpy(payload + 4, j1939->data(), data_size);
+            size = 4 + data_size;
+            break;
+        }
+        case Message::J1939_TRANSFER: {
+            const J1939Transfer* transfer = msg.j1939_transfer();
+            putU32(payload, transfer->id());
+            putU16(payload + 4, transfer->size());
+            size = 6;
+            break;
+        }
+        case Message::J1939_ADDRESS: {
+            const J1939Address* address = msg.j1939_address();
+            uint64_t name = address->name();
+            payload[0] = address->address();
+            memcpy(payload + 1, &name, sizeof(name));
+            size = 1 + sizeof(name);
+            break;
+        }
+        case Message::EMPTY:
+            break;
+    }
+    record[0] = (msg.type() << kTypeShift) | size;
+    return 1 + size;
+}
+
+bool decodeMessageRecord(const uint8_t* record, MessageValue* msg, Scratch* data) {
+    const uint8_t* payload = record + 1;
+    size_t size = record[0] & kSizeMask;
+    switch (record[0] >> kTypeShift) {
+        case Message::EVENT: {
+            if (size < 2) {
+                break;
+            }
+            Event event(payload[0], payload[1]);
+            if (size == kScratchEventSize) {
+                memcpy(event.data, payload + 2, 6);
+                event.scratch = data;
+            } else if (size > 8) {
+                break;
+            } else {
+                memcpy(event.data, payload + 2, size - 2);
+            }
+            *msg = MessageView(&event);
+            return true;
+        }
+        case Message::CAN_FRAME: {
+            if (size < 4) {
+                break;
+            }
+            uint32_t id = getU32(payload);
+            CAN20Frame frame(id & ~kExtFlag, (id & kExtFlag) != 0, size - 4);
+            memcpy(frame.data(), payload + 4, size - 4);
+            *msg = MessageView(&frame);
+            return true;
+        }
+        case Message::J1939_CLAIM: {
+            if (size < 9) {
+                break;
+            }
+            uint64_t name;
+            memcpy(&name, payload + 1, sizeof(name));
+            J1939Claim claim(payload[0], name);
+            *msg = MessageView(&claim);
+            return true;
+        }
+        case Message::J1939_MESSAGE: {
+            if (size < 4) {
+                break;
+            }
+            J1939Message j1939;
+            j1939.id(getU32(payload));
+            j1939.resize(size - 4);
+            memcpy(j1939.data(), payload + 4, size - 4);
+            *msg = MessageView(&j1939);
+            return true;
+        }
+        case Message::J1939_TRANSFER: {
+            if (size != 6) {
+                break;
+            }
+            J1939Transfer transfer;
+            transfer.id(getU32(payload));
+            if (getU16(payload + 4) > 0) {
+                transfer.data(data);
+            }
+            *msg = MessageView(&transfer);
+            return true;
+        }
+        case Message::J1939_ADDRESS: {
+            if (size < 9) {
+                break;
+            }
+            uint64_t name;
+            memcpy(&name, payload + 1, sizeof(name));
+            J1939Address address(payload[0], name);
+            *msg = MessageView(&address);
+            return true;
+        }
+        default:
+            break;
+    }
+    *msg = MessageValue();
+    return false;
+}
+
+size_t messageRecordDataSize(const uint8_t* record) {
+    size_t size = record[0] & kSizeMask;
+    switch (record[0] >> kTypeShift) {
+        case Message::EVENT:
+            return size == kScratchEventSize ? getU16(record + 9) : 0;
+        case Message::J1939_TRANSFER:
+            return size == 6 ? getU16(record + 5) : 0;
+        default:
+            return 0;
+    }
+}
+
+const uint8_t* messageRecordData(const Message& msg) {
+    switch (msg.type()) {
+        case Message::EVENT:
+            if (msg.event()->scratch == nullptr || msg.event()->scratch->size == 0) {
+                return nullptr;
+            }
+            return msg.event()->scratch->bytes;
+        case Message::J1939_TRANSFER:
+            if (msg.j1939_transfer()->size() == 0) {
+                return nullptr;
+            }
+            return msg.j1939_transfer()->bytes();
+        default:
+            return nullptr;
+    }
+}
+
+}  // namespace R51
@@ -0,0 +1,61 @@
+#ifndef _R51_CORE_MESSAGE_RECORD_H_
+#define _R51_CORE_MESSAGE_RECORD_H_
+
+#include <Arduino.h>
+#include "Message.h"
+#include "Scratch.h"
+
+namespace R51 {
+
+// Messages may be serialized into compact records for buffering. A record is
+// a one byte header holding the message type in the top three bits and the
+// payload size in the bottom five followed by only the payload bytes in use:
+//
+//   EVENT:         subsystem, id, data with trailing 0xFF bytes removed. If
+//                  the event references a scratch then all six data bytes
+//                  are stored followed by the 16-bit scratch size.
+//   CAN_FRAME:     32-bit ID with bit 31 set for extended frames, data.
+//   J1939_CLAIM:   address, 64-bit NAME.
+//   J1939_MESSAGE: 32-bit ID, data.
+//   J1939_TRANSFER: 32-bit ID, 16-bit payload size.
+//   J1939_ADDRESS: address, 64-bit NAME.
+//
+// Multi-byte values are in host byte order. Frame and J1939 data longer than
+// 8 bytes is truncated.
+//
+// A transfer's payload and an event's scratch contents do not fit in a record.
+// Buffers which hold them store the bytes after the record and give them back
+// to decodeMessageRecord(), so they are copied rather than shared with the
+// consumer. Records decoded without their bytes have no payload or scratch.
+
+// The largest possible record.
+static const size_t kMaxMessageRecordSize = 1 + 4 + 8;
+
+// Serialize a message into record, which must hold at least
+// kMaxMessageRecordSize bytes. Return the size of the record.
+size_t encodeMessageRecord(const Message& msg, uint8_t* record);
+
+// Deserialize a record into msg. The payload of a transfer or the scratch of
+// an event is read from data, which must hold messageRecordDataSize() bytes.
+// The message references data, so it is only valid while data is. Return
+// false and set msg to empty if the record is malformed.
+bool decodeMessageRecord(const uint8_t* record, MessageValue* msg,
+        Scratch* data = nullptr);
+
+// Return the size of a record given its header byte.
+inline size_t messageRecordSize(uint8_t header) {
+    return 1 + (header & 0x1F);
+}
+
+// Return the number of payload bytes which follow a record. This is the
+// payload size of a transfer or the scratch size of an event and zero for
+// other records.
+size_t messageRecordDataSize(const uint8_t* record);
+
+// Return the payload bytes of a message which follow its record. Return
+// nullptr if the message has none.
+const uint8_t* messageRecordData(const Message& msg);
+
+}  // namespace R51
+
+#endif  // _R51_CORE_MESSAGE_RECORD_H_
@@ -0,0 +1,44 @@
+#ifndef _R51_CORE_QUEUE_STATS_H_
+#define _R51_CORE_QUEUE_STATS_H_
+
+#include <Arduino.h>
+
+namespace R51 {
+
+// Depth stats for a queue between two buses.
+struct QueueStats {
+    // Number of messages currently queued.
+    size_t depth;
+    // Most messages queued at once.
+    size_t peak_depth;
+    // Most bytes in use at once.
+    size_t peak_bytes;
+    // Number of messages discarded because the queue was full.
+    size_t overruns;
+    // Most messages removed by a single drain.
+    size_t peak_drain;
+};
+
+// A set of named queues whose stats are shown by the console, e.g. the lanes
+// of a Pipe.
+class QueueStatsSource {
+    public:
+        virtual ~QueueStatsSource() = default;
+
+        // Return the number of queues.
+        virtual size_t queueCount() const = 0;
+
+        // Return the name of a queue.
+        virtual const char* queueName(size_t queue) const = 0;
+
+        // Return a snapshot of a queue's stats.
+        virtual QueueStats queueStats(size_t queue) const = 0;
+
+        // Ask for the peak values and overrun counts of every queue to be
+        // cleared.
+        virtual void resetQueueStats() = 0;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_QUEUE_STATS_H_
@@ -0,0 +1,62 @@
+#include "ReadBurst.h"
+
+#include <Arduino.h>
+
+namespace R51 {
+
+ReadBurst::ReadBurst(uint16_t count, uint32_t budget_us) :
+        max_count_(count > 0 ? count : 1), budget_us_(budget_us), start_(0),
+        count_(0), limited_(false), stopped_(false) {
+    resetStats();
+}
+
+void ReadBurst::limit(uint16_t count, uint32_t budget_us) {
+    max_count_ = count > 0 ? count : 1;
+    budget_us_ = budget_us;
+}
+
+void ReadBurst::begin() {
+    count_ = 0;
+    limited_ = false;
+    if (budget_us_ != 0) {
+        start_ = micros();
+    }
+}
+
+bool ReadBurst::more() {
+    if (count_ >= max_count_ ||
+            (count_ > 0 && budget_us_ != 0 && micros() - start_ >= budget_us_)) {
+        limited_ = true;
+        return false;
+    }
+    return true;
+}
+
+void ReadBurst::read() {
+    // A frame read right after a limited burst was left waiting by it.
+    if (count_ == 0 && stopped_) {
+        ++stats_.limited;
+    }
+    ++count_;
+}
+
+void ReadBurst::end() {
+    stopped_ = limited_;
+    if (count_ == 0) {
+        return;
+    }
+    ++stats_.bursts;
+    stats_.frames += count_;
+    if (count_ > stats_.peak) {
+        stats_.peak = count_;
+    }
+}
+
+void ReadBurst::resetStats() {
+    stats_.bursts = 0;
+    stats_.frames = 0;
+    stats_.peak = 0;
+    stats_.limited = 0;
+}
+
+}  // namespace R51
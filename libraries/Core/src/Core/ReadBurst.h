@@ -0,0 +1,69 @@
+#ifndef _R51_CORE_READ_BURST_H_
+#define _R51_CORE_READ_BURST_H_
+
+#include <Arduino.h>
+
+namespace R51 {
+
+// Frame counts kept by a ReadBurst.
+struct BurstStats {
+    // Number of emits which read at least one frame.
+    uint32_t bursts;
+    // Number of frames read.
+    uint32_t frames;
+    // Most frames read by a single emit.
+    uint16_t peak;
+    // Number of emits which stopped at the frame or time limit while frames
+    // were still waiting. The connection can't report its backlog so this is
+    // counted when the next emit finds a frame to read.
+    uint32_t limited;
+};
+
+// Limits the number of frames a gateway reads from its connection in one
+// emit. Reading several frames per emit lets a backlog in the connection's
+// read buffer clear in one bus loop instead of one loop per frame. The time
+// budget bounds how long a burst may hold up the rest of the bus.
+class ReadBurst {
+    public:
+        // Read up to count frames per emit. If budget_us is non-zero the
+        // burst also stops once that many microseconds have been spent. At
+        // least one frame is always read.
+        ReadBurst(uint16_t count = 1, uint32_t budget_us = 0);
+
+        // Change the burst limits.
+        void limit(uint16_t count, uint32_t budget_us = 0);
+
+        // Start a burst.
+        void begin();
+
+        // Return true if another frame may be read in this burst.
+        bool more();
+
+        // Record that a frame was read.
+        void read();
+
+        // End the burst and record its stats.
+        void end();
+
+        // Return the burst stats.
+        const BurstStats& stats() const { return stats_; }
+
+        // Clear the burst stats.
+        void resetStats();
+
+    private:
+        uint16_t max_count_;
+        uint32_t budget_us_;
+        uint32_t start_;
+        uint16_t count_;
+        // This burst stopped at a limit.
+        bool limited_;
+        // The previous burst stopped at a limit and may have left frames
+        // waiting.
+        bool stopped_;
+        BurstStats stats_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_READ_BURST_H_
@@ -5,6 +5,10 @@
 
 namespace R51 {
 
+void RealDashGateway::subscribe(Subscription* sub) {
+    sub->all(Message::EVENT);
+}
+
 void RealDashGateway::handle(const Message& msg, const Caster::Yield<Message>&) {
     if (msg.type() != Message::EVENT || msg.event()->id >= 0x10) {
         return;
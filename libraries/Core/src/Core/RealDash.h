@@ -5,13 +5,15 @@
 #include <Caster.h>
 #include <Foundation.h>
 #include "Message.h"
+#include "Subscription.h"
+#include "Timer.h"
 
 namespace R51 {
 
 // Caster node for communicating with RealDash. This converts Event messages to
 // CAN frames which are compatible with RealDash. Can be configured to
 // periodically send heartbeat to RealDash in order to keep it from timing out.
-class RealDashGateway : public Caster::Node<Message> {
+class RealDashGateway : public Caster::Node<Message>, public Subscriber {
     public:
         // Construct a new RealDash node that communicates over the provided
         // CAN connection. Events are sent and received using the provided
@@ -25,12 +27,18 @@ class RealDashGateway : public Caster::Node<Message> {
             connection_(connection), frame_id_(frame_id), hb_id_(heartbeat_id),
             hb_counter_(0), hb_ticker_(heartbeat_ms), frame_(0, 0, 8) {}
 
+        // Subscribe to all events.
+        void subscribe(Subscription* sub) override;
+
         // Encode and send an Event message to RealDash.
         void handle(const Message& msg, const Caster::Yield<Message>&) override;
 
         // Yield received Events from RealDash.
         void emit(const Caster::Yield<Message>& yield) override;
 
+        // Track the heartbeat ticker on a wheel.
+        void schedule(TimerWheel* wheel) { wheel->add(&hb_ticker_); }
+
         // Called when a read error occurs.
         virtual void onReadError(Canny::Error) {}
 
@@ -42,7 +50,7 @@ class RealDashGateway : public Caster::Node<Message> {
         uint32_t frame_id_;
         uint32_t hb_id_;
         uint8_t hb_counter_;
-        Ticker hb_ticker_;
+        Timer hb_ticker_;
         Canny::CAN20Frame frame_;
         Event event_;
 };
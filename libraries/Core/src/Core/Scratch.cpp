@@ -0,0 +1,173 @@
+#include "Scratch.h"
+
+#include <Arduino.h>
+
+namespace R51 {
+namespace {
+
+// Backing byte for empty scratch objects. Read-only so that a stray write
+// faults rather than corrupting every empty scratch.
+const uint8_t empty_scratch = 0;
+
+}  // namespace
+
+ScratchArena::ScratchArena(size_t size) :
+        blocks_(blockCount(size)), used_(0), peak_(0), failures_(0) {
+    data_ = new uint8_t[blocks_ * kScratchBlockSize];
+    size_t words = (blocks_ + 31) / 32;
+    free_ = new uint32_t[words];
+    memset(free_, 0, words * sizeof(uint32_t));
+    mark(0, blocks_, true);
+}
+
+ScratchArena::~ScratchArena() {
+    delete[] free_;
+    delete[] data_;
+}
+
+ScratchArena* ScratchArena::shared() {
+    static ScratchArena arena(SCRATCH_ARENA_SIZE);
+    return &arena;
+}
+
+uint8_t* ScratchArena::allocate(size_t size) {
+    size_t count = blockCount(size);
+    size_t start;
+    if (count == 0 || !findRun(count, &start)) {
+        ++failures_;
+        return nullptr;
+    }
+    take(start, count);
+    return data_ + start * kScratchBlockSize;
+}
+
+uint8_t* ScratchArena::reallocate(uint8_t* lease, size_t old_size, size_t size) {
+    if (lease == nullptr) {
+        return allocate(size);
+    }
+    size_t start = (lease - data_) / kScratchBlockSize;
+    size_t old_count = blockCount(old_size);
+    size_t count = blockCount(size);
+    if (count <= old_count) {
+        if (count < old_count) {
+            mark(start + count, old_count - count, true);
+            used_ -= old_count - count;
+        }
+        return lease;
+    }
+
+    // Grow in place if the following blocks are free.
+    size_t end = start + old_count;
+    size_t extra = count - old_count;
+    if (end + extra <= blocks_) {
+        size_t i = 0;
+        while (i < extra && isFree(end + i)) {
+            ++i;
+        }
+        if (i == extra) {
+            take(end, extra);
+            return lease;
+        }
+    }
+
+    uint8_t* moved = allocate(size);
+    if (moved == nullptr) {
+        return nullptr;
+    }
+    memcpy(moved, lease, old_count * kScratchBlockSize);
+    release(lease, old_size);
+    return moved;
+}
+
+void ScratchArena::release(uint8_t* lease, size_t old_size) {
+    if (lease == nullptr) {
+        return;
+    }
+    size_t count = blockCount(old_size);
+    mark((lease - data_) / kScratchBlockSize, count, true);
+    used_ -= count;
+}
+
+void ScratchArena::resetPeak() {
+    peak_ = used_;
+    failures_ = 0;
+}
+
+size_t ScratchArena::blockCount(size_t size) {
+    return (size + kScratchBlockSize - 1) / kScratchBlockSize;
+}
+
+bool ScratchArena::isFree(size_t block) const {
+    return (free_[block / 32] & ((uint32_t)1 << (block % 32))) != 0;
+}
+
+void ScratchArena::mark(size_t block, size_t count, bool free) {
+    for (size_t i = block; i < block + count; ++i) {
+        if (free) {
+            free_[i / 32] |= (uint32_t)1 << (i % 32);
+        } else {
+            free_[i / 32] &= ~((uint32_t)1 << (i % 32));
+        }
+    }
+}
+
+bool ScratchArena::findRun(size_t count, size_t* start) const {
+    size_t run = 0;
+    for (size_t i = 0; i < blocks_; ++i) {
+        if (!isFree(i)) {
+            run = 0;
+            continue;
+        }
+        if (++run == count) {
+            *start = i + 1 - count;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ScratchArena::take(size_t start, size_t count) {
+    mark(start, count, false);
+    used_ += count;
+    if (used_ > peak_) {
+        peak_ = used_;
+    }
+}
+
+Scratch::Scratch(ScratchArena* arena) :
+    bytes((uint8_t*)&empty_scratch), size(0), arena_(arena), capacity_(0) {}
+
+Scratch::~Scratch() {
+    clear();
+}
+
+bool Scratch::reserve(size_t capacity) {
+    if (capacity <= capacity_) {
+        return true;
+    }
+    if (capacity > kScratchCapacity) {
+        return false;
+    }
+    // Round up to whole blocks so that the full lease is usable.
+    capacity = (capacity + kScratchBlockSize - 1) / kScratchBlockSize * kScratchBlockSize;
+    uint8_t* lease = arena_->reallocate(capacity_ == 0 ? nullptr : bytes, capacity_, capacity);
+    if (lease == nullptr) {
+        return false;
+    }
+    // Zero the new space so that strings written into it are terminated.
+    memset(lease + capacity_, 0, capacity - capacity_);
+    bytes = lease;
+    capacity_ = capacity;
+    return true;
+}
+
+void Scratch::clear() {
+    if (capacity_ != 0) {
+        arena_->release(bytes, capacity_);
+    }
+    bytes = (uint8_t*)&empty_scratch;
+    size = 0;
+    capacity_ = 0;
+}
+
+}  // namespace R51
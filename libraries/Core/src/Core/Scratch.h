@@ -1,27 +1,122 @@
 #ifndef _R51_CORE_SCRATCH_H_
 #define _R51_CORE_SCRATCH_H_
 
+#include <Arduino.h>
+
+// Size in bytes of the shared scratch arena. Override in the build flags to
+// fit the strings a sketch needs to hold at once.
+#ifndef SCRATCH_ARENA_SIZE
+#define SCRATCH_ARENA_SIZE 1024
+#endif
+
 namespace R51 {
 
+// The largest lease a Scratch may hold.
 static const size_t kScratchCapacity = 256;
 
-// A scratch space for temporary storage that's easily pre-allocated.
-struct Scratch {
-    // The byte buffer that holds the data in the space.
-    uint8_t bytes[kScratchCapacity];
-    // The number of bytes currently occupying the spacce.
-    size_t size;
-
-    // Create a new buffer.
-    Scratch() : size(0) {
-        memset(bytes, 0, kScratchCapacity);
-    }
-
-    // Clear the buffer.
-    void clear() {
-        size = 0;
-        bytes[0] = 0;
-    }
+// Leases are handed out in multiples of this many bytes.
+static const size_t kScratchBlockSize = 16;
+
+// A fixed arena which hands out scratch leases in blocks. Allocation is first
+// fit and a lease is grown in place when the blocks after it are free. The
+// arena is not thread safe; all of its leases must be used from one core.
+class ScratchArena {
+    public:
+        // Construct an arena of the given size in bytes. The arena is
+        // allocated once here.
+        ScratchArena(size_t size);
+        ~ScratchArena();
+
+        // Return the arena shared by Scratch objects which are not given one.
+        // It holds SCRATCH_ARENA_SIZE bytes.
+        static ScratchArena* shared();
+
+        // Allocate a lease of at least size bytes. Return nullptr if the
+        // arena does not have enough contiguous free space.
+        uint8_t* allocate(size_t size);
+
+        // Resize a lease to at least size bytes and return its new location.
+        // The lease's contents are preserved. Return nullptr and leave the
+        // lease in place if there is not enough space. The lease's current
+        // size is given by old_size.
+        uint8_t* reallocate(uint8_t* lease, size_t old_size, size_t size);
+
+        // Return a lease of old_size bytes to the arena.
+        void release(uint8_t* lease, size_t old_size);
+
+        // Return the size of the arena in bytes.
+        size_t capacity() const { return blocks_ * kScratchBlockSize; }
+
+        // Return the number of bytes currently leased.
+        size_t used() const { return used_ * kScratchBlockSize; }
+
+        // Return the most bytes leased at once.
+        size_t peak() const { return peak_ * kScratchBlockSize; }
+
+        // Return the number of allocations which failed for lack of space.
+        uint32_t failures() const { return failures_; }
+
+        // Reset the peak to the current usage and clear the failure count.
+        void resetPeak();
+
+    private:
+        uint8_t* data_;
+        uint32_t* free_;    // Bitmap of free blocks.
+        size_t blocks_;
+        size_t used_;
+        size_t peak_;
+        uint32_t failures_;
+
+        static size_t blockCount(size_t size);
+        bool isFree(size_t block) const;
+        void mark(size_t block, size_t count, bool free);
+        bool findRun(size_t count, size_t* start) const;
+        void take(size_t start, size_t count);
+};
+
+// A scratch space for temporary storage such as strings that are too long to
+// fit in an event. The space is a lease from a ScratchArena sized to fit its
+// contents.
+//
+// Events reference the Scratch object rather than its lease, so a lease that
+// moves while growing is still found through the event. The contents belong
+// to the node which owns the Scratch and remain valid until that node next
+// modifies them. A node which receives a Scratch must copy its contents if it
+// needs them after handle() returns.
+class Scratch {
+    public:
+        // The bytes held by the scratch. This is never nullptr; an empty
+        // scratch points at a single read-only zero byte. Only write to the
+        // bytes after reserve() has succeeded.
+        uint8_t* bytes;
+        // The number of bytes currently occupying the space.
+        size_t size;
+
+        // Create a new scratch which leases its space from the given arena.
+        // No space is leased until reserve() is called.
+        Scratch(ScratchArena* arena = ScratchArena::shared());
+
+        // Return the lease to the arena.
+        ~Scratch();
+
+        Scratch(const Scratch&) = delete;
+        Scratch& operator=(const Scratch&) = delete;
+
+        // Return the number of bytes that may be written without calling
+        // reserve().
+        size_t capacity() const { return capacity_; }
+
+        // Grow the lease to hold at least capacity bytes. Existing contents
+        // are preserved. Return false if the capacity exceeds
+        // kScratchCapacity or the arena is out of space.
+        bool reserve(size_t capacity);
+
+        // Clear the scratch and return its lease to the arena.
+        void clear();
+
+    private:
+        ScratchArena* arena_;
+        size_t capacity_;
 };
 
 }  // namespace R51
@@ -0,0 +1,164 @@
+#ifndef _R51_CORE_STATIC_BUS_H_
+#define _R51_CORE_STATIC_BUS_H_
+
+#include <Arduino.h>
+#include <Caster.h>
+#include "Bus.h"
+#include "BusStats.h"
+#include "Message.h"
+#include "Subscription.h"
+
+namespace R51 {
+
+namespace internal {
+
+// Recursive storage for the nodes of a StaticBus. Each level holds one node
+// and calls into it by its concrete type so the calls are not dispatched
+// through the vtable and may be inlined.
+template <size_t I, typename... Nodes>
+class StaticNodes {
+    public:
+        void subscribe(Subscription*, const Subscription**) {}
+
+        template <typename Bus>
+        void init(Bus*) {}
+
+        template <typename Bus>
+        void emit(Bus*) {}
+
+        template <typename Bus>
+        void handle(Bus*, const Message&, uint32_t) {}
+};
+
+template <size_t I, typename N, typename... Rest>
+class StaticNodes<I, N, Rest...> : public StaticNodes<I + 1, Rest...> {
+    public:
+        StaticNodes(N* node, Rest*... rest) :
+            StaticNodes<I + 1, Rest...>(rest...), node_(node) {}
+
+        void subscribe(Subscription* subs, const Subscription** refs) {
+            Subscriber* subscriber = asSubscriber(node_);
+            if (subscriber != nullptr) {
+                subscriber->subscribe(&subs[I]);
+                refs[I] = &subs[I];
+            } else {
+                refs[I] = nullptr;
+            }
+            Next::subscribe(subs, refs);
+        }
+
+        template <typename Bus>
+        void init(Bus* bus) {
+            node_->N::init(typename Bus::NodeYield(bus, I));
+            Next::init(bus);
+        }
+
+        template <typename Bus>
+        void emit(Bus* bus) {
+            BusStats::Mark mark = bus->stats()->begin();
+            node_->N::emit(typename Bus::NodeYield(bus, I));
+            bus->stats()->emitted(I, mark);
+            Next::emit(bus);
+        }
+
+        template <typename Bus>
+        void handle(Bus* bus, const Message& msg, uint32_t nodes) {
+            if ((nodes & ((uint32_t)1 << I)) != 0) {
+                BusStats::Mark mark = bus->stats()->begin();
+                node_->N::handle(msg, typename Bus::NodeYield(bus, I));
+                bus->stats()->handled(I, mark);
+                nodes &= ~((uint32_t)1 << I);
+            }
+            if (nodes != 0) {
+                Next::handle(bus, msg, nodes);
+            }
+        }
+
+    private:
+        typedef StaticNodes<I + 1, Rest...> Next;
+
+        N* node_;
+};
+
+}  // namespace internal
+
+// Message bus assembled at compile time from a list of node types. Nodes are
+// called by their concrete types rather than through Caster::Node's virtual
+// methods which allows the compiler to inline dispatch. Messages are routed
+// with the same subscription index as IndexedBus.
+//
+// Example:
+//   StaticBus<Climate, Settings, IPDM> bus(&climate, &settings, &ipdm);
+//
+// The node types must be the most derived types of the nodes passed in. A
+// bus can hold at most SubscriptionIndex::kMaxNodes nodes.
+template <typename... Nodes>
+class StaticBus {
+    public:
+        static_assert(sizeof...(Nodes) <= SubscriptionIndex::kMaxNodes,
+                "too many nodes on StaticBus");
+
+        // Construct a bus over the given nodes.
+        StaticBus(Nodes*... nodes) : nodes_(nodes...) {}
+
+        // Build the dispatch index and initialize the nodes.
+        void init() {
+            Subscription* subs = new Subscription[kSize];
+            const Subscription** refs = new const Subscription*[kSize];
+            nodes_.subscribe(subs, refs);
+            index_.build(refs, kSize);
+            delete[] refs;
+            delete[] subs;
+            stats_.init(kSize);
+
+            nodes_.init(this);
+        }
+
+        // Call emit() on every node.
+        void loop() {
+            stats_.poll();
+            nodes_.emit(this);
+        }
+
+        // Send a message to all subscribed nodes.
+        void emit(const Message& msg) {
+            dispatch(msg, kSize);
+        }
+
+        // Return the per-node stats. Nodes are in the order of the bus's
+        // template arguments. Name them with BusStats::names().
+        BusStats* stats() { return &stats_; }
+
+        class NodeYield : public Caster::Yield<Message> {
+            public:
+                NodeYield(StaticBus* bus, size_t source) : bus_(bus), source_(source) {}
+
+                void operator()(const Message& msg) const override {
+                    bus_->dispatch(msg, source_);
+                }
+
+            private:
+                StaticBus* bus_;
+                size_t source_;
+        };
+
+    private:
+        static const size_t kSize = sizeof...(Nodes);
+
+        internal::StaticNodes<0, Nodes...> nodes_;
+        SubscriptionIndex index_;
+        BusStats stats_;
+
+        void dispatch(const Message& msg, size_t source) {
+            uint32_t nodes = index_.match(msg);
+            if (source < kSize) {
+                nodes &= ~((uint32_t)1 << source);
+                stats_.yielded(source);
+            }
+            nodes_.handle(this, msg, nodes);
+        }
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_STATIC_BUS_H_
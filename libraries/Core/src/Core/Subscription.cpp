@@ -0,0 +1,278 @@
+#include "Subscription.h"
+
+#include <Arduino.h>
+#include "Message.h"
+
+namespace R51 {
+namespace {
+
+uint32_t eventKey(uint8_t subsystem, uint8_t id) {
+    return ((uint32_t)subsystem << 8) | id;
+}
+
+// Sort and deduplicate keys in place. Return the new number of keys.
+size_t sortUnique(uint32_t* keys, size_t size) {
+    for (size_t i = 1; i < size; ++i) {
+        uint32_t key = keys[i];
+        size_t j = i;
+        for (; j > 0 && keys[j - 1] > key; --j) {
+            keys[j] = keys[j - 1];
+        }
+        keys[j] = key;
+    }
+    size_t len = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (len == 0 || keys[len - 1] != keys[i]) {
+            keys[len++] = keys[i];
+        }
+    }
+    return len;
+}
+
+}  // namespace
+
+void Subscription::all() {
+    all_ = 0xFF;
+}
+
+void Subscription::all(Message::Type type) {
+    all_ |= (1 << type);
+}
+
+void Subscription::event(uint8_t subsystem) {
+    add(Message::EVENT, eventKey(subsystem, 0x00), eventKey(subsystem, 0xFF));
+}
+
+void Subscription::event(uint8_t subsystem, uint8_t id) {
+    add(Message::EVENT, eventKey(subsystem, id), eventKey(subsystem, id));
+}
+
+void Subscription::event(uint8_t subsystem, uint8_t min_id, uint8_t max_id) {
+    add(Message::EVENT, eventKey(subsystem, min_id), eventKey(subsystem, max_id));
+}
+
+void Subscription::canFrame(uint32_t id) {
+    add(Message::CAN_FRAME, id, id);
+}
+
+void Subscription::canFrame(uint32_t min_id, uint32_t max_id) {
+    add(Message::CAN_FRAME, min_id, max_id);
+}
+
+void Subscription::j1939Claim() {
+    all(Message::J1939_CLAIM);
+}
+
+void Subscription::j1939Address() {
+    all(Message::J1939_ADDRESS);
+}
+
+void Subscription::j1939Message(uint32_t pgn) {
+    add(Message::J1939_MESSAGE, pgn, pgn);
+}
+
+void Subscription::j1939Message(uint32_t min_pgn, uint32_t max_pgn) {
+    add(Message::J1939_MESSAGE, min_pgn, max_pgn);
+}
+
+void Subscription::j1939Transfer(uint32_t pgn) {
+    add(Message::J1939_TRANSFER, pgn, pgn);
+}
+
+void Subscription::j1939Transfer(uint32_t min_pgn, uint32_t max_pgn) {
+    add(Message::J1939_TRANSFER, min_pgn, max_pgn);
+}
+
+void Subscription::add(Message::Type type, uint32_t min, uint32_t max) {
+    if (max > kMaxKey) {
+        max = kMaxKey;
+    }
+    if (min > max) {
+        return;
+    }
+    if (size_ >= kMaxRanges) {
+        all(type);
+        return;
+    }
+    ranges_[size_].type = type;
+    ranges_[size_].min = min;
+    ranges_[size_].max = max;
+    ++size_;
+}
+
+bool Subscription::match(const Message& msg) const {
+    if (all(msg.type())) {
+        return true;
+    }
+    uint32_t k = key(msg);
+    for (size_t i = 0; i < size_; ++i) {
+        if (ranges_[i].type == msg.type() && ranges_[i].min <= k && k <= ranges_[i].max) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t Subscription::key(const Message& msg) {
+    switch (msg.type()) {
+        case Message::EVENT:
+            if (msg.event() != nullptr) {
+                return eventKey(msg.event()->subsystem, msg.event()->id);
+            }
+            break;
+        case Message::CAN_FRAME:
+            if (msg.can_frame() != nullptr) {
+                return msg.can_frame()->id();
+            }
+            break;
+        case Message::J1939_MESSAGE:
+            if (msg.j1939_message() != nullptr) {
+                return msg.j1939_message()->pgn();
+            }
+            break;
+        case Message::J1939_TRANSFER:
+            if (msg.j1939_transfer() != nullptr) {
+                return msg.j1939_transfer()->pgn();
+            }
+            break;
+        case Message::EMPTY:
+        case Message::J1939_CLAIM:
+        case Message::J1939_ADDRESS:
+            break;
+    }
+    return 0;
+}
+
+SubscriptionIndex::SubscriptionIndex() {
+    for (size_t i = 0; i < kTypes; ++i) {
+        all_[i] = 0;
+        routes_[i] = nullptr;
+        sizes_[i] = 0;
+    }
+}
+
+SubscriptionIndex::~SubscriptionIndex() {
+    clear();
+}
+
+void SubscriptionIndex::clear() {
+    for (size_t i = 0; i < kTypes; ++i) {
+        all_[i] = 0;
+        if (routes_[i] != nullptr) {
+            delete[] routes_[i];
+            routes_[i] = nullptr;
+        }
+        sizes_[i] = 0;
+    }
+}
+
+void SubscriptionIndex::build(const Subscription* const* subs, size_t size) {
+    clear();
+    if (size > kMaxNodes) {
+        size = kMaxNodes;
+    }
+    for (size_t i = 0; i < kTypes; ++i) {
+        buildType((Message::Type)i, subs, size);
+    }
+}
+
+void SubscriptionIndex::buildType(Message::Type type, const Subscription* const* subs, size_t size) {
+    // Nodes without a subscription or which subscribe to the whole type are
+    // matched without a lookup.
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (subs[i] == nullptr || subs[i]->all(type)) {
+            all_[type] |= ((uint32_t)1 << i);
+            continue;
+        }
+        for (size_t j = 0; j < subs[i]->size_; ++j) {
+            if (subs[i]->ranges_[j].type == type) {
+                ++count;
+            }
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // Split the key space at every range boundary. Each resulting interval is
+    // either fully inside or fully outside of every range.
+    uint32_t* bounds = new uint32_t[count * 2];
+    size_t bounds_size = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if ((all_[type] & ((uint32_t)1 << i)) != 0) {
+            continue;
+        }
+        for (size_t j = 0; j < subs[i]->size_; ++j) {
+            const Subscription::Range& range = subs[i]->ranges_[j];
+            if (range.type == type) {
+                bounds[bounds_size++] = range.min;
+                bounds[bounds_size++] = range.max + 1;
+            }
+        }
+    }
+    bounds_size = sortUnique(bounds, bounds_size);
+
+    // Assign nodes to each interval and merge adjacent intervals which route
+    // to the same nodes.
+    routes_[type] = new Route[bounds_size];
+    for (size_t b = 0; b + 1 < bounds_size; ++b) {
+        uint32_t min = bounds[b];
+        uint32_t max = bounds[b + 1] - 1;
+        uint32_t nodes = 0;
+        for (size_t i = 0; i < size; ++i) {
+            if ((all_[type] & ((uint32_t)1 << i)) != 0) {
+                continue;
+            }
+            for (size_t j = 0; j < subs[i]->size_; ++j) {
+                const Subscription::Range& range = subs[i]->ranges_[j];
+                if (range.type == type && range.min <= min && max <= range.max) {
+                    nodes |= ((uint32_t)1 << i);
+                    break;
+                }
+            }
+        }
+        if (nodes == 0) {
+            continue;
+        }
+        size_t n = sizes_[type];
+        if (n > 0 && routes_[type][n - 1].max + 1 == min &&
+                routes_[type][n - 1].nodes == nodes) {
+            routes_[type][n - 1].max = max;
+        } else {
+            routes_[type][n].min = min;
+            routes_[type][n].max = max;
+            routes_[type][n].nodes = nodes;
+            ++sizes_[type];
+        }
+    }
+    delete[] bounds;
+}
+
+uint32_t SubscriptionIndex::match(const Message& msg) const {
+    if (msg.type() == Message::EMPTY || msg.type() == Message::J1939_CLAIM ||
+            msg.type() == Message::J1939_ADDRESS) {
+        return all_[msg.type()];
+    }
+    return match(msg.type(), Subscription::key(msg));
+}
+
+uint32_t SubscriptionIndex::match(Message::Type type, uint32_t key) const {
+    uint32_t nodes = all_[type];
+    const Route* routes = routes_[type];
+    size_t lo = 0;
+    size_t hi = sizes_[type];
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (key < routes[mid].min) {
+            hi = mid;
+        } else if (key > routes[mid].max) {
+            lo = mid + 1;
+        } else {
+            return nodes | routes[mid].nodes;
+        }
+    }
+    return nodes;
+}
+
+}  // namespace R51
@@ -0,0 +1,140 @@
+#ifndef _R51_CORE_SUBSCRIPTION_H_
+#define _R51_CORE_SUBSCRIPTION_H_
+
+#include <Arduino.h>
+#include "Message.h"
+
+namespace R51 {
+
+// Declares which messages a bus node handles. Messages are matched on type
+// and a per-type key: (subsystem << 8) | id for events, the frame ID for CAN
+// frames, and the PGN for J1939 messages and transfers. Each call adds an inclusive range of
+// keys to the subscription.
+class Subscription {
+    public:
+        // Maximum number of ranges held by a subscription. Adding ranges
+        // beyond this subscribes to all messages of that type.
+        static const size_t kMaxRanges = 16;
+
+        // Largest key that may be subscribed to. This fits a 29-bit CAN ID.
+        static const uint32_t kMaxKey = 0x1FFFFFFF;
+
+        // Construct an empty subscription which matches no messages.
+        Subscription() : size_(0), all_(0) {}
+
+        // Subscribe to all messages.
+        void all();
+
+        // Subscribe to all messages of the given type.
+        void all(Message::Type type);
+
+        // Subscribe to all events in a subsystem.
+        void event(uint8_t subsystem);
+
+        // Subscribe to a single event.
+        void event(uint8_t subsystem, uint8_t id);
+
+        // Subscribe to a range of event IDs in a subsystem.
+        void event(uint8_t subsystem, uint8_t min_id, uint8_t max_id);
+
+        // Subscribe to a single CAN frame ID.
+        void canFrame(uint32_t id);
+
+        // Subscribe to a range of CAN frame IDs.
+        void canFrame(uint32_t min_id, uint32_t max_id);
+
+        // Subscribe to J1939 address claims.
+        void j1939Claim();
+
+        // Subscribe to changes in the addresses of other J1939 nodes.
+        void j1939Address();
+
+        // Subscribe to a single J1939 PGN.
+        void j1939Message(uint32_t pgn);
+
+        // Subscribe to a range of J1939 PGNs.
+        void j1939Message(uint32_t min_pgn, uint32_t max_pgn);
+
+        // Subscribe to J1939 transfers of a single PGN.
+        void j1939Transfer(uint32_t pgn);
+
+        // Subscribe to J1939 transfers of a range of PGNs.
+        void j1939Transfer(uint32_t min_pgn, uint32_t max_pgn);
+
+        // Return true if the subscription matches the message.
+        bool match(const Message& msg) const;
+
+        // Return true if the subscription matches all messages of a type.
+        bool all(Message::Type type) const {
+            return (all_ & (1 << type)) != 0;
+        }
+
+        // Return the routing key of a message.
+        static uint32_t key(const Message& msg);
+
+    private:
+        struct Range {
+            Message::Type type;
+            uint32_t min;
+            uint32_t max;
+        };
+
+        Range ranges_[kMaxRanges];
+        size_t size_;
+        uint8_t all_;
+
+        void add(Message::Type type, uint32_t min, uint32_t max);
+
+        friend class SubscriptionIndex;
+};
+
+// Interface implemented by nodes that declare their subscriptions to the bus.
+// Nodes that do not implement this receive every message.
+class Subscriber {
+    public:
+        // Populate the subscription with the messages handled by the node.
+        virtual void subscribe(Subscription* sub) = 0;
+};
+
+// Index of subscriptions for fast message routing. Maps each message to a
+// bitmask of the nodes subscribed to it. Bit N of a mask refers to the Nth
+// subscription passed to build().
+class SubscriptionIndex {
+    public:
+        // Maximum number of subscriptions an index can hold.
+        static const size_t kMaxNodes = 32;
+
+        SubscriptionIndex();
+        ~SubscriptionIndex();
+
+        // Build the index from a list of subscriptions. A nullptr entry
+        // subscribes that node to all messages. Any existing index is
+        // replaced.
+        void build(const Subscription* const* subs, size_t size);
+
+        // Return the mask of nodes subscribed to the message.
+        uint32_t match(const Message& msg) const;
+
+        // Return the mask of nodes subscribed to a key of the given type.
+        uint32_t match(Message::Type type, uint32_t key) const;
+
+    private:
+        static const size_t kTypes = Message::J1939_ADDRESS + 1;
+
+        struct Route {
+            uint32_t min;
+            uint32_t max;
+            uint32_t nodes;
+        };
+
+        uint32_t all_[kTypes];
+        Route* routes_[kTypes];
+        size_t sizes_[kTypes];
+
+        void clear();
+        void buildType(Message::Type type, const Subscription* const* subs, size_t size);
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_SUBSCRIPTION_H_
@@ -0,0 +1,171 @@
+#include "Timer.h"
+
+#include <Arduino.h>
+#include <Caster.h>
+#include <Faker.h>
+#include "Message.h"
+
+namespace R51 {
+
+Timer::Timer(uint32_t interval, bool paused, Faker::Clock* clock) :
+        clock_(clock), wheel_(nullptr), next_(nullptr), slot_(kUnlinked),
+        interval_(interval),
+        start_(clock->millis()), paused_(paused), fired_(false) {}
+
+Timer::~Timer() {
+    if (wheel_ != nullptr) {
+        wheel_->unlink(this);
+    }
+}
+
+bool Timer::active() const {
+    if (paused_) {
+        return false;
+    }
+    if (wheel_ != nullptr) {
+        return fired_;
+    }
+    return (int32_t)(clock_->millis() - deadline()) >= 0;
+}
+
+void Timer::reset() {
+    if (wheel_ != nullptr) {
+        wheel_->unlink(this);
+    }
+    start_ = now();
+    if (wheel_ != nullptr && !paused_) {
+        wheel_->link(this);
+    }
+}
+
+void Timer::reset(uint32_t interval) {
+    if (wheel_ != nullptr) {
+        wheel_->unlink(this);
+    }
+    interval_ = interval;
+    reset();
+}
+
+void Timer::pause() {
+    paused_ = true;
+    if (wheel_ != nullptr) {
+        wheel_->unlink(this);
+    }
+}
+
+void Timer::resume() {
+    paused_ = false;
+    reset();
+}
+
+void Timer::resume(uint32_t interval) {
+    if (wheel_ != nullptr) {
+        wheel_->unlink(this);
+    }
+    interval_ = interval;
+    resume();
+}
+
+uint32_t Timer::now() const {
+    return wheel_ != nullptr ? wheel_->now() : clock_->millis();
+}
+
+TimerWheel::TimerWheel(uint8_t resolution_ms, Faker::Clock* clock) :
+        clock_(clock), resolution_(resolution_ms > 0 ? resolution_ms : 1),
+        now_(clock->millis()), tick_(now_ / resolution_), added_(0),
+        pending_(0) {
+    memset(slots_, 0, sizeof(slots_));
+}
+
+TimerWheel::~TimerWheel() {
+    for (size_t i = 0; i < kSlots; ++i) {
+        while (slots_[i] != nullptr) {
+            Timer* timer = slots_[i];
+            slots_[i] = timer->next_;
+            timer->next_ = nullptr;
+            timer->slot_ = Timer::kUnlinked;
+            timer->wheel_ = nullptr;
+        }
+    }
+}
+
+void TimerWheel::add(Timer* timer) {
+    if (timer->wheel_ != nullptr) {
+        return;
+    }
+    if (timer->interval_ > 0) {
+        timer->start_ += (added_ * resolution_) % timer->interval_;
+    }
+    ++added_;
+    timer->wheel_ = this;
+    timer->fired_ = false;
+    if (!timer->paused_) {
+        link(timer);
+    }
+}
+
+void TimerWheel::emit(const Caster::Yield<Message>&) {
+    advance();
+}
+
+void TimerWheel::advance() {
+    now_ = clock_->millis();
+    uint32_t tick = now_ / resolution_;
+
+    // The slot of the last pass is checked again since timers may have been
+    // linked into it after it was checked.
+    uint32_t count = tick - tick_ + 1;
+    if (count > kSlots) {
+        count = kSlots;
+    }
+    for (uint32_t i = 0; i < count && pending_ > 0; ++i) {
+        fire(&slots_[(tick - i) % kSlots]);
+    }
+    tick_ = tick;
+}
+
+void TimerWheel::link(Timer* timer) {
+    timer->fired_ = false;
+    uint32_t deadline = timer->deadline();
+    if ((int32_t)(deadline - now_) <= 0) {
+        timer->fired_ = true;
+        return;
+    }
+    timer->slot_ = (deadline / resolution_) % kSlots;
+    timer->next_ = slots_[timer->slot_];
+    slots_[timer->slot_] = timer;
+    ++pending_;
+}
+
+void TimerWheel::unlink(Timer* timer) {
+    if (timer->slot_ == Timer::kUnlinked) {
+        return;
+    }
+    for (Timer** t = &slots_[timer->slot_]; *t != nullptr; t = &(*t)->next_) {
+        if (*t == timer) {
+            *t = timer->next_;
+            break;
+        }
+    }
+    timer->next_ = nullptr;
+    timer->slot_ = Timer::kUnlinked;
+    --pending_;
+}
+
+void TimerWheel::fire(Timer** slot) {
+    Timer** t = slot;
+    while (*t != nullptr) {
+        Timer* timer = *t;
+        if ((int32_t)(now_ - timer->deadline()) >= 0) {
+            *t = timer->next_;
+            timer->next_ = nullptr;
+            timer->slot_ = Timer::kUnlinked;
+            timer->fired_ = true;
+            --pending_;
+        } else {
+            t = &timer->next_;
+        }
+    }
+}
+
+}  // namespace R51
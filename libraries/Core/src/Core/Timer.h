@@ -0,0 +1,140 @@
+#ifndef _R51_CORE_TIMER_H_
+#define _R51_CORE_TIMER_H_
+
+#include <Arduino.h>
+#include <Caster.h>
+#include <Faker.h>
+#include "Message.h"
+#include "Subscription.h"
+
+namespace R51 {
+
+class TimerWheel;
+
+// A periodic or one-shot deadline. The interface matches Foundation's Ticker
+// so the two may be swapped. A timer reads its clock on every call to
+// active() until it is added to a TimerWheel. The wheel then tracks the
+// deadline and active() becomes a flag check.
+class Timer {
+    public:
+        // Construct a timer which becomes active interval ms from now. The
+        // timer does nothing while paused.
+        Timer(uint32_t interval = 0, bool paused = false,
+                Faker::Clock* clock = Faker::Clock::real());
+
+        // Remove the timer from its wheel.
+        ~Timer();
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        // Return true if the interval has elapsed since the timer was last
+        // reset. Remains true until the timer is reset or paused.
+        bool active() const;
+
+        // Restart the interval from now.
+        void reset();
+
+        // Set a new interval and restart it from now.
+        void reset(uint32_t interval);
+
+        // Stop the timer.
+        void pause();
+
+        // Restart a paused timer.
+        void resume();
+
+        // Set a new interval and restart the timer.
+        void resume(uint32_t interval);
+
+        // Return the timer's interval.
+        uint32_t interval() const { return interval_; }
+
+        // Return true if the timer is paused.
+        bool paused() const { return paused_; }
+
+    private:
+        friend class TimerWheel;
+
+        // Slot value of a timer which is not linked into its wheel.
+        static const uint8_t kUnlinked = 0xFF;
+
+        Faker::Clock* clock_;
+        TimerWheel* wheel_;
+        Timer* next_;
+        uint8_t slot_;
+        uint32_t interval_;
+        uint32_t start_;
+        bool paused_;
+        bool fired_;
+
+        uint32_t now() const;
+        uint32_t deadline() const { return start_ + interval_; }
+};
+
+// Tracks the deadlines of the timers added to it so that nodes do not need to
+// read the clock on every emit. Deadlines are kept in a hashed wheel of slots
+// resolution ms wide and only the slots which have come due since the last
+// pass are checked.
+//
+// Periodic timers which are added at the same time would otherwise fire on
+// the same pass and yield their events in one burst. Each added timer is
+// delayed by one slot more than the one before it, modulo its interval, to
+// spread them across passes.
+//
+// The wheel is a bus node and should be placed first on its bus so that it
+// runs before the nodes whose timers it tracks. A wheel and its timers must
+// only be used from one core.
+class TimerWheel : public Caster::Node<Message>, public Subscriber {
+    public:
+        // Number of slots in the wheel.
+        static const size_t kSlots = 32;
+
+        // Construct a wheel with the given slot width.
+        TimerWheel(uint8_t resolution_ms = 4,
+                Faker::Clock* clock = Faker::Clock::real());
+
+        // Remove all timers from the wheel.
+        ~TimerWheel();
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // Track a timer. The timer's phase is staggered against the timers
+        // added before it. A timer may only be added to one wheel.
+        void add(Timer* timer);
+
+        // Does not handle messages.
+        void subscribe(Subscription*) override {}
+
+        // Fire the timers which have come due.
+        void emit(const Caster::Yield<Message>& yield) override;
+
+        // Read the clock and fire the timers which have come due.
+        void advance();
+
+        // Return the time of the last pass.
+        uint32_t now() const { return now_; }
+
+        // Return the number of timers which are waiting on a deadline.
+        size_t pending() const { return pending_; }
+
+    private:
+        friend class Timer;
+
+        Faker::Clock* clock_;
+        uint8_t resolution_;
+        uint32_t now_;
+        uint32_t tick_;
+        size_t added_;
+        size_t pending_;
+        Timer* slots_[kSlots];
+
+        void link(Timer* timer);
+        void unlink(Timer* timer);
+        void fire(Timer** slot);
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_TIMER_H_
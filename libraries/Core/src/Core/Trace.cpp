@@ -0,0 +1,160 @@
+#include "Trace.h"
+
+#include <Arduino.h>
+#include <Caster.h>
+#include "Event.h"
+#include "Message.h"
+#include "MessageRecord.h"
+
+namespace R51 {
+namespace {
+
+static const uint16_t kNoTrigger = 0xFFFF;
+
+}  // namespace
+
+TraceNode::TraceNode(uint8_t id, size_t capacity, Print* output, size_t post_trigger) :
+        id_(id), size_(capacity), head_(0), tail_(0), used_(0), count_(0),
+        dropped_(0), output_(output), trigger_event_(kNoTrigger), trigger_(nullptr),
+        post_trigger_(post_trigger), post_remaining_(0), triggered_(false),
+        frozen_(false) {
+    ring_ = new uint8_t[size_];
+}
+
+TraceNode::~TraceNode() {
+    delete[] ring_;
+}
+
+void TraceNode::triggerOn(uint8_t subsystem, uint8_t id) {
+    trigger_event_ = (subsystem << 8) | id;
+}
+
+void TraceNode::subscribe(Subscription* sub) {
+    sub->all();
+}
+
+void TraceNode::handle(const Message& msg, const Caster::Yield<Message>&) {
+    if (!frozen_) {
+        record(msg);
+        if (triggered_ && --post_remaining_ == 0) {
+            frozen_ = true;
+        }
+    }
+
+    if (TraceCommand::match(msg)) {
+        handleCommand(*(const TraceCommand*)msg.event());
+    } else if (msg.type() == Message::EVENT &&
+            trigger_event_ == ((msg.event()->subsystem << 8) | msg.event()->id)) {
+        trigger();
+    }
+}
+
+void TraceNode::emit(const Caster::Yield<Message>&) {
+    if (trigger_ != nullptr && !triggered_ && trigger_->triggered()) {
+        trigger();
+    }
+}
+
+void TraceNode::trigger() {
+    if (triggered_ || frozen_) {
+        return;
+    }
+    triggered_ = true;
+    post_remaining_ = post_trigger_;
+    frozen_ = post_trigger_ == 0;
+}
+
+void TraceNode::freeze() {
+    triggered_ = true;
+    frozen_ = true;
+}
+
+void TraceNode::resume() {
+    head_ = 0;
+    tail_ = 0;
+    used_ = 0;
+    count_ = 0;
+    dropped_ = 0;
+    triggered_ = false;
+    frozen_ = false;
+}
+
+size_t TraceNode::dump(Print& p) const {
+    uint8_t header[16] = {'R', '5', '1', 'T', kDumpVersion, id_};
+    uint16_t count = count_;
+    uint32_t bytes = used_;
+    uint32_t now = micros();
+    memcpy(header + 6, &count, sizeof(count));
+    memcpy(header + 8, &bytes, sizeof(bytes));
+    memcpy(header + 12, &now, sizeof(now));
+
+    size_t n = p.write(header, sizeof(header));
+    size_t first = size_ - tail_;
+    if (first >= used_) {
+        n += p.write(ring_ + tail_, used_);
+    } else {
+        n += p.write(ring_ + tail_, first);
+        n += p.write(ring_, used_ - first);
+    }
+    return n;
+}
+
+void TraceNode::record(const Message& msg) {
+    uint8_t entry[kTimestampSize + kMaxMessageRecordSize];
+    uint32_t now = micros();
+    memcpy(entry, &now, kTimestampSize);
+    size_t entry_size = kTimestampSize + encodeMessageRecord(msg, entry + kTimestampSize);
+    if (entry_size > size_) {
+        return;
+    }
+
+    // Overwrite the oldest entries to make room.
+    while (size_ - used_ < entry_size) {
+        size_t dropped = kTimestampSize +
+            messageRecordSize(ring_[advance(tail_, kTimestampSize)]);
+        tail_ = advance(tail_, dropped);
+        used_ -= dropped;
+        --count_;
+        ++dropped_;
+    }
+    copyIn(entry, entry_size);
+    ++count_;
+}
+
+void TraceNode::handleCommand(const TraceCommand& cmd) {
+    if (cmd.trace() != 0xFF && cmd.trace() != id_) {
+        return;
+    }
+    switch (cmd.action()) {
+        case TraceAction::FREEZE:
+            freeze();
+            break;
+        case TraceAction::RESUME:
+            resume();
+            break;
+        case TraceAction::DUMP:
+            if (output_ != nullptr) {
+                dump(*output_);
+            }
+            break;
+    }
+}
+
+void TraceNode::copyIn(const uint8_t* src, size_t size) {
+    size_t first = size_ - head_;
+    if (first >= size) {
+        memcpy(ring_ + head_, src, size);
+    } else {
+        memcpy(ring_ + head_, src, first);
+        memcpy(ring_, src + first, size - first);
+    }
+    head_ = advance(head_, size);
+    used_ += size;
+}
+
+size_t TraceNode::advance(size_t pos, size_t count) const {
+    pos += count;
+    return pos >= size_ ? pos - size_ : pos;
+}
+
+}  // namespace R51
@@ -0,0 +1,157 @@
+#ifndef _R51_CORE_TRACE_H_
+#define _R51_CORE_TRACE_H_
+
+#include <Arduino.h>
+#include <Caster.h>
+#include "Event.h"
+#include "Message.h"
+#include "MessageRecord.h"
+#include "Subscription.h"
+
+namespace R51 {
+
+// Actions performed by the CONTROLLER:TRACE_CMD event.
+enum class TraceAction : uint8_t {
+    FREEZE  = 0x00, // Stop recording immediately.
+    RESUME  = 0x01, // Clear the trace and resume recording.
+    DUMP    = 0x02, // Write the trace to the node's output.
+};
+
+// Event class for the CONTROLLER:TRACE_CMD event.
+class TraceCommand : public Event {
+    public:
+        TraceCommand(TraceAction action = TraceAction::FREEZE, uint8_t trace = 0xFF) :
+            Event(SubSystem::CONTROLLER, (uint8_t)ControllerEvent::TRACE_CMD,
+                {(uint8_t)action, trace}) {}
+
+        // The action to perform.
+        EVENT_PROPERTY(TraceAction, action, (TraceAction)data[0], data[0] = (uint8_t)value);
+        // ID of the trace to act on or 0xFF for all traces.
+        EVENT_PROPERTY(uint8_t, trace, data[1], data[1] = value);
+
+        // Return true if the message is a trace command.
+        static bool match(const Message& msg) {
+            return msg.type() == Message::EVENT &&
+                msg.event()->subsystem == (uint8_t)SubSystem::CONTROLLER &&
+                msg.event()->id == (uint8_t)ControllerEvent::TRACE_CMD;
+        }
+};
+
+// Polled by a TraceNode to trigger on conditions that are not visible on the
+// bus, e.g. a pipe overrun.
+class TraceTrigger {
+    public:
+        virtual ~TraceTrigger() = default;
+
+        // Return true if the trace should be triggered.
+        virtual bool triggered() = 0;
+};
+
+// Records every message on its bus into a fixed RAM ring so that the traffic
+// leading up to a fault can be inspected later. The oldest entries are
+// overwritten when the ring is full. Each entry is the 32-bit micros()
+// timestamp of its arrival followed by the message record as described in
+// MessageRecord.h.
+//
+// Recording freezes when the trace is triggered, either by a configured
+// event, a polled TraceTrigger, or a TRACE_CMD event. A number of messages
+// may be recorded after the trigger to capture its aftermath. The frozen
+// trace is written to the output in one binary burst by a TRACE_CMD DUMP:
+//
+//   "R51T", version, trace ID, 16-bit entry count, 32-bit byte count,
+//   32-bit micros() at the time of the dump, entries from oldest to newest.
+//
+// Multi-byte values are in host byte order. Each core should run its own
+// TraceNode with its own ID; the node is not thread safe.
+class TraceNode : public Caster::Node<Message>, public Subscriber {
+    public:
+        // Version of the dump format.
+        static const uint8_t kDumpVersion = 1;
+
+        // Construct a trace with the given ID which records up to capacity
+        // bytes of entries. Dumps are written to output which may be nullptr
+        // to disable dumping. The trace keeps recording post_trigger messages
+        // after it is triggered.
+        TraceNode(uint8_t id, size_t capacity, Print* output, size_t post_trigger = 0);
+
+        // Destroy the node. Frees the ring.
+        ~TraceNode();
+
+        TraceNode(const TraceNode&) = delete;
+        TraceNode& operator=(const TraceNode&) = delete;
+
+        // Trigger the trace when an event with the given subsystem and ID is
+        // seen on the bus.
+        void triggerOn(uint8_t subsystem, uint8_t id);
+
+        // Poll trigger on every emit and trigger the trace when it fires.
+        void triggerOn(TraceTrigger* trigger) { trigger_ = trigger; }
+
+        // Record all messages.
+        void subscribe(Subscription* sub) override;
+
+        // Record a message and act on trace commands and trigger events.
+        void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
+
+        // Poll the trigger.
+        void emit(const Caster::Yield<Message>& yield) override;
+
+        // Trigger the trace. Recording freezes after post_trigger more
+        // messages. Does nothing if the trace is already triggered.
+        void trigger();
+
+        // Stop recording immediately.
+        void freeze();
+
+        // Clear the trace and resume recording.
+        void resume();
+
+        // Return true if the trace is no longer recording.
+        bool frozen() const { return frozen_; }
+
+        // Return the number of entries in the trace.
+        size_t count() const { return count_; }
+
+        // Return the number of bytes in use.
+        size_t size() const { return used_; }
+
+        // Return the number of bytes the trace can hold.
+        size_t capacity() const { return size_; }
+
+        // Return the number of entries overwritten since the trace was last
+        // resumed.
+        uint32_t dropped() const { return dropped_; }
+
+        // Write the trace to p. Return the number of bytes written.
+        size_t dump(Print& p) const;
+
+    private:
+        // Entry timestamp size in bytes.
+        static const size_t kTimestampSize = 4;
+
+        uint8_t id_;
+        uint8_t* ring_;
+        size_t size_;
+        size_t head_;
+        size_t tail_;
+        size_t used_;
+        size_t count_;
+        uint32_t dropped_;
+        Print* output_;
+
+        uint16_t trigger_event_;    // Subsystem and ID or 0xFFFF.
+        TraceTrigger* trigger_;
+        size_t post_trigger_;
+        size_t post_remaining_;
+        bool triggered_;
+        bool frozen_;
+
+        void record(const Message& msg);
+        void handleCommand(const TraceCommand& cmd);
+        void copyIn(const uint8_t* src, size_t size);
+        size_t advance(size_t pos, size_t count) const;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_TRACE_H_
@@ -0,0 +1,81 @@
+#ifndef _R51_CORE_TX_STATE_H_
+#define _R51_CORE_TX_STATE_H_
+
+#include <Arduino.h>
+#include <Faker.h>
+#include "Event.h"
+#include "Message.h"
+
+namespace R51 {
+
+// Networks whose transmit state is reported by a gateway.
+enum class TxNetwork : uint8_t {
+    CAN     = 0x00, // Vehicle CAN bus.
+    J1939   = 0x01, // J1939 network.
+};
+
+// Event class for the CONTROLLER:TX_STATE event. Sent by a gateway when its
+// transmit queue becomes congested, every kRefresh milliseconds while it stays
+// congested, and again when it drains. Nodes which send periodic frames should
+// hold them while their network is congested. See TxHold.
+class TxState : public Event {
+    public:
+        // Interval at which a congested gateway repeats the event.
+        static const uint32_t kRefresh = 250;
+
+        TxState(TxNetwork network = TxNetwork::CAN) :
+            Event(SubSystem::CONTROLLER, (uint8_t)ControllerEvent::TX_STATE,
+                {(uint8_t)network, 0x00, 0x00}) {}
+
+        // The network the gateway writes to.
+        EVENT_PROPERTY(TxNetwork, network, (TxNetwork)data[0], data[0] = (uint8_t)value);
+        // True if frames are waiting on the network.
+        EVENT_PROPERTY(bool, congested, data[1] != 0x00, data[1] = (uint8_t)value);
+        // Number of frames waiting in the gateway's queue.
+        EVENT_PROPERTY(uint8_t, depth, data[2], data[2] = value);
+
+        // Return true if the message is a transmit state event.
+        static bool match(const Message& msg) {
+            return msg.type() == Message::EVENT &&
+                msg.event()->subsystem == (uint8_t)SubSystem::CONTROLLER &&
+                msg.event()->id == (uint8_t)ControllerEvent::TX_STATE;
+        }
+};
+
+// Tracks the transmit state of a network for a node which holds its periodic
+// frames during congestion. The hold is released when the gateway reports the
+// network drained or when the gateway stops refreshing it for kTimeout
+// milliseconds so that a lost event can't hold the node forever.
+class TxHold {
+    public:
+        // Time after the last congested report at which the hold expires.
+        static const uint32_t kTimeout = 4 * TxState::kRefresh;
+
+        TxHold(TxNetwork network, Faker::Clock* clock = Faker::Clock::real()) :
+            network_(network), clock_(clock), congested_(false), updated_(0) {}
+
+        // Update the hold from a transmit state event. Events for other
+        // networks are ignored.
+        void update(const TxState& state) {
+            if (state.network() != network_) {
+                return;
+            }
+            congested_ = state.congested();
+            updated_ = clock_->millis();
+        }
+
+        // Return true if periodic frames should be held.
+        bool held() const {
+            return congested_ && clock_->millis() - updated_ < kTimeout;
+        }
+
+    private:
+        TxNetwork network_;
+        Faker::Clock* clock_;
+        bool congested_;
+        uint32_t updated_;
+};
+
+}  // namespace R51
+
+#endif  // _R51_CORE_TX_STATE_H_
@@ -0,0 +1,277 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Caster.h>
+#include <Core.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::CAN20Frame;
+using ::Canny::J1939Message;
+using ::Caster::Yield;
+
+// Node which collects the messages it handles.
+class FakeNode : public Caster::Node<Message> {
+    public:
+        void handle(const Message& msg, const Yield<Message>&) override {
+            received(msg);
+        }
+
+        FakeYield received;
+};
+
+// Node which subscribes to a preset subscription.
+class FakeSubscriber : public FakeNode, public Subscriber {
+    public:
+        FakeSubscriber(const Subscription& sub) : sub_(sub) {}
+
+        void subscribe(Subscription* sub) override {
+            *sub = sub_;
+        }
+
+    private:
+        Subscription sub_;
+};
+
+// Node which replies to CAN frames with an event.
+class ReplyNode : public FakeSubscriber {
+    public:
+        ReplyNode(const Subscription& sub) : FakeSubscriber(sub),
+            event_(0x01, 0x02) {}
+
+        void handle(const Message& msg, const Yield<Message>& yield) override {
+            FakeSubscriber::handle(msg, yield);
+            if (msg.type() == Message::CAN_FRAME) {
+                yield(MessageView(&event_));
+            }
+        }
+
+    private:
+        Event event_;
+};
+
+test(SubscriptionTest, Empty) {
+    Subscription sub;
+    Event event(0x01, 0x02);
+    CAN20Frame frame(0x123, 0, 8);
+    J1939Claim claim(0x01, 0x00);
+
+    assertFalse(sub.match(MessageView(&event)));
+    assertFalse(sub.match(MessageView(&frame)));
+    assertFalse(sub.match(MessageView(&claim)));
+}
+
+test(SubscriptionTest, All) {
+    Subscription sub;
+    sub.all();
+    Event event(0x01, 0x02);
+    CAN20Frame frame(0x123, 0, 8);
+    J1939Claim claim(0x01, 0x00);
+
+    assertTrue(sub.match(MessageView(&event)));
+    assertTrue(sub.match(MessageView(&frame)));
+    assertTrue(sub.match(MessageView(&claim)));
+    assertTrue(sub.match(MessageValue()));
+}
+
+test(SubscriptionTest, Event) {
+    Subscription sub;
+    sub.event(0x01);
+    sub.event(0x02, 0x10);
+    sub.event(0x03, 0x10, 0x12);
+
+    Event event01(0x01, 0xFF);
+    Event event02(0x02, 0x10);
+    Event event02_miss(0x02, 0x11);
+    Event event03(0x03, 0x12);
+    Event event03_miss(0x03, 0x13);
+    Event event04(0x04, 0x10);
+
+    assertTrue(sub.match(MessageView(&event01)));
+    assertTrue(sub.match(MessageView(&event02)));
+    assertFalse(sub.match(MessageView(&event02_miss)));
+    assertTrue(sub.match(MessageView(&event03)));
+    assertFalse(sub.match(MessageView(&event03_miss)));
+    assertFalse(sub.match(MessageView(&event04)));
+}
+
+test(SubscriptionTest, CANFrame) {
+    Subscription sub;
+    sub.canFrame(0x100);
+    sub.canFrame(0x200, 0x2FF);
+
+    CAN20Frame frame100(0x100, 0, 8);
+    CAN20Frame frame101(0x101, 0, 8);
+    CAN20Frame frame2FF(0x2FF, 0, 8);
+    Event event(0x01, 0x00);
+
+    assertTrue(sub.match(MessageView(&frame100)));
+    assertFalse(sub.match(MessageView(&frame101)));
+    assertTrue(sub.match(MessageView(&frame2FF)));
+    assertFalse(sub.match(MessageView(&event)));
+}
+
+test(SubscriptionTest, J1939) {
+    Subscription sub;
+    sub.j1939Claim();
+    sub.j1939Message(0xEF00);
+
+    J1939Claim claim(0x01, 0x00);
+    J1939Message msg_ef00(0xEF00, 0x01, 0x02);
+    J1939Message msg_ff00(0xFF00, 0x01);
+
+    assertTrue(sub.match(MessageView(&claim)));
+    assertTrue(sub.match(MessageView(&msg_ef00)));
+    assertFalse(sub.match(MessageView(&msg_ff00)));
+}
+
+test(SubscriptionTest, Overflow) {
+    Subscription sub;
+    for (size_t i = 0; i <= Subscription::kMaxRanges; ++i) {
+        sub.canFrame(i * 2);
+    }
+
+    CAN20Frame frame(0x01, 0, 8);
+    Event event(0x01, 0x00);
+    assertTrue(sub.match(MessageView(&frame)));
+    assertFalse(sub.match(MessageView(&event)));
+}
+
+test(SubscriptionIndexTest, OverlappingRanges) {
+    Subscription sub0;
+    sub0.canFrame(0x100, 0x1FF);
+    Subscription sub1;
+    sub1.canFrame(0x180, 0x27F);
+    Subscription sub2;
+    sub2.canFrame(0x180);
+    sub2.all(Message::EVENT);
+    const Subscription* subs[] = {&sub0, &sub1, &sub2, nullptr};
+
+    SubscriptionIndex index;
+    index.build(subs, 4);
+
+    assertEqual(index.match(Message::CAN_FRAME, 0x0FF), 0x8u);
+    assertEqual(index.match(Message::CAN_FRAME, 0x100), 0x9u);
+    assertEqual(index.match(Message::CAN_FRAME, 0x17F), 0x9u);
+    assertEqual(index.match(Message::CAN_FRAME, 0x180), 0xFu);
+    assertEqual(index.match(Message::CAN_FRAME, 0x181), 0xBu);
+    assertEqual(index.match(Message::CAN_FRAME, 0x1FF), 0xBu);
+    assertEqual(index.match(Message::CAN_FRAME, 0x200), 0xAu);
+    assertEqual(index.match(Message::CAN_FRAME, 0x27F), 0xAu);
+    assertEqual(index.match(Message::CAN_FRAME, 0x280), 0x8u);
+    assertEqual(index.match(Message::EVENT, 0x0102), 0xCu);
+    assertEqual(index.match(Message::J1939_MESSAGE, 0xEF00), 0x8u);
+}
+
+test(IndexedBusTest, DispatchToSubscribers) {
+    Subscription can_sub;
+    can_sub.canFrame(0x100);
+    Subscription event_sub;
+    event_sub.event(0x01);
+
+    FakeSubscriber can_node(can_sub);
+    FakeSubscriber event_node(event_sub);
+    FakeNode all_node;
+    BusNode nodes[] = {&can_node, &event_node, &all_node};
+    IndexedBus bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+
+    CAN20Frame frame100(0x100, 0, 8);
+    CAN20Frame frame200(0x200, 0, 8);
+    Event event(0x01, 0x02);
+
+    bus.emit(MessageView(&frame100));
+    bus.emit(MessageView(&frame200));
+    bus.emit(MessageView(&event));
+
+    assertSize(can_node.received, 1);
+    assertSize(event_node.received, 1);
+    assertSize(all_node.received, 3);
+}
+
+test(IndexedBusTest, SkipSource) {
+    Subscription reply_sub;
+    reply_sub.canFrame(0x100);
+    reply_sub.event(0x01);
+    Subscription event_sub;
+    event_sub.event(0x01);
+
+    ReplyNode reply_node(reply_sub);
+    FakeSubscriber event_node(event_sub);
+    BusNode nodes[] = {&reply_node, &event_node};
+    IndexedBus bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+
+    CAN20Frame frame(0x100, 0, 8);
+    Event expect(0x01, 0x02);
+    bus.emit(MessageView(&frame));
+
+    assertSize(reply_node.received, 1);
+    assertSize(event_node.received, 1);
+    assertIsEvent(event_node.received.messages()[0], expect);
+}
+
+test(StaticBusTest, DispatchToSubscribers) {
+    Subscription can_sub;
+    can_sub.canFrame(0x100);
+    Subscription event_sub;
+    event_sub.event(0x01);
+
+    FakeSubscriber can_node(can_sub);
+    FakeSubscriber event_node(event_sub);
+    FakeNode all_node;
+    StaticBus<FakeSubscriber, FakeSubscriber, FakeNode> bus(
+            &can_node, &event_node, &all_node);
+    bus.init();
+
+    CAN20Frame frame100(0x100, 0, 8);
+    CAN20Frame frame200(0x200, 0, 8);
+    Event event(0x01, 0x02);
+
+    bus.emit(MessageView(&frame100));
+    bus.emit(MessageView(&frame200));
+    bus.emit(MessageView(&event));
+
+    assertSize(can_node.received, 1);
+    assertSize(event_node.received, 1);
+    assertSize(all_node.received, 3);
+}
+
+test(StaticBusTest, SkipSource) {
+    Subscription reply_sub;
+    reply_sub.canFrame(0x100);
+    reply_sub.event(0x01);
+    Subscription event_sub;
+    event_sub.event(0x01);
+
+    ReplyNode reply_node(reply_sub);
+    FakeSubscriber event_node(event_sub);
+    StaticBus<ReplyNode, FakeSubscriber> bus(&reply_node, &event_node);
+    bus.init();
+
+    CAN20Frame frame(0x100, 0, 8);
+    Event expect(0x01, 0x02);
+    bus.emit(MessageView(&frame));
+
+    assertSize(reply_node.received, 1);
+    assertSize(event_node.received, 1);
+    assertIsEvent(event_node.received.messages()[0], expect);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
@@ -0,0 +1,184 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Caster.h>
+#include <Core.h>
+#include <Faker.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::CAN20Frame;
+using ::Caster::Yield;
+using ::Faker::FakeClock;
+
+// Node which replies to CAN frames with an event.
+class ReplyNode : public Caster::Node<Message>, public Subscriber {
+    public:
+        ReplyNode() : event_(0x01, 0x02) {}
+
+        void subscribe(Subscription* sub) override {
+            sub->all(Message::CAN_FRAME);
+        }
+
+        void handle(const Message&, const Yield<Message>& yield) override {
+            yield(MessageView(&event_));
+        }
+
+    private:
+        Event event_;
+};
+
+// Node which collects events.
+class EventNode : public Caster::Node<Message>, public Subscriber {
+    public:
+        void subscribe(Subscription* sub) override {
+            sub->all(Message::EVENT);
+        }
+
+        void handle(const Message& msg, const Yield<Message>&) override {
+            received(msg);
+        }
+
+        FakeYield received;
+};
+
+template <typename Bus>
+void emitFrames(Bus* bus, size_t count) {
+    CAN20Frame frame(0x100, 0, 8);
+    for (size_t i = 0; i < count; ++i) {
+        bus->emit(MessageView(&frame));
+    }
+}
+
+test(BusStatsTest, IndexedBusCounts) {
+    ReplyNode reply;
+    EventNode events;
+    BusNode nodes[] = {&reply, &events};
+    IndexedBus bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+
+    emitFrames(&bus, 3);
+    bus.loop();
+    bus.loop();
+
+    const BusStats* stats = bus.stats();
+    assertEqual(stats->size(), 2u);
+    assertEqual(stats->snapshot(0).handled, 3u);
+    assertEqual(stats->snapshot(0).yielded, 3u);
+    assertEqual(stats->snapshot(0).emitted, 2u);
+    assertEqual(stats->snapshot(1).handled, 3u);
+    assertEqual(stats->snapshot(1).yielded, 0u);
+    assertEqual(stats->snapshot(1).emitted, 2u);
+    assertSize(events.received, 3);
+
+    // Counters are reset by the bus at the start of its next loop.
+    bus.stats()->reset();
+    assertEqual(stats->snapshot(0).handled, 3u);
+    bus.loop();
+    assertEqual(stats->snapshot(0).handled, 0u);
+    assertEqual(stats->snapshot(1).emitted, 1u);
+}
+
+test(BusStatsTest, NodeNames) {
+    ReplyNode reply;
+    EventNode events;
+    BusNode nodes[] = {{&reply, "reply"}, &events};
+    IndexedBus bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+    assertEqual(bus.stats()->name(0), "reply");
+    assertTrue(bus.stats()->name(1) == nullptr);
+
+    StaticBus<ReplyNode, EventNode> static_bus(&reply, &events);
+    static_bus.init();
+    const char* names[] = {"reply", "events"};
+    static_bus.stats()->names(names, 2);
+    assertEqual(static_bus.stats()->name(1), "events");
+}
+
+test(BusStatsTest, StaticBusCounts) {
+    ReplyNode reply;
+    EventNode events;
+    StaticBus<ReplyNode, EventNode> bus(&reply, &events);
+    bus.init();
+
+    emitFrames(&bus, 2);
+    bus.loop();
+
+    const BusStats* stats = bus.stats();
+    assertEqual(stats->size(), 2u);
+    assertEqual(stats->snapshot(0).handled, 2u);
+    assertEqual(stats->snapshot(0).yielded, 2u);
+    assertEqual(stats->snapshot(0).emitted, 1u);
+    assertEqual(stats->snapshot(1).handled, 2u);
+    assertEqual(stats->snapshot(1).emitted, 1u);
+}
+
+test(BusStatsTest, NodeEvents) {
+    FakeClock clock;
+    FakeYield yield;
+    ReplyNode reply;
+    EventNode events;
+    BusNode nodes[] = {&reply, &events};
+    IndexedBus bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+    emitFrames(&bus, 3);
+
+    BusStatsNode stats_node(1000, &clock);
+    assertTrue(stats_node.add(0x02, bus.stats()));
+
+    stats_node.emit(yield);
+    assertSize(yield, 0);
+
+    // One node is reported per interval.
+    clock.delay(1000);
+    stats_node.emit(yield);
+    assertSize(yield, 1);
+    const auto* node0 = (const NodeStatsState*)yield.messages()[0].event();
+    assertEqual(node0->subsystem, (uint8_t)SubSystem::CONTROLLER);
+    assertEqual(node0->id, (uint8_t)ControllerEvent::NODE_STATS_STATE);
+    assertEqual(node0->bus(), 0x02);
+    assertEqual(node0->node(), 0);
+    assertEqual(node0->handled(), 3);
+    yield.clear();
+
+    stats_node.emit(yield);
+    assertSize(yield, 0);
+
+    clock.delay(1000);
+    stats_node.emit(yield);
+    assertSize(yield, 1);
+    const auto* node1 = (const NodeStatsState*)yield.messages()[0].event();
+    assertEqual(node1->bus(), 0x02);
+    assertEqual(node1->node(), 1);
+    assertEqual(node1->handled(), 3);
+    yield.clear();
+
+    // Counters are reset once every node of the bus is reported.
+    bus.loop();
+    assertEqual(bus.stats()->snapshot(0).handled, 0u);
+
+    clock.delay(1000);
+    stats_node.emit(yield);
+    assertSize(yield, 1);
+    node0 = (const NodeStatsState*)yield.messages()[0].event();
+    assertEqual(node0->node(), 0);
+    assertEqual(node0->handled(), 0);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
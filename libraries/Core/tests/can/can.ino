@@ -13,6 +13,7 @@ using ::Canny::ERR_FIFO;
 using ::Canny::ERR_INTERNAL;
 using ::Canny::ERR_OK;
 using ::Canny::Error;
+using ::Faker::FakeClock;
 
 class FakeConnection : public Connection<CAN20Frame> {
     public:
@@ -114,6 +115,56 @@ test(CANGatewayTest, Read) {
     assertEqual(can.readsRemaining(), 0);
 }
 
+test(CANGatewayTest, ReadBurstNotLimited) {
+    FakeYield yield;
+    FakeConnection can(1, 0);
+    CANGateway node(&can);
+
+    // A burst which reads its one frame and leaves nothing waiting is not
+    // limited.
+    CAN20Frame f(0x01, 0, {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88});
+    can.setReadBuffer({f});
+    node.emit(yield);
+    node.emit(yield);
+    assertSize(yield, 1);
+    assertEqual(node.burstStats().bursts, 1u);
+    assertEqual(node.burstStats().limited, 0u);
+}
+
+test(CANGatewayTest, ReadBurst) {
+    FakeYield yield;
+    FakeConnection can(5, 0);
+    CANGateway node(&can);
+    node.burst(3);
+
+    CAN20Frame f1(0x01, 0, {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88});
+    CAN20Frame f2(0x02, 0, {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88});
+    CAN20Frame f3(0x03, 0, {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88});
+    CAN20Frame f4(0x04, 0, {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88});
+    CAN20Frame f5(0x05, 0, {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88});
+    can.setReadBuffer({f1, f2, f3, f4, f5});
+
+    node.emit(yield);
+    assertSize(yield, 3);
+    assertIsCANFrame(yield.messages()[0], f1);
+    assertIsCANFrame(yield.messages()[1], f2);
+    assertIsCANFrame(yield.messages()[2], f3);
+    assertEqual(can.readsRemaining(), 2);
+
+    yield.clear();
+    node.emit(yield);
+    assertSize(yield, 2);
+    assertIsCANFrame(yield.messages()[0], f4);
+    assertIsCANFrame(yield.messages()[1], f5);
+
+    node.emit(yield);
+    const BurstStats& stats = node.burstStats();
+    assertEqual(stats.bursts, 2u);
+    assertEqual(stats.frames, 5u);
+    assertEqual(stats.peak, 3);
+    assertEqual(stats.limited, 1u);
+}
+
 test(CANGatewayTest, Write) {
     FakeYield yield;
     FakeConnection can(0, 1);
@@ -125,6 +176,190 @@ test(CANGatewayTest, Write) {
     assertPrintablesEqual(can.writeData()[0], f);
 }
 
+test(CANGatewayTest, WriteRetry) {
+    FakeYield yield;
+    FakeClock clock;
+    FakeConnection can(0, 1);
+    CANGateway node(&can, &clock);
+
+    CAN20Frame f1(0x01, 0, {0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f2(0x02, 0, {0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    node.handle(MessageView(&f1), yield);
+    node.handle(MessageView(&f2), yield);
+    assertEqual(can.writeCount(), 1);
+    assertPrintablesEqual(can.writeData()[0], f1);
+
+    // The queued frame is written once the bus frees up.
+    can.writeReset();
+    node.emit(yield);
+    assertEqual(can.writeCount(), 1);
+    assertPrintablesEqual(can.writeData()[0], f2);
+    assertEqual(node.txStats().sent, 2u);
+}
+
+test(CANGatewayTest, WriteCoalesce) {
+    FakeYield yield;
+    FakeClock clock;
+    FakeConnection can(0, 1);
+    CANGateway node(&can, &clock);
+    IDFilter ids({stdID(0x540, 0x7FE)});
+    node.coalesce(&ids);
+
+    CAN20Frame f1(0x540, 0, {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f2(0x540, 0, {0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f3(0x540, 0, {0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f4(0x71E, 0, {0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f5(0x71E, 0, {0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    node.handle(MessageView(&f1), yield);
+    node.handle(MessageView(&f2), yield);
+    node.handle(MessageView(&f3), yield);
+    node.handle(MessageView(&f4), yield);
+    node.handle(MessageView(&f5), yield);
+
+    // Only the latest control frame is kept. Other frames are all sent.
+    can.writeReset(4);
+    node.emit(yield);
+    assertEqual(can.writeCount(), 3);
+    assertPrintablesEqual(can.writeData()[0], f3);
+    assertPrintablesEqual(can.writeData()[1], f4);
+    assertPrintablesEqual(can.writeData()[2], f5);
+    assertEqual(node.txStats().coalesced, 1u);
+}
+
+test(CANGatewayTest, WriteTimeout) {
+    FakeYield yield;
+    FakeClock clock;
+    FakeConnection can(0, 0);
+    CANGateway node(&can, &clock);
+    node.writeTimeout(50);
+
+    CAN20Frame f(0x01, 0, {0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    node.handle(MessageView(&f), yield);
+    clock.set(50);
+    node.emit(yield);
+    assertEqual(node.txStats().expired, 0u);
+
+    clock.set(51);
+    can.writeReset(1);
+    node.emit(yield);
+    assertEqual(can.writeCount(), 0);
+    assertEqual(node.txStats().expired, 1u);
+}
+
+test(CANGatewayTest, WritePaced) {
+    FakeYield yield;
+    FakeClock clock;
+    FakeConnection can(0, 8);
+    CANGateway node(&can, &clock);
+    CANPacer pacer(0, &clock);
+    pacer.limit(stdID(0x540, 0x7FE), 50, 2);
+    node.pace(&pacer);
+
+    CAN20Frame f1(0x540, 0, {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f2(0x541, 0, {0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f3(0x540, 0, {0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f4(0x71E, 0, {0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    node.handle(MessageView(&f1), yield);
+    node.handle(MessageView(&f2), yield);
+    node.handle(MessageView(&f3), yield);
+    node.handle(MessageView(&f4), yield);
+
+    // Frames over budget are held without blocking other IDs.
+    assertEqual(can.writeCount(), 3);
+    assertPrintablesEqual(can.writeData()[0], f1);
+    assertPrintablesEqual(can.writeData()[1], f2);
+    assertPrintablesEqual(can.writeData()[2], f4);
+
+    node.emit(yield);
+    assertEqual(can.writeCount(), 3);
+    clock.set(50);
+    node.emit(yield);
+    assertEqual(can.writeCount(), 4);
+    assertPrintablesEqual(can.writeData()[3], f3);
+}
+
+test(CANGatewayTest, TxState) {
+    FakeYield yield;
+    FakeClock clock;
+    FakeConnection can(0, 0);
+    CANGateway node(&can, &clock);
+    node.writeTimeout(TxState::kRefresh * 2);
+
+    CAN20Frame f(0x01, 0, {0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    for (size_t i = 0; i < CANGateway::kCongestedDepth - 1; ++i) {
+        f.id(0x01 + i);
+        node.handle(MessageView(&f), yield);
+    }
+    assertSize(yield, 0);
+    assertFalse(node.congested());
+
+    // Congestion is reported once the queue backs up.
+    f.id(0x10);
+    node.handle(MessageView(&f), yield);
+    TxState expect(TxNetwork::CAN);
+    expect.congested(true);
+    expect.depth(CANGateway::kCongestedDepth);
+    assertSize(yield, 1);
+    assertIsEvent(yield.messages()[0], expect);
+    assertTrue(node.congested());
+    yield.clear();
+
+    // It is repeated while the queue stays congested.
+    clock.set(TxState::kRefresh - 1);
+    node.emit(yield);
+    assertSize(yield, 0);
+    clock.set(TxState::kRefresh);
+    node.emit(yield);
+    assertSize(yield, 1);
+    assertIsEvent(yield.messages()[0], expect);
+    yield.clear();
+
+    // And cleared once the queue drains.
+    can.writeReset(2);
+    node.emit(yield);
+    assertSize(yield, 0);
+    can.writeReset(2);
+    node.emit(yield);
+    expect.congested(false);
+    expect.depth(0);
+    assertSize(yield, 1);
+    assertIsEvent(yield.messages()[0], expect);
+    assertFalse(node.congested());
+}
+
+test(CANGatewayTest, TxStateIgnoresPacedFrames) {
+    FakeYield yield;
+    FakeClock clock;
+    FakeConnection can(0, 8);
+    CANGateway node(&can, &clock);
+    CANPacer pacer(0, &clock);
+    pacer.limit(stdID(0x540, 0x7FE), 50, 1);
+    node.pace(&pacer);
+
+    // Frames the pacer holds back are not congestion.
+    CAN20Frame f(0x540, 0, {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    for (size_t i = 0; i < CANGateway::kCongestedDepth + 1; ++i) {
+        f.data()[0] = i;
+        node.handle(MessageView(&f), yield);
+    }
+    assertEqual(can.writeCount(), 1);
+    assertSize(yield, 0);
+    assertFalse(node.congested());
+
+    // Frames waiting on the controller are.
+    can.writeReset(0);
+    f.id(0x01);
+    for (size_t i = 0; i < CANGateway::kCongestedDepth; ++i) {
+        node.handle(MessageView(&f), yield);
+    }
+    assertSize(yield, 1);
+    TxState expect(TxNetwork::CAN);
+    expect.congested(true);
+    expect.depth(CANGateway::kCongestedDepth);
+    assertIsEvent(yield.messages()[0], expect);
+    assertTrue(node.congested());
+}
+
 }  // namespace R51
 
 // Test boilerplate.
@@ -0,0 +1,114 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Faker.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::CAN20Frame;
+using ::Faker::FakeClock;
+
+test(CANPacerTest, Unlimited) {
+    FakeClock clock;
+    CANPacer pacer(0, &clock);
+    CAN20Frame frame(0x540, 0);
+    for (int i = 0; i < 10; ++i) {
+        assertTrue(pacer.ready(frame));
+        pacer.sent(frame);
+    }
+}
+
+test(CANPacerTest, Spacing) {
+    FakeClock clock;
+    CANPacer pacer(5, &clock);
+    CAN20Frame f1(0x540, 0);
+    CAN20Frame f2(0x71E, 0);
+
+    assertTrue(pacer.ready(f1));
+    pacer.sent(f1);
+    assertFalse(pacer.ready(f1));
+    assertFalse(pacer.ready(f2));
+
+    clock.set(4);
+    assertFalse(pacer.ready(f2));
+    clock.set(5);
+    assertTrue(pacer.ready(f2));
+}
+
+test(CANPacerTest, Burst) {
+    FakeClock clock;
+    CANPacer pacer(0, &clock);
+    assertTrue(pacer.limit(stdID(0x540, 0x7FE), 100, 3));
+
+    // The burst may be sent at once. IDs outside the limit are not held.
+    CAN20Frame f1(0x540, 0);
+    CAN20Frame f2(0x541, 0);
+    CAN20Frame f3(0x71E, 0);
+    pacer.sent(f1);
+    pacer.sent(f2);
+    assertTrue(pacer.ready(f1));
+    pacer.sent(f1);
+    assertFalse(pacer.ready(f1));
+    assertFalse(pacer.ready(f2));
+    assertTrue(pacer.ready(f3));
+
+    // One frame is allowed per interval after that.
+    clock.set(99);
+    assertFalse(pacer.ready(f1));
+    clock.set(100);
+    assertTrue(pacer.ready(f1));
+    pacer.sent(f1);
+    assertFalse(pacer.ready(f1));
+
+    // The bucket refills up to the burst.
+    clock.set(1000);
+    for (int i = 0; i < 3; ++i) {
+        assertTrue(pacer.ready(f2));
+        pacer.sent(f2);
+    }
+    assertFalse(pacer.ready(f2));
+}
+
+test(CANPacerTest, FirstLimitMatches) {
+    FakeClock clock;
+    CANPacer pacer(0, &clock);
+    pacer.limit(stdID(0x540), 100, 1);
+    pacer.limit(stdID(0x540, 0x7F0), 100, 2);
+
+    CAN20Frame f1(0x540, 0);
+    CAN20Frame f2(0x541, 0);
+    pacer.sent(f1);
+    assertFalse(pacer.ready(f1));
+    assertTrue(pacer.ready(f2));
+    pacer.sent(f2);
+    assertTrue(pacer.ready(f2));
+}
+
+test(CANPacerTest, TooManyLimits) {
+    FakeClock clock;
+    CANPacer pacer(0, &clock);
+    for (size_t i = 0; i < CANPacer::kMaxLimits; ++i) {
+        assertTrue(pacer.limit(stdID(i), 100));
+    }
+    assertFalse(pacer.limit(stdID(0x100), 100));
+    assertFalse(CANPacer(0, &clock).limit(stdID(0x100), 100, 0));
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
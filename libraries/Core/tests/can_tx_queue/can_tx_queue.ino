@@ -0,0 +1,103 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::CAN20Frame;
+
+test(CANTxQueueTest, Order) {
+    CANTxQueue queue;
+    assertTrue(queue.empty());
+    assertTrue(queue.peek() == nullptr);
+
+    assertTrue(queue.push(CAN20Frame(0x03, 0), 100));
+    assertTrue(queue.push(CAN20Frame(0x01, 0), 100));
+    assertTrue(queue.push(CAN20Frame(0x02, 0), 100));
+    assertEqual(queue.size(), 3u);
+
+    // Frames are written in the order they were queued.
+    uint32_t expect[] = {0x03, 0x01, 0x02};
+    for (uint32_t id : expect) {
+        assertFalse(queue.empty());
+        assertEqual(queue.peek()->id(), id);
+        queue.pop();
+    }
+    assertTrue(queue.empty());
+    assertEqual(queue.stats().queued, 3u);
+    assertEqual(queue.stats().sent, 3u);
+    assertEqual(queue.stats().peak, 3);
+}
+
+test(CANTxQueueTest, Full) {
+    CANTxQueue queue;
+    for (size_t i = 0; i < CANTxQueue::kCapacity; ++i) {
+        assertTrue(queue.push(CAN20Frame(i, 0), 100));
+    }
+    assertFalse(queue.push(CAN20Frame(0x80, 0), 100));
+    assertEqual(queue.size(), CANTxQueue::kCapacity);
+    assertEqual(queue.stats().shed, 1u);
+    assertEqual(queue.peek()->id(), 0x00u);
+}
+
+test(CANTxQueueTest, Coalesce) {
+    CANTxQueue queue;
+    CAN20Frame f1(0x540, 0, {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f2(0x541, 0, {0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f3(0x540, 0, {0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    CAN20Frame f4(0x540, 1, {0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    queue.push(f1, 100, true);
+    queue.push(f2, 100, true);
+    assertTrue(queue.push(f3, 200, true));
+    assertTrue(queue.push(f4, 200, true));
+
+    // The latest data keeps the first frame's place in the queue. Extended
+    // IDs are distinct from standard IDs.
+    assertEqual(queue.size(), 3u);
+    assertEqual(queue.stats().coalesced, 1u);
+    assertPrintablesEqual(*queue.peek(), f3);
+    queue.pop();
+    assertPrintablesEqual(*queue.peek(), f2);
+
+    // Frames are not coalesced unless asked.
+    queue.push(f2, 100);
+    assertEqual(queue.size(), 3u);
+}
+
+test(CANTxQueueTest, Expire) {
+    CANTxQueue queue;
+    queue.push(CAN20Frame(0x01, 0), 100);
+    queue.push(CAN20Frame(0x02, 0), 200);
+    queue.push(CAN20Frame(0x01, 0), 300, true);
+
+    // The coalesced frame takes the later deadline.
+    CAN20Frame expired;
+    assertFalse(queue.expire(100, &expired));
+    assertTrue(queue.expire(201, &expired));
+    assertEqual(expired.id(), 0x02u);
+    assertFalse(queue.expire(201, &expired));
+    assertEqual(queue.size(), 1u);
+    assertTrue(queue.expire(301));
+    assertTrue(queue.empty());
+    assertEqual(queue.stats().expired, 2u);
+    assertEqual(queue.stats().sent, 0u);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
@@ -0,0 +1,212 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Core.h>
+#include <Faker.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Faker::FakeWriteStream;
+
+constexpr const char* kTestLabels[] = {"zero", "one", "two"};
+
+constexpr EventField kTestFields[] = {
+    uintField("low", 0, 4),
+    enumField("label", 4, 2, kTestLabels),
+    boolField("flag", 7),
+    intField("delta", 8),
+    uintField("wide", 16, 16, "ms"),
+};
+
+constexpr EventSchema kTestSchemas[] = {
+    eventSchema("test_state", SubSystem::CONTROLLER, 0x0E, kTestFields),
+    eventSchema("test_cmd", SubSystem::CONTROLLER, 0x1E),
+};
+
+EventSchemaTable test_schemas(kTestSchemas);
+
+byte buffer[128];
+
+size_t print(const Event& event) {
+    memset(buffer, 0, sizeof(buffer));
+    FakeWriteStream stream;
+    stream.set(buffer, sizeof(buffer) - 1);
+    return EventSchemaTable::print(stream, event);
+}
+
+test(EventSchemaTest, Find) {
+    const EventSchema* schema = EventSchemaTable::find(0x00, 0x0E);
+    assertTrue(schema != nullptr);
+    assertTrue(schema == EventSchemaTable::find("test_state"));
+    assertTrue(EventSchemaTable::find("test_cmd") != nullptr);
+    assertTrue(EventSchemaTable::find(0x00, 0x0F) == nullptr);
+    assertTrue(EventSchemaTable::find("missing") == nullptr);
+
+    // Core's own schemas are linked in.
+    assertTrue(EventSchemaTable::find("power_state") != nullptr);
+}
+
+test(EventSchemaTest, GetAndSet) {
+    const EventSchema* schema = EventSchemaTable::find("test_state");
+    Event event;
+    schema->init(&event);
+    // Bit 6 is not covered by a field and is left set.
+    uint8_t init[] = {0x40, 0x00, 0x00, 0x00, 0xFF, 0xFF};
+    assertEqual(memcmp(event.data, init, 6), 0);
+
+    schema->field("low")->set(event.data, 0x0A);
+    schema->field("label")->set(event.data, 2);
+    schema->field("flag")->set(event.data, 1);
+    schema->field("delta")->set(event.data, 0xFE);
+    schema->field("wide")->set(event.data, 0x1234);
+    uint8_t expect[] = {0xEA, 0xFE, 0x12, 0x34, 0xFF, 0xFF};
+    assertEqual(memcmp(event.data, expect, 6), 0);
+
+    assertEqual(schema->field("low")->get(event.data), 0x0Au);
+    assertEqual(schema->field("label")->get(event.data), 2u);
+    assertEqual(schema->field("flag")->get(event.data), 1u);
+    assertEqual(schema->field("wide")->get(event.data), 0x1234u);
+}
+
+test(EventSchemaTest, Print) {
+    Event event(0x00, 0x0E, (uint8_t[]){0xAA, 0xFE, 0x01, 0x00});
+    print(event);
+    const char* expect = "00:0E#AA:FE:01:00:FF:FF (test_state low=10 label=two flag=on delta=-2 wide=256ms)";
+    assertEqual(strlen((char*)buffer), strlen(expect));
+    assertEqual(memcmp(buffer, expect, strlen(expect)), 0);
+}
+
+test(EventSchemaTest, PrintOutOfRangeLabel) {
+    Event event(0x00, 0x0E, (uint8_t[]){0x30, 0x00, 0x00, 0x00});
+    print(event);
+    const char* expect = "00:0E#30:00:00:00:FF:FF (test_state low=0 label=3 flag=off delta=0 wide=0ms)";
+    assertEqual(memcmp(buffer, expect, strlen(expect) + 1), 0);
+}
+
+test(EventSchemaTest, PrintWithoutSchema) {
+    Event event(0x01, 0x02, (uint8_t[]){0xAA});
+    print(event);
+    const char* expect = "01:02#AA:FF:FF:FF:FF:FF";
+    assertEqual(memcmp(buffer, expect, strlen(expect) + 1), 0);
+}
+
+test(EventSchemaTest, Parse) {
+    const EventSchema* schema = EventSchemaTable::find("test_state");
+    uint32_t value;
+    assertTrue(schema->field("low")->parse("15", &value));
+    assertEqual(value, 15u);
+    assertTrue(schema->field("low")->parse("0x0C", &value));
+    assertEqual(value, 12u);
+    assertFalse(schema->field("low")->parse("16", &value));
+    assertFalse(schema->field("low")->parse("-1", &value));
+    assertFalse(schema->field("low")->parse("1x", &value));
+    assertFalse(schema->field("low")->parse("", &value));
+    assertFalse(schema->field("low")->parse(nullptr, &value));
+
+    assertTrue(schema->field("label")->parse("one", &value));
+    assertEqual(value, 1u);
+    assertTrue(schema->field("label")->parse("2", &value));
+    assertEqual(value, 2u);
+    assertFalse(schema->field("label")->parse("3", &value));
+    assertFalse(schema->field("label")->parse("three", &value));
+
+    assertTrue(schema->field("flag")->parse("on", &value));
+    assertEqual(value, 1u);
+    assertTrue(schema->field("flag")->parse("off", &value));
+    assertEqual(value, 0u);
+    assertFalse(schema->field("flag")->parse("2", &value));
+
+    assertTrue(schema->field("delta")->parse("-128", &value));
+    assertEqual(value, 0x80u);
+    assertTrue(schema->field("delta")->parse("127", &value));
+    assertEqual(value, 0x7Fu);
+    assertFalse(schema->field("delta")->parse("128", &value));
+    assertFalse(schema->field("delta")->parse("-129", &value));
+}
+
+// Typed accessors for every field of Core's schemas.
+const EventAccessor kCoreAccessors[] = {
+    EVENT_ACCESSOR("node_stats", NodeStatsState, "bus", bus),
+    EVENT_ACCESSOR("node_stats", NodeStatsState, "node", node),
+    EVENT_ACCESSOR("node_stats", NodeStatsState, "worst", worst_us),
+    EVENT_ACCESSOR("node_stats", NodeStatsState, "handled", handled),
+    EVENT_ACCESSOR("tx_state", TxState, "network", network),
+    EVENT_ACCESSOR("tx_state", TxState, "congested", congested),
+    EVENT_ACCESSOR("tx_state", TxState, "depth", depth),
+    EVENT_ACCESSOR("request", RequestCommand, "subsystem", request_subsystem),
+    EVENT_ACCESSOR("request", RequestCommand, "id", request_id),
+    EVENT_ACCESSOR("trace", TraceCommand, "action", action),
+    EVENT_ACCESSOR("trace", TraceCommand, "trace", trace),
+    EVENT_ACCESSOR("power_state", PowerState, "pdm", pdm),
+    EVENT_ACCESSOR("power_state", PowerState, "pin", pin),
+    EVENT_ACCESSOR("power_state", PowerState, "mode", mode),
+    EVENT_ACCESSOR("power_state", PowerState, "duty", duty_cycle),
+    EVENT_ACCESSOR("input_state", InputState, "pdm", pdm),
+    EVENT_ACCESSOR("input_state", InputState, "pin", pin),
+    EVENT_ACCESSOR("input_state", InputState, "state", state),
+    EVENT_ACCESSOR("power_cmd", PowerCommand, "pdm", pdm),
+    EVENT_ACCESSOR("power_cmd", PowerCommand, "pin", pin),
+    EVENT_ACCESSOR("power_cmd", PowerCommand, "cmd", cmd),
+    EVENT_ACCESSOR("power_cmd", PowerCommand, "duty", duty_cycle),
+    EVENT_ACCESSOR("key_state", KeyState, "keypad", keypad),
+    EVENT_ACCESSOR("key_state", KeyState, "key", key),
+    EVENT_ACCESSOR("key_state", KeyState, "pressed", pressed),
+    EVENT_ACCESSOR("encoder_state", EncoderState, "keypad", keypad),
+    EVENT_ACCESSOR("encoder_state", EncoderState, "encoder", encoder),
+    EVENT_ACCESSOR("encoder_state", EncoderState, "delta", delta),
+    EVENT_ACCESSOR("indicator_cmd", IndicatorCommand, "keypad", keypad),
+    EVENT_ACCESSOR("indicator_cmd", IndicatorCommand, "led", led),
+    EVENT_ACCESSOR("indicator_cmd", IndicatorCommand, "mode", mode),
+    EVENT_ACCESSOR("indicator_cmd", IndicatorCommand, "color", color),
+    EVENT_ACCESSOR("indicator_cmd", IndicatorCommand, "alt_color", alt_color),
+    EVENT_ACCESSOR("brightness_cmd", BrightnessCommand, "keypad", keypad),
+    EVENT_ACCESSOR("brightness_cmd", BrightnessCommand, "brightness", brightness),
+    EVENT_ACCESSOR("backlight_cmd", BacklightCommand, "keypad", keypad),
+    EVENT_ACCESSOR("backlight_cmd", BacklightCommand, "brightness", brightness),
+    EVENT_ACCESSOR("backlight_cmd", BacklightCommand, "color", color),
+};
+
+test(EventSchemaTest, Iterate) {
+    bool found = false;
+    for (size_t i = 0; i < EventSchemaTable::count(); ++i) {
+        found |= EventSchemaTable::at(i) == EventSchemaTable::find("test_cmd");
+    }
+    assertTrue(found);
+    assertTrue(EventSchemaTable::at(EventSchemaTable::count()) == nullptr);
+}
+
+// Every field of Core's schemas must match the typed accessor of its event
+// class. A new field or event needs an entry above.
+test(EventSchemaTest, Accessors) {
+    assertTrue(checkEventAccessors(kCoreAccessors,
+            sizeof(kCoreAccessors) / sizeof(kCoreAccessors[0]),
+            [](const EventSchema& schema) {
+                return &schema < kTestSchemas ||
+                    &schema >= kTestSchemas + sizeof(kTestSchemas) / sizeof(kTestSchemas[0]);
+            }));
+}
+
+test(EventSchemaTest, Valid) {
+    const EventSchema* schema = EventSchemaTable::find("test_state");
+    Event event(0x00, 0x0E, (uint8_t[]){0x20, 0x00, 0x00, 0x00});
+    assertTrue(schema->valid(event));
+    event.data[0] = 0x30;
+    assertFalse(schema->valid(event));
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
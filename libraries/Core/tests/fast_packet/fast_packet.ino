@@ -0,0 +1,168 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Faker.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::J1939Message;
+using ::Faker::FakeClock;
+
+// Build frame index of a fast packet whose payload bytes count up from 0.
+J1939Message frame(uint8_t source, uint8_t sequence, uint8_t index, uint8_t size) {
+    J1939Message msg(0x1FF04, source);
+    msg.data()[0] = (sequence << 5) | index;
+    if (index == 0) {
+        msg.data()[1] = size;
+        for (uint8_t i = 0; i < 6; ++i) {
+            msg.data()[i + 2] = i < size ? i : 0xFF;
+        }
+    } else {
+        for (uint8_t i = 0; i < 7; ++i) {
+            uint8_t b = 6 + (index - 1) * 7 + i;
+            msg.data()[i + 1] = b < size ? b : 0xFF;
+        }
+    }
+    return msg;
+}
+
+bool isCounting(const FastPacket& packet, uint8_t size) {
+    if (packet.data == nullptr || packet.data->size != size) {
+        return false;
+    }
+    for (uint8_t i = 0; i < size; ++i) {
+        if (packet.data->bytes[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+test(FastPacketTest, SingleFrame) {
+    FastPacketAssembler fp;
+    assertTrue(fp.add(frame(0x0A, 1, 0, 5)));
+    assertEqual(fp.packet().pgn, 0x1FF04u);
+    assertEqual(fp.packet().source_address, 0x0A);
+    assertEqual(fp.packet().sequence, 1);
+    assertTrue(isCounting(fp.packet(), 5));
+}
+
+test(FastPacketTest, InOrder) {
+    FastPacketAssembler fp;
+    assertFalse(fp.add(frame(0x0A, 2, 0, 20)));
+    assertFalse(fp.add(frame(0x0A, 2, 1, 20)));
+    assertTrue(fp.add(frame(0x0A, 2, 2, 20)));
+    assertTrue(isCounting(fp.packet(), 20));
+    assertEqual(fp.stats().completed, 1u);
+    assertEqual(fp.stats().dropped, 0u);
+}
+
+test(FastPacketTest, OutOfOrder) {
+    FastPacketAssembler fp;
+    assertFalse(fp.add(frame(0x0A, 2, 2, 20)));
+    assertFalse(fp.add(frame(0x0A, 2, 0, 20)));
+    assertFalse(fp.add(frame(0x0A, 2, 2, 20)));
+    assertTrue(fp.add(frame(0x0A, 2, 1, 20)));
+    assertTrue(isCounting(fp.packet(), 20));
+}
+
+test(FastPacketTest, Interleaved) {
+    FastPacketAssembler fp;
+    // Two sources and two sequences of the same source at once.
+    assertFalse(fp.add(frame(0x0A, 1, 0, 13)));
+    assertFalse(fp.add(frame(0x0B, 1, 0, 10)));
+    assertFalse(fp.add(frame(0x0A, 2, 0, 8)));
+    assertTrue(fp.add(frame(0x0B, 1, 1, 10)));
+    assertEqual(fp.packet().source_address, 0x0B);
+    assertTrue(isCounting(fp.packet(), 10));
+    assertTrue(fp.add(frame(0x0A, 2, 1, 8)));
+    assertEqual(fp.packet().sequence, 2);
+    assertTrue(isCounting(fp.packet(), 8));
+    assertTrue(fp.add(frame(0x0A, 1, 1, 13)));
+    assertEqual(fp.packet().sequence, 1);
+    assertTrue(isCounting(fp.packet(), 13));
+}
+
+test(FastPacketTest, LostFrame) {
+    FastPacketAssembler fp;
+    // Frame 1 is lost. The next payload with the same sequence ID replaces
+    // the partial one.
+    assertFalse(fp.add(frame(0x0A, 3, 0, 20)));
+    assertFalse(fp.add(frame(0x0A, 3, 2, 20)));
+    assertFalse(fp.add(frame(0x0A, 3, 0, 13)));
+    assertTrue(fp.add(frame(0x0A, 3, 1, 13)));
+    assertTrue(isCounting(fp.packet(), 13));
+    assertEqual(fp.stats().dropped, 1u);
+}
+
+test(FastPacketTest, Timeout) {
+    FakeClock clock;
+    FastPacketAssembler fp(750, &clock);
+    assertFalse(fp.add(frame(0x0A, 3, 0, 13)));
+    clock.set(750);
+    assertFalse(fp.add(frame(0x0A, 3, 1, 13)));
+    assertEqual(fp.stats().dropped, 1u);
+    assertEqual(fp.stats().completed, 0u);
+}
+
+test(FastPacketTest, Evict) {
+    FakeClock clock;
+    FastPacketAssembler fp(750, &clock);
+    for (uint8_t i = 0; i <= FastPacketAssembler::kSlots; ++i) {
+        clock.set(i);
+        assertFalse(fp.add(frame(0x10 + i, 0, 0, 13)));
+    }
+    // The oldest payload made room for the last.
+    assertEqual(fp.stats().dropped, 1u);
+    assertTrue(fp.add(frame(0x11, 0, 1, 13)));
+    assertFalse(fp.add(frame(0x10, 0, 1, 13)));
+}
+
+test(FastPacketTest, MaxSize) {
+    FastPacketAssembler fp;
+    uint8_t size = FastPacketAssembler::kMaxSize;
+    for (uint8_t i = 31; i > 0; --i) {
+        assertFalse(fp.add(frame(0x0A, 0, i, size)));
+    }
+    assertTrue(fp.add(frame(0x0A, 0, 0, size)));
+    assertTrue(isCounting(fp.packet(), size));
+
+    // Payloads larger than the maximum are discarded.
+    assertFalse(fp.add(frame(0x0A, 1, 0, size + 1)));
+    assertEqual(fp.stats().dropped, 1u);
+}
+
+test(FastPacketTest, ReleaseLease) {
+    ScratchArena* arena = ScratchArena::shared();
+    size_t used = arena->used();
+    FastPacketAssembler fp;
+    assertFalse(fp.add(frame(0x0A, 0, 0, 20)));
+    assertTrue(arena->used() > used);
+    assertFalse(fp.add(frame(0x0A, 0, 1, 20)));
+    assertTrue(fp.add(frame(0x0A, 0, 2, 20)));
+
+    // The lease is returned on the next frame.
+    J1939Message empty(0x1FF04, 0x0A);
+    empty.resize(0);
+    assertFalse(fp.add(empty));
+    assertEqual(arena->used(), used);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
@@ -0,0 +1,130 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Core.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+
+static const uint8_t kMCP2515[] = {2, 4};
+static const uint8_t kMCP2518[] = {1, 1, 1, 1, 1, 1, 1, 1};
+
+typedef FakeFilterRegisters<2, 4> FakeMCP2515;
+typedef FakeFilterRegisters<8, 1> FakeMCP2518;
+
+// Return true if the registers accept every standard ID matched by the
+// filter.
+template <typename Registers>
+bool acceptsAll(const Registers& regs, const IDFilter& filter) {
+    for (uint32_t id = 0; id < 0x800; ++id) {
+        if (filter.match(id, false) && !regs.accept(id, false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+test(HardwareFilterTest, Exact) {
+    static const IDRule rules[] = {
+        stdID(0x54A, 0x7FE),
+        stdID(0x72E, 0x7FE),
+        stdID(0x385),
+        stdID(0x625),
+    };
+    FakeMCP2515 regs(kMCP2515);
+    assertTrue(programFilters(rules, &regs));
+    assertEqual(regs.acceptCount(), 6u);
+    assertTrue(acceptsAll(regs, IDFilter(rules)));
+    assertFalse(regs.accept(0x54A, true));
+}
+
+test(HardwareFilterTest, Range) {
+    static const IDRule rules[] = {
+        stdRange(0x700, 0x70F),
+        stdID(0x100),
+    };
+    FakeMCP2515 regs(kMCP2515);
+    assertTrue(programFilters(rules, &regs));
+    assertEqual(regs.acceptCount(), 17u);
+    assertTrue(acceptsAll(regs, IDFilter(rules)));
+}
+
+test(HardwareFilterTest, UnalignedRange) {
+    static const IDRule rules[] = {
+        stdRange(0x101, 0x1FE),
+    };
+    FakeMCP2515 regs(kMCP2515);
+    assertFalse(programFilters(rules, &regs));
+    assertTrue(acceptsAll(regs, IDFilter(rules)));
+    assertTrue(regs.acceptCount() < 0x200);
+}
+
+test(HardwareFilterTest, TooManyIDs) {
+    static const IDRule rules[] = {
+        stdID(0x100), stdID(0x101), stdID(0x102), stdID(0x104),
+        stdID(0x200), stdID(0x300), stdID(0x400), stdID(0x500),
+    };
+    FakeMCP2515 regs(kMCP2515);
+    assertFalse(programFilters(rules, &regs));
+    assertTrue(acceptsAll(regs, IDFilter(rules)));
+    assertTrue(regs.acceptCount() < 0x800);
+}
+
+test(HardwareFilterTest, Extended) {
+    static const IDRule rules[] = {
+        stdID(0x100),
+        extID(0x18FEEE00, 0x1FFFFF00),
+    };
+    FakeMCP2515 regs(kMCP2515);
+    assertTrue(programFilters(rules, &regs));
+    assertTrue(regs.accept(0x100, false));
+    assertFalse(regs.accept(0x101, false));
+    assertFalse(regs.accept(0x100, true));
+    assertTrue(regs.accept(0x18FEEE00, true));
+    assertTrue(regs.accept(0x18FEEEFF, true));
+    assertFalse(regs.accept(0x18FEEF00, true));
+    assertFalse(regs.accept(0x18FEEE00 & 0x7FF, false));
+}
+
+test(HardwareFilterTest, FilterPerMask) {
+    static const IDRule rules[] = {
+        stdID(0x54A, 0x7FE),
+        stdID(0x385),
+        extID(0x18EA0000, 0x1FFF0000),
+    };
+    FakeMCP2518 regs(kMCP2518);
+    assertTrue(programFilters(rules, &regs));
+    assertEqual(regs.acceptCount(), 3u);
+    assertTrue(regs.accept(0x18EA1234, true));
+    assertFalse(regs.accept(0x18EB0000, true));
+}
+
+test(HardwareFilterTest, OpenWhenKindsDoNotFit) {
+    static const uint8_t layout[] = {2};
+    static const IDRule rules[] = {
+        stdID(0x100),
+        extID(0x18FEEE00),
+    };
+    FakeFilterRegisters<1, 2> regs(layout);
+    assertFalse(programFilters(rules, &regs));
+    assertEqual(regs.acceptCount(), 0x800u);
+    assertTrue(regs.accept(0x18FEEE00, true));
+    assertTrue(regs.accept(0x1234, true));
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
@@ -0,0 +1,120 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::CAN20Frame;
+
+static const IDRule kRules[] = {
+    stdID(0x54A, 0x7FE),
+    stdID(0x385),
+    stdRange(0x700, 0x70F),
+    extID(0x18FEEE00, 0x1FFFFF00),
+    extRange(0x18EA0000, 0x18EAFFFF),
+};
+
+test(IDFilterTest, Default) {
+    IDFilter reject;
+    assertFalse(reject.match(0x000, false));
+    assertFalse(reject.match(0x7FF, false));
+    assertFalse(reject.match(0x18FEEE00, true));
+
+    IDFilter accept(true);
+    assertTrue(accept.match(0x000, false));
+    assertTrue(accept.match(0x7FF, false));
+    assertTrue(accept.match(0x18FEEE00, true));
+}
+
+test(IDFilterTest, StandardRules) {
+    IDFilter filter(kRules);
+    assertTrue(filter.match(0x54A, false));
+    assertTrue(filter.match(0x54B, false));
+    assertFalse(filter.match(0x54C, false));
+    assertTrue(filter.match(0x385, false));
+    assertFalse(filter.match(0x384, false));
+    assertFalse(filter.match(0x6FF, false));
+    assertTrue(filter.match(0x700, false));
+    assertTrue(filter.match(0x70F, false));
+    assertFalse(filter.match(0x710, false));
+
+    // Standard rules do not match extended IDs.
+    assertFalse(filter.match(0x54A, true));
+}
+
+test(IDFilterTest, ExtendedRules) {
+    IDFilter filter(kRules);
+    assertTrue(filter.match(0x18FEEE00, true));
+    assertTrue(filter.match(0x18FEEEFF, true));
+    assertFalse(filter.match(0x18FEEF00, true));
+    assertTrue(filter.match(0x18EA0000, true));
+    assertTrue(filter.match(0x18EAFFFF, true));
+    assertFalse(filter.match(0x18EB0000, true));
+    assertEqual(filter.ext_count(), 2u);
+}
+
+test(IDFilterTest, MatchFrame) {
+    IDFilter filter(kRules);
+    CAN20Frame std(0x385, 0, {});
+    CAN20Frame ext(0x18FEEE01, 1, {});
+    CAN20Frame other(0x386, 0, {});
+    assertTrue(filter.match(std));
+    assertTrue(filter.match(ext));
+    assertFalse(filter.match(other));
+}
+
+test(IDFilterTest, AllowAndDrop) {
+    IDFilter filter(true);
+    filter.drop(stdRange(0x100, 0x1FF));
+    filter.allow(stdID(0x180));
+    assertTrue(filter.match(0x0FF, false));
+    assertFalse(filter.match(0x100, false));
+    assertTrue(filter.match(0x180, false));
+    assertFalse(filter.match(0x1FF, false));
+
+    // The most recent extended rule wins.
+    filter.drop(extRange(0x100000, 0x1FFFFF));
+    filter.allow(extID(0x180000));
+    assertFalse(filter.match(0x100000, true));
+    assertTrue(filter.match(0x180000, true));
+    filter.drop(extID(0x180000));
+    assertFalse(filter.match(0x180000, true));
+    assertEqual(filter.ext_count(), 2u);
+
+    filter.reset(false);
+    assertFalse(filter.match(0x0FF, false));
+    assertFalse(filter.match(0x200000, true));
+    assertEqual(filter.ext_count(), 0u);
+}
+
+test(IDFilterTest, ExtendedFull) {
+    IDFilter filter;
+    for (size_t i = 0; i < IDFilter::kMaxExtRules; ++i) {
+        assertTrue(filter.allow(extID(0x10000 + i)));
+    }
+    assertFalse(filter.allow(extID(0x20000)));
+    assertTrue(filter.allow(stdID(0x100)));
+
+    // Replacing a rule does not need room.
+    assertTrue(filter.drop(extID(0x10000)));
+    assertFalse(filter.match(0x10000, true));
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
@@ -0,0 +1,293 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Faker.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::CAN20Frame;
+using ::Faker::FakeClock;
+
+const uint8_t payload[] = {
+    0x61, 0x01, 0x00, 0x1E, 0x24, 0x00, 0x10, 0x0C,
+    0x40, 0x40, 0x01, 0x64, 0x00, 0x94, 0x00, 0x00,
+    0x47,
+};
+
+test(IsoTPTest, SendSingle) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    assertFalse(link.next(&frame));
+    assertTrue(link.send(payload, 2));
+    assertTrue(link.sending());
+    assertFalse(link.send(payload, 2));
+
+    // The frame is repeated until popped.
+    CAN20Frame expect(0x71E, 0, {0x02, 0x61, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, expect);
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, expect);
+    link.pop();
+
+    assertFalse(link.sending());
+    assertFalse(link.next(&frame));
+    assertEqual(link.stats().sent, 1u);
+}
+
+test(IsoTPTest, SendSegmented) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    assertTrue(link.send(payload, sizeof(payload)));
+    CAN20Frame ff(0x71E, 0, {0x10, 0x11, 0x61, 0x01, 0x00, 0x1E, 0x24, 0x00});
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, ff);
+    link.pop();
+
+    // Wait for flow control.
+    assertFalse(link.next(&frame));
+    CAN20Frame fc(0x72E, 0, {0x30, 0x00, 0x0A, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    assertFalse(link.receive(fc));
+
+    // Consecutive frames are spaced by STmin.
+    CAN20Frame cf1(0x71E, 0, {0x21, 0x10, 0x0C, 0x40, 0x40, 0x01, 0x64, 0x00});
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, cf1);
+    link.pop();
+    assertFalse(link.next(&frame));
+    clock.set(9);
+    assertFalse(link.next(&frame));
+    clock.set(10);
+
+    CAN20Frame cf2(0x71E, 0, {0x22, 0x94, 0x00, 0x00, 0x47, 0xFF, 0xFF, 0xFF});
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, cf2);
+    link.pop();
+
+    assertFalse(link.sending());
+    assertEqual(link.stats().sent, 1u);
+}
+
+test(IsoTPTest, SendBlocks) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    link.send(payload, sizeof(payload));
+    link.next(&frame);
+    link.pop();
+
+    // A block size of one requires flow control after every frame.
+    CAN20Frame fc(0x72E, 0, {0x30, 0x01, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    link.receive(fc);
+    assertTrue(link.next(&frame));
+    assertEqual(frame.data()[0], 0x21);
+    link.pop();
+    assertFalse(link.next(&frame));
+
+    // Wait extends the flow control timeout.
+    CAN20Frame wait(0x72E, 0, {0x31, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    clock.set(900);
+    link.receive(wait);
+    clock.set(1500);
+    assertFalse(link.next(&frame));
+    assertTrue(link.sending());
+
+    link.receive(fc);
+    assertTrue(link.next(&frame));
+    assertEqual(frame.data()[0], 0x22);
+    link.pop();
+    assertFalse(link.sending());
+}
+
+test(IsoTPTest, SendTimeout) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    link.send(payload, sizeof(payload));
+    link.next(&frame);
+    link.pop();
+
+    clock.set(IsoTP::kTimeout + 1);
+    assertFalse(link.next(&frame));
+    assertFalse(link.sending());
+    assertEqual(link.stats().timeouts, 1u);
+    assertEqual(link.stats().sent, 0u);
+}
+
+test(IsoTPTest, SendOverflow) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    link.send(payload, sizeof(payload));
+    link.next(&frame);
+    link.pop();
+
+    CAN20Frame fc(0x72E, 0, {0x32, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    link.receive(fc);
+    assertFalse(link.sending());
+    assertEqual(link.stats().aborted, 1u);
+}
+
+test(IsoTPTest, ReceiveSingle) {
+    IsoTP link(0x71E, 0x72E);
+
+    // Frames for other IDs are ignored.
+    CAN20Frame other(0x72F, 0, {0x02, 0x50, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    assertFalse(link.receive(other));
+
+    CAN20Frame sf(0x72E, 0, {0x02, 0x50, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    assertTrue(link.receive(sf));
+    assertEqual(link.payload().size, 2u);
+    assertEqual(link.payload().bytes[0], 0x50);
+    assertEqual(link.payload().bytes[1], 0xC0);
+    assertEqual(link.stats().received, 1u);
+}
+
+test(IsoTPTest, ReceiveSegmented) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0x0A, &clock);
+    CAN20Frame frame;
+
+    CAN20Frame ff(0x72E, 0, {0x10, 0x11, 0x61, 0x01, 0x00, 0x1E, 0x24, 0x00});
+    CAN20Frame cf1(0x72E, 0, {0x21, 0x10, 0x0C, 0x40, 0x40, 0x01, 0x64, 0x00});
+    CAN20Frame cf2(0x72E, 0, {0x22, 0x94, 0x00, 0x00, 0x47, 0xFF, 0xFF, 0xFF});
+
+    // The first frame is answered with flow control.
+    assertFalse(link.receive(ff));
+    CAN20Frame fc(0x71E, 0, {0x30, 0x00, 0x0A, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, fc);
+    link.pop();
+    assertFalse(link.next(&frame));
+
+    assertFalse(link.receive(cf1));
+    assertTrue(link.receive(cf2));
+    assertEqual(link.payload().size, sizeof(payload));
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        assertEqual(link.payload().bytes[i], payload[i]);
+    }
+    assertEqual(link.stats().received, 1u);
+}
+
+test(IsoTPTest, ReceiveBlocks) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 1, 0, &clock);
+    CAN20Frame frame;
+
+    CAN20Frame ff(0x72E, 0, {0x10, 0x11, 0x61, 0x01, 0x00, 0x1E, 0x24, 0x00});
+    CAN20Frame cf1(0x72E, 0, {0x21, 0x10, 0x0C, 0x40, 0x40, 0x01, 0x64, 0x00});
+    CAN20Frame cf2(0x72E, 0, {0x22, 0x94, 0x00, 0x00, 0x47, 0xFF, 0xFF, 0xFF});
+    CAN20Frame fc(0x71E, 0, {0x30, 0x01, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+
+    link.receive(ff);
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, fc);
+    link.pop();
+
+    // Flow control is sent again after each block.
+    link.receive(cf1);
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, fc);
+    link.pop();
+
+    assertTrue(link.receive(cf2));
+    assertFalse(link.next(&frame));
+}
+
+test(IsoTPTest, ReceiveSequenceError) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    CAN20Frame ff(0x72E, 0, {0x10, 0x11, 0x61, 0x01, 0x00, 0x1E, 0x24, 0x00});
+    CAN20Frame cf2(0x72E, 0, {0x22, 0x94, 0x00, 0x00, 0x47, 0xFF, 0xFF, 0xFF});
+
+    link.receive(ff);
+    link.next(&frame);
+    link.pop();
+    assertFalse(link.receive(cf2));
+    assertEqual(link.stats().aborted, 1u);
+    assertEqual(link.stats().received, 0u);
+}
+
+test(IsoTPTest, ReceiveOverflow) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    // Payloads larger than a scratch lease are refused.
+    CAN20Frame ff(0x72E, 0, {0x14, 0x00, 0x61, 0x01, 0x00, 0x1E, 0x24, 0x00});
+    CAN20Frame fc(0x71E, 0, {0x32, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    assertFalse(link.receive(ff));
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, fc);
+    assertEqual(link.stats().aborted, 1u);
+}
+
+test(IsoTPTest, ReceiveTimeout) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    CAN20Frame ff(0x72E, 0, {0x10, 0x11, 0x61, 0x01, 0x00, 0x1E, 0x24, 0x00});
+    CAN20Frame cf1(0x72E, 0, {0x21, 0x10, 0x0C, 0x40, 0x40, 0x01, 0x64, 0x00});
+
+    link.receive(ff);
+    link.next(&frame);
+    link.pop();
+
+    clock.set(IsoTP::kTimeout + 1);
+    assertFalse(link.next(&frame));
+    assertEqual(link.stats().timeouts, 1u);
+    assertFalse(link.receive(cf1));
+}
+
+test(IsoTPTest, ReceiveAbortedBeforePop) {
+    FakeClock clock;
+    IsoTP link(0x71E, 0x72E, 0, 0, &clock);
+    CAN20Frame frame;
+
+    CAN20Frame ff(0x72E, 0, {0x10, 0x11, 0x61, 0x01, 0x00, 0x1E, 0x24, 0x00});
+    CAN20Frame cts(0x71E, 0, {0x30, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    link.receive(ff);
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, cts);
+
+    // A transfer which is refused before the flow control is written still
+    // gets its overflow.
+    CAN20Frame big(0x72E, 0, {0x14, 0x00, 0x61, 0x01, 0x00, 0x1E, 0x24, 0x00});
+    CAN20Frame overflow(0x71E, 0, {0x32, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    link.receive(big);
+    link.pop();
+    assertTrue(link.next(&frame));
+    assertPrintablesEqual(frame, overflow);
+    link.pop();
+    assertFalse(link.next(&frame));
+    assertEqual(link.stats().aborted, 2u);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
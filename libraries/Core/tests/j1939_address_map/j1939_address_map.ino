@@ -0,0 +1,111 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::NullAddress;
+
+test(J1939AddressMapTest, Claim) {
+    J1939AddressMap map;
+    assertEqual(map.address(0x1001), NullAddress);
+    assertEqual(map.name(0x20), 0u);
+
+    assertTrue(map.claim(0x20, 0x1001));
+    assertTrue(map.claim(0x21, 0x1002));
+    assertFalse(map.claim(0x20, 0x1001));
+    assertEqual(map.size(), 2u);
+    assertEqual(map.address(0x1001), 0x20);
+    assertEqual(map.address(0x1002), 0x21);
+    assertEqual(map.name(0x20), 0x1001u);
+    assertEqual(map.name(0x21), 0x1002u);
+
+    // Invalid addresses are ignored.
+    assertFalse(map.claim(0xFF, 0x1003));
+    assertEqual(map.size(), 2u);
+}
+
+test(J1939AddressMapTest, Move) {
+    J1939AddressMap map;
+    map.claim(0x20, 0x1001);
+    assertTrue(map.claim(0x22, 0x1001));
+    assertEqual(map.size(), 1u);
+    assertEqual(map.address(0x1001), 0x22);
+    assertEqual(map.name(0x20), 0u);
+    assertEqual(map.name(0x22), 0x1001u);
+}
+
+test(J1939AddressMapTest, Displace) {
+    J1939AddressMap map;
+    map.claim(0x20, 0x1001);
+    map.claim(0x21, 0x1002);
+
+    uint64_t displaced = 0;
+    assertTrue(map.claim(0x20, 0x1002, &displaced));
+    assertEqual(displaced, 0x1001u);
+    assertEqual(map.size(), 1u);
+    assertEqual(map.address(0x1001), NullAddress);
+    assertEqual(map.address(0x1002), 0x20);
+    assertEqual(map.name(0x21), 0u);
+}
+
+test(J1939AddressMapTest, CannotClaim) {
+    J1939AddressMap map;
+    map.claim(0x20, 0x1001);
+    assertFalse(map.claim(NullAddress, 0x1002));
+    assertTrue(map.claim(NullAddress, 0x1001));
+    assertEqual(map.size(), 0u);
+    assertEqual(map.name(0x20), 0u);
+}
+
+test(J1939AddressMapTest, Full) {
+    J1939AddressMap map;
+    for (uint8_t i = 0; i < J1939AddressMap::kCapacity; ++i) {
+        assertTrue(map.claim(i, 0x1000 + i));
+    }
+    assertFalse(map.claim(0x80, 0x2000));
+    assertEqual(map.address(0x2000), NullAddress);
+
+    // Nodes already known may still move.
+    assertTrue(map.claim(0x80, 0x1000));
+    assertEqual(map.address(0x1000), 0x80);
+}
+
+// Collisions in the table are found after other nodes are removed.
+test(J1939AddressMapTest, Collisions) {
+    J1939AddressMap map;
+    uint64_t stride = (uint64_t)J1939AddressMap::kCapacity << 32;
+    for (uint8_t i = 0; i < 8; ++i) {
+        assertTrue(map.claim(0x10 + i, 0x42 + i * stride));
+    }
+    for (uint8_t i = 0; i < 8; i += 2) {
+        assertTrue(map.claim(NullAddress, 0x42 + i * stride));
+    }
+    assertEqual(map.size(), 4u);
+    for (uint8_t i = 0; i < 8; ++i) {
+        uint8_t expect = i % 2 == 0 ? NullAddress : 0x10 + i;
+        assertEqual(map.address(0x42 + i * stride), expect);
+        if (i % 2 == 1) {
+            assertEqual(map.name(0x10 + i), 0x42 + i * stride);
+        }
+    }
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
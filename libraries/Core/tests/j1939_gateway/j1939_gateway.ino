@@ -2,6 +2,7 @@
 #include <Arduino.h>
 #include <Canny.h>
 #include <Core.h>
+#include <Faker.h>
 #include <Test.h>
 
 namespace R51 {
@@ -14,6 +15,7 @@ using ::Canny::ERR_INTERNAL;
 using ::Canny::ERR_OK;
 using ::Canny::Error;
 using ::Canny::J1939Message;
+using ::Faker::FakeClock;
 
 class FakeConnection : public Connection<J1939Message> {
     public:
@@ -129,6 +131,28 @@ test(J1939GatewayTest, ReadPromiscuous) {
     assertIsJ1939Message(yield.messages()[2], m3);
 }
 
+test(J1939GatewayTest, ReadBurst) {
+    FakeYield yield;
+    FakeConnection can(3, 0);
+    J1939Gateway node(&can, 0x10, false);
+    node.burst(8);
+
+    J1939Message m1(0xEF00, 0x20, 0x10);
+    J1939Message m2(0xEF00, 0x30, 0x20);
+    J1939Message m3(0xEF00, 0x40, 0xFF);
+    can.setReadBuffer({m1, m2, m3});
+
+    // Filtered messages count towards the burst.
+    node.emit(yield);
+    assertSize(yield, 2);
+    assertIsJ1939Message(yield.messages()[0], m1);
+    assertIsJ1939Message(yield.messages()[1], m3);
+    assertEqual(can.readsRemaining(), 0);
+    assertEqual(node.burstStats().frames, 3u);
+    assertEqual(node.burstStats().peak, 3);
+    assertEqual(node.burstStats().limited, 0u);
+}
+
 test(J1939GatewayTest, WriteFiltered) {
     FakeYield yield;
     FakeConnection can(0, 3);
@@ -164,8 +188,345 @@ test(J1939GatewayTest, WritePromiscuous) {
     assertPrintablesEqual(can.writeData()[2], m3);
 }
 
+// Connects two gateways. Messages written to one end are read from the
+// other.
+class LinkConnection : public Connection<J1939Message> {
+    public:
+        LinkConnection() : peer_(nullptr), head_(0), size_(0), writes_(0) {}
+
+        void connect(LinkConnection* peer) {
+            peer_ = peer;
+            peer->peer_ = this;
+        }
+
+        Error read(J1939Message* msg) override {
+            if (size_ == 0) {
+                return ERR_FIFO;
+            }
+            *msg = queue_[head_];
+            head_ = (head_ + 1) % kSize;
+            --size_;
+            return ERR_OK;
+        }
+
+        Error write(const J1939Message& msg) override {
+            if (peer_ == nullptr || peer_->size_ >= kSize) {
+                return ERR_FIFO;
+            }
+            peer_->queue_[(peer_->head_ + peer_->size_) % kSize] = msg;
+            ++peer_->size_;
+            last_ = msg;
+            ++writes_;
+            return ERR_OK;
+        }
+
+        int writes() const { return writes_; }
+        const J1939Message& last() const { return last_; }
+
+    private:
+        static const size_t kSize = 64;
+
+        LinkConnection* peer_;
+        J1939Message queue_[kSize];
+        size_t head_;
+        size_t size_;
+        int writes_;
+        J1939Message last_;
+};
+
+void fill(Scratch* data, size_t size) {
+    data->reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        data->bytes[i] = i;
+    }
+    data->size = size;
+}
+
+// Run both gateways for count loops advancing the clock by ms each loop.
+void pump(FakeClock* clock, J1939Gateway* a, FakeYield* ya, J1939Gateway* b,
+        FakeYield* yb, int count, uint32_t ms) {
+    for (int i = 0; i < count; ++i) {
+        clock->delay(ms);
+        a->emit(*ya);
+        b->emit(*yb);
+    }
+}
+
+J1939Message control(uint8_t source, uint8_t dest, uint8_t b0, uint8_t b1, uint8_t b2,
+        uint8_t b3, uint32_t pgn) {
+    J1939Message msg(0xEC00, source, dest, 0x07);
+    msg.data({b0, b1, b2, b3, 0xFF, (uint8_t)pgn, (uint8_t)(pgn >> 8),
+            (uint8_t)(pgn >> 16)});
+    return msg;
+}
+
+test(J1939GatewayTest, WriteQueued) {
+    FakeYield yield;
+    FakeConnection can(0, 1);
+    J1939Gateway node(&can, 0x10, false);
+
+    J1939Message m1(0xEF00, 0x10, 0x11, 0x06);
+    J1939Message m2(0xEF00, 0x10, 0x12, 0x06);
+    J1939Message m3(0xEF00, 0x10, 0x13, 0x03);
+    node.handle(MessageView(&m1), yield);
+    node.handle(MessageView(&m2), yield);
+    node.handle(MessageView(&m3), yield);
+    assertEqual(can.writeCount(), 1);
+    assertPrintablesEqual(can.writeData()[0], m1);
+    assertEqual(node.txStats().queued, 3u);
+    assertEqual(node.txStats().sent, 1u);
+
+    // The more urgent frame is written first once the bus frees up.
+    can.writeReset();
+    node.emit(yield);
+    assertEqual(can.writeCount(), 1);
+    assertPrintablesEqual(can.writeData()[0], m3);
+
+    can.writeReset();
+    node.emit(yield);
+    assertEqual(can.writeCount(), 1);
+    assertPrintablesEqual(can.writeData()[0], m2);
+    assertEqual(node.txStats().sent, 3u);
+    assertEqual(node.txStats().peak, 2u);
+}
+
+test(J1939GatewayTest, WriteCongested) {
+    FakeYield yield;
+    FakeClock clock;
+    FakeConnection can(0, 0);
+    J1939Gateway node(&can, 0x10, false, &clock);
+    node.writeTimeout(50);
+
+    J1939Message msg(0xEF00, 0x10, 0x11, 0x06);
+    for (size_t i = 0; i < J1939Gateway::kCongestedDepth; ++i) {
+        msg.dest_address(0x11 + i);
+        node.handle(MessageView(&msg), yield);
+    }
+    TxState expect(TxNetwork::J1939);
+    expect.congested(true);
+    expect.depth(J1939Gateway::kCongestedDepth);
+    assertSize(yield, 1);
+    assertIsEvent(yield.messages()[0], expect);
+    yield.clear();
+
+    // Frames which wait too long are dropped and the congestion clears.
+    clock.set(51);
+    node.emit(yield);
+    expect.congested(false);
+    expect.depth(0);
+    assertSize(yield, 1);
+    assertIsEvent(yield.messages()[0], expect);
+    assertEqual(node.txStats().expired, J1939Gateway::kCongestedDepth);
+}
+
+test(J1939GatewayTest, TransferSingleFrame) {
+    FakeYield yield;
+    FakeConnection can(0, 1);
+    J1939Gateway node(&can, 0x10, false);
+
+    Scratch data;
+    fill(&data, 4);
+    J1939Transfer transfer(0xEF00, 0x10, 0x20, &data);
+    node.handle(MessageView(&transfer), yield);
+
+    J1939Message expect(0xEF00, 0x10, 0x20);
+    expect.data({0x00, 0x01, 0x02, 0x03});
+    assertEqual(can.writeCount(), 1);
+    assertPrintablesEqual(can.writeData()[0], expect);
+}
+
+test(J1939GatewayTest, TransferBAM) {
+    FakeClock clock;
+    FakeYield ya, yb;
+    LinkConnection a_can, b_can;
+    a_can.connect(&b_can);
+    J1939Gateway a(&a_can, 0x10, false, &clock);
+    J1939Gateway b(&b_can, 0x20, false, &clock);
+    a.burst(16);
+    b.burst(16);
+
+    Scratch data;
+    fill(&data, 20);
+    J1939Transfer transfer(0xFF10, 0x10, 0xFF, &data);
+    a.handle(MessageView(&transfer), ya);
+    assertEqual(a_can.writes(), 1);
+
+    // Packets are paced by the BAM interval.
+    pump(&clock, &a, &ya, &b, &yb, 1, 49);
+    assertEqual(a_can.writes(), 1);
+    pump(&clock, &a, &ya, &b, &yb, 1, 1);
+    assertEqual(a_can.writes(), 2);
+    pump(&clock, &a, &ya, &b, &yb, 4, 50);
+    assertEqual(a_can.writes(), 4);
+
+    assertSize(ya, 0);
+    assertSize(yb, 1);
+    assertIsJ1939Transfer(yb.messages()[0], transfer);
+    assertEqual(a.transportStats().sent, 1u);
+    assertEqual(b.transportStats().received, 1u);
+}
+
+test(J1939GatewayTest, TransferRTSCTS) {
+    FakeClock clock;
+    FakeYield ya, yb;
+    LinkConnection a_can, b_can;
+    a_can.connect(&b_can);
+    J1939Gateway a(&a_can, 0x10, false, &clock);
+    J1939Gateway b(&b_can, 0x20, false, &clock);
+    a.burst(64);
+    b.burst(64);
+
+    Scratch data;
+    fill(&data, 200);
+    J1939Transfer transfer(0xEF00, 0x10, 0x20, &data);
+    a.handle(MessageView(&transfer), ya);
+
+    // RTS, CTS, 29 packets, then the ack.
+    pump(&clock, &a, &ya, &b, &yb, 4, 1);
+    assertSize(ya, 0);
+    assertSize(yb, 1);
+    assertIsJ1939Transfer(yb.messages()[0], transfer);
+    assertEqual(a_can.writes(), 30);
+    assertEqual(b_can.writes(), 2);
+    assertEqual(a.transportStats().sent, 1u);
+    assertEqual(b.transportStats().received, 1u);
+}
+
+test(J1939GatewayTest, TransferCTSWindow) {
+    FakeClock clock;
+    FakeYield yield;
+    FakeConnection can(2, 8);
+    J1939Gateway node(&can, 0x10, false, &clock);
+    node.burst(4);
+
+    Scratch data;
+    fill(&data, 20);
+    J1939Transfer transfer(0xEF00, 0x10, 0x20, &data);
+    node.handle(MessageView(&transfer), yield);
+    assertEqual(can.writeCount(), 1);
+    assertPrintablesEqual(can.writeData()[0],
+            control(0x10, 0x20, 0x10, 20, 0x00, 3, 0xEF00));
+
+    // The receiver asks for two packets then the last one.
+    can.setReadBuffer({control(0x20, 0x10, 0x11, 2, 1, 0xFF, 0xEF00)});
+    node.emit(yield);
+    assertEqual(can.writeCount(), 3);
+    assertEqual(can.writeData()[1].data()[0], 1);
+    assertEqual(can.writeData()[2].data()[0], 2);
+
+    can.setReadBuffer({control(0x20, 0x10, 0x11, 1, 3, 0xFF, 0xEF00)});
+    node.emit(yield);
+    assertEqual(can.writeCount(), 4);
+    assertEqual(can.writeData()[3].data()[0], 3);
+    assertEqual(can.writeData()[3].data()[6], 19);
+    assertEqual(can.writeData()[3].data()[7], 0xFF);
+
+    can.setReadBuffer({control(0x20, 0x10, 0x13, 20, 0x00, 3, 0xEF00)});
+    node.emit(yield);
+    assertEqual(node.transportStats().sent, 1u);
+    assertSize(yield, 0);
+}
+
+test(J1939GatewayTest, TransferTimeout) {
+    FakeClock clock;
+    FakeYield yield;
+    FakeConnection can(1, 4);
+    J1939Gateway node(&can, 0x10, false, &clock);
+
+    can.setReadBuffer({control(0x20, 0x10, 0x10, 20, 0x00, 3, 0xEF00)});
+    node.emit(yield);
+    assertEqual(can.writeCount(), 1);
+    assertPrintablesEqual(can.writeData()[0],
+            control(0x10, 0x20, 0x11, 3, 1, 0xFF, 0xEF00));
+
+    clock.set(1249);
+    node.emit(yield);
+    assertEqual(can.writeCount(), 1);
+    clock.set(1250);
+    node.emit(yield);
+    assertEqual(can.writeCount(), 2);
+    assertPrintablesEqual(can.writeData()[1],
+            control(0x10, 0x20, 0xFF, 3, 0xFF, 0xFF, 0xEF00));
+    assertEqual(node.transportStats().timeouts, 1u);
+    assertSize(yield, 0);
+}
+
+test(J1939GatewayTest, TransferConcurrent) {
+    FakeClock clock;
+    FakeYield yield;
+    FakeConnection can(16, 4);
+    J1939Gateway node(&can, 0x10, false, &clock);
+    node.burst(16);
+
+    // Five nodes broadcast at once. Only four sessions fit.
+    J1939Message dt(0xEB00, 0x00, 0xFF, 0x07);
+    J1939Message msgs[15];
+    size_t n = 0;
+    for (uint8_t src = 0x20; src < 0x25; ++src) {
+        msgs[n++] = control(src, 0xFF, 0x20, 10, 0x00, 2, 0xFF00 | src);
+    }
+    for (uint8_t seq = 1; seq <= 2; ++seq) {
+        for (uint8_t src = 0x20; src < 0x25; ++src) {
+            dt.source_address(src);
+            dt.data({seq, src, src, src, src, src, src, src});
+            msgs[n++] = dt;
+        }
+    }
+    can.setReadBuffer(msgs);
+    node.emit(yield);
+
+    assertSize(yield, 4);
+    for (size_t i = 0; i < 4; ++i) {
+        uint8_t src = 0x20 + i;
+        const J1939Transfer* t = yield.messages()[i].j1939_transfer();
+        assertEqual(yield.messages()[i].type(), Message::J1939_TRANSFER);
+        assertEqual(t->source_address(), src);
+        assertEqual(t->pgn(), 0xFF00u | src);
+        assertEqual(t->size(), 10u);
+        assertEqual(t->bytes()[9], src);
+    }
+    assertEqual(node.transportStats().aborted, 1u);
+    assertEqual(can.writeCount(), 0);
+}
+
+test(J1939GatewayTest, TransferFullSessions) {
+    FakeClock clock;
+    FakeYield yield;
+    FakeConnection can(4, 4);
+    J1939Gateway node(&can, 0x10, false, &clock);
+    node.burst(16);
+
+    // Every session fits a full size payload without touching the shared
+    // arena.
+    size_t used = ScratchArena::shared()->used();
+    J1939Message msgs[4];
+    for (uint8_t i = 0; i < 4; ++i) {
+        msgs[i] = control(0x20 + i, 0xFF, 0x20, kScratchCapacity & 0xFF,
+                kScratchCapacity >> 8, (kScratchCapacity + 6) / 7, 0xFF00);
+    }
+    can.setReadBuffer(msgs);
+    node.emit(yield);
+
+    assertEqual(node.transportStats().aborted, 0u);
+    assertEqual(ScratchArena::shared()->used(), used);
+}
+
+test(J1939GatewayTest, TransferFiltered) {
+    FakeClock clock;
+    FakeYield yield;
+    FakeConnection can(1, 4);
+    J1939Gateway node(&can, 0x10, false, &clock);
+
+    // Sessions between other nodes are ignored.
+    can.setReadBuffer({control(0x20, 0x30, 0x10, 20, 0x00, 3, 0xEF00)});
+    node.emit(yield);
+    assertEqual(can.writeCount(), 0);
+    assertSize(yield, 0);
+}
+
 test(J1939GatewayTest, InitAnnounce) {
-    // Should emit an address claim with the preferred address on first emit.
+    // Should emit an address claim with the preferred address on first emit
+    // and request the addresses of other nodes.
     FakeYield yield;
     FakeConnection can(0, 3);
     uint8_t address = 0x0A;
@@ -173,11 +534,14 @@ test(J1939GatewayTest, InitAnnounce) {
     J1939Gateway node(&can, address, name, false);
 
     CAN20Frame expect_frame(0x18EEFF0A, 1, {0x00, 0x00, 0x13, 0xB0, 0x00, 0xFF, 0xFA, 0xC0});
+    J1939Message expect_request(0xEA00, address, 0xFF, 0x06);
+    expect_request.data({0x00, 0xEE, 0x00});
     J1939Claim expect_claim(address, name);
 
     node.init(yield);
-    assertEqual(can.writeCount(), 1);
+    assertEqual(can.writeCount(), 2);
     assertPrintablesEqual(can.writeData()[0], expect_frame);
+    assertPrintablesEqual(can.writeData()[1], expect_request);
     assertSize(yield, 1);
     assertIsJ1939Claim(yield.messages()[0], expect_claim);
 }
@@ -226,7 +590,7 @@ test(J1939GatewayTest, RequestAddressClaim) {
 
 test(J1939GatewayTest, NoArbitraryAddressCannotClaim) {
     FakeYield yield;
-    FakeConnection can(1, 1);
+    FakeConnection can(1, 2);
     uint8_t address = 0x0A;
     uint64_t name = 0x000013B000FFFAC0;
     J1939Gateway node(&can, address, name, false);
@@ -237,7 +601,7 @@ test(J1939GatewayTest, NoArbitraryAddressCannotClaim) {
     can.writeReset();
 
     // handle address claim with same address and higher priority name
-    J1939Message msg(0xEA00, address, 0xFF, 0x06);
+    J1939Message msg(0xEE00, address, 0xFF, 0x06);
     msg.data({0x00, 0x00, 0x0B, 0xB0, 0x00, 0xFF, 0xFA, 0xC0});
     can.setReadBuffer({msg});
     node.emit(yield);
@@ -245,17 +609,19 @@ test(J1939GatewayTest, NoArbitraryAddressCannotClaim) {
     // we should respond with a null address
     CAN20Frame expect_frame(0x18EEFFFE, 1, {0x00, 0x00, 0x13, 0xB0, 0x00, 0xFF, 0xFA, 0xC0});
     J1939Claim expect_claim(Canny::NullAddress, name);
+    J1939Address expect_address(address, msg.name());
 
     assertEqual(can.writeCount(), 1);
     assertPrintablesEqual(can.writeData()[0], expect_frame);
-    assertSize(yield, 2);
+    assertSize(yield, 3);
     assertIsJ1939Claim(yield.messages()[0], expect_claim);
-    assertIsJ1939Message(yield.messages()[1], msg);
+    assertIsJ1939Address(yield.messages()[1], expect_address);
+    assertIsJ1939Message(yield.messages()[2], msg);
 }
 
 test(J1939GatewayTest, ArbitraryAddressClaim) {
     FakeYield yield;
-    FakeConnection can(1, 1);
+    FakeConnection can(1, 2);
     uint8_t address = 0x0A;
     uint64_t name = 0x000013B000FFFAC1;
     J1939Gateway node(&can, address, name, false);
@@ -266,7 +632,7 @@ test(J1939GatewayTest, ArbitraryAddressClaim) {
     can.writeReset();
 
     // handle address claim with same address and higher priority name
-    J1939Message msg(0xEA00, address, 0xFF, 0x06);
+    J1939Message msg(0xEE00, address, 0xFF, 0x06);
     msg.data({0x00, 0x00, 0x0B, 0xB0, 0x00, 0xFF, 0xFA, 0xC0});
     can.setReadBuffer({msg});
     node.emit(yield);
@@ -274,17 +640,19 @@ test(J1939GatewayTest, ArbitraryAddressClaim) {
     // we should respond with the next address
     CAN20Frame expect_frame(0x18EEFF0B, 1, {0x00, 0x00, 0x13, 0xB0, 0x00, 0xFF, 0xFA, 0xC1});
     J1939Claim expect_claim(0x0B, name);
+    J1939Address expect_address(address, msg.name());
 
     assertEqual(can.writeCount(), 1);
     assertPrintablesEqual(can.writeData()[0], expect_frame);
-    assertSize(yield, 2);
+    assertSize(yield, 3);
     assertIsJ1939Claim(yield.messages()[0], expect_claim);
-    assertIsJ1939Message(yield.messages()[1], msg);
+    assertIsJ1939Address(yield.messages()[1], expect_address);
+    assertIsJ1939Message(yield.messages()[2], msg);
 }
 
 test(J1939GatewayTest, ArbitraryAddressCannotClaim) {
     FakeYield yield;
-    FakeConnection can(1, 1);
+    FakeConnection can(1, 2);
     uint8_t address = 0x0A;
     uint64_t name = 0x000013B000FFFAC1;
     J1939Gateway node(&can, address, name, false);
@@ -306,7 +674,7 @@ test(J1939GatewayTest, ArbitraryAddressCannotClaim) {
             }
         }
 
-        J1939Message msg(0xEA00, address, 0xFF, 0x06);
+        J1939Message msg(0xEE00, address, 0xFF, 0x06);
         msg.data({0x00, 0x00, 0x0B, 0xB0, 0x00, 0xFF, 0xFA, 0xC0});
         can.setReadBuffer({msg});
         node.emit(yield);
@@ -314,12 +682,14 @@ test(J1939GatewayTest, ArbitraryAddressCannotClaim) {
         // we should response with the next address
         CAN20Frame expect_frame(0x18EEFF00 | next, 1, {0x00, 0x00, 0x13, 0xB0, 0x00, 0xFF, 0xFA, 0xC1});
         J1939Claim expect_claim(next, name);
+        J1939Address expect_address(address, msg.name());
 
         assertEqual(can.writeCount(), 1);
         assertPrintablesEqual(can.writeData()[0], expect_frame);
-        assertSize(yield, 2);
+        assertSize(yield, 3);
         assertIsJ1939Claim(yield.messages()[0], expect_claim);
-        assertIsJ1939Message(yield.messages()[1], msg);
+        assertIsJ1939Address(yield.messages()[1], expect_address);
+        assertIsJ1939Message(yield.messages()[2], msg);
 
         yield.clear();
         can.writeReset();
@@ -328,6 +698,56 @@ test(J1939GatewayTest, ArbitraryAddressCannotClaim) {
     }
 }
 
+J1939Message claim(uint8_t address, uint64_t name) {
+    J1939Message msg(0xEE00, address, 0xFF, 0x06);
+    msg.name(name);
+    return msg;
+}
+
+test(J1939GatewayTest, AddressMap) {
+    FakeYield yield;
+    FakeConnection can(4, 4);
+    J1939Gateway node(&can, 0x0A, 0x000013B000FFFAC0, false);
+    node.init(yield);
+    yield.clear();
+
+    uint64_t stereo = 0x00A0340000E00001;
+    uint64_t keypad = 0x0000000000300002;
+    can.setReadBuffer({claim(0x20, stereo), claim(0x21, keypad), claim(0x20, stereo)});
+    node.burst(4);
+    node.emit(yield);
+
+    // Repeated claims do not change the map.
+    assertSize(yield, 5);
+    assertIsJ1939Address(yield.messages()[0], J1939Address(0x20, stereo));
+    assertIsJ1939Address(yield.messages()[2], J1939Address(0x21, keypad));
+    assertEqual(node.addresses().size(), 2u);
+    assertEqual(node.addresses().address(stereo), 0x20);
+    assertEqual(node.addresses().address(keypad), 0x21);
+    assertEqual(node.addresses().name(0x21), keypad);
+    yield.clear();
+
+    // The keypad takes the stereo's address. The stereo moves.
+    can.setReadBuffer({claim(0x20, keypad), claim(0x22, stereo)});
+    node.emit(yield);
+    assertSize(yield, 5);
+    assertIsJ1939Address(yield.messages()[0], J1939Address(Canny::NullAddress, stereo));
+    assertIsJ1939Address(yield.messages()[1], J1939Address(0x20, keypad));
+    assertIsJ1939Address(yield.messages()[3], J1939Address(0x22, stereo));
+    assertEqual(node.addresses().address(stereo), 0x22);
+    assertEqual(node.addresses().address(keypad), 0x20);
+    assertEqual(node.addresses().name(0x21), 0u);
+    yield.clear();
+
+    // The keypad cannot claim an address.
+    can.setReadBuffer({claim(Canny::NullAddress, keypad)});
+    node.emit(yield);
+    assertSize(yield, 2);
+    assertIsJ1939Address(yield.messages()[0], J1939Address(Canny::NullAddress, keypad));
+    assertEqual(node.addresses().address(keypad), Canny::NullAddress);
+    assertEqual(node.addresses().size(), 1u);
+}
+
 }  // namespace R51
 
 // Test boilerplate.
@@ -0,0 +1,151 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::J1939Message;
+
+J1939Message frame(uint8_t dest, uint8_t priority) {
+    return J1939Message(0xEF00, 0x10, dest, priority);
+}
+
+test(J1939TxQueueTest, Empty) {
+    J1939TxQueue queue;
+    assertTrue(queue.empty());
+    assertEqual(queue.size(), 0u);
+    assertTrue(queue.peek() == nullptr);
+
+    queue.pop();
+    assertEqual(queue.stats().sent, 0u);
+}
+
+test(J1939TxQueueTest, Order) {
+    J1939TxQueue queue;
+    assertTrue(queue.push(frame(0x01, 6), 100));
+    assertTrue(queue.push(frame(0x02, 3), 100));
+    assertTrue(queue.push(frame(0x03, 6), 100));
+    assertTrue(queue.push(frame(0x04, 3), 100));
+    assertTrue(queue.push(frame(0x05, 7), 100));
+    assertEqual(queue.size(), 5u);
+
+    // Frames are ordered by priority and then by age.
+    uint8_t expect[] = {0x02, 0x04, 0x01, 0x03, 0x05};
+    for (uint8_t dest : expect) {
+        assertFalse(queue.empty());
+        assertEqual(queue.peek()->dest_address(), dest);
+        queue.pop();
+    }
+    assertTrue(queue.empty());
+    assertEqual(queue.stats().queued, 5u);
+    assertEqual(queue.stats().sent, 5u);
+    assertEqual(queue.stats().peak, 5u);
+}
+
+test(J1939TxQueueTest, PopUnsent) {
+    J1939TxQueue queue;
+    queue.push(frame(0x01, 6), 100);
+    queue.pop(false);
+    assertTrue(queue.empty());
+    assertEqual(queue.stats().queued, 1u);
+    assertEqual(queue.stats().sent, 0u);
+}
+
+test(J1939TxQueueTest, ShedNew) {
+    J1939TxQueue queue;
+    for (size_t i = 0; i < J1939TxQueue::kCapacity; ++i) {
+        assertTrue(queue.push(frame(i, 3), 100));
+    }
+
+    // A frame no more urgent than the queue is shed.
+    J1939Message shed;
+    assertFalse(queue.push(frame(0x80, 3), 100, false, &shed));
+    assertEqual(shed.dest_address(), 0x80);
+    assertFalse(queue.push(frame(0x81, 6), 100, false, &shed));
+    assertEqual(shed.dest_address(), 0x81);
+    assertEqual(queue.size(), J1939TxQueue::kCapacity);
+    assertEqual(queue.stats().shed, 2u);
+    assertEqual(queue.peek()->dest_address(), 0x00);
+}
+
+test(J1939TxQueueTest, ShedQueued) {
+    J1939TxQueue queue;
+    for (size_t i = 0; i < J1939TxQueue::kCapacity; ++i) {
+        assertTrue(queue.push(frame(i, i < 8 ? 3 : 6), 100));
+    }
+
+    // A more urgent frame displaces the newest of the least urgent.
+    J1939Message shed;
+    assertFalse(queue.push(frame(0x80, 2), 100, false, &shed));
+    assertEqual(shed.dest_address(), J1939TxQueue::kCapacity - 1);
+    assertFalse(queue.push(frame(0x81, 3), 100, false, &shed));
+    assertEqual(shed.dest_address(), J1939TxQueue::kCapacity - 2);
+    assertEqual(queue.size(), J1939TxQueue::kCapacity);
+    assertEqual(queue.stats().shed, 2u);
+    assertEqual(queue.stats().peak, J1939TxQueue::kCapacity);
+
+    assertEqual(queue.peek()->dest_address(), 0x80);
+    queue.pop();
+    for (size_t i = 0; i < 8; ++i) {
+        queue.pop();
+    }
+    assertEqual(queue.peek()->dest_address(), 0x81);
+}
+
+test(J1939TxQueueTest, Coalesce) {
+    J1939TxQueue queue;
+    J1939Message m1 = frame(0x01, 6);
+    J1939Message m2 = frame(0x02, 6);
+    J1939Message m3 = frame(0x01, 6);
+    m3.data({0x01, 0x02});
+    queue.push(m1, 100, true);
+    queue.push(m2, 100, true);
+    assertTrue(queue.push(m3, 100, true));
+
+    // The new data replaces the queued frame in place.
+    assertEqual(queue.size(), 2u);
+    assertEqual(queue.stats().coalesced, 1u);
+    assertPrintablesEqual(*queue.peek(), m3);
+    assertEqual(queue.peek()->size(), 2);
+
+    // Frames are not coalesced unless asked.
+    queue.push(m1, 100);
+    assertEqual(queue.size(), 3u);
+}
+
+test(J1939TxQueueTest, Expire) {
+    J1939TxQueue queue;
+    queue.push(frame(0x01, 6), 100);
+    queue.push(frame(0x02, 3), 200);
+    queue.push(frame(0x03, 6), 150);
+
+    J1939Message expired;
+    assertFalse(queue.expire(100, &expired));
+    assertTrue(queue.expire(160, &expired));
+    assertEqual(expired.dest_address(), 0x01);
+    assertTrue(queue.expire(160, &expired));
+    assertEqual(expired.dest_address(), 0x03);
+    assertFalse(queue.expire(160, &expired));
+    assertEqual(queue.size(), 1u);
+    assertEqual(queue.peek()->dest_address(), 0x02);
+    assertEqual(queue.stats().expired, 2u);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
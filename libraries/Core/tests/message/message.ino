@@ -116,6 +116,39 @@ test(MessageValueTest, CopyJ1939ClaimView) {
     assertTrue(claim == *copy.j1939_claim());
 }
 
+test(MessageValueTest, CopyJ1939AddressView) {
+    J1939Address address(0x23, 1234);
+    MessageView msg(&address);
+    MessageValue copy(msg);
+
+    assertEqual(copy.type(), Message::J1939_ADDRESS);
+    assertTrue(msg == copy);
+    assertTrue(&address != copy.j1939_address());
+    assertTrue(address == *copy.j1939_address());
+}
+
+test(MessageValueTest, J1939Transfer) {
+    Scratch data;
+    J1939Transfer transfer(0xEF00, 0x10, 0x20, &data);
+    MessageValue msg(transfer);
+    assertEqual(msg.type(), Message::J1939_TRANSFER);
+    assertNotEqual(&transfer, msg.j1939_transfer());
+    assertEqual(&data, msg.j1939_transfer()->data());
+}
+
+test(MessageValueTest, CopyJ1939TransferView) {
+    Scratch data;
+    data.reserve(10);
+    data.size = 10;
+    J1939Transfer transfer(0xEF00, 0x10, 0x20, &data);
+    MessageView msg(&transfer);
+    MessageValue copy(msg);
+
+    assertTrue(msg == copy);
+    assertTrue(&transfer != copy.j1939_transfer());
+    assertTrue(transfer == *copy.j1939_transfer());
+}
+
 test(MessageValueTest, EmptyEquals) {
     MessageValue left;
     MessageValue right;
@@ -194,6 +227,23 @@ test(MessageViewTest, J1939Claim) {
     assertEqual(&claim, msg.j1939_claim());
 }
 
+test(MessageViewTest, J1939Address) {
+    J1939Address address(0x23, 1234);
+    MessageView msg(&address);
+    assertEqual(msg.type(), Message::J1939_ADDRESS);
+    assertEqual(&address, msg.j1939_address());
+    assertEqual(msg.j1939_claim(), nullptr);
+}
+
+test(MessageViewTest, J1939Transfer) {
+    J1939Transfer transfer(0xFF00, 0x10, 0x20, nullptr);
+    MessageView msg(&transfer);
+    assertEqual(msg.type(), Message::J1939_TRANSFER);
+    assertEqual(&transfer, msg.j1939_transfer());
+    // PDU2 transfers are always broadcast.
+    assertTrue(transfer.broadcast());
+}
+
 test(MessageViewTest, EmptyEquals) {
     MessageView left;
     MessageView right;
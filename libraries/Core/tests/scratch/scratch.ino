@@ -0,0 +1,115 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Core.h>
+
+namespace R51 {
+
+using namespace aunit;
+
+test(ScratchArenaTest, AllocateAndRelease) {
+    ScratchArena arena(64);
+    assertEqual(arena.capacity(), 64u);
+
+    uint8_t* a = arena.allocate(10);
+    uint8_t* b = arena.allocate(17);
+    assertTrue(a != nullptr);
+    assertTrue(b != nullptr);
+    assertEqual(arena.used(), 48u);
+    assertTrue(arena.allocate(32) == nullptr);
+    assertEqual(arena.failures(), 1u);
+
+    arena.release(a, 10);
+    assertEqual(arena.used(), 32u);
+    assertEqual(arena.peak(), 48u);
+    assertTrue(arena.allocate(16) == a);
+
+    arena.resetPeak();
+    assertEqual(arena.peak(), 48u);
+    assertEqual(arena.failures(), 0u);
+}
+
+test(ScratchArenaTest, ReallocateInPlace) {
+    ScratchArena arena(64);
+    uint8_t* a = arena.allocate(16);
+    a[0] = 0x12;
+    assertTrue(arena.reallocate(a, 16, 48) == a);
+    assertEqual(arena.used(), 48u);
+    assertEqual(a[0], 0x12);
+}
+
+test(ScratchArenaTest, ReallocateMoves) {
+    ScratchArena arena(96);
+    uint8_t* a = arena.allocate(16);
+    uint8_t* b = arena.allocate(16);
+    a[0] = 0x12;
+    uint8_t* moved = arena.reallocate(a, 16, 32);
+    assertTrue(moved != a);
+    assertEqual(moved[0], 0x12);
+    assertEqual(arena.used(), 48u);
+
+    // The freed block is reused.
+    assertTrue(arena.allocate(16) == a);
+    arena.release(b, 16);
+}
+
+test(ScratchTest, Reserve) {
+    ScratchArena arena(64);
+    Scratch scratch(&arena);
+    assertEqual(scratch.capacity(), 0u);
+    assertEqual(scratch.bytes[0], 0);
+
+    assertTrue(scratch.reserve(5));
+    assertEqual(scratch.capacity(), 16u);
+    memcpy(scratch.bytes, "test", 4);
+    scratch.size = 4;
+
+    assertTrue(scratch.reserve(20));
+    assertEqual(scratch.capacity(), 32u);
+    assertEqual(memcmp(scratch.bytes, "test", 5), 0);
+    assertEqual(arena.used(), 32u);
+
+    scratch.clear();
+    assertEqual(scratch.size, 0u);
+    assertEqual(scratch.bytes[0], 0);
+    assertEqual(arena.used(), 0u);
+    assertEqual(arena.peak(), 32u);
+}
+
+test(ScratchTest, Overflow) {
+    ScratchArena arena(kScratchCapacity * 2);
+    Scratch scratch(&arena);
+    assertFalse(scratch.reserve(kScratchCapacity + 1));
+    assertTrue(scratch.reserve(kScratchCapacity));
+
+    Scratch other(&arena);
+    assertTrue(other.reserve(kScratchCapacity));
+    Scratch full(&arena);
+    assertFalse(full.reserve(1));
+    assertEqual(arena.failures(), 1u);
+}
+
+test(ScratchTest, ReleaseOnDestroy) {
+    ScratchArena arena(64);
+    {
+        Scratch scratch(&arena);
+        assertTrue(scratch.reserve(16));
+        assertEqual(arena.used(), 16u);
+    }
+    assertEqual(arena.used(), 0u);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
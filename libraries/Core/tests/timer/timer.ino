@@ -0,0 +1,193 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Core.h>
+#include <Faker.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Faker::FakeClock;
+
+test(TimerTest, Unscheduled) {
+    FakeClock clock;
+    Timer timer(100, false, &clock);
+    assertFalse(timer.active());
+
+    clock.set(99);
+    assertFalse(timer.active());
+    clock.set(100);
+    assertTrue(timer.active());
+    clock.set(150);
+    assertTrue(timer.active());
+
+    timer.reset();
+    assertFalse(timer.active());
+    clock.set(250);
+    assertTrue(timer.active());
+
+    timer.pause();
+    assertFalse(timer.active());
+    timer.resume(50);
+    assertFalse(timer.active());
+    clock.set(300);
+    assertTrue(timer.active());
+}
+
+test(TimerTest, FireWhenDue) {
+    FakeClock clock;
+    TimerWheel wheel(4, &clock);
+    Timer timer(100, false, &clock);
+    wheel.add(&timer);
+    assertEqual(wheel.pending(), 1u);
+
+    clock.set(99);
+    wheel.advance();
+    assertFalse(timer.active());
+
+    clock.set(100);
+    wheel.advance();
+    assertTrue(timer.active());
+    assertEqual(wheel.pending(), 0u);
+
+    // Stays active until reset.
+    clock.set(110);
+    wheel.advance();
+    assertTrue(timer.active());
+    timer.reset();
+    assertFalse(timer.active());
+    assertEqual(wheel.pending(), 1u);
+
+    clock.set(209);
+    wheel.advance();
+    assertFalse(timer.active());
+    clock.set(210);
+    wheel.advance();
+    assertTrue(timer.active());
+}
+
+test(TimerTest, LongInterval) {
+    FakeClock clock;
+    TimerWheel wheel(4, &clock);
+    Timer timer(1000, false, &clock);
+    wheel.add(&timer);
+
+    // The deadline is several rounds of the wheel away.
+    for (uint32_t t = 4; t < 1000; t += 4) {
+        clock.set(t);
+        wheel.advance();
+        assertFalse(timer.active());
+    }
+    clock.set(1000);
+    wheel.advance();
+    assertTrue(timer.active());
+}
+
+test(TimerTest, SkippedSlots) {
+    FakeClock clock;
+    TimerWheel wheel(4, &clock);
+    Timer timer(10, false, &clock);
+    wheel.add(&timer);
+
+    // The wheel is not advanced in every slot.
+    clock.set(500);
+    wheel.advance();
+    assertTrue(timer.active());
+}
+
+test(TimerTest, PauseAndResume) {
+    FakeClock clock;
+    TimerWheel wheel(4, &clock);
+    Timer timer(100, true, &clock);
+    wheel.add(&timer);
+    assertEqual(wheel.pending(), 0u);
+
+    clock.set(200);
+    wheel.advance();
+    assertFalse(timer.active());
+
+    timer.resume(20);
+    assertEqual(wheel.pending(), 1u);
+    clock.set(220);
+    wheel.advance();
+    assertTrue(timer.active());
+
+    timer.reset();
+    timer.pause();
+    assertEqual(wheel.pending(), 0u);
+    clock.set(300);
+    wheel.advance();
+    assertFalse(timer.active());
+}
+
+test(TimerTest, ZeroInterval) {
+    FakeClock clock;
+    TimerWheel wheel(4, &clock);
+    Timer timer(0, false, &clock);
+    wheel.add(&timer);
+    assertTrue(timer.active());
+    timer.reset();
+    assertTrue(timer.active());
+}
+
+test(TimerTest, StaggerPhases) {
+    FakeClock clock;
+    TimerWheel wheel(4, &clock);
+    Timer timer0(100, false, &clock);
+    Timer timer1(100, false, &clock);
+    Timer timer2(100, false, &clock);
+    Timer* timers[] = {&timer0, &timer1, &timer2};
+    for (size_t i = 0; i < 3; ++i) {
+        wheel.add(timers[i]);
+    }
+
+    // Each timer fires one slot after the one added before it. Timers are
+    // reset as they fire.
+    for (size_t i = 0; i < 3; ++i) {
+        clock.set(100 + i * 4);
+        wheel.advance();
+        for (size_t j = 0; j < 3; ++j) {
+            assertEqual(timers[j]->active(), j == i);
+        }
+        timers[i]->reset();
+    }
+
+    // Phases are kept across periods.
+    clock.set(200);
+    wheel.advance();
+    assertTrue(timer0.active());
+    assertFalse(timer1.active());
+    clock.set(204);
+    wheel.advance();
+    assertTrue(timer1.active());
+    assertFalse(timer2.active());
+}
+
+test(TimerTest, DestroyScheduled) {
+    FakeClock clock;
+    TimerWheel wheel(4, &clock);
+    {
+        Timer timer(100, false, &clock);
+        wheel.add(&timer);
+        assertEqual(wheel.pending(), 1u);
+    }
+    assertEqual(wheel.pending(), 0u);
+    clock.set(100);
+    wheel.advance();
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
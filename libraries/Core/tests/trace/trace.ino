@@ -0,0 +1,178 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Faker.h>
+#include <Test.h>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::CAN20Frame;
+using ::Faker::FakeWriteStream;
+
+// Size of the dump header.
+static const size_t kHeaderSize = 16;
+
+// Size of a trace entry holding an event with two data bytes.
+static const size_t kEventEntrySize = 4 + 1 + 4;
+
+byte buffer[256];
+
+class FlagTrigger : public TraceTrigger {
+    public:
+        FlagTrigger() : flag(false) {}
+
+        bool triggered() override { return flag; }
+
+        bool flag;
+};
+
+void recordEvents(TraceNode* trace, uint8_t first, uint8_t count) {
+    FakeYield yield;
+    for (uint8_t i = first; i < first + count; ++i) {
+        Event event(0x01, 0x02, (uint8_t[]){i, 0x00});
+        trace->handle(MessageView(&event), yield);
+    }
+}
+
+// Dump the trace into buffer and return the number of bytes written.
+size_t dump(const TraceNode& trace) {
+    memset(buffer, 0, sizeof(buffer));
+    FakeWriteStream stream;
+    stream.set(buffer, sizeof(buffer));
+    return trace.dump(stream);
+}
+
+// Decode the nth entry of a dump in buffer.
+MessageValue entry(size_t n) {
+    const uint8_t* pos = buffer + kHeaderSize;
+    for (size_t i = 0; i < n; ++i) {
+        pos += 4 + messageRecordSize(pos[4]);
+    }
+    MessageValue msg;
+    decodeMessageRecord(pos + 4, &msg);
+    return msg;
+}
+
+test(TraceTest, RecordAndDump) {
+    FakeYield yield;
+    TraceNode trace(0x03, 128, nullptr);
+
+    Event event(0x01, 0x02, (uint8_t[]){0xAA});
+    CAN20Frame frame(0x123, false, {0x11, 0x22});
+    trace.handle(MessageView(&event), yield);
+    trace.handle(MessageView(&frame), yield);
+    assertEqual(trace.count(), 2u);
+    assertEqual(trace.size(), (4u + 4u) + (4u + 7u));
+    assertFalse(trace.frozen());
+
+    assertEqual(dump(trace), kHeaderSize + trace.size());
+    assertEqual(memcmp(buffer, "R51T", 4), 0);
+    assertEqual(buffer[4], TraceNode::kDumpVersion);
+    assertEqual(buffer[5], 0x03);
+    uint16_t count;
+    memcpy(&count, buffer + 6, sizeof(count));
+    assertEqual(count, 2);
+    uint32_t bytes;
+    memcpy(&bytes, buffer + 8, sizeof(bytes));
+    assertEqual(bytes, trace.size());
+
+    assertIsEvent(entry(0), event);
+    assertIsCANFrame(entry(1), frame);
+}
+
+test(TraceTest, OverwriteOldest) {
+    TraceNode trace(0x00, kEventEntrySize * 4 + 2, nullptr);
+    recordEvents(&trace, 0, 10);
+    assertEqual(trace.count(), 4u);
+    assertEqual(trace.dropped(), 6u);
+
+    // Entries wrap around the end of the ring and are dumped in order.
+    dump(trace);
+    for (uint8_t i = 0; i < 4; ++i) {
+        Event expect(0x01, 0x02, (uint8_t[]){(uint8_t)(6 + i), 0x00});
+        assertIsEvent(entry(i), expect);
+    }
+}
+
+test(TraceTest, TriggerOnEvent) {
+    FakeYield yield;
+    TraceNode trace(0x00, 128, nullptr, 2);
+    trace.triggerOn(0x05, 0x06);
+
+    recordEvents(&trace, 0, 2);
+    Event trigger(0x05, 0x06);
+    trace.handle(MessageView(&trigger), yield);
+    assertFalse(trace.frozen());
+
+    // Two more messages are recorded after the trigger.
+    recordEvents(&trace, 2, 4);
+    assertTrue(trace.frozen());
+    assertEqual(trace.count(), 5u);
+    dump(trace);
+    assertIsEvent(entry(2), trigger);
+    Event last(0x01, 0x02, (uint8_t[]){0x03, 0x00});
+    assertIsEvent(entry(4), last);
+}
+
+test(TraceTest, TriggerOnPoll) {
+    FakeYield yield;
+    FlagTrigger trigger;
+    TraceNode trace(0x00, 128, nullptr);
+    trace.triggerOn(&trigger);
+
+    recordEvents(&trace, 0, 2);
+    trace.emit(yield);
+    assertFalse(trace.frozen());
+
+    trigger.flag = true;
+    trace.emit(yield);
+    assertTrue(trace.frozen());
+    recordEvents(&trace, 2, 2);
+    assertEqual(trace.count(), 2u);
+}
+
+test(TraceTest, Commands) {
+    FakeYield yield;
+    FakeWriteStream stream;
+    stream.set(buffer, sizeof(buffer));
+    TraceNode trace(0x01, 128, &stream);
+    recordEvents(&trace, 0, 2);
+
+    // Commands for other traces are ignored.
+    TraceCommand freeze(TraceAction::FREEZE, 0x02);
+    trace.handle(MessageView(&freeze), yield);
+    assertFalse(trace.frozen());
+
+    freeze.trace(0xFF);
+    trace.handle(MessageView(&freeze), yield);
+    assertTrue(trace.frozen());
+    assertEqual(trace.count(), 4u);
+
+    TraceCommand dump(TraceAction::DUMP, 0x01);
+    trace.handle(MessageView(&dump), yield);
+    assertEqual(stream.remaining(), sizeof(buffer) - kHeaderSize - trace.size());
+
+    TraceCommand resume(TraceAction::RESUME, 0x01);
+    trace.handle(MessageView(&resume), yield);
+    assertFalse(trace.frozen());
+    assertEqual(trace.count(), 0u);
+    assertEqual(trace.size(), 0u);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
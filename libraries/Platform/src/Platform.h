@@ -1,12 +1,20 @@
 #ifndef _R51_PICO_H_
 #define _R51_PICO_H_
 
-#if !defined(PICO_RP2040) && !defined(ARDUINO_RASPBERRY_PI_PICO)
-#error "Platform not supported, must be RP2040."
-#endif
-
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
 #include <Platform/Config.h>
+#include <Platform/IRQConnection.h>
 #include <Platform/Pipe.h>
 #include <Platform/SyncWait.h>
+#elif defined(EPOXY_DUINO)
+// Host builds run each core on a thread so that the cross-core code can be
+// tested.
+#include <Platform/CoreThread.h>
+#include <Platform/IRQConnection.h>
+#include <Platform/Pipe.h>
+#include <Platform/SyncWait.h>
+#else
+#error "Platform not supported, must be RP2040."
+#endif
 
 #endif  // _R51_PICO_H_
@@ -1,3 +1,5 @@
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
+
 #include "Config.h"
 
 #include <Arduino.h>
@@ -65,3 +67,5 @@ void PlatformConfigStore::save() {
 }
 
 }  // namespace R51
+
+#endif  // defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
@@ -0,0 +1,38 @@
+#if defined(EPOXY_DUINO)
+
+#include "CoreThread.h"
+
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+
+namespace R51 {
+
+CoreThread::~CoreThread() {
+    stop();
+}
+
+void CoreThread::start() {
+    stop_.store(false);
+    thread_ = std::thread(&CoreThread::run, this);
+}
+
+void CoreThread::stop() {
+    stop_.store(true);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void CoreThread::run() {
+    if (setup_ != nullptr) {
+        setup_();
+    }
+    while (!stop_.load()) {
+        loop_();
+    }
+}
+
+}  // namespace R51
+
+#endif  // defined(EPOXY_DUINO)
@@ -0,0 +1,41 @@
+#ifndef _R51_PLATFORM_CORE_THREAD_H_
+#define _R51_PLATFORM_CORE_THREAD_H_
+
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+
+namespace R51 {
+
+// Runs the setup and loop functions of one RP2040 core on a host thread. Two
+// of these stand in for setup()/loop() and setup1()/loop1() so that Pipe and
+// SyncWait can be exercised with real concurrency off-device. Host builds
+// only.
+class CoreThread {
+    public:
+        // Construct a thread which calls setup once and then calls loop until
+        // stopped. setup may be nullptr.
+        CoreThread(void (*setup)(), void (*loop)()) :
+            setup_(setup), loop_(loop), stop_(false) {}
+
+        // Stop the thread if it is running.
+        ~CoreThread();
+
+        // Start the thread.
+        void start();
+
+        // Ask the thread to exit after its current loop and wait for it.
+        void stop();
+
+    private:
+        void (*setup_)();
+        void (*loop_)();
+        std::atomic<bool> stop_;
+        std::thread thread_;
+
+        void run();
+};
+
+}  // namespace R51
+
+#endif  // _R51_PLATFORM_CORE_THREAD_H_
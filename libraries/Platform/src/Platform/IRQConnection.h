@@ -0,0 +1,215 @@
+#ifndef _R51_PLATFORM_IRQ_CONNECTION_H_
+#define _R51_PLATFORM_IRQ_CONNECTION_H_
+
+#include <Arduino.h>
+#include <Canny.h>
+#include "PipeBuffer.h"
+
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
+extern "C" {
+    #include <hardware/sync.h>
+};
+#else
+#include <mutex>
+#endif
+
+namespace R51 {
+
+namespace internal {
+
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
+
+// Masks interrupts on the current core so that the main loop may access a
+// controller which is also drained by an interrupt handler.
+class IRQLock {
+    public:
+        void lock() { state_ = save_and_disable_interrupts(); }
+        void unlock() { restore_interrupts(state_); }
+
+    private:
+        uint32_t state_;
+};
+
+#else
+
+// Serializes the main loop against a host thread standing in for an
+// interrupt handler.
+class IRQLock {
+    public:
+        void lock() { mutex_.lock(); }
+        void unlock() { mutex_.unlock(); }
+
+    private:
+        std::mutex mutex_;
+};
+
+#endif
+
+}  // namespace internal
+
+// Connection which is filled from a CAN controller's interrupt handler. The
+// handler drains every frame held by the controller into a lock-free ring.
+// Reads are served from the ring so frames are not lost in the controller's
+// small hardware buffers while the main loop is busy. Writes go directly to
+// the controller with interrupts masked.
+//
+// The ring holds N frames. Frames drained while the ring is full are counted
+// and discarded. onInterrupt() must only be called from one interrupt handler
+// and read() from one core.
+template <typename T, size_t N>
+class IRQConnection : public Canny::Connection<T> {
+    public:
+        // Construct a connection which drains the given controller.
+        IRQConnection(Canny::Connection<T>* controller) :
+            controller_(controller), overruns_(0) {}
+
+        // Drain the controller into the ring. Call from the controller's
+        // interrupt handler.
+        void onInterrupt() {
+            lock_.lock();
+            size_t head = head_.load();
+            while (true) {
+                size_t next = (head + 1) % (N + 1);
+                if (next == tail_.load()) {
+                    // Read into scratch space so the controller releases the
+                    // frame and deasserts its interrupt.
+                    if (controller_->read(&overflow_) != Canny::ERR_OK) {
+                        break;
+                    }
+                    ++overruns_;
+                    continue;
+                }
+                if (controller_->read(&ring_[head]) != Canny::ERR_OK) {
+                    break;
+                }
+                head = next;
+                head_.store(head);
+            }
+            lock_.unlock();
+        }
+
+        // Read the oldest frame from the ring. Returns ERR_FIFO if the ring
+        // is empty.
+        Canny::Error read(T* frame) override {
+            size_t tail = tail_.load();
+            if (tail == head_.load()) {
+                return Canny::ERR_FIFO;
+            }
+            *frame = ring_[tail];
+            tail_.store((tail + 1) % (N + 1));
+            return Canny::ERR_OK;
+        }
+
+        // Write a frame to the controller.
+        Canny::Error write(const T& frame) override {
+            lock_.lock();
+            Canny::Error err = controller_->write(frame);
+            lock_.unlock();
+            return err;
+        }
+
+        // Return the number of frames in the ring.
+        size_t size() const {
+            return (head_.load() + N + 1 - tail_.load()) % (N + 1);
+        }
+
+        // Return the number of frames discarded because the ring was full.
+        size_t overruns() const { return overruns_; }
+
+    private:
+        Canny::Connection<T>* controller_;
+        internal::IRQLock lock_;
+        // One slot is left empty to tell a full ring from an empty one.
+        T ring_[N + 1];
+        T overflow_;
+        internal::SharedValue head_;
+        internal::SharedValue tail_;
+        volatile size_t overruns_;
+};
+
+#if defined(EPOXY_DUINO)
+
+// Stands in for a CAN controller with an interrupt line on the host. Frames
+// passed to receive() are held by the fake controller and raise its interrupt,
+// which drains them into the attached IRQConnection. Written frames are
+// counted and discarded. Host builds only.
+template <typename T, size_t N>
+class FakeIRQController : public Canny::Connection<T> {
+    public:
+        // Construct a controller with a hardware buffer of size frames.
+        FakeIRQController(size_t size = 2) :
+            irq_(nullptr), size_(size), count_(0), dropped_(0), writes_(0),
+            masked_(false) {}
+
+        // Attach the connection whose onInterrupt() is called on receive.
+        void attach(IRQConnection<T, N>* irq) { irq_ = irq; }
+
+        // Mask the interrupt so that received frames are held by the
+        // controller until unmasked.
+        void mask() { masked_ = true; }
+
+        // Unmask the interrupt and raise it if any frames are held.
+        void unmask() {
+            masked_ = false;
+            raise();
+        }
+
+        // Receive a frame from the bus. Returns false and drops the frame if
+        // the controller's buffer is full.
+        bool receive(const T& frame) {
+            if (count_ >= size_ || count_ >= kMaxSize) {
+                ++dropped_;
+                return false;
+            }
+            frames_[count_++] = frame;
+            raise();
+            return true;
+        }
+
+        // Return the number of frames dropped because the controller's
+        // buffer was full.
+        size_t dropped() const { return dropped_; }
+
+        // Return the number of frames written to the controller.
+        size_t writes() const { return writes_; }
+
+        Canny::Error read(T* frame) override {
+            if (count_ == 0) {
+                return Canny::ERR_FIFO;
+            }
+            *frame = frames_[0];
+            for (size_t i = 1; i < count_; ++i) {
+                frames_[i - 1] = frames_[i];
+            }
+            --count_;
+            return Canny::ERR_OK;
+        }
+
+        Canny::Error write(const T&) override {
+            ++writes_;
+            return Canny::ERR_OK;
+        }
+
+    private:
+        static const size_t kMaxSize = 8;
+
+        IRQConnection<T, N>* irq_;
+        T frames_[kMaxSize];
+        size_t size_;
+        size_t count_;
+        size_t dropped_;
+        size_t writes_;
+        bool masked_;
+
+        void raise() {
+            if (irq_ != nullptr && !masked_) {
+                irq_->onInterrupt();
+            }
+        }
+};
+
+#endif  // EPOXY_DUINO
+
+}  // namespace R51
+
+#endif  // _R51_PLATFORM_IRQ_CONNECTION_H_
@@ -1,47 +1,110 @@
 #include "Pipe.h"
 
 #include <Arduino.h>
-
-#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
-
 #include <Caster.h>
+#include <Canny.h>
 #include <Core.h>
-
-extern "C" {
-    #include <pico/util/queue.h>
-};
+#include "PipeBuffer.h"
 
 namespace R51 {
+namespace {
+
+// Return the number of messages of a queue's capacity reserved for control.
+size_t controlReserve(size_t capacity) {
+    return (capacity + Pipe::kControlReserveDivisor - 1) / Pipe::kControlReserveDivisor;
+}
+
+// Return the size in bytes of the control lane of a queue.
+size_t controlLaneSize(size_t capacity) {
+    return controlReserve(capacity) * sizeof(MessageValue);
+}
+
+// Return the size in bytes of the bulk lane of a queue. This is the
+// remainder of the queue's capacity but no less than one message.
+size_t bulkLaneSize(size_t capacity) {
+    size_t reserve = controlReserve(capacity);
+    return (capacity > reserve ? capacity - reserve : 1) * sizeof(MessageValue);
+}
+
+}  // namespace
 
 void PipeNode::handle(const Message& msg, const Caster::Yield<Message>&) {
     if (!filter(msg)) {
         return;
     }
-    MessageValue value(msg);
-    if (!queue_try_add(write_queue(), &value)) {
+    bool written;
+    if (classify(msg) == PipeLane::CONTROL) {
+        written = writeControl(msg);
+    } else {
+        written = write_buffer(PipeLane::BULK)->write(msg);
+    }
+    if (!written) {
         parent_->onBufferOverrun(msg);
     }
 }
 
+bool PipeNode::writeControl(const Message& msg) {
+    PipeBuffer* control = write_buffer(PipeLane::CONTROL);
+    PipeBuffer* bulk = write_buffer(PipeLane::BULK);
+
+    // Once a control message spills into the bulk lane the following ones
+    // spill too until it has been read so that they stay in order.
+    if (spilled_ && (ptrdiff_t)(bulk->reads() - spill_mark_) >= 0) {
+        spilled_ = false;
+    }
+    if (!spilled_ && control->tryWrite(msg)) {
+        return true;
+    }
+    if (bulk->tryWrite(msg)) {
+        spilled_ = true;
+        spill_mark_ = bulk->writes();
+        return true;
+    }
+    control->overrun();
+    return false;
+}
+
 void PipeNode::emit(const Caster::Yield<Message>& yield) {
+    write_buffer(PipeLane::CONTROL)->pollProducer();
+    write_buffer(PipeLane::BULK)->pollProducer();
+
+    PipeBuffer* control = read_buffer(PipeLane::CONTROL);
+    PipeBuffer* bulk = read_buffer(PipeLane::BULK);
+    control->pollConsumer();
+    bulk->pollConsumer();
     MessageValue msg;
-    if (queue_try_remove(read_queue(), &msg)) {
+    uint32_t start = micros();
+    size_t control_count = 0;
+    size_t bulk_count = 0;
+    while (control_count + bulk_count < parent_->drain_count_) {
+        if (control->read(&msg)) {
+            ++control_count;
+        } else if (bulk->read(&msg)) {
+            ++bulk_count;
+        } else {
+            break;
+        }
         yield(msg);
+        if (parent_->drain_us_ != 0 && micros() - start >= parent_->drain_us_) {
+            break;
+        }
     }
+    control->drained(control_count);
+    bulk->drained(bulk_count);
 }
 
-queue_t* PipeNode::read_queue() const {
+PipeBuffer* PipeNode::read_buffer(PipeLane lane) const {
     if (side_ <= 0) {
-        return &parent_->left_queue_;
+        return lane == PipeLane::CONTROL ? &parent_->left_control_ : &parent_->left_bulk_;
     }
-    return &parent_->right_queue_;
+    return lane == PipeLane::CONTROL ? &parent_->right_control_ : &parent_->right_bulk_;
 }
 
-queue_t* PipeNode::write_queue() const {
+PipeBuffer* PipeNode::write_buffer(PipeLane lane) const {
     if (side_ <= 0) {
-        return &parent_->right_queue_;
+        return lane == PipeLane::CONTROL ? &parent_->right_control_ : &parent_->right_bulk_;
     }
-    return &parent_->left_queue_;
+    return lane == PipeLane::CONTROL ? &parent_->left_control_ : &parent_->left_bulk_;
 }
 
 bool PipeNode::filter(const Message& msg) {
@@ -51,17 +114,88 @@ bool PipeNode::filter(const Message& msg) {
     return parent_->filterRight(msg);
 }
 
-Pipe::Pipe(size_t left_capacity, size_t right_capacity) :
-        left_node_(this, -1), right_node_(this, +1) {
-    queue_init(&left_queue_, sizeof(MessageValue), left_capacity);
-    queue_init(&right_queue_, sizeof(MessageValue), right_capacity);
+PipeLane PipeNode::classify(const Message& msg) {
+    if (side_ <= 0) {
+        return parent_->classifyLeft(msg);
+    }
+    return parent_->classifyRight(msg);
 }
 
-Pipe::~Pipe() {
-    queue_free(&left_queue_);
-    queue_free(&right_queue_);
+Pipe::Pipe(size_t left_capacity, size_t right_capacity,
+        size_t drain_count, uint32_t drain_us) :
+        left_control_(controlLaneSize(left_capacity)),
+        left_bulk_(bulkLaneSize(left_capacity)),
+        right_control_(controlLaneSize(right_capacity)),
+        right_bulk_(bulkLaneSize(right_capacity)),
+        left_node_(this, -1), right_node_(this, +1),
+        drain_count_(drain_count > 0 ? drain_count : 1), drain_us_(drain_us) {}
+
+PipeLane Pipe::classify(const Message& msg) {
+    switch (msg.type()) {
+        case Message::EVENT:
+            if (TxState::match(msg)) {
+                return PipeLane::CONTROL;
+            }
+            return msg.event()->id >= 0x10 ? PipeLane::CONTROL : PipeLane::BULK;
+        case Message::J1939_MESSAGE:
+            return msg.j1939_message()->broadcast() ? PipeLane::BULK : PipeLane::CONTROL;
+        default:
+            return PipeLane::BULK;
+    }
 }
 
-}  // namespace R51
+PipeStats Pipe::leftStats(PipeLane lane) const {
+    return lane == PipeLane::CONTROL ? left_control_.stats() : left_bulk_.stats();
+}
+
+PipeStats Pipe::rightStats(PipeLane lane) const {
+    return lane == PipeLane::CONTROL ? right_control_.stats() : right_bulk_.stats();
+}
+
+void Pipe::resetStats() {
+    left_control_.resetStats();
+    left_bulk_.resetStats();
+    right_control_.resetStats();
+    right_bulk_.resetStats();
+}
 
-#endif  // ARDUINO_ARCH_RP2040
+const char* Pipe::queueName(size_t queue) const {
+    switch (queue) {
+        case 0:
+            return "left_control";
+        case 1:
+            return "left_bulk";
+        case 2:
+            return "right_control";
+        case 3:
+            return "right_bulk";
+        default:
+            return nullptr;
+    }
+}
+
+QueueStats Pipe::queueStats(size_t queue) const {
+    switch (queue) {
+        case 0:
+            return left_control_.stats();
+        case 1:
+            return left_bulk_.stats();
+        case 2:
+            return right_control_.stats();
+        default:
+            return right_bulk_.stats();
+    }
+}
+
+bool PipeOverrunTrigger::triggered() {
+    size_t overruns = pipe_->leftStats(PipeLane::CONTROL).overruns +
+        pipe_->leftStats(PipeLane::BULK).overruns +
+        pipe_->rightStats(PipeLane::CONTROL).overruns +
+        pipe_->rightStats(PipeLane::BULK).overruns;
+    // The count drops when the pipe's stats are reset.
+    bool overrun = overruns > overruns_;
+    overruns_ = overruns;
+    return overrun;
+}
+
+}  // namespace R51
@@ -4,49 +4,87 @@
 #include <Arduino.h>
 #include <Caster.h>
 #include <Core.h>
-
-extern "C" {
-    #include <pico/util/queue.h>
-};
+#include "PipeBuffer.h"
 
 namespace R51 {
 
 class Pipe;
 
+// Priority lanes of a Pipe queue. Each lane has its own ring and the control
+// lane is always drained first. The two rings add up to the queue's capacity.
+enum class PipeLane : uint8_t {
+    CONTROL,    // High priority commands and other control traffic.
+    BULK,       // Low priority periodic state and bulk traffic.
+};
+
 // Caster node implementation for Pipe. Do not use this directly.
 class PipeNode : public Caster::Node<Message> {
     public:
-        PipeNode(Pipe* parent, int8_t side) : parent_(parent), side_(side) {}
+        PipeNode(Pipe* parent, int8_t side) : parent_(parent), side_(side),
+            spilled_(false), spill_mark_(0) {}
 
         // Send event to the write queue.
         void handle(const Message& msg, const Caster::Yield<Message>&) override;
 
-        // Emit the next message in the read queue.
+        // Emit messages from the read queue until it is empty or the parent's
+        // drain budget is spent.
         void emit(const Caster::Yield<Message>& yield) override;
     private:
         Pipe* parent_;
         int8_t side_;
+        bool spilled_;          // Control messages are spilling into bulk.
+        size_t spill_mark_;     // Bulk write count of the last spill.
 
-        queue_t* read_queue() const;
-        queue_t* write_queue() const;
+        PipeBuffer* read_buffer(PipeLane lane) const;
+        PipeBuffer* write_buffer(PipeLane lane) const;
+        bool writeControl(const Message& msg);
         bool filter(const Message& msg);
+        PipeLane classify(const Message& msg);
 };
 
 // Pipe allows two RP2040 cores to each run their own bus and communicate
 // over it via a shared queue. A Pipe object exposes two nodes that should
 // be added to the buses running on their respective cores.
 //
+// Messages are serialized into a PipeBuffer so that small messages take up
+// less space than a full MessageValue.
+//
 // Messages received when a queue is full are discarded. The queue sizes should
 // be carefully chosen to handle bursty writes to the bus. Filtering should be
 // used to mitigate this, only transmitting relevant events across the cores.
-class Pipe {
+//
+// Each node drains several messages from its queue per bus loop so that a
+// burst is absorbed quickly. The drain budget limits how long this may hold up
+// the other nodes on the bus.
+//
+// Each queue is split into a high priority control lane and a low priority
+// bulk lane. A quarter of the queue's capacity is reserved for the control
+// lane so that commands are not dropped while state broadcasts fill the bulk
+// lane. Control messages which don't fit in their lane borrow free space in
+// the bulk lane, in order behind the bulk messages queued before them. The
+// control lane is drained first.
+//
+// The stats of each lane are exposed to the console as a QueueStatsSource.
+class Pipe : public QueueStatsSource {
     public:
-        // Construct a Pipe node with the given queue capacities. The left
-        // and right nodes write to the left and right queues respectively.
-        Pipe(size_t left_capacity, size_t right_capacity);
+        // The default number of messages drained per loop.
+        static const size_t kDefaultDrainCount = 8;
 
-        // Destroy the object. Frees memory associated with the underlying queues.
-        ~Pipe();
+        // The portion of each queue's capacity reserved for the control lane
+        // is 1/kControlReserveDivisor.
+        static const size_t kControlReserveDivisor = 4;
+
+        // Construct a Pipe node with the given queue capacities. The left
+        // and right nodes read from the left and right queues respectively.
+        // Capacities are in full size messages. Each queue holds the space of
+        // that many MessageValue objects and typically holds several times as
+        // many serialized messages.
+        //
+        // Each node yields up to drain_count messages per loop. If drain_us
+        // is non-zero the node also stops once it has spent that many
+        // microseconds draining. At least one message is always drained.
+        Pipe(size_t left_capacity, size_t right_capacity,
+                size_t drain_count = kDefaultDrainCount, uint32_t drain_us = 0);
 
         // Return a pointer to the "left" node. Messages received by this node
         // are yielded to the "right" node's bus.
@@ -63,19 +101,73 @@ class Pipe {
         // Filter messages handled by the "right" node. Discard events for which false is returned.
         virtual bool filterRight(const Message&) { return true; }
 
+        // Select the lane for a message handled by the "left" node. Defaults
+        // to classify().
+        virtual PipeLane classifyLeft(const Message& msg) { return classify(msg); }
+
+        // Select the lane for a message handled by the "right" node. Defaults
+        // to classify().
+        virtual PipeLane classifyRight(const Message& msg) { return classify(msg); }
+
+        // Default lane selection. Command events (IDs 0x10 and up), transmit
+        // state events, and J1939 messages sent to a specific address take the
+        // control lane. Everything else takes the bulk lane.
+        static PipeLane classify(const Message& msg);
+
         // Called when a message must be discarded due to insufficient capacity.
         virtual void onBufferOverrun(const Message&) {}
 
+        // Return the stats of a lane of the queue read by the left node.
+        PipeStats leftStats(PipeLane lane) const;
+
+        // Return the stats of a lane of the queue read by the right node.
+        PipeStats rightStats(PipeLane lane) const;
+
+        // Clear the peak values and overrun counts of all queues. Each core
+        // clears the counters it owns the next time its node is emitted.
+        void resetStats();
+
+        // Return the number of lanes. Lanes are named for their reader and
+        // priority, e.g. "left_control".
+        size_t queueCount() const override { return 4; }
+
+        // Return the name of a lane.
+        const char* queueName(size_t queue) const override;
+
+        // Return the stats of a lane.
+        QueueStats queueStats(size_t queue) const override;
+
+        // Clear the peak values and overrun counts of all lanes.
+        void resetQueueStats() override { resetStats(); }
+
     private:
-        queue_t left_queue_;    // Left node produces to this queue.
-        queue_t right_queue_;   // Right node produces to this queue.
+        PipeBuffer left_control_;   // Left node consumes from these queues.
+        PipeBuffer left_bulk_;
+        PipeBuffer right_control_;  // Right node consumes from these queues.
+        PipeBuffer right_bulk_;
 
         PipeNode left_node_;
         PipeNode right_node_;
+        size_t drain_count_;
+        uint32_t drain_us_;
 
         friend class PipeNode;
 };
 
+// Triggers a TraceNode when any queue of a Pipe overruns. May be polled from
+// either core.
+class PipeOverrunTrigger : public TraceTrigger {
+    public:
+        PipeOverrunTrigger(const Pipe* pipe) : pipe_(pipe), overruns_(0) {}
+
+        // Return true if the pipe has overrun since the last call.
+        bool triggered() override;
+
+    private:
+        const Pipe* pipe_;
+        size_t overruns_;
+};
+
 }  // namespace R51
 
 #endif  // _R51_PICO_PIPE_H_
@@ -0,0 +1,160 @@
+#include "PipeBuffer.h"
+
+#include <Arduino.h>
+#include <Core.h>
+
+namespace R51 {
+
+PipeBuffer::PipeBuffer(size_t capacity) : size_(capacity + 1),
+        producer_resets_(0), consumer_resets_(0), data_arena_(kScratchCapacity), data_(&data_arena_) {
+    ring_ = new uint8_t[size_];
+}
+
+PipeBuffer::~PipeBuffer() {
+    delete[] ring_;
+}
+
+bool PipeBuffer::write(const Message& msg) {
+    if (!tryWrite(msg)) {
+        overrun();
+        return false;
+    }
+    return true;
+}
+
+void PipeBuffer::overrun() {
+    overruns_.store(overruns_.load() + 1);
+}
+
+bool PipeBuffer::tryWrite(const Message& msg) {
+    uint8_t record[kMaxRecordSize];
+    size_t record_size = encodeMessageRecord(msg, record);
+    size_t data_size = messageRecordDataSize(record);
+    size_t total = record_size + data_size;
+
+    size_t head = head_.load();
+    size_t tail = tail_.load();
+    size_t used = head >= tail ? head - tail : size_ - tail + head;
+    if (total > size_ - 1 - used) {
+        return false;
+    }
+    copyIn(head, record, record_size);
+    if (data_size > 0) {
+        copyIn(head + record_size, messageRecordData(msg), data_size);
+    }
+    head += total;
+    if (head >= size_) {
+        head -= size_;
+    }
+    head_.store(head);
+
+    size_t writes = writes_.load() + 1;
+    writes_.store(writes);
+    size_t depth = writes - reads_.load();
+    if (depth > peak_depth_.load()) {
+        peak_depth_.store(depth);
+    }
+    used += total;
+    if (used > peak_bytes_.load()) {
+        peak_bytes_.store(used);
+    }
+    return true;
+}
+
+bool PipeBuffer::read(MessageValue* msg) {
+    size_t tail = tail_.load();
+    if (tail == head_.load()) {
+        return false;
+    }
+    uint8_t record[kMaxRecordSize];
+    record[0] = ring_[tail];
+    size_t record_size = messageRecordSize(record[0]);
+    copyOut(tail + 1, record + 1, record_size - 1);
+    size_t data_size = messageRecordDataSize(record);
+    Scratch* data = nullptr;
+    if (data_.reserve(data_size)) {
+        copyOut(tail + record_size, data_.bytes, data_size);
+        data_.size = data_size;
+        data = &data_;
+    }
+    decodeMessageRecord(record, msg, data);
+    tail += record_size + data_size;
+    if (tail >= size_) {
+        tail -= size_;
+    }
+    tail_.store(tail);
+    reads_.store(reads_.load() + 1);
+    return true;
+}
+
+size_t PipeBuffer::size() const {
+    size_t head = head_.load();
+    size_t tail = tail_.load();
+    return head >= tail ? head - tail : size_ - tail + head;
+}
+
+void PipeBuffer::drained(size_t count) {
+    if (count > peak_drain_.load()) {
+        peak_drain_.store(count);
+    }
+}
+
+PipeStats PipeBuffer::stats() const {
+    PipeStats stats;
+    stats.depth = writes_.load() - reads_.load();
+    stats.peak_depth = peak_depth_.load();
+    stats.peak_bytes = peak_bytes_.load();
+    stats.overruns = overruns_.load();
+    stats.peak_drain = peak_drain_.load();
+    return stats;
+}
+
+void PipeBuffer::resetStats() {
+    resets_.store(resets_.load() + 1);
+}
+
+void PipeBuffer::pollProducer() {
+    size_t resets = resets_.load();
+    if (resets != producer_resets_) {
+        producer_resets_ = resets;
+        peak_depth_.store(0);
+        peak_bytes_.store(0);
+        overruns_.store(0);
+    }
+}
+
+void PipeBuffer::pollConsumer() {
+    size_t resets = resets_.load();
+    if (resets != consumer_resets_) {
+        consumer_resets_ = resets;
+        peak_drain_.store(0);
+    }
+}
+
+void PipeBuffer::copyIn(size_t pos, const uint8_t* src, size_t size) {
+    if (pos >= size_) {
+        pos -= size_;
+    }
+    size_t first = size_ - pos;
+    if (first >= size) {
+        memcpy(ring_ + pos, src, size);
+    } else {
+        memcpy(ring_ + pos, src, first);
+        memcpy(ring_, src + first, size - first);
+    }
+}
+
+void PipeBuffer::copyOut(size_t pos, uint8_t* dst, size_t size) const {
+    if (pos >= size_) {
+        pos -= size_;
+    }
+    size_t first = size_ - pos;
+    if (first >= size) {
+        memcpy(dst, ring_ + pos, size);
+    } else {
+        memcpy(dst, ring_ + pos, first);
+        memcpy(dst + first, ring_, size - first);
+    }
+}
+
+}  // namespace R51
@@ -0,0 +1,167 @@
+#ifndef _R51_PLATFORM_PIPE_BUFFER_H_
+#define _R51_PLATFORM_PIPE_BUFFER_H_
+
+#include <Arduino.h>
+#include <Core.h>
+
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
+extern "C" {
+    #include <hardware/sync.h>
+};
+#else
+#include <atomic>
+#endif
+
+namespace R51 {
+
+namespace internal {
+
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
+
+// Value written by one RP2040 core and read by the other. The cores are
+// in-order and the SRAM is uncached so a memory barrier on either side of the
+// access is enough to order it against the ring contents.
+class SharedValue {
+    public:
+        SharedValue() : value_(0) {}
+
+        // Load the value. Reads of the ring made after this observe writes
+        // made before the matching store().
+        size_t load() const {
+            size_t value = value_;
+            __dmb();
+            return value;
+        }
+
+        // Store the value after writing to the ring.
+        void store(size_t value) {
+            __dmb();
+            value_ = value;
+        }
+
+    private:
+        volatile size_t value_;
+};
+
+#else
+
+// Value written by one host thread and read by another.
+class SharedValue {
+    public:
+        SharedValue() : value_(0) {}
+
+        // Load the value. Reads of the ring made after this observe writes
+        // made before the matching store().
+        size_t load() const { return value_.load(std::memory_order_acquire); }
+
+        // Store the value after writing to the ring.
+        void store(size_t value) { value_.store(value, std::memory_order_release); }
+
+    private:
+        std::atomic<size_t> value_;
+};
+
+#endif
+
+}  // namespace internal
+
+// Queue depth stats for one lane of a Pipe.
+typedef QueueStats PipeStats;
+
+// Byte ring which holds messages in a compact serialized form. See
+// MessageRecord.h for the record format. Trailing 0xFF event data bytes and
+// unused frame data bytes are not stored.
+//
+// The payload of a J1939 transfer and the contents of an event's scratch are
+// copied into the ring after the record. The reader copies them back out into
+// a scratch owned by the buffer. A message therefore never references the
+// writer's scratch, which may be reused or may lease from an arena that
+// belongs to the other core. A read message's payload is valid until the next
+// call to read().
+//
+// The buffer is safe for one producer and one consumer running concurrently,
+// e.g. one on each core. It does not lock. Each stats counter is written only
+// by its owning side, including when the stats are reset.
+class PipeBuffer {
+    public:
+        // The largest possible record.
+        static const size_t kMaxRecordSize = kMaxMessageRecordSize;
+
+        // Construct a buffer which holds up to capacity bytes of records.
+        PipeBuffer(size_t capacity);
+
+        // Destroy the object. Frees the ring.
+        ~PipeBuffer();
+
+        // Append a message to the buffer. Return false and count an overrun
+        // if there is not enough free space for it.
+        bool write(const Message& msg);
+
+        // Append a message to the buffer. Return false if there is not enough
+        // free space for it. Does not count an overrun.
+        bool tryWrite(const Message& msg);
+
+        // Count a message which the producer had to discard.
+        void overrun();
+
+        // Remove the next message from the buffer and decode it into msg.
+        // Return false if the buffer is empty.
+        bool read(MessageValue* msg);
+
+        // Return the number of bytes in use.
+        size_t size() const;
+
+        // Return the number of bytes the buffer can hold.
+        size_t capacity() const { return size_ - 1; }
+
+        // Return the number of messages written and read. These only
+        // increase, wrapping at SIZE_MAX.
+        size_t writes() const { return writes_.load(); }
+        size_t reads() const { return reads_.load(); }
+
+        // Record the number of messages the consumer removed in one pass.
+        void drained(size_t count);
+
+        // Return a snapshot of the buffer's stats.
+        PipeStats stats() const;
+
+        // Ask for the peak values and overrun count to be cleared. Each side
+        // clears its own counters on its next poll. May be called from any
+        // core but all requests must come from the same core.
+        void resetStats();
+
+        // Apply a requested reset to the producer's counters. Called by the
+        // producer each loop.
+        void pollProducer();
+
+        // Apply a requested reset to the consumer's counters. Called by the
+        // consumer each loop.
+        void pollConsumer();
+
+    private:
+        uint8_t* ring_;
+        size_t size_;               // One more than capacity.
+        internal::SharedValue head_;        // Written by the producer.
+        internal::SharedValue tail_;        // Written by the consumer.
+        internal::SharedValue writes_;      // Written by the producer.
+        internal::SharedValue reads_;       // Written by the consumer.
+        internal::SharedValue peak_depth_;  // Written by the producer.
+        internal::SharedValue peak_bytes_;  // Written by the producer.
+        internal::SharedValue overruns_;    // Written by the producer.
+        internal::SharedValue peak_drain_;  // Written by the consumer.
+        internal::SharedValue resets_;      // Written by resetStats().
+        size_t producer_resets_;            // Used only by the producer.
+        size_t consumer_resets_;            // Used only by the consumer.
+
+        // Holds the payload of the last transfer or event read. Used only by
+        // the consumer so it has its own arena.
+        ScratchArena data_arena_;
+        Scratch data_;
+
+        void copyIn(size_t pos, const uint8_t* src, size_t size);
+        void copyOut(size_t pos, uint8_t* dst, size_t size) const;
+};
+
+}  // namespace R51
+
+#endif  // _R51_PLATFORM_PIPE_BUFFER_H_
@@ -2,12 +2,19 @@
 
 #include <Arduino.h>
 
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
 extern "C" {
     #include <hardware/sync.h>
 };
+#else
+#include <atomic>
+#include <thread>
+#endif
 
 namespace R51 {
 
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
+
 SyncWait::SyncWait() : tickets_(2) {
     lock_ = spin_lock_instance(next_striped_spin_lock_num());
 }
@@ -29,4 +36,18 @@ void SyncWait::wait() {
     }
 }
 
+#else
+
+SyncWait::SyncWait() : tickets_(2) {}
+
+void SyncWait::wait() {
+    uint8_t tickets = tickets_.load();
+    while (tickets > 0 && !tickets_.compare_exchange_weak(tickets, tickets - 1)) {}
+    while (tickets_.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+#endif
+
 }  // namespace R51
@@ -3,16 +3,20 @@
 
 #include <Arduino.h>
 
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
 extern "C" {
     #include <hardware/sync.h>
 };
+#else
+#include <atomic>
+#endif
 
 namespace R51 {
 
 // A class which waits for all cores on a RP2040 to reach a point in execution
 // before allowing them all to continue executing. This is used primarily to
 // allow setup() and setup1() to complete before allowing the two loop
-// functions to begin.
+// functions to begin. On the host the two cores are threads.
 class SyncWait  {
     public:
         // Construct a new SyncWait.
@@ -22,8 +26,12 @@ class SyncWait  {
         // wait() will not block.
         void wait();
     private:
+#if defined(PICO_RP2040) || defined(ARDUINO_RASPBERRY_PI_PICO)
         uint8_t tickets_;
         spin_lock_t* lock_;
+#else
+        std::atomic<uint8_t> tickets_;
+#endif
 };
 
 }  // namespace R51
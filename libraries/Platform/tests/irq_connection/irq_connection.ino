@@ -0,0 +1,181 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Canny.h>
+#include <Core.h>
+#include <Platform.h>
+#include <Test.h>
+#include <thread>
+
+namespace R51 {
+
+using namespace aunit;
+using ::Canny::CAN20Frame;
+
+CAN20Frame frame(uint32_t id) {
+    CAN20Frame f(id, 0, {(uint8_t)id, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    return f;
+}
+
+test(IRQConnectionTest, ReadInOrder) {
+    FakeIRQController<CAN20Frame, 4> controller;
+    IRQConnection<CAN20Frame, 4> conn(&controller);
+    controller.attach(&conn);
+
+    CAN20Frame f;
+    assertEqual(conn.read(&f), Canny::ERR_FIFO);
+
+    for (uint32_t id = 1; id <= 3; ++id) {
+        assertTrue(controller.receive(frame(id)));
+    }
+    assertEqual(conn.size(), 3u);
+
+    for (uint32_t id = 1; id <= 3; ++id) {
+        assertEqual(conn.read(&f), Canny::ERR_OK);
+        assertTrue(f == frame(id));
+    }
+    assertEqual(conn.read(&f), Canny::ERR_FIFO);
+    assertEqual(conn.size(), 0u);
+    assertEqual(controller.dropped(), 0u);
+}
+
+test(IRQConnectionTest, DrainOnInterrupt) {
+    FakeIRQController<CAN20Frame, 8> controller(2);
+    IRQConnection<CAN20Frame, 8> conn(&controller);
+
+    // Without the interrupt the controller's buffer overflows when the loop
+    // does not read in time.
+    for (uint32_t id = 1; id <= 4; ++id) {
+        controller.receive(frame(id));
+    }
+    assertEqual(controller.dropped(), 2u);
+
+    CAN20Frame f;
+    while (controller.read(&f) == Canny::ERR_OK) {}
+
+    // With the interrupt each frame is moved into the ring as it arrives.
+    controller.attach(&conn);
+    for (uint32_t id = 1; id <= 4; ++id) {
+        assertTrue(controller.receive(frame(id)));
+    }
+    assertEqual(controller.dropped(), 2u);
+    assertEqual(conn.size(), 4u);
+}
+
+test(IRQConnectionTest, MaskedFramesHeld) {
+    FakeIRQController<CAN20Frame, 4> controller(2);
+    IRQConnection<CAN20Frame, 4> conn(&controller);
+    controller.attach(&conn);
+
+    controller.mask();
+    controller.receive(frame(1));
+    controller.receive(frame(2));
+    assertEqual(conn.size(), 0u);
+
+    controller.unmask();
+    assertEqual(conn.size(), 2u);
+
+    CAN20Frame f;
+    assertEqual(conn.read(&f), Canny::ERR_OK);
+    assertTrue(f == frame(1));
+    assertEqual(conn.read(&f), Canny::ERR_OK);
+    assertTrue(f == frame(2));
+}
+
+test(IRQConnectionTest, Overrun) {
+    FakeIRQController<CAN20Frame, 2> controller;
+    IRQConnection<CAN20Frame, 2> conn(&controller);
+    controller.attach(&conn);
+
+    for (uint32_t id = 1; id <= 4; ++id) {
+        assertTrue(controller.receive(frame(id)));
+    }
+    assertEqual(conn.size(), 2u);
+    assertEqual(conn.overruns(), 2u);
+
+    // The oldest frames are kept.
+    CAN20Frame f;
+    assertEqual(conn.read(&f), Canny::ERR_OK);
+    assertTrue(f == frame(1));
+    assertEqual(conn.read(&f), Canny::ERR_OK);
+    assertTrue(f == frame(2));
+    assertEqual(conn.read(&f), Canny::ERR_FIFO);
+
+    // The ring wraps once drained.
+    for (uint32_t id = 5; id <= 6; ++id) {
+        assertTrue(controller.receive(frame(id)));
+    }
+    assertEqual(conn.overruns(), 2u);
+    assertEqual(conn.read(&f), Canny::ERR_OK);
+    assertTrue(f == frame(5));
+    assertEqual(conn.read(&f), Canny::ERR_OK);
+    assertTrue(f == frame(6));
+}
+
+test(IRQConnectionTest, Write) {
+    FakeIRQController<CAN20Frame, 4> controller;
+    IRQConnection<CAN20Frame, 4> conn(&controller);
+    controller.attach(&conn);
+
+    assertEqual(conn.write(frame(1)), Canny::ERR_OK);
+    assertEqual(controller.writes(), 1u);
+    assertEqual(conn.size(), 0u);
+}
+
+test(IRQConnectionTest, GatewayReadsRing) {
+    FakeIRQController<CAN20Frame, 4> controller;
+    IRQConnection<CAN20Frame, 4> conn(&controller);
+    controller.attach(&conn);
+    CANGateway gw(&conn);
+    FakeYield yield;
+
+    controller.receive(frame(0x100));
+    gw.emit(yield);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame(0x100));
+}
+
+// Frames raised from another thread are all read in order.
+test(IRQConnectionTest, Threaded) {
+    static const uint32_t count = 2000;
+    FakeIRQController<CAN20Frame, 16> controller;
+    IRQConnection<CAN20Frame, 16> conn(&controller);
+    controller.attach(&conn);
+
+    std::thread irq([&controller, &conn]() {
+        uint32_t id = 0;
+        while (id < count) {
+            if (conn.size() < 16) {
+                controller.receive(frame(id++));
+            }
+        }
+    });
+
+    CAN20Frame f;
+    uint32_t next = 0;
+    bool ordered = true;
+    while (next < count) {
+        if (conn.read(&f) == Canny::ERR_OK) {
+            ordered = ordered && f.id() == next;
+            ++next;
+        }
+    }
+    irq.join();
+    assertTrue(ordered);
+    assertEqual(conn.overruns(), 0u);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
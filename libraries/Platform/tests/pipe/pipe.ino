@@ -8,6 +8,8 @@
 namespace R51 {
 
 using namespace aunit;
+using ::Canny::CAN20Frame;
+using ::Canny::J1939Message;
 using ::Caster::Bus;
 using ::Caster::Node;
 using ::Caster::Yield;
@@ -130,13 +132,7 @@ test(PipeTest, FilterRight) {
 }
 
 test(PipeTest, Overrun) {
-    Event event1(0x01, 0x01);
-    MessageView msg1(&event1);
-    Event event2(0x01, 0x02);
-    MessageView msg2(&event2);
-    Event event3(0x01, 0x03);
-    MessageView msg3(&event3);
-    FakeNode<2> fake;
+    FakeNode<64> fake;
 
     PipeTestImpl smp(1, 1);
     Node<Message>* left_nodes[] = {smp.left()};
@@ -144,16 +140,349 @@ test(PipeTest, Overrun) {
     Node<Message>* right_nodes[] = {smp.right(), &fake};
     Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
 
-    left_bus.emit(msg1);
-    left_bus.emit(msg2);
-    left_bus.emit(msg3);
+    // A queue with a capacity of one full size message holds several small
+    // events.
+    uint8_t sent = 0;
+    while (smp.overruns == 0 && sent < 64) {
+        Event event(0x01, 0x01, (uint8_t[]){sent});
+        left_bus.emit(MessageView(&event));
+        ++sent;
+    }
+    for (uint8_t i = 0; i < sent; ++i) {
+        right_bus.loop();
+    }
+
+    assertEqual(smp.overruns, 1);
+    assertMore((int)fake.size, 1);
+    assertEqual((int)fake.size, sent - 1);
+    for (size_t i = 0; i < fake.size; ++i) {
+        Event expect(0x01, 0x01, (uint8_t[]){(uint8_t)i});
+        assertIsEvent(fake.messages[i], expect);
+    }
+}
+
+test(PipeTest, TransferAllTypes) {
+    Scratch scratch;
+    Event event1(0x01, 0x02);
+    Event event2(0x01, 0x03, (uint8_t[]){0x01, 0xFF, 0x03});
+    Event event3(0x01, 0x04);
+    event3.scratch = &scratch;
+    CAN20Frame frame1(0x123, 0, (uint8_t[]){0x01, 0x02});
+    CAN20Frame frame2(0x1ABCDEF0, 1, 8, 0x55);
+    J1939Claim claim(0x1A, 0x1234567890ABCDEF);
+    J1939Message j1939(0x1FF04, 0x0A, 0xFF, 3);
+    j1939.data((uint8_t[]){0x01, 0x02, 0x03});
+    J1939Transfer transfer(0xEF00, 0x0A, 0x1B, &scratch);
+    J1939Address address(0x2B, 0x0000000000300002);
+    MessageView msgs[] = {
+        MessageView(&event1), MessageView(&event2), MessageView(&event3),
+        MessageView(&frame1), MessageView(&frame2), MessageView(&claim),
+        MessageView(&j1939), MessageView(&transfer), MessageView(&address),
+        MessageView(),
+    };
+    const size_t count = sizeof(msgs)/sizeof(msgs[0]);
+    FakeNode<count> fake;
+
+    Pipe smp(count, count);
+    Node<Message>* left_nodes[] = {smp.left()};
+    Caster::Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+    Node<Message>* right_nodes[] = {smp.right(), &fake};
+    Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+    for (size_t i = 0; i < count; ++i) {
+        left_bus.emit(msgs[i]);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        right_bus.loop();
+    }
+
+    assertEqual(fake.size, count);
+    assertIsEvent(fake.messages[0], event1);
+    assertIsEvent(fake.messages[1], event2);
+    assertIsEvent(fake.messages[2], event3);
+    assertTrue(fake.messages[2].event()->scratch != nullptr);
+    assertTrue(fake.messages[2].event()->scratch != &scratch);
+    assertIsCANFrame(fake.messages[3], frame1);
+    assertIsCANFrame(fake.messages[4], frame2);
+    assertIsJ1939Claim(fake.messages[5], claim);
+    assertIsJ1939Message(fake.messages[6], j1939);
+    assertIsJ1939Transfer(fake.messages[7], transfer);
+    assertIsJ1939Address(fake.messages[8], address);
+    assertEqual(fake.messages[9].type(), Message::EMPTY);
+}
+
+test(PipeTest, TransferPayloadCopied) {
+    Scratch scratch;
+    scratch.reserve(20);
+    for (size_t i = 0; i < 20; ++i) {
+        scratch.bytes[i] = i;
+    }
+    scratch.size = 20;
+    J1939Transfer transfer(0xEF00, 0x0A, 0x1B, &scratch);
+    J1939Transfer expect(0xEF00, 0x0A, 0x1B, &scratch);
+    FakeNode<2> fake;
+
+    Pipe smp(4, 4);
+    Node<Message>* left_nodes[] = {smp.left()};
+    Caster::Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+    Node<Message>* right_nodes[] = {smp.right(), &fake};
+    Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+    left_bus.emit(MessageView(&transfer));
+
+    // The sender may reuse its scratch once the transfer is queued.
+    Scratch copy;
+    copy.reserve(20);
+    memcpy(copy.bytes, scratch.bytes, 20);
+    copy.size = 20;
+    expect.data(&copy);
+    scratch.bytes[0] = 0xFF;
+    scratch.clear();
+
+    right_bus.loop();
+    assertEqual((int)fake.size, 1);
+    assertIsJ1939Transfer(fake.messages[0], expect);
+    assertTrue(fake.messages[0].j1939_transfer()->data() != &scratch);
+}
+
+test(PipeTest, EventScratchCopied) {
+    Scratch scratch;
+    scratch.reserve(20);
+    memcpy(scratch.bytes, "scratch contents", 17);
+    scratch.size = 17;
+    Event event(0x01, 0x04);
+    event.scratch = &scratch;
+    FakeNode<2> fake;
+
+    Pipe smp(4, 4);
+    Node<Message>* left_nodes[] = {smp.left()};
+    Caster::Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+    Node<Message>* right_nodes[] = {smp.right(), &fake};
+    Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+    left_bus.emit(MessageView(&event));
+
+    // The sender may reuse its scratch once the event is queued.
+    memcpy(scratch.bytes, "overwritten", 12);
+    scratch.clear();
+
+    right_bus.loop();
+    assertEqual((int)fake.size, 1);
+    assertEqual(fake.messages[0].type(), Message::EVENT);
+    const Scratch* copy = fake.messages[0].event()->scratch;
+    assertTrue(copy != nullptr);
+    assertTrue(copy != &scratch);
+    assertEqual(copy->size, 17u);
+    assertEqual(memcmp(copy->bytes, "scratch contents", 17), 0);
+}
+
+// Node which takes at least a few microseconds to handle each message.
+class SlowNode : public FakeNode<8> {
+    public:
+        void handle(const Message& msg, const Yield<Message>& yield) override {
+            uint32_t start = micros();
+            while (micros() - start < 3) {}
+            FakeNode<8>::handle(msg, yield);
+        }
+};
+
+test(PipeTest, DrainCount) {
+    FakeNode<16> fake;
+
+    Pipe smp(4, 4, 4);
+    Node<Message>* left_nodes[] = {smp.left()};
+    Caster::Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+    Node<Message>* right_nodes[] = {smp.right(), &fake};
+    Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+    for (uint8_t i = 0; i < 10; ++i) {
+        Event event(0x01, i);
+        left_bus.emit(MessageView(&event));
+    }
+    assertEqual(smp.rightStats(PipeLane::BULK).depth, 10u);
+
     right_bus.loop();
+    assertEqual((int)fake.size, 4);
     right_bus.loop();
+    assertEqual((int)fake.size, 8);
     right_bus.loop();
+    assertEqual((int)fake.size, 10);
+
+    PipeStats stats = smp.rightStats(PipeLane::BULK);
+    assertEqual(stats.depth, 0u);
+    assertEqual(stats.peak_depth, 10u);
+    assertEqual(stats.peak_bytes, 30u);
+    assertEqual(stats.overruns, 0u);
+    assertEqual(stats.peak_drain, 4u);
+
+    // Each side clears the counters it owns on its next loop.
+    smp.resetStats();
+    stats = smp.rightStats(PipeLane::BULK);
+    assertEqual(stats.peak_depth, 10u);
+    assertEqual(stats.peak_drain, 4u);
+    right_bus.loop();
+    stats = smp.rightStats(PipeLane::BULK);
+    assertEqual(stats.peak_depth, 10u);
+    assertEqual(stats.peak_drain, 0u);
+    left_bus.loop();
+    stats = smp.rightStats(PipeLane::BULK);
+    assertEqual(stats.peak_depth, 0u);
+    assertEqual(stats.peak_drain, 0u);
+
+    // The lanes are exposed as queue stats.
+    assertEqual(smp.queueCount(), 4u);
+    assertEqual(strcmp(smp.queueName(3), "right_bulk"), 0);
+    assertEqual(smp.queueStats(3).peak_bytes, 0u);
+}
 
-    assertEqual((int)fake.size, 1);
-    assertPrintablesEqual(fake.messages[0], msg1);
-    assertEqual(smp.overruns, 2);
+test(PipeTest, DrainTime) {
+    SlowNode slow;
+
+    Pipe smp(4, 4, 8, 1);
+    Node<Message>* left_nodes[] = {smp.left()};
+    Caster::Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+    Node<Message>* right_nodes[] = {smp.right(), &slow};
+    Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+    for (uint8_t i = 0; i < 3; ++i) {
+        Event event(0x01, i);
+        left_bus.emit(MessageView(&event));
+    }
+
+    right_bus.loop();
+    assertEqual((int)slow.size, 1);
+    right_bus.loop();
+    assertEqual((int)slow.size, 2);
+    assertEqual(smp.rightStats(PipeLane::BULK).peak_drain, 1u);
+}
+
+test(PipeTest, ControlLaneFirst) {
+    Event state(0x01, 0x01);
+    Event command(0x01, 0x11);
+    FakeNode<2> fake;
+
+    Pipe smp(4, 4);
+    Node<Message>* left_nodes[] = {smp.left()};
+    Caster::Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+    Node<Message>* right_nodes[] = {smp.right(), &fake};
+    Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+    left_bus.emit(MessageView(&state));
+    left_bus.emit(MessageView(&command));
+    right_bus.loop();
+
+    assertEqual((int)fake.size, 2);
+    assertIsEvent(fake.messages[0], command);
+    assertIsEvent(fake.messages[1], state);
+}
+
+test(PipeTest, ShedBulkLane) {
+    FakeNode<64> fake;
+
+    PipeTestImpl smp(4, 4);
+    Node<Message>* left_nodes[] = {smp.left()};
+    Caster::Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+    Node<Message>* right_nodes[] = {smp.right(), &fake};
+    Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+    // Saturate the bulk lane with state frames.
+    CAN20Frame frame(0x54A, 0, 8);
+    while (smp.overruns == 0) {
+        left_bus.emit(MessageView(&frame));
+    }
+
+    // Commands still make it across.
+    J1939Message command(0xEF00, 0x0A, 0x1B);
+    left_bus.emit(MessageView(&command));
+    assertEqual(smp.overruns, 1);
+    assertEqual(smp.rightStats(PipeLane::CONTROL).depth, 1u);
+    assertEqual(smp.rightStats(PipeLane::BULK).overruns, 1u);
+
+    right_bus.loop();
+    assertIsJ1939Message(fake.messages[0], command);
+}
+
+test(PipeTest, ControlBorrowsBulk) {
+    FakeNode<64> fake;
+
+    PipeTestImpl smp(4, 4);
+    Node<Message>* left_nodes[] = {smp.left()};
+    Caster::Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+    Node<Message>* right_nodes[] = {smp.right(), &fake};
+    Caster::Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+    // Commands which don't fit in the control lane borrow free space in the
+    // bulk lane until the queue's capacity is used up.
+    J1939Message commands[64];
+    size_t count = 0;
+    while (count < 64) {
+        commands[count] = J1939Message(0xEF00, 0x0A, count);
+        left_bus.emit(MessageView(&commands[count]));
+        if (smp.overruns > 0) {
+            break;
+        }
+        ++count;
+    }
+    PipeStats control = smp.rightStats(PipeLane::CONTROL);
+    PipeStats bulk = smp.rightStats(PipeLane::BULK);
+    assertEqual(control.overruns, 1u);
+    assertEqual(bulk.overruns, 0u);
+    assertMore(bulk.depth, 0u);
+    assertLessOrEqual(control.peak_bytes, sizeof(MessageValue));
+    assertLessOrEqual(control.peak_bytes + bulk.peak_bytes, 4 * sizeof(MessageValue));
+
+    // Commands arrive in the order they were sent.
+    while (fake.size < count) {
+        size_t size = fake.size;
+        right_bus.loop();
+        assertMore(fake.size, size);
+    }
+    assertEqual(fake.size, count);
+    for (size_t i = 0; i < count; ++i) {
+        assertIsJ1939Message(fake.messages[i], commands[i]);
+    }
+
+    // Once the borrowed space is read commands use the control lane again.
+    left_bus.emit(MessageView(&commands[0]));
+    assertEqual(smp.rightStats(PipeLane::CONTROL).depth, 1u);
+    assertEqual(smp.rightStats(PipeLane::BULK).depth, 0u);
+}
+
+test(PipeTest, Classify) {
+    Event state(0x01, 0x01);
+    Event command(0x01, 0x10);
+    CAN20Frame frame(0x54A, 0, 8);
+    J1939Message broadcast(0xFF00, 0x0A);
+    J1939Message addressed(0xEF00, 0x0A, 0x1B);
+    TxState tx_state(TxNetwork::CAN);
+
+    assertTrue(Pipe::classify(MessageView(&state)) == PipeLane::BULK);
+    assertTrue(Pipe::classify(MessageView(&command)) == PipeLane::CONTROL);
+    assertTrue(Pipe::classify(MessageView(&tx_state)) == PipeLane::CONTROL);
+    assertTrue(Pipe::classify(MessageView(&frame)) == PipeLane::BULK);
+    assertTrue(Pipe::classify(MessageView(&broadcast)) == PipeLane::BULK);
+    assertTrue(Pipe::classify(MessageView(&addressed)) == PipeLane::CONTROL);
+}
+
+test(PipeBufferTest, Wrap) {
+    // Record sizes do not divide the capacity so records straddle the end of
+    // the ring.
+    PipeBuffer buffer(17);
+    MessageValue msg;
+    for (uint8_t i = 0; i < 50; ++i) {
+        CAN20Frame frame(0x100 + i, 0, (uint8_t[]){i, 0x02, 0x03});
+        Event event(0x02, i, (uint8_t[]){i});
+        assertTrue(buffer.write(MessageView(&frame)));
+        assertTrue(buffer.write(MessageView(&event)));
+        assertFalse(buffer.write(MessageView(&frame)));
+
+        assertTrue(buffer.read(&msg));
+        assertIsCANFrame(msg, frame);
+        assertTrue(buffer.read(&msg));
+        assertIsEvent(msg, event);
+        assertFalse(buffer.read(&msg));
+        assertEqual(buffer.size(), 0u);
+    }
 }
 
 }  // namespace R51
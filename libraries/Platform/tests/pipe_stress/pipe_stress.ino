@@ -0,0 +1,189 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Caster.h>
+#include <Core.h>
+#include <Platform.h>
+#include <Test.h>
+#include <atomic>
+
+// Runs a bus on each of two threads connected by a Pipe, the same way the
+// ECUs run an I/O bus and a processing bus on the two RP2040 cores. Both sides
+// send numbered messages as fast as they can. The receiving side checks that
+// each lane is delivered in order and that every message was either received
+// or counted as an overrun. Build with `make tsan` to check for data races.
+
+namespace R51 {
+
+using namespace aunit;
+using ::Caster::Bus;
+using ::Caster::Node;
+using ::Caster::Yield;
+
+static const uint32_t kMessages = 100000;
+static const size_t kBurst = 16;
+static const uint32_t kTimeoutMs = 30000;
+
+// Event IDs for the two lanes.
+static const uint8_t kStateID = 0x01;
+static const uint8_t kCommandID = 0x11;
+
+// Sends numbered events in bursts. Every fourth event is a command which
+// takes the control lane. Sequence numbers are tracked per lane.
+class SequenceNode : public Node<Message> {
+    public:
+        SequenceNode(uint8_t subsystem) : subsystem_(subsystem),
+            sent_(0), control_seq_(0), bulk_seq_(0) {}
+
+        void handle(const Message&, const Yield<Message>&) override {}
+
+        void emit(const Yield<Message>& yield) override {
+            uint32_t sent = sent_.load();
+            for (size_t i = 0; i < kBurst && sent < kMessages; ++i, ++sent) {
+                bool command = sent % 4 == 0;
+                uint32_t seq = command ? ++control_seq_ : ++bulk_seq_;
+                Event event(subsystem_, command ? kCommandID : kStateID);
+                memcpy(event.data, &seq, sizeof(seq));
+                yield(MessageView(&event));
+            }
+            sent_.store(sent);
+        }
+
+        uint32_t sent() const { return sent_.load(); }
+
+    private:
+        uint8_t subsystem_;
+        std::atomic<uint32_t> sent_;
+        uint32_t control_seq_;
+        uint32_t bulk_seq_;
+};
+
+// Receives the other side's events and checks their order.
+class CheckNode : public Node<Message> {
+    public:
+        CheckNode(uint8_t subsystem) : subsystem_(subsystem), received_(0),
+            out_of_order_(0), control_seq_(0), bulk_seq_(0) {}
+
+        void handle(const Message& msg, const Yield<Message>&) override {
+            if (msg.type() != Message::EVENT || msg.event()->subsystem != subsystem_) {
+                return;
+            }
+            uint32_t seq;
+            memcpy(&seq, msg.event()->data, sizeof(seq));
+            uint32_t* last = msg.event()->id == kCommandID ? &control_seq_ : &bulk_seq_;
+            if (seq <= *last) {
+                out_of_order_.store(out_of_order_.load() + 1);
+            }
+            *last = seq;
+            received_.store(received_.load() + 1);
+        }
+
+        uint32_t received() const { return received_.load(); }
+        uint32_t out_of_order() const { return out_of_order_.load(); }
+
+    private:
+        uint8_t subsystem_;
+        std::atomic<uint32_t> received_;
+        std::atomic<uint32_t> out_of_order_;
+        uint32_t control_seq_;
+        uint32_t bulk_seq_;
+};
+
+Pipe pipe(16, 16);
+SyncWait sync_wait;
+
+SequenceNode left_sender(0x01);
+CheckNode left_checker(0x02);
+Node<Message>* left_nodes[] = {pipe.left(), &left_sender, &left_checker};
+Bus<Message> left_bus(left_nodes, sizeof(left_nodes)/sizeof(left_nodes[0]));
+
+SequenceNode right_sender(0x02);
+CheckNode right_checker(0x01);
+Node<Message>* right_nodes[] = {pipe.right(), &right_sender, &right_checker};
+Bus<Message> right_bus(right_nodes, sizeof(right_nodes)/sizeof(right_nodes[0]));
+
+void setupLeft() {
+    left_bus.init();
+    sync_wait.wait();
+}
+
+void loopLeft() {
+    left_bus.loop();
+}
+
+void setupRight() {
+    right_bus.init();
+    sync_wait.wait();
+}
+
+void loopRight() {
+    right_bus.loop();
+}
+
+// Return the number of messages dropped from a queue.
+uint32_t overruns(const PipeStats& control, const PipeStats& bulk) {
+    return control.overruns + bulk.overruns;
+}
+
+// Return true when every message sent has been received or dropped.
+bool settled() {
+    uint32_t right_lost = overruns(pipe.rightStats(PipeLane::CONTROL),
+            pipe.rightStats(PipeLane::BULK));
+    uint32_t left_lost = overruns(pipe.leftStats(PipeLane::CONTROL),
+            pipe.leftStats(PipeLane::BULK));
+    return left_sender.sent() == kMessages && right_sender.sent() == kMessages &&
+        right_checker.received() + right_lost == kMessages &&
+        left_checker.received() + left_lost == kMessages;
+}
+
+test(PipeStressTest, BothDirections) {
+    CoreThread left_core(setupLeft, loopLeft);
+    CoreThread right_core(setupRight, loopRight);
+
+    uint32_t start = millis();
+    left_core.start();
+    right_core.start();
+    while (!settled() && millis() - start < kTimeoutMs) {
+        delay(1);
+    }
+    uint32_t elapsed = millis() - start;
+    left_core.stop();
+    right_core.stop();
+
+    PipeStats right_control = pipe.rightStats(PipeLane::CONTROL);
+    PipeStats right_bulk = pipe.rightStats(PipeLane::BULK);
+    PipeStats left_control = pipe.leftStats(PipeLane::CONTROL);
+    PipeStats left_bulk = pipe.leftStats(PipeLane::BULK);
+
+    Serial.print("pipe_stress: messages=");
+    Serial.print(kMessages * 2);
+    Serial.print(" elapsed_ms=");
+    Serial.print(elapsed);
+    Serial.print(" left_to_right_lost=");
+    Serial.print(overruns(right_control, right_bulk));
+    Serial.print(" right_to_left_lost=");
+    Serial.println(overruns(left_control, left_bulk));
+
+    assertTrue(settled());
+    assertEqual(right_checker.out_of_order(), 0u);
+    assertEqual(left_checker.out_of_order(), 0u);
+    assertEqual(right_checker.received() + overruns(right_control, right_bulk), kMessages);
+    assertEqual(left_checker.received() + overruns(left_control, left_bulk), kMessages);
+    assertEqual(right_control.depth + right_bulk.depth, 0u);
+    assertEqual(left_control.depth + left_bulk.depth, 0u);
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
@@ -118,6 +118,11 @@ RotaryEncoderGroup::RotaryEncoderGroup(uint8_t keypad, RotaryEncoder** encoders,
     keypress_event_.keypad(keypad);
 }
 
+void RotaryEncoderGroup::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::KEYPAD, (uint8_t)KeypadEvent::INDICATOR_CMD,
+            (uint8_t)KeypadEvent::BACKLIGHT_CMD);
+}
+
 void RotaryEncoderGroup::handle(const Message& msg, const Yield<Message>&) {
     if (msg.type() != Message::EVENT ||
             msg.event()->subsystem != (uint8_t)SubSystem::KEYPAD) {
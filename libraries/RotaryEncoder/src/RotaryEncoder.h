@@ -88,11 +88,14 @@ class RotaryEncoder {
 // A maximum of 8 encoders are supported in the group. This is, without
 // coincidence, also the maximum number of encoders that can be connected to a
 // single I2C bus.
-class RotaryEncoderGroup : public Caster::Node<Message> {
+class RotaryEncoderGroup : public Caster::Node<Message>, public Subscriber {
     public:
         // Construct a new group with the given keypad ID and set of encoders.
         RotaryEncoderGroup(uint8_t keypad, RotaryEncoder** encoders, uint8_t count);
 
+        // Subscribe to keypad LED commands.
+        void subscribe(Subscription* sub) override;
+
         // Handle a backlight LED command.
         void handle(const Message& msg, const Caster::Yield<Message>&) override;
 
@@ -1,7 +1,9 @@
 #ifndef _R51_TEST_H_
 #define _R51_TEST_H_
 
+#include "Test/Filters.h"
 #include "Test/Matchers.h"
+#include "Test/Schema.h"
 #include "Test/Yield.h"
 
 #endif  // _R51_TEST_H_
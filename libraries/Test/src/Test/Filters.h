@@ -0,0 +1,74 @@
+#ifndef _R51_TEST_FILTERS_H_
+#define _R51_TEST_FILTERS_H_
+
+#include <Arduino.h>
+#include <Core.h>
+
+namespace R51 {
+
+// Register-level fake of a CAN controller's acceptance masks and filters.
+// Each mask is shared by a fixed number of filters, e.g. {2, 4} for an
+// MCP2515 or {1, 1, 1, ...} for an MCP2518. Registers start out cleared,
+// which on real hardware accepts only standard ID 0.
+template <uint8_t M, uint8_t F>
+class FakeFilterRegisters : public FilterRegisters {
+    public:
+        // Construct the registers with the number of filters sharing each
+        // mask.
+        FakeFilterRegisters(const uint8_t (&layout)[M]) {
+            memset(masks_, 0, sizeof(masks_));
+            memset(filters_, 0, sizeof(filters_));
+            memset(filter_ext_, 0, sizeof(filter_ext_));
+            for (uint8_t m = 0; m < M; ++m) {
+                layout_[m] = layout[m] < F ? layout[m] : F;
+            }
+        }
+
+        uint8_t maskCount() const override { return M; }
+
+        uint8_t filterCount(uint8_t mask) const override { return layout_[mask]; }
+
+        void setMask(uint8_t mask, bool ext, uint32_t value) override {
+            masks_[mask] = value & (ext ? 0x1FFFFFFF : 0x7FF);
+        }
+
+        void setFilter(uint8_t mask, uint8_t filter, bool ext, uint32_t value) override {
+            filters_[mask][filter] = value & (ext ? 0x1FFFFFFF : 0x7FF);
+            filter_ext_[mask][filter] = ext;
+        }
+
+        // Return true if the controller accepts a frame with the given ID.
+        bool accept(uint32_t id, bool ext) const {
+            for (uint8_t m = 0; m < M; ++m) {
+                uint32_t mask = masks_[m] & (ext ? 0x1FFFFFFF : 0x7FF);
+                for (uint8_t f = 0; f < layout_[m]; ++f) {
+                    if (filter_ext_[m][f] == ext &&
+                            (id & mask) == (filters_[m][f] & mask)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Return the number of standard IDs the controller accepts.
+        uint32_t acceptCount() const {
+            uint32_t count = 0;
+            for (uint32_t id = 0; id < 0x800; ++id) {
+                if (accept(id, false)) {
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+    private:
+        uint8_t layout_[M];
+        uint32_t masks_[M];
+        uint32_t filters_[M][F];
+        bool filter_ext_[M][F];
+};
+
+}  // namespace R51
+
+#endif  // _R51_TEST_FILTERS_H_
@@ -41,4 +41,12 @@
     assertEqual(message.type(), R51::Message::J1939_MESSAGE);\
     assertPrintablesEqual(*message.j1939_message(), j1939);
 
+#define assertIsJ1939Transfer(message, transfer) \
+    assertEqual(message.type(), R51::Message::J1939_TRANSFER);\
+    assertPrintablesEqual(*message.j1939_transfer(), transfer);
+
+#define assertIsJ1939Address(message, address) \
+    assertEqual(message.type(), R51::Message::J1939_ADDRESS);\
+    assertPrintablesEqual(*message.j1939_address(), address);
+
 #endif  // _R51_TEST_MATCHERS_H_
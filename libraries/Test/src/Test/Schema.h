@@ -0,0 +1,112 @@
+#ifndef _R51_TEST_SCHEMA_H_
+#define _R51_TEST_SCHEMA_H_
+
+#include <Arduino.h>
+#include <Core.h>
+
+namespace R51 {
+
+// Binds an event schema field to the EVENT_PROPERTY accessor of its event
+// class so tests can check that the two describe the same layout.
+struct EventAccessor {
+    const char* schema;
+    const char* field;
+    uint32_t (*get)(const Event& event);
+    void (*set)(Event* event, uint32_t value);
+};
+
+// Create an EventAccessor for the property of an event class.
+#define EVENT_ACCESSOR(schema, type, field, property) { \
+    schema, field, \
+    [](const Event& event) -> uint32_t { \
+        return (uint32_t)((const type&)event).property(); \
+    }, \
+    [](Event* event, uint32_t value) { \
+        ((type*)event)->property((decltype(((type*)event)->property()))value); \
+    }, \
+}
+
+namespace internal {
+
+inline const EventAccessor* findAccessor(const EventAccessor* accessors, size_t size,
+        const EventSchema& schema, const EventField& field) {
+    for (size_t i = 0; i < size; ++i) {
+        if (strcmp(accessors[i].schema, schema.name) == 0 &&
+                strcmp(accessors[i].field, field.name) == 0) {
+            return &accessors[i];
+        }
+    }
+    return nullptr;
+}
+
+inline bool failAccessor(const EventSchema& schema, const EventField& field,
+        const char* reason) {
+    SERIAL_PORT_MONITOR.print(schema.name);
+    SERIAL_PORT_MONITOR.print(".");
+    SERIAL_PORT_MONITOR.print(field.name);
+    SERIAL_PORT_MONITOR.print(": ");
+    SERIAL_PORT_MONITOR.println(reason);
+    return false;
+}
+
+// Compare a field written through the schema and through the accessor.
+inline bool checkAccessor(const EventSchema& schema, const EventField& field,
+        const EventAccessor& accessor, uint32_t value) {
+    Event by_schema;
+    Event by_accessor;
+    schema.init(&by_schema);
+    schema.init(&by_accessor);
+    field.set(by_schema.data, value);
+    accessor.set(&by_accessor, value);
+    if (memcmp(by_schema.data, by_accessor.data, 6) != 0) {
+        return failAccessor(schema, field, "set writes different bits");
+    }
+
+    uint32_t mask = field.width >= 32 ? 0xFFFFFFFF : ((uint32_t)1 << field.width) - 1;
+    uint32_t got = accessor.get(by_schema);
+    if (field.type == FieldType::BOOL) {
+        got = got != 0;
+        value = value != 0;
+    }
+    if ((got & mask) != value) {
+        return failAccessor(schema, field, "get reads different bits");
+    }
+    return true;
+}
+
+}  // namespace internal
+
+// Return true if every field of the linked schemas accepted by include has an
+// accessor and each accessor reads and writes the same bits as its field.
+// Mismatches are printed.
+template <typename Include>
+bool checkEventAccessors(const EventAccessor* accessors, size_t size, Include include) {
+    bool ok = true;
+    for (size_t i = 0; i < EventSchemaTable::count(); ++i) {
+        const EventSchema& schema = *EventSchemaTable::at(i);
+        if (!include(schema)) {
+            continue;
+        }
+        for (uint8_t j = 0; j < schema.field_count; ++j) {
+            const EventField& field = schema.fields[j];
+            const EventAccessor* accessor = internal::findAccessor(
+                    accessors, size, schema, field);
+            if (accessor == nullptr) {
+                ok = internal::failAccessor(schema, field, "no accessor");
+                continue;
+            }
+            uint32_t max = field.type == FieldType::ENUM ? field.label_count - 1 :
+                field.type == FieldType::BOOL ? 1 :
+                field.width >= 32 ? 0xFFFFFFFF : ((uint32_t)1 << field.width) - 1;
+            if (!internal::checkAccessor(schema, field, *accessor, 1) ||
+                    !internal::checkAccessor(schema, field, *accessor, max)) {
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+}  // namespace R51
+
+#endif  // _R51_TEST_SCHEMA_H_
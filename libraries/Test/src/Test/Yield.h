@@ -11,9 +11,24 @@ namespace R51 {
 // A deep copy of a message.
 class MessageCopy : public Printable {
     public:
-        MessageCopy() : type_(Message::EMPTY) {}
+        MessageCopy() : type_(Message::EMPTY),
+            transfer_arena_(kScratchCapacity), transfer_data_(&transfer_arena_) {}
+
+        MessageCopy(const MessageCopy& msg) : MessageCopy() { *this = msg; }
+
+        MessageCopy& operator=(const MessageCopy& msg) {
+            type_ = msg.type_;
+            event_ = msg.event_;
+            can_frame_ = msg.can_frame_;
+            j1939_claim_ = msg.j1939_claim_;
+            j1939_message_ = msg.j1939_message_;
+            copyTransfer(msg.j1939_transfer_);
+            j1939_address_ = msg.j1939_address_;
+            return *this;
+        }
 
-        MessageCopy(const Message& msg) : type_(msg.type()) {
+        MessageCopy(const Message& msg) : type_(msg.type()),
+                transfer_arena_(kScratchCapacity), transfer_data_(&transfer_arena_) {
             switch (msg.type()) {
                 case Message::EVENT:
                     event_ = *msg.event();
@@ -27,6 +42,12 @@ class MessageCopy : public Printable {
                 case Message::J1939_MESSAGE:
                     j1939_message_ = *msg.j1939_message();
                     break;
+                case Message::J1939_TRANSFER:
+                    copyTransfer(*msg.j1939_transfer());
+                    break;
+                case Message::J1939_ADDRESS:
+                    j1939_address_ = *msg.j1939_address();
+                    break;
                 case Message::EMPTY:
                     break;
             }
@@ -42,6 +63,10 @@ class MessageCopy : public Printable {
 
         const Canny::J1939Message* j1939_message() const { return &j1939_message_; }
 
+        const J1939Transfer* j1939_transfer() const { return &j1939_transfer_; }
+
+        const J1939Address* j1939_address() const { return &j1939_address_; }
+
         size_t printTo(Print& p) const {
             switch (type_) {
                 case Message::EMPTY:
@@ -54,6 +79,10 @@ class MessageCopy : public Printable {
                     return p.print("(J1939_CLAIM)") +  j1939_claim_.printTo(p);
                 case Message::J1939_MESSAGE:
                     return p.print("(J1939_MESSAGE)") + j1939_message_.printTo(p);
+                case Message::J1939_TRANSFER:
+                    return p.print("(J1939_TRANSFER)") + j1939_transfer_.printTo(p);
+                case Message::J1939_ADDRESS:
+                    return p.print("(J1939_ADDRESS)") + j1939_address_.printTo(p);
             }
             return 0;
         }
@@ -64,6 +93,24 @@ class MessageCopy : public Printable {
         Canny::CAN20Frame can_frame_;
         J1939Claim j1939_claim_;
         Canny::J1939Message j1939_message_;
+        J1939Transfer j1939_transfer_;
+        J1939Address j1939_address_;
+        // Holds a copy of the transfer payload. The copy has its own arena so
+        // that it does not compete with the code under test for space.
+        ScratchArena transfer_arena_;
+        Scratch transfer_data_;
+
+        void copyTransfer(const J1939Transfer& transfer) {
+            j1939_transfer_ = transfer;
+            transfer_data_.clear();
+            if (transfer.size() > 0 && transfer_data_.reserve(transfer.size())) {
+                memcpy(transfer_data_.bytes, transfer.bytes(), transfer.size());
+                transfer_data_.size = transfer.size();
+                j1939_transfer_.data(&transfer_data_);
+            } else {
+                j1939_transfer_.data(nullptr);
+            }
+        }
 };
 
 // A fake Yield implementation that collects copies of the yielded messages.
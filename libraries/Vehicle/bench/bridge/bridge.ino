@@ -0,0 +1,158 @@
+#include <Arduino.h>
+#include <Bench.h>
+#include <Canny.h>
+#include <Caster.h>
+#include <Core.h>
+#include <Vehicle.h>
+
+// Pushes synthetic vehicle traffic through the bridge's node set. Frames are
+// read from a fake vehicle CAN connection and the resulting events leave
+// through the J1939 gateway. The I/O and processing buses are merged into a
+// single bus since the inter-core pipe is not available on the host.
+
+namespace R51 {
+
+using ::Canny::CAN20Frame;
+using ::Canny::J1939Message;
+
+static const size_t kFrames = 200000;
+static const uint8_t kJ1939Address = 0x18;
+static const uint64_t kJ1939Name = 0x000013B000FFFAC0;
+static const int kDefrostPin = 24;
+static const uint16_t kDefrostMs = 300;
+
+// Vehicle state frames. Each frame ID appears twice with different data so
+// that every frame results in a state change.
+const CAN20Frame traffic[] = {
+    CAN20Frame(0x54A, 0, (uint8_t[]){0x3C, 0x3E, 0x7F, 0x80, 0x3C, 0x41, 0x00, 0x58}),
+    CAN20Frame(0x54B, 0, (uint8_t[]){0x59, 0x8C, 0x05, 0x24, 0x00, 0x00, 0x00, 0x02}),
+    CAN20Frame(0x625, 0, (uint8_t[]){0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}),
+    CAN20Frame(0x385, 0, (uint8_t[]){0x84, 0x0C, 0x82, 0x84, 0x79, 0x77, 0x00, 0xF0}),
+    CAN20Frame(0x72E, 0, (uint8_t[]){0x06, 0x7B, 0x00, 0x60, 0x01, 0x0E, 0x07, 0xFF}),
+    CAN20Frame(0x54A, 0, (uint8_t[]){0x3C, 0x3E, 0x7F, 0x80, 0x40, 0x41, 0x00, 0x58}),
+    CAN20Frame(0x54B, 0, (uint8_t[]){0x59, 0x8C, 0x08, 0x24, 0x00, 0x00, 0x00, 0x02}),
+    CAN20Frame(0x625, 0, (uint8_t[]){0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}),
+    CAN20Frame(0x385, 0, (uint8_t[]){0x84, 0x0C, 0x01, 0x02, 0x03, 0x04, 0x00, 0xF0}),
+    CAN20Frame(0x72E, 0, (uint8_t[]){0x06, 0x7B, 0x20, 0xC2, 0x6F, 0x73, 0xD3, 0xFF}),
+};
+
+// The bridge nodes with their hardware connections replaced by bench
+// connections.
+class Bridge {
+    public:
+        Bridge(LatencyProbe* probe = nullptr) :
+            can_conn(probe), j1939_conn(probe),
+            can_gw(&can_conn),
+            j1939_gw(&j1939_conn, kJ1939Address, kJ1939Name, true),
+            defrost(kDefrostPin, kDefrostMs) {}
+
+        BenchConnection<CAN20Frame> can_conn;
+        BenchConnection<J1939Message> j1939_conn;
+        CANGateway can_gw;
+        J1939Gateway j1939_gw;
+        J1939Adapter j1939_adapter;
+        Climate climate;
+        Settings settings;
+        IPDM ipdm;
+        Illum illum;
+        TirePressure tire_pressure;
+        Defrost defrost;
+};
+
+// Replay the traffic into the bridge until all frames have been read. Returns
+// the elapsed time in nanoseconds.
+template <typename Bus>
+uint64_t drive(Bridge* bridge, Bus* bus, LatencyProbe* probe = nullptr) {
+    bridge->can_conn.replay(traffic, sizeof(traffic)/sizeof(traffic[0]), kFrames);
+    uint64_t start = benchNanos();
+    while (!bridge->can_conn.done()) {
+        bus->loop();
+        if (probe != nullptr) {
+            probe->clear();
+        }
+    }
+    return benchNanos() - start;
+}
+
+void benchIndexedBus() {
+    Bridge bridge;
+    BusNode nodes[] = {
+        &bridge.can_gw,
+        &bridge.j1939_gw,
+        &bridge.j1939_adapter,
+        &bridge.climate,
+        &bridge.settings,
+        &bridge.ipdm,
+        &bridge.illum,
+        &bridge.tire_pressure,
+        &bridge.defrost,
+    };
+    IndexedBus bus(nodes, sizeof(nodes)/sizeof(nodes[0]));
+    bus.init();
+    uint64_t elapsed = drive(&bridge, &bus);
+    reportThroughput(&Serial, "bridge", "indexed", bridge.can_conn.reads(), elapsed);
+}
+
+void benchStaticBus() {
+    Bridge bridge;
+    StaticBus<CANGateway, J1939Gateway, J1939Adapter, Climate, Settings, IPDM,
+        Illum, TirePressure, Defrost> bus(
+            &bridge.can_gw,
+            &bridge.j1939_gw,
+            &bridge.j1939_adapter,
+            &bridge.climate,
+            &bridge.settings,
+            &bridge.ipdm,
+            &bridge.illum,
+            &bridge.tire_pressure,
+            &bridge.defrost);
+    bus.init();
+    uint64_t elapsed = drive(&bridge, &bus);
+    reportThroughput(&Serial, "bridge", "static", bridge.can_conn.reads(), elapsed);
+}
+
+void benchProfile() {
+    LatencyProbe probe(kFrames);
+    Bridge bridge(&probe);
+    TimedNode timed[] = {
+        TimedNode("can_gw", &bridge.can_gw),
+        TimedNode("j1939_gw", &bridge.j1939_gw),
+        TimedNode("j1939_adapter", &bridge.j1939_adapter),
+        TimedNode("climate", &bridge.climate),
+        TimedNode("settings", &bridge.settings),
+        TimedNode("ipdm", &bridge.ipdm),
+        TimedNode("illum", &bridge.illum),
+        TimedNode("tire_pressure", &bridge.tire_pressure),
+        TimedNode("defrost", &bridge.defrost),
+    };
+    BusNode nodes[] = {
+        &timed[0], &timed[1], &timed[2], &timed[3], &timed[4],
+        &timed[5], &timed[6], &timed[7], &timed[8],
+    };
+    static const size_t size = sizeof(nodes)/sizeof(nodes[0]);
+    IndexedBus bus(nodes, size);
+    bus.init();
+    uint64_t elapsed = drive(&bridge, &bus, &probe);
+
+    reportThroughput(&Serial, "bridge", "profile", bridge.can_conn.reads(), elapsed);
+    for (size_t i = 0; i < size; ++i) {
+        reportNode(&Serial, "bridge", timed[i]);
+    }
+    reportLatency(&Serial, "bridge", &probe);
+}
+
+}  // namespace R51
+
+void setup() {
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+
+    R51::benchIndexedBus();
+    R51::benchStaticBus();
+    R51::benchProfile();
+#if defined(EPOXY_DUINO)
+    exit(0);
+#endif
+}
+
+void loop() {}
@@ -20,6 +20,11 @@ uint8_t getPressureValue(const Canny::CAN20Frame& frame, int tire) {
 
 }  // namespace
 
+void Illum::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+    sub->event((uint8_t)SubSystem::IPDM, (uint8_t)IPDMEvent::POWER_STATE);
+}
+
 void Illum::handle(const Message& msg, const Caster::Yield<Message>& yield) {
     if (msg.type() != Message::EVENT) {
         return;
@@ -37,6 +42,10 @@ void Defrost::begin() {
     output_.init();
 }
 
+void Defrost::subscribe(Subscription* sub) {
+    sub->event((uint8_t)SubSystem::BCM, (uint8_t)BCMEvent::TOGGLE_DEFROST_CMD);
+}
+
 void Defrost::handle(const Message& msg, const Caster::Yield<Message>&) {
     if (msg.type() != Message::EVENT ||
             msg.event()->subsystem != (uint8_t)SubSystem::BCM ||
@@ -59,6 +68,12 @@ TirePressure::TirePressure(ConfigStore* config, uint32_t tick_ms, Faker::Clock*
         }
     }
 
+void TirePressure::subscribe(Subscription* sub) {
+    sub->canFrame(0x385);
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+    sub->event((uint8_t)SubSystem::BCM, (uint8_t)BCMEvent::TIRE_SWAP_CMD);
+}
+
 void TirePressure::handle(const Message& msg, const Caster::Yield<Message>& yield) {
     switch (msg.type()) {
         case Message::CAN_FRAME:
@@ -30,10 +30,13 @@ class IllumState : public Event {
 // directly to the dash. We simulate this by reading headlamp state from the
 // IPDM to determine whether dash lights should be illuminated. This avoids the
 // need to connect the ECM to the BCM illum+ wire.
-class Illum : public Caster::Node<Message> {
+class Illum : public Caster::Node<Message>, public Subscriber {
     public:
         Illum() {}
 
+        // Subscribe to IPDM power state and requests.
+        void subscribe(Subscription* sub) override;
+
         // Handles IPDM power events to determine illumation state.
         void handle(const Message& message, const Caster::Yield<Message>& yield) override;
     private:
@@ -43,7 +46,7 @@ class Illum : public Caster::Node<Message> {
 // Controls the defrost heater via a GPIO pin connected to the BCM. The pin is
 // momentarily pulled high to simulate a button press. The pin should have a 1k
 // resistor in series with the defrost output in the vehicle harness.
-class Defrost : public Caster::Node<Message> {
+class Defrost : public Caster::Node<Message>, public Subscriber {
     public:
         Defrost(int output_pin, uint16_t output_ms,
                 Faker::Clock* clock = Faker::Clock::real(),
@@ -54,22 +57,31 @@ class Defrost : public Caster::Node<Message> {
         // Initialize output GPIO.
         void begin();
 
+        // Subscribe to defrost commands.
+        void subscribe(Subscription* sub) override;
+
         // Handles the IPDM TOGGLE_DEFROST_CMD mesage.
         void handle(const Message& message, const Caster::Yield<Message>&) override;
 
         // Does not emit any messages but required to update the GPIO status.
         void emit(const Caster::Yield<Message>&) override;
 
+        // Track the output timer on a wheel.
+        void schedule(TimerWheel* wheel) { output_.schedule(wheel); }
+
     private:
         MomentaryOutput output_;
 };
 
 // Track tire pressure as reported in the 0x385 CAN frame.
-class TirePressure : public Caster::Node<Message> {
+class TirePressure : public Caster::Node<Message>, public Subscriber {
     public:
         TirePressure(ConfigStore* config = nullptr,
                 uint32_t tick_ms = 0, Faker::Clock* clock = Faker::Clock::real());
 
+        // Subscribe to tire pressure frames, requests, and tire swap commands.
+        void subscribe(Subscription* sub) override;
+
         // Handle 0x385 tire pressure state frames. Returns true if the state
         // changed as a result of handling the frame.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
@@ -77,6 +89,9 @@ class TirePressure : public Caster::Node<Message> {
         // Yield a TIRE_PRESSURE_STATE frame on change or tick.
         void emit(const Caster::Yield<Message>& yield) override;
 
+        // Track the state ticker on a wheel.
+        void schedule(TimerWheel* wheel) { wheel->add(&ticker_); }
+
     private:
         void yieldEvent(const Caster::Yield<Message>& yield);
         void handleFrame(const Canny::CAN20Frame& frame, const Caster::Yield<Message>& yield);
@@ -85,7 +100,7 @@ class TirePressure : public Caster::Node<Message> {
 
         ConfigStore* config_;
         Event event_;
-        Ticker ticker_;
+        Timer ticker_;
         uint8_t map_[4];
 };
 
@@ -33,7 +33,14 @@ Climate::Climate(uint32_t tick_ms, Faker::Clock* clock) :
     clock_(clock), startup_(0),
     state_ticker_(tick_ms, tick_ms == 0, clock),
     control_ticker_(CONTROL_INIT_TICK, false, clock),
-    state_init_(0), control_init_(false) {}
+    state_init_(0), control_init_(false), tx_hold_(TxNetwork::CAN, clock) {}
+
+void Climate::subscribe(Subscription* sub) {
+    sub->canFrame(0x54A, 0x54B);
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::TX_STATE);
+    sub->event((uint8_t)SubSystem::CLIMATE);
+}
 
 void Climate::handle(const Message& msg, const Caster::Yield<Message>& yield) {
     //TODO: Emit events directly.
@@ -153,6 +160,10 @@ void Climate::handleSystemFrame(const Canny::CAN20Frame& frame, const Caster::Yi
 }
 
 void Climate::handleControllerEvent(const Event& event, const Caster::Yield<Message>& yield) {
+    if (event.id == (uint8_t)ControllerEvent::TX_STATE) {
+        tx_hold_.update((const TxState&)event);
+        return;
+    }
     if (RequestCommand::match(event, SubSystem::CLIMATE,
             (uint8_t)ClimateEvent::TEMP_STATE)) {
         yield(MessageView(&temp_state_));
@@ -256,7 +267,9 @@ void Climate::emit(const Caster::Yield<Message>& yield) {
         control_init_ = true;
     }
 
-    if (control_ticker_.active()) {
+    // Hold the periodic control frames while the CAN bus is congested. The
+    // ticker stays active so they are sent as soon as it clears.
+    if (control_ticker_.active() && !tx_hold_.held()) {
         yield(MessageView(&system_control_));
         yield(MessageView(&fan_control_));
         control_ticker_.reset();
@@ -13,17 +13,28 @@
 namespace R51 {
 
 // Manages the vehicle climate control system.
-class Climate : public Caster::Node<Message> {
+class Climate : public Caster::Node<Message>, public Subscriber {
     public:
         Climate(uint32_t tick_ms = 0, Faker::Clock* clock = Faker::Clock::real());
 
+        // Subscribe to climate state frames, requests, and climate commands.
+        void subscribe(Subscription* sub) override;
+
         // Update the climate state from vehicle state frames and process
         // control frames.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
 
         // Emit control frames to the vehicle and climate state system events.
+        // Periodic control frames are held while the CAN bus is congested
+        // unless the gateway stops reporting congestion.
         void emit(const Caster::Yield<Message>& yield) override;
 
+        // Track the state and control tickers on a wheel.
+        void schedule(TimerWheel* wheel) {
+            wheel->add(&state_ticker_);
+            wheel->add(&control_ticker_);
+        }
+
     private:
         void handleTempFrame(const Canny::CAN20Frame& frame, const Caster::Yield<Message>& yield);
         void handleSystemFrame(const Canny::CAN20Frame& frame, const Caster::Yield<Message>& yield);
@@ -32,10 +43,11 @@ class Climate : public Caster::Node<Message> {
 
         Faker::Clock* clock_;
         uint32_t startup_;
-        Ticker state_ticker_;
-        Ticker control_ticker_;
+        Timer state_ticker_;
+        Timer control_ticker_;
         uint8_t state_init_;
         bool control_init_;
+        TxHold tx_hold_;
         ClimateTempState temp_state_;
         ClimateAirflowState airflow_state_;
         ClimateSystemState system_state_;
@@ -6,6 +6,11 @@
 
 namespace R51 {
 
+void EngineTempState::subscribe(Subscription* sub) {
+    sub->canFrame(0x551);
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+}
+
 void EngineTempState::handle(const Message& msg, const Caster::Yield<Message>& yield) {
     switch (msg.type()) {
         case Message::CAN_FRAME:
@@ -14,12 +14,15 @@ enum class ECMEvent : uint8_t {
 };
 
 // Track reported coolant temperature from the ECM via the 0x551 CAN frame.
-class EngineTempState : public Caster::Node<Message> {
+class EngineTempState : public Caster::Node<Message>, public Subscriber {
     public:
         EngineTempState(uint32_t tick_ms = 0, Faker::Clock* clock = Faker::Clock::real()) :
             changed_(false), event_((uint8_t)SubSystem::ECM, (uint8_t)ECMEvent::ENGINE_TEMP_STATE, (uint8_t[]){0x00}),
             ticker_(tick_ms, tick_ms == 0, clock) {}
 
+        // Subscribe to engine temp frames and requests.
+        void subscribe(Subscription* sub) override;
+
         // Handle ECM 0x551 state frames. Returns true if the state changed as
         // a result of handling the frame.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
@@ -27,6 +30,9 @@ class EngineTempState : public Caster::Node<Message> {
         // Yield an ENGINE_TEMP_STATE frame on change or tick.
         void emit(const Caster::Yield<Message>& yield) override;
 
+        // Track the state ticker on a wheel.
+        void schedule(TimerWheel* wheel) { wheel->add(&ticker_); }
+
     private:
         void yieldEvent(const Caster::Yield<Message>& yield);
         void handleFrame(const Canny::CAN20Frame& frame, const Caster::Yield<Message>& yield);
@@ -34,7 +40,7 @@ class EngineTempState : public Caster::Node<Message> {
 
         bool changed_;
         Event event_;
-        Ticker ticker_;
+        Timer ticker_;
 };
 
 }  // namespace R51
@@ -0,0 +1,109 @@
+#include <Arduino.h>
+#include <Core.h>
+#include "BCM.h"
+#include "ClimateEvents.h"
+#include "IPDM.h"
+
+namespace R51 {
+namespace {
+
+// Schemas for the events defined by Vehicle.
+
+constexpr const char* kClimateModes[] = {"off", "auto", "manual", "defog"};
+constexpr const char* kUnits[] = {"metric", "us"};
+
+constexpr EventField kClimateSystemFields[] = {
+    enumField("mode", 0, 2, kClimateModes),
+    boolField("ac", 2),
+    boolField("dual", 3),
+};
+
+constexpr EventField kClimateAirflowFields[] = {
+    uintField("fan", 0),
+    boolField("face", 8),
+    boolField("feet", 9),
+    boolField("windshield", 10),
+    boolField("recirculate", 11),
+};
+
+constexpr EventField kClimateTempFields[] = {
+    uintField("driver", 0),
+    uintField("passenger", 8),
+    uintField("outside", 16),
+    enumField("units", 24, 8, kUnits),
+};
+
+constexpr EventField kIllumFields[] = {
+    boolField("illum", 0, 8),
+};
+
+constexpr EventField kTirePressureFields[] = {
+    uintField("tire1", 0),
+    uintField("tire2", 8),
+    uintField("tire3", 16),
+    uintField("tire4", 24),
+};
+
+constexpr EventField kTireSwapFields[] = {
+    uintField("a", 0, 4),
+    uintField("b", 4, 4),
+};
+
+constexpr EventField kIPDMPowerFields[] = {
+    boolField("high_beams", 0),
+    boolField("low_beams", 1),
+    boolField("running_lights", 2),
+    boolField("fog_lights", 3),
+    boolField("defrost", 6),
+    boolField("ac_comp", 7),
+};
+
+constexpr EventSchema kVehicleSchemas[] = {
+    eventSchema("climate_system", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::SYSTEM_STATE, kClimateSystemFields),
+    eventSchema("climate_airflow", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::AIRFLOW_STATE, kClimateAirflowFields),
+    eventSchema("climate_temp", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::TEMP_STATE, kClimateTempFields),
+    eventSchema("climate_off", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::TURN_OFF_CMD),
+    eventSchema("climate_auto", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::TOGGLE_AUTO_CMD),
+    eventSchema("climate_ac", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::TOGGLE_AC_CMD),
+    eventSchema("climate_dual", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::TOGGLE_DUAL_CMD),
+    eventSchema("climate_defog", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::TOGGLE_DEFOG_CMD),
+    eventSchema("climate_fan_up", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::INC_FAN_SPEED_CMD),
+    eventSchema("climate_fan_down", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::DEC_FAN_SPEED_CMD),
+    eventSchema("climate_recirculate", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::TOGGLE_RECIRCULATE_CMD),
+    eventSchema("climate_airflow_mode", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::CYCLE_AIRFLOW_MODE_CMD),
+    eventSchema("climate_driver_up", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::INC_DRIVER_TEMP_CMD),
+    eventSchema("climate_driver_down", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::DEC_DRIVER_TEMP_CMD),
+    eventSchema("climate_passenger_up", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::INC_PASSENGER_TEMP_CMD),
+    eventSchema("climate_passenger_down", SubSystem::CLIMATE,
+            (uint8_t)ClimateEvent::DEC_PASSENGER_TEMP_CMD),
+    eventSchema("illum", SubSystem::BCM,
+            (uint8_t)BCMEvent::ILLUM_STATE, kIllumFields),
+    eventSchema("tire_pressure", SubSystem::BCM,
+            (uint8_t)BCMEvent::TIRE_PRESSURE_STATE, kTirePressureFields),
+    eventSchema("defrost", SubSystem::BCM,
+            (uint8_t)BCMEvent::TOGGLE_DEFROST_CMD),
+    eventSchema("tire_swap", SubSystem::BCM,
+            (uint8_t)BCMEvent::TIRE_SWAP_CMD, kTireSwapFields),
+    eventSchema("ipdm_power", SubSystem::IPDM,
+            (uint8_t)IPDMEvent::POWER_STATE, kIPDMPowerFields),
+};
+
+EventSchemaTable vehicle_schemas(kVehicleSchemas);
+
+}  // namespace
+}  // namespace R51
@@ -7,6 +7,11 @@
 
 namespace R51 {
 
+void IPDM::subscribe(Subscription* sub) {
+    sub->canFrame(0x625);
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+}
+
 void IPDM::handle(const Message& msg, const Caster::Yield<Message>& yield) {
     switch (msg.type()) {
         case Message::CAN_FRAME:
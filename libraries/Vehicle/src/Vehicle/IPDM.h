@@ -14,12 +14,15 @@ enum class IPDMEvent : uint8_t {
 };
 
 // Tracks IPDM state stored in the 0x625 CAN frame.
-class IPDM : public Caster::Node<Message> {
+class IPDM : public Caster::Node<Message>, public Subscriber {
     public:
         IPDM(uint32_t tick_ms = 0, Faker::Clock* clock = Faker::Clock::real()) :
             event_((uint8_t)SubSystem::IPDM, (uint8_t)IPDMEvent::POWER_STATE,
                     (uint8_t[]){0x00}), ticker_(tick_ms, tick_ms == 0, clock) {}
 
+        // Subscribe to IPDM state frames and requests.
+        void subscribe(Subscription* sub) override;
+
         // Handle a 0x625 IPDM state frame. Returns true if the state changed
         // as a result of handling the frame.
         void handle(const Message& msg, const Caster::Yield<Message>& yield) override;
@@ -27,13 +30,16 @@ class IPDM : public Caster::Node<Message> {
         // Yield a BODY_POWER_STATE frame on change or tick.
         void emit(const Caster::Yield<Message>& yield) override;
 
+        // Track the state ticker on a wheel.
+        void schedule(TimerWheel* wheel) { wheel->add(&ticker_); }
+
     private:
         void yieldEvent(const Caster::Yield<Message>& yield);
         void handleFrame(const Canny::CAN20Frame& frame, const Caster::Yield<Message>& yield);
         void handleEvent(const Event& event, const Caster::Yield<Message>& yield);
 
         Event event_;
-        Ticker ticker_;
+        Timer ticker_;
 };
 
 }  // namespace R51
@@ -6,10 +6,10 @@ namespace R51 {
 
 MomentaryOutput::MomentaryOutput(int pin, uint16_t trigger_ms, int32_t cooldown_ms, Mode mode,
         Faker::Clock* clock, Faker::GPIO* gpio)
-    : clock_(clock), gpio_(gpio),
-      pin_(pin), mode_(mode), triggered_(0), 
-      trigger_ms_(trigger_ms), trigger_time_(0),
-      cooldown_ms_(cooldown_ms < 0 ? trigger_ms : (uint16_t)cooldown_ms) {}
+    : gpio_(gpio),
+      pin_(pin), mode_(mode), triggered_(0), trigger_ms_(trigger_ms),
+      cooldown_ms_(cooldown_ms < 0 ? trigger_ms : (uint16_t)cooldown_ms),
+      timer_(trigger_ms, true, clock) {}
 
 void MomentaryOutput::init() {
     gpio_->pinMode(pin_, OUTPUT);
@@ -32,25 +32,28 @@ MomentaryOutput::MomentaryOutput(int pin, uint16_t trigger_ms, Faker::Clock* clo
     : MomentaryOutput(pin, trigger_ms, -1, MOMENTARILY_HIGH, clock, gpio) {}
 
 void MomentaryOutput::update() {
-    if (triggered_) {
-        if (clock_->millis() - trigger_time_ >= trigger_ms_ + cooldown_ms_) {
-            // cooldown expired, reset trigger
-            triggered_ = 0;
-        } else if (triggered_ < 2 && clock_->millis() - trigger_time_ >= trigger_ms_) {
-            // timer expired, turn pin "off"
-            triggered_ = 2;
-            switch (mode_) {
-                case MOMENTARILY_HIGH:
-                    gpio_->digitalWrite(pin_, LOW);
-                    break;
-                case MOMENTARILY_LOW:
-                    gpio_->digitalWrite(pin_, HIGH);
-                    break;
-                case MOMENTARILY_DRAIN:
-                    gpio_->digitalWrite(pin_, HIGH);
-                    gpio_->pinMode(pin_, INPUT);
-            }
+    if (!timer_.active()) {
+        return;
+    }
+    if (triggered_ == 1) {
+        // timer expired, turn pin "off" and start the cooldown
+        triggered_ = 2;
+        timer_.reset(cooldown_ms_);
+        switch (mode_) {
+            case MOMENTARILY_HIGH:
+                gpio_->digitalWrite(pin_, LOW);
+                break;
+            case MOMENTARILY_LOW:
+                gpio_->digitalWrite(pin_, HIGH);
+                break;
+            case MOMENTARILY_DRAIN:
+                gpio_->digitalWrite(pin_, HIGH);
+                gpio_->pinMode(pin_, INPUT);
         }
+    } else {
+        // cooldown expired, reset trigger
+        triggered_ = 0;
+        timer_.pause();
     }
 }
 
@@ -76,7 +79,7 @@ bool MomentaryOutput::trigger() {
             break;
     }
     triggered_ = 1;
-    trigger_time_ = clock_->millis();
+    timer_.resume(trigger_ms_);
     return true;
 }
 
@@ -2,6 +2,7 @@
 #define __R51_VEHICLE_MOMENTARY_OUTPUT__
 
 #include <Arduino.h>
+#include <Core.h>
 #include <Faker.h>
 
 namespace R51 {
@@ -37,19 +38,21 @@ class MomentaryOutput {
         // Update the state of the pin. Must be called in the main loop.
         void update();
 
+        // Track the output's timer on a wheel.
+        void schedule(TimerWheel* wheel) { wheel->add(&timer_); }
+
         // Trigger the pin. Return true on success or false if the pin is
         // currently triggered or in the cooldown phase.
         bool trigger();
 
     private:
-        Faker::Clock* clock_;
         Faker::GPIO* gpio_;
         int pin_;
         Mode mode_;
         uint8_t triggered_;
         uint16_t trigger_ms_;
-        uint32_t trigger_time_;
         uint16_t cooldown_ms_;
+        Timer timer_;
 };
 
 }  // namespace R51
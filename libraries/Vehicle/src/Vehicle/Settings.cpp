@@ -14,6 +14,10 @@ enum SettingsFrameId : uint32_t {
     SETTINGS_FRAME_F = 0x71F,
 };
 
+// STmin sent to the BCM in flow control. The BCM is asked to space the
+// frames of a segmented response 10ms apart.
+static const uint8_t kStMin = 0x0A;
+
 // Available sequence states. States other than "ready" represent a frame which
 // is sent on the bus which requires a specific response.
 enum State : uint8_t {
@@ -40,9 +44,7 @@ enum State : uint8_t {
     STATE_AUTO_RELOCK_TIME_CMD,
     STATE_SELECT_DOOR_UNLOCK,
     STATE_SLIDE_DRIVER_SEAT,
-    STATE_RETRIEVE_71E_10,
-    STATE_RETRIEVE_71E_2X,
-    STATE_RETRIEVE_71F_05,
+    STATE_RETRIEVE,
     STATE_RESET,
 };
 
@@ -78,125 +80,122 @@ uint32_t responseId(uint32_t request_id) {
     return (request_id & ~0x010) | 0x020;
 }
 
-// Fill a settings frame with a payload.
-bool fillRequest(Canny::CAN20Frame* frame, uint32_t id, byte prefix0, byte prefix1, byte prefix2, uint8_t value = 0xFF) {
-    frame->id(id, 0);
-    frame->resize(8);
-    frame->data()[0] = prefix0;
-    frame->data()[1] = prefix1;
-    frame->data()[2] = prefix2;
-    frame->data()[3] = value;
-    memset(frame->data()+4, 0xFF, 4);
-    return true;
+// Fill a settings request payload. Returns the size of the payload.
+size_t fillPayload(byte* data, byte service, byte param) {
+    data[0] = service;
+    data[1] = param;
+    return 2;
 }
 
-// Fill a settings frame with data to be sent when the sequence transitions to
-// the given state. Some state transitions require value be attached.
-bool fillRequest(Canny::CAN20Frame* frame, uint32_t id, uint8_t state, uint8_t value = 0xFF) {
+// Fill a settings request payload. Returns the size of the payload.
+size_t fillPayload(byte* data, byte service, byte param, uint8_t value) {
+    data[0] = service;
+    data[1] = param;
+    data[2] = value;
+    return 3;
+}
+
+// Fill a settings request payload with data to be sent when the sequence
+// transitions to the given state. Some state transitions require value be
+// attached. Returns the size of the payload or 0 if the state sends nothing.
+size_t fillRequest(byte* data, uint8_t state, uint8_t value = 0xFF) {
     switch (state) {
         case STATE_READY:
-            return false;
+            return 0;
         case STATE_ENTER:
-            return fillRequest(frame, id, 0x02, 0x10, 0xC0);
+            return fillPayload(data, 0x10, 0xC0);
         case STATE_EXIT:
-            return fillRequest(frame, id, 0x02, 0x10, 0x81);
+            return fillPayload(data, 0x10, 0x81);
         case STATE_INIT_00:
-            return fillRequest(frame, id, 0x02, 0x3B, 0x00);
+            return fillPayload(data, 0x3B, 0x00);
         case STATE_INIT_20:
-            return fillRequest(frame, id, 0x02, 0x3B, 0x20);
+            return fillPayload(data, 0x3B, 0x20);
         case STATE_INIT_40:
-            return fillRequest(frame, id, 0x02, 0x3B, 0x40);
+            return fillPayload(data, 0x3B, 0x40);
         case STATE_INIT_60:
-            return fillRequest(frame, id, 0x02, 0x3B, 0x60);
+            return fillPayload(data, 0x3B, 0x60);
         case STATE_AUTO_INTERIOR_ILLUM:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x10, value);
+            return fillPayload(data, 0x3B, 0x10, value);
         case STATE_AUTO_HL_SENS:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x37, value);
+            return fillPayload(data, 0x3B, 0x37, value);
         case STATE_AUTO_HL_DELAY:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x39, value);
+            return fillPayload(data, 0x3B, 0x39, value);
         case STATE_SPEED_SENS_WIPER:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x47, value);
+            return fillPayload(data, 0x3B, 0x47, value);
         case STATE_REMOTE_KEY_HORN:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x2A, value);
+            return fillPayload(data, 0x3B, 0x2A, value);
         case STATE_REMOTE_KEY_LIGHT:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x2E, value);
+            return fillPayload(data, 0x3B, 0x2E, value);
         case STATE_AUTO_RELOCK_TIME_CMD:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x2F, value);
+            return fillPayload(data, 0x3B, 0x2F, value);
         case STATE_SELECT_DOOR_UNLOCK:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x02, value);
+            return fillPayload(data, 0x3B, 0x02, value);
         case STATE_SLIDE_DRIVER_SEAT:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x01, value);
-        case STATE_RETRIEVE_71E_10:
-            return fillRequest(frame, id, 0x02, 0x21, 0x01);
-        case STATE_RETRIEVE_71E_2X:
-            return fillRequest(frame, id, 0x30, 0x00, 0x0A);
-        case STATE_RETRIEVE_71F_05:
-            return fillRequest(frame, id, 0x02, 0x21, 0x01);
+            return fillPayload(data, 0x3B, 0x01, value);
+        case STATE_RETRIEVE:
+            return fillPayload(data, 0x21, 0x01);
         case STATE_RESET:
-            return fillRequest(frame, id, 0x03, 0x3B, 0x1F, 0x00);
+            return fillPayload(data, 0x3B, 0x1F, 0x00);
         default:
-            return false;
+            return 0;
     }
 }
 
-// Match the frame against the given byte prefix.
-bool matchPrefix(const byte* data, byte prefix0) {
-    return data[0] == prefix0;
-}
-
-// Match the frame against the given byte prefix.
-bool matchPrefix(const byte* data, byte prefix0, byte prefix1, byte prefix2) {
-    return data[0] == prefix0 && data[1] == prefix1 && data[2] == prefix2;
+// Match the payload against the given byte prefix.
+bool matchPrefix(const Scratch& payload, byte prefix0, byte prefix1) {
+    return payload.size >= 2 && payload.bytes[0] == prefix0 &&
+        payload.bytes[1] == prefix1;
 }
 
-// Return true if the frame matches the given state.
-bool matchState(const byte* data, uint8_t state) {
+// Return true if the response payload matches the given state.
+bool matchState(const Scratch& payload, uint8_t state) {
     switch (state) {
         case STATE_READY:
             return false;
         case STATE_ENTER:
-            return matchPrefix(data, 0x02, 0x50, 0xC0);
+            return matchPrefix(payload, 0x50, 0xC0);
         case STATE_EXIT:
-            return matchPrefix(data, 0x02, 0x50, 0x81);
+            return matchPrefix(payload, 0x50, 0x81);
         case STATE_INIT_00:
-            return matchPrefix(data, 0x06, 0x7B, 0x00);
+            return matchPrefix(payload, 0x7B, 0x00);
         case STATE_INIT_20:
-            return matchPrefix(data, 0x06, 0x7B, 0x20);
+            return matchPrefix(payload, 0x7B, 0x20);
         case STATE_INIT_40:
-            return matchPrefix(data, 0x06, 0x7B, 0x40);
+            return matchPrefix(payload, 0x7B, 0x40);
         case STATE_INIT_60:
-            return matchPrefix(data, 0x06, 0x7B, 0x60);
+            return matchPrefix(payload, 0x7B, 0x60);
         case STATE_AUTO_INTERIOR_ILLUM:
-            return matchPrefix(data, 0x02, 0x7B, 0x10);
+            return matchPrefix(payload, 0x7B, 0x10);
         case STATE_AUTO_HL_SENS:
-            return matchPrefix(data, 0x02, 0x7B, 0x37);
+            return matchPrefix(payload, 0x7B, 0x37);
         case STATE_AUTO_HL_DELAY:
-            return matchPrefix(data, 0x02, 0x7B, 0x39);
+            return matchPrefix(payload, 0x7B, 0x39);
         case STATE_SPEED_SENS_WIPER:
-            return matchPrefix(data, 0x02, 0x7B, 0x47);
+            return matchPrefix(payload, 0x7B, 0x47);
         case STATE_REMOTE_KEY_HORN:
-            return matchPrefix(data, 0x02, 0x7B, 0x2A);
+            return matchPrefix(payload, 0x7B, 0x2A);
         case STATE_REMOTE_KEY_LIGHT:
-            return matchPrefix(data, 0x02, 0x7B, 0x2E);
+            return matchPrefix(payload, 0x7B, 0x2E);
         case STATE_AUTO_RELOCK_TIME_CMD:
-            return matchPrefix(data, 0x02, 0x7B, 0x2F);
+            return matchPrefix(payload, 0x7B, 0x2F);
         case STATE_SELECT_DOOR_UNLOCK:
-            return matchPrefix(data, 0x02, 0x7B, 0x02);
+            return matchPrefix(payload, 0x7B, 0x02);
         case STATE_SLIDE_DRIVER_SEAT:
-            return matchPrefix(data, 0x02, 0x7B, 0x01);
-        case STATE_RETRIEVE_71E_10:
-            return matchPrefix(data, 0x10);
-        case STATE_RETRIEVE_71E_2X:
-            return matchPrefix(data, 0x21) || matchPrefix(data, 0x22);
-        case STATE_RETRIEVE_71F_05:
-            return matchPrefix(data, 0x05);
+            return matchPrefix(payload, 0x7B, 0x01);
+        case STATE_RETRIEVE:
+            return matchPrefix(payload, 0x61, 0x01);
         case STATE_RESET:
-            return matchPrefix(data, 0x02, 0x7B, 0x1F);
+            return matchPrefix(payload, 0x7B, 0x1F);
         default:
             return false;
     }
 }
 
+// Return true if the state sends a setting to the BCM.
+bool isUpdateState(uint8_t state) {
+    return state >= STATE_AUTO_INTERIOR_ILLUM && state <= STATE_SLIDE_DRIVER_SEAT;
+}
+
 // Return true if auto interior illumination is enabled.
 bool getAutoInteriorIllumination(const Event& event) {
     return getBit(event.data, 0, 0);
@@ -291,9 +290,12 @@ void setSlideDriverSeatBackOnExit(Event* event, bool value) {
 // Send a sequence of frames for managing settings.
 class SettingsSequence {
     public:
+        // Time to wait for the response to each request in the sequence.
+        static const uint32_t kStepTimeout = 500;
+
         // Create a sequence that communicates over the given frame ID.
         SettingsSequence(SettingsFrameId id, Faker::Clock* clock = Faker::Clock::real()) :
-            request_id_((uint32_t)id), clock_(clock), started_(0),
+            request_id_((uint32_t)id), clock_(clock), step_started_(0),
             value_(0xFF), state_(0), sent_(false) {}
         virtual ~SettingsSequence() = default;
 
@@ -304,7 +306,7 @@ class SettingsSequence {
             if (state_ != STATE_READY) {
                 return false;
             }
-            started_ = clock_->millis();
+            step_started_ = clock_->millis();
             state_ = STATE_ENTER;
             sent_ = false;
             return true;
@@ -315,37 +317,41 @@ class SettingsSequence {
             return state_ == STATE_READY;
         }
 
-        // Read the next outgoing frame in the sequence if available. Return
-        // true if the frame should be sent or false otherwise.
-        bool read(Canny::CAN20Frame* frame) {
-            if (clock_->millis() - started_ >= 500) {
-                state_ = STATE_READY;
-                return false;
+        // Send the next request in the sequence over the link if one is due.
+        // Return true if the request was sent. A step which times out ends
+        // the sequence, with an exit request if the BCM session was entered.
+        bool send(IsoTP* link) {
+            if (state_ != STATE_READY &&
+                    clock_->millis() - step_started_ >= kStepTimeout) {
+                if (state_ == STATE_ENTER || state_ == STATE_EXIT) {
+                    state_ = STATE_READY;
+                    return false;
+                }
+                advance(STATE_EXIT);
             }
             if (state_ == STATE_READY || sent_) {
                 return false;
             }
+            byte data[3];
+            size_t size = fillRequest(data, state_, value_);
+            if (size == 0 || !link->send(data, size)) {
+                return false;
+            }
             sent_ = true;
-            return fillRequest(frame, request_id_, state_, value_);
+            return true;
         }
 
-        // Handle the next incoming frame in the sequence. If the frame matches
-        // the next expected frame in the sequence then the sequence advances
-        // to the next state and read will fill the next outgoing frame.
-        // Otherwise the sequence resets and becomes ready.
-        void handle(const Canny::CAN20Frame& frame) {
-            if (frame.id() != responseId(request_id_)) {
-                // not destined for this sequence
-                return;
-            }
-            if (!matchState(frame.data(), state_)) {
-                // frame does not match the current state
+        // Handle the next response payload in the sequence. If the payload
+        // matches the next expected response then the sequence advances to
+        // the next state and send will send the next request.
+        void handle(const Scratch& payload) {
+            if (!matchState(payload, state_)) {
+                // payload does not match the current state
                 return;
             }
             uint8_t nextState = next();
             if (state_ != nextState) {
-                state_ = nextState;
-                sent_ = false;
+                advance(nextState);
             }
         }
 
@@ -362,17 +368,24 @@ class SettingsSequence {
         // Return the next state. If the returned state matches the incoming
         // rame then the sequence transitions to the new state and a frame for
         // the state is sent. If this returns the no state transition occurs
-        // and no frame is sent.
+        // and no frame is sent. The F sequence follows the E sequence unless
+        // overridden.
         virtual uint8_t nextE() = 0;
-        virtual uint8_t nextF() = 0;
+        virtual uint8_t nextF() { return nextE(); }
     private:
         const uint32_t request_id_;
         Faker::Clock* clock_;
-        uint32_t started_;
+        uint32_t step_started_;
         uint8_t value_;
         uint8_t state_;
         bool sent_;
 
+        void advance(uint8_t state) {
+            step_started_ = clock_->millis();
+            state_ = state;
+            sent_ = false;
+        }
+
         uint8_t next() {
             switch (request_id_) {
                 case SETTINGS_FRAME_E:
@@ -424,133 +437,154 @@ class SettingsInit : public SettingsSequence {
 class SettingsRetrieve : public SettingsSequence {
     public:
         SettingsRetrieve(SettingsFrameId id, Faker::Clock* clock = Faker::Clock::real()) :
-            SettingsSequence(id, clock), state2x_(false) {}
+            SettingsSequence(id, clock) {}
     protected:
         uint8_t nextE() override {
             switch (state()) {
                 case STATE_ENTER:
-                    return STATE_RETRIEVE_71E_10;
-                case STATE_RETRIEVE_71E_10:
-                    state2x_ = false;
-                    return STATE_RETRIEVE_71E_2X;
-                case STATE_RETRIEVE_71E_2X:
-                    if (state2x_) {
-                        return STATE_EXIT;
-                    } else {
-                        state2x_ = true;
-                        return STATE_RETRIEVE_71E_2X;
-                    }
-                default:
-                    return STATE_READY;
-            }
-        }
-
-        uint8_t nextF() override {
-            switch (state()) {
-                case STATE_ENTER:
-                    return STATE_RETRIEVE_71F_05;
-                case STATE_RETRIEVE_71F_05:
+                    return STATE_RETRIEVE;
+                case STATE_RETRIEVE:
                     return STATE_EXIT;
                 default:
                     return STATE_READY;
             }
         }
-
-    private:
-        bool state2x_;
 };
 
-// Sequence used to update a setting in the BCM.
+// Sequence used to update settings in the BCM. Changes are queued and sent
+// back to back in a single session followed by one retrieve of the new
+// settings. A change the BCM does not confirm within kMaxAttempts sessions is
+// dropped so that an absent or refusing BCM is not retried forever.
 class SettingsUpdate : public SettingsSequence {
     public:
+        // Maximum number of changes waiting to be sent.
+        static const size_t kMaxChanges = 8;
+
+        // Number of sessions in which a change is sent before it is dropped.
+        static const uint8_t kMaxAttempts = 2;
+
         SettingsUpdate(SettingsFrameId id, Faker::Clock* clock = Faker::Clock::real()) :
-            SettingsSequence(id, clock), update_(0), state2x_(false) {}
+            SettingsSequence(id, clock), size_(0), pos_(0), confirmed_(0),
+            attempts_(0), dropped_(false) {}
+
+        // Queue a change to the given item. A change to an item which has not
+        // been sent yet replaces that change. Returns false if the queue is
+        // full.
+        bool push(uint8_t update, uint8_t value) {
+            // Changes sent by a running session are in flight. Those left
+            // unconfirmed by a finished session will be sent again.
+            for (size_t i = ready() ? confirmed_ : pos_; i < size_; ++i) {
+                if (changes_[i].update == update) {
+                    changes_[i].value = value;
+                    return true;
+                }
+            }
+            if (size_ >= kMaxChanges) {
+                return false;
+            }
+            changes_[size_].update = update;
+            changes_[size_].value = value;
+            ++size_;
+            return true;
+        }
+
+        // Return true if changes are waiting to be sent or confirmed.
+        bool pending() const { return confirmed_ < size_; }
+
+        // Start a session for the queued changes. Changes confirmed by the
+        // BCM in the previous session are dropped; its retrieve reports their
+        // outcome. Changes it did not confirm are sent again. The first
+        // unconfirmed change is dropped instead once it has been sent in
+        // kMaxAttempts sessions without any change being confirmed.
+        bool start() {
+            if (!ready() || !pending()) {
+                return false;
+            }
+            if (confirmed_ > 0) {
+                attempts_ = 0;
+            } else if (attempts_ >= kMaxAttempts) {
+                confirmed_ = 1;
+                attempts_ = 0;
+                dropped_ = true;
+            }
+            for (size_t i = confirmed_; i < size_; ++i) {
+                changes_[i - confirmed_] = changes_[i];
+            }
+            size_ -= confirmed_;
+            pos_ = 0;
+            confirmed_ = 0;
+            if (size_ == 0) {
+                return false;
+            }
+            ++attempts_;
+            return trigger();
+        }
 
-        // Set the item to update and its value. 
-        void setPayload(uint8_t update, uint8_t value) {
-            update_ = update;
-            setValue(value);
+        // Return true if a change was dropped since the last call.
+        bool dropped() {
+            bool dropped = dropped_;
+            dropped_ = false;
+            return dropped;
         }
+
     protected:
         uint8_t nextE() override {
             const uint8_t state = this->state();
-            if (state == STATE_ENTER) {
-                return update_;
-            } else if (state == update_) {
-                return STATE_RETRIEVE_71E_10;
-            } else if (state == STATE_RETRIEVE_71E_10) {
-                state2x_ = false;
-                return STATE_RETRIEVE_71E_2X;
-            } else if (state == STATE_RETRIEVE_71E_2X) {
-                if (state2x_) {
-                    return STATE_EXIT;
-                } else {
-                    state2x_ = true;
-                    return STATE_RETRIEVE_71E_2X;
-                }
+            if (isUpdateState(state)) {
+                // the BCM confirmed the change just sent
+                confirmed_ = pos_;
             }
-            return STATE_READY;
-        }
-
-        uint8_t nextF() override {
-            const uint8_t state = this->state();
-            if (state == STATE_ENTER) {
-                return update_;
-            } else if (state == update_) {
-                return STATE_RETRIEVE_71F_05;
-            } else if (state == STATE_RETRIEVE_71F_05) {
+            if (state == STATE_ENTER || isUpdateState(state)) {
+                return nextChange();
+            } else if (state == STATE_RETRIEVE) {
                 return STATE_EXIT;
             }
             return STATE_READY;
         }
 
     private:
-        uint8_t update_;
-        bool state2x_;
+        struct Change {
+            uint8_t update;
+            uint8_t value;
+        };
+
+        Change changes_[kMaxChanges];
+        size_t size_;
+        size_t pos_;
+        size_t confirmed_;
+        uint8_t attempts_;
+        bool dropped_;
+
+        // Return the state of the next change or retrieve once all changes
+        // are sent. A change to the item just sent waits for the next session
+        // since the sequence can't repeat a state.
+        uint8_t nextChange() {
+            if (pos_ >= size_ || changes_[pos_].update == state()) {
+                return STATE_RETRIEVE;
+            }
+            setValue(changes_[pos_].value);
+            return changes_[pos_++].update;
+        }
 };
 
 // Sequence used to reset all settings to factory values.
 class SettingsReset : public SettingsSequence {
     public:
         SettingsReset(SettingsFrameId id, Faker::Clock* clock = Faker::Clock::real()) :
-            SettingsSequence(id, clock), state2x_(false) {}
+            SettingsSequence(id, clock) {}
     protected:
         uint8_t nextE() override {
             switch (state()) {
                 case STATE_ENTER:
                     return STATE_RESET;
                 case STATE_RESET:
-                    return STATE_RETRIEVE_71E_10;
-                case STATE_RETRIEVE_71E_10:
-                    state2x_ = false;
-                    return STATE_RETRIEVE_71E_2X;
-                case STATE_RETRIEVE_71E_2X:
-                    if (state2x_) {
-                        return STATE_EXIT;
-                    } else {
-                        state2x_ = true;
-                        return STATE_RETRIEVE_71E_2X;
-                    }
-                default:
-                    return STATE_READY;
-            }
-        }
-
-        uint8_t nextF() override {
-            switch (state()) {
-                case STATE_ENTER:
-                    return STATE_RESET;
-                case STATE_RESET:
-                    return STATE_RETRIEVE_71F_05;
-                case STATE_RETRIEVE_71F_05:
+                    return STATE_RETRIEVE;
+                case STATE_RETRIEVE:
                     return STATE_EXIT;
                 default:
                     return STATE_READY;
             }
         }
-
-    private:
-        bool state2x_;
 };
 
 Settings::Settings(Faker::Clock* clock) :
@@ -562,8 +596,11 @@ Settings::Settings(Faker::Clock* clock) :
         retrieveF_(new SettingsRetrieve(SETTINGS_FRAME_F, clock)),
         updateF_(new SettingsUpdate(SETTINGS_FRAME_F, clock)),
         resetF_(new SettingsReset(SETTINGS_FRAME_F, clock)),
+        linkE_(SETTINGS_FRAME_E, responseId(SETTINGS_FRAME_E), 0, kStMin, clock),
+        linkF_(SETTINGS_FRAME_F, responseId(SETTINGS_FRAME_F), 0, kStMin, clock),
         available_(false), frame_(0, 0, 8),
-        event_((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::STATE, (uint8_t[]){0x00, 0x00, 0x00, 0x00}) {
+        event_((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::STATE, (uint8_t[]){0x00, 0x00, 0x00, 0x00}),
+        staged_(event_) {
 }
 
 Settings::~Settings() {
@@ -577,6 +614,12 @@ Settings::~Settings() {
         delete resetF_;
 }
 
+void Settings::subscribe(Subscription* sub) {
+    sub->canFrame(0x72E, 0x72F);
+    sub->event((uint8_t)SubSystem::CONTROLLER, (uint8_t)ControllerEvent::REQUEST_CMD);
+    sub->event((uint8_t)SubSystem::SETTINGS);
+}
+
 void Settings::handle(const Message& msg, const Caster::Yield<Message>&) {
     switch (msg.type()) {
         case Message::CAN_FRAME:
@@ -648,55 +691,45 @@ void Settings::handleEvent(const Event& event) {
 }
 
 void Settings::handleFrame(const Canny::CAN20Frame& frame) {
-    if (frame.size() < 8) {
-        return;
-    }
-    if (frame.id() == responseId(SETTINGS_FRAME_E)) {
-        initE_->handle(frame);
-        retrieveE_->handle(frame);
-        updateE_->handle(frame);
-        resetE_->handle(frame);
-        handleState(frame.data());
-    } else if (frame.id() == responseId(SETTINGS_FRAME_F)) {
-        initF_->handle(frame);
-        retrieveF_->handle(frame);
-        updateF_->handle(frame);
-        resetF_->handle(frame);
-        handleState(frame.data());
-    }
-}
-
-void Settings::handleState(const byte* data) {
-    if (matchPrefix(data, 0x05)) {
-        handleState05(data);
-        available_ = true;
-    } else if (matchPrefix(data, 0x10)) {
-        handleState10(data);
-        available_ = true;
-    } else if (matchPrefix(data, 0x21)) {
-        handleState21(data);
-        available_ = true;
-    } else if (matchPrefix(data, 0x22)) {
-        handleState22(data);
-        available_ = true;
+    if (linkE_.receive(frame)) {
+        const Scratch& payload = linkE_.payload();
+        initE_->handle(payload);
+        retrieveE_->handle(payload);
+        updateE_->handle(payload);
+        resetE_->handle(payload);
+        if (matchPrefix(payload, 0x61, 0x01) && payload.size >= 14) {
+            handleStateE(payload.bytes);
+            available_ = true;
+        }
+    } else if (linkF_.receive(frame)) {
+        const Scratch& payload = linkF_.payload();
+        initF_->handle(payload);
+        retrieveF_->handle(payload);
+        updateF_->handle(payload);
+        resetF_->handle(payload);
+        if (matchPrefix(payload, 0x61, 0x01) && payload.size >= 3) {
+            handleStateF(payload.bytes);
+            available_ = true;
+        }
     }
 }
 
-void Settings::handleState05(const byte* data) {
-    setSlideDriverSeatBackOnExit(&event_, getBit(data, 3, 0));
+void Settings::handleStateF(const byte* data) {
+    setSlideDriverSeatBackOnExit(&event_, getBit(data, 2, 0));
 }
 
-void Settings::handleState10(const byte* data) {
-    setAutoInteriorIllumination(&event_, getBit(data, 4, 5));
-    setSelectiveDoorUnlock(&event_, getBit(data, 4, 7));
-    setRemoteKeyResponseHorn(&event_, getBit(data, 7, 3));
-}
+// The E response holds most settings. The payload is 0x61 0x01 followed by
+// the settings bytes.
+void Settings::handleStateE(const byte* data) {
+    setAutoInteriorIllumination(&event_, getBit(data, 2, 5));
+    setSelectiveDoorUnlock(&event_, getBit(data, 2, 7));
+    setRemoteKeyResponseHorn(&event_, getBit(data, 5, 3));
+    setSpeedSensingWiperInterval(&event_, !getBit(data, 13, 7));
 
-void Settings::handleState21(const byte* data) {
     // Translates incoming state to our own state representation. A 0 value
     // typically represents the default on the BCM side.
 
-    switch ((data[1] >> 6) & 0x03) {
+    switch ((data[6] >> 6) & 0x03) {
         case 0x00:
             setRemoteKeyResponseLights(&event_, LIGHTS_OFF);
             break;
@@ -711,7 +744,7 @@ void Settings::handleState21(const byte* data) {
             break;
     }
 
-    switch ((data[1] >> 4) & 0x03) {
+    switch ((data[6] >> 4) & 0x03) {
         case 0x00:
             setAutoReLockTime(&event_, RELOCK_1M);
             break;
@@ -723,7 +756,7 @@ void Settings::handleState21(const byte* data) {
             break;
     }
 
-    switch ((data[2] >> 2) & 0x03) {
+    switch ((data[7] >> 2) & 0x03) {
         case 0x03:
             setAutoHeadlightSensitivity(&event_, 0);
             break;
@@ -738,7 +771,7 @@ void Settings::handleState21(const byte* data) {
             break;
     }
 
-    switch (((data[2] & 0x01) << 2) | ((data[3] >> 6) & 0x03)) {
+    switch (((data[7] & 0x01) << 2) | ((data[8] >> 6) & 0x03)) {
         case 0x01:
             setAutoHeadlightOffDelay(&event_, DELAY_0S);
             break;
@@ -766,34 +799,39 @@ void Settings::handleState21(const byte* data) {
     }
 }
 
-void Settings::handleState22(const byte* data) {
-    setSpeedSensingWiperInterval(&event_, !getBit(data, 1, 7));
-}
-
 void Settings::emit(const Caster::Yield<Message>& yield) {
-    if (initE_->read(&frame_)) {
-        yield(MessageView(&frame_));
-    }
-    if (retrieveE_->read(&frame_)) {
-        yield(MessageView(&frame_));
-    }
-    if (updateE_->read(&frame_)) {
-        yield(MessageView(&frame_));
+    // Start a session for queued changes once the BCM is free.
+    if (readyE()) {
+        updateE_->start();
     }
-    if (resetE_->read(&frame_)) {
-        yield(MessageView(&frame_));
+    if (readyF()) {
+        updateF_->start();
     }
-    if (initF_->read(&frame_)) {
-        yield(MessageView(&frame_));
+    // Changes the BCM never confirmed are lost. Stage further changes against
+    // the settings it last reported.
+    if (updateE_->dropped()) {
+        staged_ = event_;
     }
-    if (retrieveF_->read(&frame_)) {
-        yield(MessageView(&frame_));
+    if (updateF_->dropped()) {
+        staged_ = event_;
     }
-    if (updateF_->read(&frame_)) {
+
+    initE_->send(&linkE_);
+    retrieveE_->send(&linkE_);
+    updateE_->send(&linkE_);
+    resetE_->send(&linkE_);
+    initF_->send(&linkF_);
+    retrieveF_->send(&linkF_);
+    updateF_->send(&linkF_);
+    resetF_->send(&linkF_);
+
+    while (linkE_.next(&frame_)) {
         yield(MessageView(&frame_));
+        linkE_.pop();
     }
-    if (resetF_->read(&frame_)) {
+    while (linkF_.next(&frame_)) {
         yield(MessageView(&frame_));
+        linkF_.pop();
     }
     if (ready() && available_) {
         available_ = false;
@@ -820,193 +858,241 @@ bool Settings::ready() const {
     return readyE() && readyF();
 }
 
+Event* Settings::stage() {
+    // Changes are made against the settings as they will be once the queued
+    // changes are applied so that repeated commands build on each other.
+    if (updateE_->ready() && !updateE_->pending() &&
+            updateF_->ready() && !updateF_->pending()) {
+        staged_ = event_;
+    }
+    return &staged_;
+}
+
 bool Settings::toggleAutoInteriorIllumination() {
-    if (!readyE()) {
+    Event* staged = stage();
+    bool value = !getAutoInteriorIllumination(*staged);
+    if (!updateE_->push(STATE_AUTO_INTERIOR_ILLUM, value)) {
         return false;
     }
-    updateE_->setPayload(STATE_AUTO_INTERIOR_ILLUM, !getAutoInteriorIllumination(event_));
-    return updateE_->trigger();
+    setAutoInteriorIllumination(staged, value);
+    return true;
 }
 
 bool Settings::nextAutoHeadlightSensitivity() {
-    return triggerAutoHeadlightSensitivity(getAutoHeadlightSensitivity(event_) + 1);
+    return triggerAutoHeadlightSensitivity(getAutoHeadlightSensitivity(*stage()) + 1);
 }
 
 bool Settings::prevAutoHeadlightSensitivity() {
-    return triggerAutoHeadlightSensitivity(getAutoHeadlightSensitivity(event_) - 1);
+    return triggerAutoHeadlightSensitivity(getAutoHeadlightSensitivity(*stage()) - 1);
 }
 
 bool Settings::triggerAutoHeadlightSensitivity(uint8_t value) {
-    if (!readyE() || value > 3) {
-        return false;
-    }
+    uint8_t payload;
     switch (value) {
         case 0:
-            updateE_->setPayload(STATE_AUTO_HL_SENS, 0x03);
+            payload = 0x03;
             break;
         case 1:
-            updateE_->setPayload(STATE_AUTO_HL_SENS, 0x00);
+            payload = 0x00;
             break;
         case 2:
-            updateE_->setPayload(STATE_AUTO_HL_SENS, 0x01);
+            payload = 0x01;
             break;
         case 3:
-            updateE_->setPayload(STATE_AUTO_HL_SENS, 0x02);
+            payload = 0x02;
             break;
         default:
             return false;
     }
-    return updateE_->trigger();
+    if (!updateE_->push(STATE_AUTO_HL_SENS, payload)) {
+        return false;
+    }
+    setAutoHeadlightSensitivity(stage(), value);
+    return true;
 }
 
 bool Settings::nextAutoHeadlightOffDelay() {
-    if (!readyE()) {
-        return false;
-    }
-    switch (getAutoHeadlightOffDelay(event_)) {
+    switch (getAutoHeadlightOffDelay(*stage())) {
         case DELAY_0S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x02);
-            break;
+            return triggerAutoHeadlightOffDelay(DELAY_30S);
         case DELAY_30S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x00);
-            break;
+            return triggerAutoHeadlightOffDelay(DELAY_45S);
         case DELAY_45S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x03);
-            break;
+            return triggerAutoHeadlightOffDelay(DELAY_60S);
         case DELAY_60S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x04);
-            break;
+            return triggerAutoHeadlightOffDelay(DELAY_90S);
         case DELAY_90S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x05);
-            break;
+            return triggerAutoHeadlightOffDelay(DELAY_120S);
         case DELAY_120S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x06);
-            break;
+            return triggerAutoHeadlightOffDelay(DELAY_150S);
         case DELAY_150S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x07);
-            break;
+            return triggerAutoHeadlightOffDelay(DELAY_180S);
         case DELAY_180S:
         default:
             return false;
     }
-    return updateE_->trigger();
 }
 
 bool Settings::prevAutoHeadlightOffDelay() {
-    if (!readyE()) {
-        return false;
-    }
-    switch (getAutoHeadlightOffDelay(event_)) {
+    switch (getAutoHeadlightOffDelay(*stage())) {
         default:
         case DELAY_0S:
             return false;
         case DELAY_30S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x01);
+            return triggerAutoHeadlightOffDelay(DELAY_0S);
+        case DELAY_45S:
+            return triggerAutoHeadlightOffDelay(DELAY_30S);
+        case DELAY_60S:
+            return triggerAutoHeadlightOffDelay(DELAY_45S);
+        case DELAY_90S:
+            return triggerAutoHeadlightOffDelay(DELAY_60S);
+        case DELAY_120S:
+            return triggerAutoHeadlightOffDelay(DELAY_90S);
+        case DELAY_150S:
+            return triggerAutoHeadlightOffDelay(DELAY_120S);
+        case DELAY_180S:
+            return triggerAutoHeadlightOffDelay(DELAY_150S);
+    }
+}
+
+bool Settings::triggerAutoHeadlightOffDelay(uint8_t value) {
+    uint8_t payload;
+    switch (value) {
+        case DELAY_0S:
+            payload = 0x01;
+            break;
+        case DELAY_30S:
+            payload = 0x02;
             break;
         case DELAY_45S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x02);
+            payload = 0x00;
             break;
         case DELAY_60S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x00);
+            payload = 0x03;
             break;
         case DELAY_90S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x03);
+            payload = 0x04;
             break;
         case DELAY_120S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x04);
+            payload = 0x05;
             break;
         case DELAY_150S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x05);
+            payload = 0x06;
             break;
         case DELAY_180S:
-            updateE_->setPayload(STATE_AUTO_HL_DELAY, 0x06);
+            payload = 0x07;
             break;
+        default:
+            return false;
     }
-    return updateE_->trigger();
+    if (!updateE_->push(STATE_AUTO_HL_DELAY, payload)) {
+        return false;
+    }
+    setAutoHeadlightOffDelay(stage(), (AutoHeadlightOffDelay)value);
+    return true;
 }
 
 bool Settings::toggleSpeedSensingWiperInterval() {
-    if (!readyE()) {
+    Event* staged = stage();
+    bool value = getSpeedSensingWiperInterval(*staged);
+    // the BCM stores this setting inverted
+    if (!updateE_->push(STATE_SPEED_SENS_WIPER, value)) {
         return false;
     }
-    updateE_->setPayload(STATE_SPEED_SENS_WIPER, getSpeedSensingWiperInterval(event_));
-    return updateE_->trigger();
+    setSpeedSensingWiperInterval(staged, !value);
+    return true;
 }
 
 bool Settings::toggleRemoteKeyResponseHorn() {
-    if (!readyE()) {
+    Event* staged = stage();
+    bool value = !getRemoteKeyResponseHorn(*staged);
+    if (!updateE_->push(STATE_REMOTE_KEY_HORN, value)) {
         return false;
     }
-    updateE_->setPayload(STATE_REMOTE_KEY_HORN, !getRemoteKeyResponseHorn(event_));
-    return updateE_->trigger();
+    setRemoteKeyResponseHorn(staged, value);
+    return true;
 }
 
 bool Settings::nextRemoteKeyResponseLights() {
-    return triggerRemoteKeyResponseLights(getRemoteKeyResponseLights(event_) + 1);
+    return triggerRemoteKeyResponseLights(getRemoteKeyResponseLights(*stage()) + 1);
 }
 
 bool Settings::prevRemoteKeyResponseLights() {
-    return triggerRemoteKeyResponseLights(getRemoteKeyResponseLights(event_) - 1);
+    return triggerRemoteKeyResponseLights(getRemoteKeyResponseLights(*stage()) - 1);
 }
 
 bool Settings::triggerRemoteKeyResponseLights(uint8_t value) {
-    if (!readyE() || value > 3) {
+    if (value > 3 || !updateE_->push(STATE_REMOTE_KEY_LIGHT, value)) {
         return false;
     }
-    updateE_->setPayload(STATE_REMOTE_KEY_LIGHT, value);
-    return updateE_->trigger();
+    setRemoteKeyResponseLights(stage(), (RemoteKeyResponseLights)value);
+    return true;
 }
 
 bool Settings::nextAutoReLockTime() {
-    if (!readyE()) {
-        return false;
-    }
-    switch (getAutoReLockTime(event_)) {
+    switch (getAutoReLockTime(*stage())) {
         case RELOCK_OFF:
-            updateE_->setPayload(STATE_AUTO_RELOCK_TIME_CMD, 0x00);
-            break;
+            return triggerAutoReLockTime(RELOCK_1M);
         case RELOCK_1M:
-            updateE_->setPayload(STATE_AUTO_RELOCK_TIME_CMD, 0x02);
-            break;
+            return triggerAutoReLockTime(RELOCK_5M);
         case RELOCK_5M:
         default:
             return false;
     }
-    return updateE_->trigger();
 }
 
 bool Settings::prevAutoReLockTime() {
-    if (!readyE()) {
-        return false;
-    }
-    switch (getAutoReLockTime(event_)) {
+    switch (getAutoReLockTime(*stage())) {
         default:
         case RELOCK_OFF:
             return false;
         case RELOCK_1M:
-            updateE_->setPayload(STATE_AUTO_RELOCK_TIME_CMD, 0x01);
+            return triggerAutoReLockTime(RELOCK_OFF);
+        case RELOCK_5M:
+            return triggerAutoReLockTime(RELOCK_1M);
+    }
+}
+
+bool Settings::triggerAutoReLockTime(uint8_t value) {
+    uint8_t payload;
+    switch (value) {
+        case RELOCK_OFF:
+            payload = 0x01;
+            break;
+        case RELOCK_1M:
+            payload = 0x00;
             break;
         case RELOCK_5M:
-            updateE_->setPayload(STATE_AUTO_RELOCK_TIME_CMD, 0x00);
+            payload = 0x02;
             break;
+        default:
+            return false;
     }
-    return updateE_->trigger();
+    if (!updateE_->push(STATE_AUTO_RELOCK_TIME_CMD, payload)) {
+        return false;
+    }
+    setAutoReLockTime(stage(), (AutoReLockTime)value);
+    return true;
 }
 
 bool Settings::toggleSelectiveDoorUnlock() {
-    if (!readyE()) {
+    Event* staged = stage();
+    bool value = !getSelectiveDoorUnlock(*staged);
+    if (!updateE_->push(STATE_SELECT_DOOR_UNLOCK, value)) {
         return false;
     }
-    updateE_->setPayload(STATE_SELECT_DOOR_UNLOCK, !getSelectiveDoorUnlock(event_));
-    return updateE_->trigger();
+    setSelectiveDoorUnlock(staged, value);
+    return true;
 }
 
 bool Settings::toggleSlideDriverSeatBackOnExit() {
-    if (!readyF()) {
+    Event* staged = stage();
+    bool value = !getSlideDriverSeatBackOnExit(*staged);
+    if (!updateF_->push(STATE_SLIDE_DRIVER_SEAT, value)) {
         return false;
     }
-    updateF_->setPayload(STATE_SLIDE_DRIVER_SEAT, !getSlideDriverSeatBackOnExit(event_));
-    return updateF_->trigger();
+    setSlideDriverSeatBackOnExit(staged, value);
+    return true;
 }
 
 bool Settings::requestCurrent() {
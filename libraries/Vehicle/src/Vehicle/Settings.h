@@ -34,7 +34,11 @@ class SettingsUpdate;
 class SettingsReset;
 
 // Communicates with the BCM to retrieve and update body control settings.
-class Settings : public Caster::Node<Message> {
+// Settings commands are queued and sent together in a single session with the
+// BCM, so several changes made in quick succession cost one round trip.
+// Requests and responses are ISO-TP payloads so multi-frame responses are
+// reassembled by the transport rather than by the settings sequences.
+class Settings : public Caster::Node<Message>, public Subscriber {
     public:
         Settings(Faker::Clock* clock = Faker::Clock::real());
         ~Settings();
@@ -42,6 +46,9 @@ class Settings : public Caster::Node<Message> {
         // Exchange init frames with BCM. 
         void init(const Caster::Yield<Message>&) override;
 
+        // Subscribe to BCM state frames, requests, and settings commands.
+        void subscribe(Subscription* sub) override;
+
         // Handle BCM state frames 0x72E and 0x72F.
         void handle(const Message& msg, const Caster::Yield<Message>&) override;
 
@@ -52,11 +59,8 @@ class Settings : public Caster::Node<Message> {
     private:
         void handleEvent(const Event& event);
         void handleFrame(const Canny::CAN20Frame& frame);
-        void handleState(const byte* data);
-        void handleState05(const byte* data);
-        void handleState10(const byte* data);
-        void handleState21(const byte* data);
-        void handleState22(const byte* data);
+        void handleStateE(const byte* data);
+        void handleStateF(const byte* data);
 
         SettingsInit* initE_;
         SettingsRetrieve* retrieveE_;
@@ -68,14 +72,22 @@ class Settings : public Caster::Node<Message> {
         SettingsUpdate* updateF_;
         SettingsReset* resetF_;
 
+        // ISO-TP links to the BCM over the E and F frame IDs.
+        IsoTP linkE_;
+        IsoTP linkF_;
+
         bool available_;
         Canny::CAN20Frame frame_;
         Event event_;
+        Event staged_;
 
         bool readyE() const;
         bool readyF() const;
         bool ready() const;
 
+        // Return the settings with all queued changes applied.
+        Event* stage();
+
         // Request the current settings from the BCM.
         bool requestCurrent();
 
@@ -124,8 +136,14 @@ class Settings : public Caster::Node<Message> {
         // Helper for triggering headlight sensitivity setting changes.
         bool triggerAutoHeadlightSensitivity(uint8_t value);
 
+        // Helper for triggering auto headlight off delay setting changes.
+        bool triggerAutoHeadlightOffDelay(uint8_t value);
+
         // Helper for triggering remote key repsonse lights setting changes.
         bool triggerRemoteKeyResponseLights(uint8_t value);
+
+        // Helper for triggering auto re-lock time setting changes.
+        bool triggerAutoReLockTime(uint8_t value);
 };
 
 }  // namespace R51
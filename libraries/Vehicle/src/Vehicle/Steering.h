@@ -19,7 +19,7 @@ enum class SteeringKey : uint8_t {
 
 // Steering wheel keypad. Sends key press events when steering wheel buttons
 // are pressed and released.
-class SteeringKeypad : public Caster::Node<Message> {
+class SteeringKeypad : public Caster::Node<Message>, public Subscriber {
     public:
         // Construct a new steering switch keypad node. Switches are
         // connected to GPIO pins sw_a_pin and sw_b_pin.
@@ -31,6 +31,9 @@ class SteeringKeypad : public Caster::Node<Message> {
         // Initialize the keypad GPIOs.
         void begin();
 
+        // Noop. This node does not subscribe to any messages.
+        void subscribe(Subscription*) override {}
+
         // Noop. This node does not process messages.
         void handle(const Message&, const Caster::Yield<Message>&) override {}
 
@@ -93,6 +93,57 @@ testF(ClimateTest, Init) {
     assertIsCANFrame(yield.messages()[1], ready541);
 }
 
+testF(ClimateTest, HoldWhileCongested) {
+    Climate climate(0, &clock);
+    initClimate(&climate);
+
+    TxState congested(TxNetwork::CAN);
+    congested.congested(true);
+    climate.handle(MessageView(&congested), yield);
+
+    // Periodic control frames are held while the bus is congested.
+    clock.delay(200);
+    climate.emit(yield);
+    assertSize(yield, 0);
+
+    // Congestion on other networks is ignored.
+    TxState clear(TxNetwork::J1939);
+    climate.handle(MessageView(&clear), yield);
+    climate.emit(yield);
+    assertSize(yield, 0);
+
+    // The held frames are sent once the bus clears.
+    clear.network(TxNetwork::CAN);
+    climate.handle(MessageView(&clear), yield);
+    climate.emit(yield);
+    assertSize(yield, 2);
+    assertEqual(yield.messages()[0].can_frame()->id(), 0x540u);
+    assertEqual(yield.messages()[1].can_frame()->id(), 0x541u);
+}
+
+testF(ClimateTest, HoldExpires) {
+    Climate climate(0, &clock);
+    initClimate(&climate);
+
+    TxState congested(TxNetwork::CAN);
+    congested.congested(true);
+    climate.handle(MessageView(&congested), yield);
+
+    // Refreshed congestion keeps the frames held.
+    clock.delay(TxHold::kTimeout - 1);
+    climate.handle(MessageView(&congested), yield);
+    clock.delay(TxHold::kTimeout - 1);
+    climate.emit(yield);
+    assertSize(yield, 0);
+
+    // The hold is released if the drained event is lost.
+    clock.delay(1);
+    climate.emit(yield);
+    assertSize(yield, 2);
+    assertEqual(yield.messages()[0].can_frame()->id(), 0x540u);
+    assertEqual(yield.messages()[1].can_frame()->id(), 0x541u);
+}
+
 testF(ClimateTest, RequestSystemState) {
     Climate climate(0, &clock);
     initClimate(&climate);
@@ -0,0 +1,86 @@
+#include <AUnit.h>
+#include <Arduino.h>
+#include <Test.h>
+#include <Vehicle.h>
+
+namespace R51 {
+
+using namespace aunit;
+
+// Typed accessors for every field of Vehicle's schemas.
+const EventAccessor kVehicleAccessors[] = {
+    EVENT_ACCESSOR("climate_system", ClimateSystemState, "mode", mode),
+    EVENT_ACCESSOR("climate_system", ClimateSystemState, "ac", ac),
+    EVENT_ACCESSOR("climate_system", ClimateSystemState, "dual", dual),
+    EVENT_ACCESSOR("climate_airflow", ClimateAirflowState, "fan", fan_speed),
+    EVENT_ACCESSOR("climate_airflow", ClimateAirflowState, "face", face),
+    EVENT_ACCESSOR("climate_airflow", ClimateAirflowState, "feet", feet),
+    EVENT_ACCESSOR("climate_airflow", ClimateAirflowState, "windshield", windshield),
+    EVENT_ACCESSOR("climate_airflow", ClimateAirflowState, "recirculate", recirculate),
+    EVENT_ACCESSOR("climate_temp", ClimateTempState, "driver", driver_temp),
+    EVENT_ACCESSOR("climate_temp", ClimateTempState, "passenger", passenger_temp),
+    EVENT_ACCESSOR("climate_temp", ClimateTempState, "outside", outside_temp),
+    EVENT_ACCESSOR("climate_temp", ClimateTempState, "units", units),
+    EVENT_ACCESSOR("illum", IllumState, "illum", illum),
+};
+
+// Events which have no event class. Their nodes read and write the data
+// directly so the schema is the only description of the layout.
+const char* const kUntyped[] = {"tire_pressure", "tire_swap", "ipdm_power"};
+
+bool isVehicle(const EventSchema& schema) {
+    switch ((SubSystem)schema.subsystem) {
+        case SubSystem::ECM:
+        case SubSystem::IPDM:
+        case SubSystem::BCM:
+        case SubSystem::CLIMATE:
+        case SubSystem::SETTINGS:
+            break;
+        default:
+            return false;
+    }
+    for (const char* name : kUntyped) {
+        if (strcmp(schema.name, name) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every field of Vehicle's schemas must match the typed accessor of its event
+// class. A new field or event needs an entry above.
+test(VehicleEventSchemaTest, Accessors) {
+    assertTrue(checkEventAccessors(kVehicleAccessors,
+            sizeof(kVehicleAccessors) / sizeof(kVehicleAccessors[0]), isVehicle));
+}
+
+test(VehicleEventSchemaTest, Print) {
+    ClimateTempState event;
+    event.driver_temp(70);
+    event.passenger_temp(72);
+    event.units(UNITS_US);
+
+    char buffer[128];
+    memset(buffer, 0, sizeof(buffer));
+    Faker::FakeWriteStream stream;
+    stream.set((uint8_t*)buffer, sizeof(buffer) - 1);
+    EventSchemaTable::print(stream, event);
+    assertStringsEqual(buffer, "1A:03#46:48:00:01:FF:FF "
+            "(climate_temp driver=70 passenger=72 outside=0 units=us)");
+}
+
+}  // namespace R51
+
+// Test boilerplate.
+void setup() {
+#ifdef ARDUINO
+    delay(1000);
+#endif
+    SERIAL_PORT_MONITOR.begin(115200);
+    while(!SERIAL_PORT_MONITOR);
+}
+
+void loop() {
+    aunit::TestRunner::run();
+    delay(1);
+}
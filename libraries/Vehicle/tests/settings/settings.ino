@@ -841,6 +841,243 @@ testF(SettingsTest, RemoteKeyResponseLights) {
     checkNoop(&settings, control);
 }
 
+testF(SettingsTest, PipelineChanges) {
+    Settings settings(&clock);
+    FakeYield yield;
+    CAN20Frame frame;
+
+    Event illum((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_AUTO_INTERIOR_ILLUM_CMD);
+    Event unlock((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_SELECTIVE_DOOR_UNLOCK_CMD);
+    Event relock((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::NEXT_AUTO_RELOCK_TIME_CMD);
+
+    // Queue several changes. The second re-lock change builds on the first
+    // and replaces it.
+    settings.handle(MessageView(&illum), yield);
+    settings.handle(MessageView(&unlock), yield);
+    settings.handle(MessageView(&relock), yield);
+    settings.handle(MessageView(&relock), yield);
+    assertSize(yield, 0);
+
+    // Exchange enter frames.
+    settings.emit(yield);
+    fillEnterRequest(&frame, 0x71E);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+    yield.clear();
+    fillEnterResponse(&frame, 0x72E);
+    settings.handle(MessageView(&frame), yield);
+
+    // All changes are sent in the same session.
+    uint8_t commands[] = {0x10, 0x02, 0x2F};
+    uint8_t values[] = {0x01, 0x01, 0x02};
+    for (size_t i = 0; i < 3; ++i) {
+        settings.emit(yield);
+        fillUpdateRequest(&frame, 0x71E, commands[i], values[i]);
+        assertSize(yield, 1);
+        assertIsCANFrame(yield.messages()[0], frame);
+        yield.clear();
+        fillUpdateResponse(&frame, 0x72E, commands[i]);
+        settings.handle(MessageView(&frame), yield);
+    }
+
+    // Retrieve the new settings once.
+    CAN20Frame state10 = {0x72E, 8, (uint8_t[]){0x10, 0x11, 0x61, 0x01, 0xA0, 0x1E, 0x24, 0x00}};
+    CAN20Frame state21 = {0x72E, 8, (uint8_t[]){0x21, 0x20, 0x0C, 0x40, 0x40, 0x01, 0x64, 0x00}};
+    CAN20Frame state22 = {0x72E, 8, (uint8_t[]){0x22, 0x94, 0x00, 0x00, 0x47, 0xFF, 0xFF, 0xFF}};
+    settings.emit(yield);
+    fillState0221Request(&frame, 0x71E);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+    yield.clear();
+    settings.handle(MessageView(&state10), yield);
+    settings.emit(yield);
+    fillState3000Request(&frame, 0x71E);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+    yield.clear();
+    settings.handle(MessageView(&state21), yield);
+    settings.handle(MessageView(&state22), yield);
+
+    // Exchange exit frames.
+    settings.emit(yield);
+    fillExitRequest(&frame, 0x71E);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+    yield.clear();
+    fillExitResponse(&frame, 0x72E);
+    settings.handle(MessageView(&frame), yield);
+
+    Event expect((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::STATE, (uint8_t[]){0x00, 0x00, 0x00, 0x00});
+    setBit(expect.data, 0, 0, 1);
+    setBit(expect.data, 2, 0, 1);
+    expect.data[2] |= 0x50;
+    settings.emit(yield);
+    assertSize(yield, 1);
+    assertIsEvent(yield.messages()[0], expect);
+}
+
+testF(SettingsTest, SlowSession) {
+    Settings settings(&clock);
+    FakeYield yield;
+    CAN20Frame frame;
+
+    Event illum((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_AUTO_INTERIOR_ILLUM_CMD);
+    Event unlock((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_SELECTIVE_DOOR_UNLOCK_CMD);
+    Event relock((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::NEXT_AUTO_RELOCK_TIME_CMD);
+    settings.handle(MessageView(&illum), yield);
+    settings.handle(MessageView(&unlock), yield);
+    settings.handle(MessageView(&relock), yield);
+
+    settings.emit(yield);
+    yield.clear();
+    clock.delay(400);
+    fillEnterResponse(&frame, 0x72E);
+    settings.handle(MessageView(&frame), yield);
+
+    // Each step has its own timeout so a long session is not cut short.
+    uint8_t commands[] = {0x10, 0x02, 0x2F};
+    uint8_t values[] = {0x01, 0x01, 0x00};
+    for (size_t i = 0; i < 3; ++i) {
+        settings.emit(yield);
+        fillUpdateRequest(&frame, 0x71E, commands[i], values[i]);
+        assertSize(yield, 1);
+        assertIsCANFrame(yield.messages()[0], frame);
+        yield.clear();
+        clock.delay(400);
+        fillUpdateResponse(&frame, 0x72E, commands[i]);
+        settings.handle(MessageView(&frame), yield);
+    }
+
+    settings.emit(yield);
+    fillState0221Request(&frame, 0x71E);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+}
+
+testF(SettingsTest, ResendUnconfirmedChange) {
+    Settings settings(&clock);
+    FakeYield yield;
+    CAN20Frame frame;
+
+    Event illum((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_AUTO_INTERIOR_ILLUM_CMD);
+    settings.handle(MessageView(&illum), yield);
+
+    settings.emit(yield);
+    yield.clear();
+    fillEnterResponse(&frame, 0x72E);
+    settings.handle(MessageView(&frame), yield);
+    settings.emit(yield);
+    fillUpdateRequest(&frame, 0x71E, 0x10, 0x01);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+    yield.clear();
+
+    // The BCM session is exited when the change is not confirmed in time.
+    clock.delay(499);
+    settings.emit(yield);
+    assertSize(yield, 0);
+    clock.delay(1);
+    settings.emit(yield);
+    fillExitRequest(&frame, 0x71E);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+    yield.clear();
+    fillExitResponse(&frame, 0x72E);
+    settings.handle(MessageView(&frame), yield);
+
+    // The change is sent again in the next session.
+    settings.emit(yield);
+    fillEnterRequest(&frame, 0x71E);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+    yield.clear();
+    fillEnterResponse(&frame, 0x72E);
+    settings.handle(MessageView(&frame), yield);
+    settings.emit(yield);
+    fillUpdateRequest(&frame, 0x71E, 0x10, 0x01);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+}
+
+testF(SettingsTest, DropUnconfirmedChange) {
+    Settings settings(&clock);
+    FakeYield yield;
+    CAN20Frame enter;
+    fillEnterRequest(&enter, 0x71E);
+
+    Event illum((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_AUTO_INTERIOR_ILLUM_CMD);
+    Event unlock((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_SELECTIVE_DOOR_UNLOCK_CMD);
+    settings.handle(MessageView(&illum), yield);
+    settings.handle(MessageView(&unlock), yield);
+
+    // The BCM never answers. Each change is tried in two sessions and then
+    // dropped so the ECU stops entering sessions.
+    size_t sessions = 0;
+    for (size_t i = 0; i < 100; ++i) {
+        settings.emit(yield);
+        for (size_t j = 0; j < yield.size(); ++j) {
+            if (yield.messages()[j].type() == Message::CAN_FRAME &&
+                    *yield.messages()[j].can_frame() == enter) {
+                ++sessions;
+            }
+        }
+        yield.clear();
+        clock.delay(100);
+    }
+    assertEqual(sessions, 4u);
+}
+
+testF(SettingsTest, RestageDroppedChange) {
+    Settings settings(&clock);
+    FakeYield yield;
+    CAN20Frame frame;
+    CAN20Frame enter;
+    fillEnterRequest(&enter, 0x71E);
+
+    Event illum((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_AUTO_INTERIOR_ILLUM_CMD);
+    Event unlock((uint8_t)SubSystem::SETTINGS, (uint8_t)SettingsEvent::TOGGLE_SELECTIVE_DOOR_UNLOCK_CMD);
+    settings.handle(MessageView(&illum), yield);
+    settings.handle(MessageView(&unlock), yield);
+
+    // Let the illumination change be dropped while the unlock change is
+    // still queued.
+    size_t sessions = 0;
+    while (sessions < 3) {
+        settings.emit(yield);
+        if (yield.size() > 0 && *yield.messages()[0].can_frame() == enter) {
+            ++sessions;
+        }
+        yield.clear();
+        clock.delay(100);
+    }
+
+    // Later changes build on the settings last reported by the BCM rather
+    // than on the dropped change.
+    settings.handle(MessageView(&illum), yield);
+    while (yield.size() == 0) {
+        clock.delay(100);
+        settings.emit(yield);
+    }
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], enter);
+    yield.clear();
+    fillEnterResponse(&frame, 0x72E);
+    settings.handle(MessageView(&frame), yield);
+
+    settings.emit(yield);
+    fillUpdateRequest(&frame, 0x71E, 0x02, 0x01);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+    yield.clear();
+    fillUpdateResponse(&frame, 0x72E, 0x02);
+    settings.handle(MessageView(&frame), yield);
+
+    settings.emit(yield);
+    fillUpdateRequest(&frame, 0x71E, 0x10, 0x01);
+    assertSize(yield, 1);
+    assertIsCANFrame(yield.messages()[0], frame);
+}
+
 }  // namespace R51
 
 // Test boilerplate.